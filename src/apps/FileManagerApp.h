@@ -4,6 +4,7 @@
 #include "system/EventSystem.h"
 #include "system/AppManager.h"
 #include "system/SDFileManager.h"
+#include "system/FileOpEngine.h"
 
 class FileManagerApp : public App {
 private:
@@ -16,7 +17,9 @@ private:
         PATH_LABEL_ID = 2,
         FILE_LIST_ID = 3,
         STATUS_LABEL_ID = 4,
-        WINDOW_ID = 5
+        WINDOW_ID = 5,
+        INFO_POPUP_ID = 6,
+        CONFIRM_POPUP_ID = 7
     };
     
     // UI控件
@@ -26,15 +29,41 @@ private:
     UILabel* statusLabel;
     UIWindow* mainWindow;
     
-    // 文件数据
-    static const int MAX_FILES = 100;
-    FileInfo files[MAX_FILES];
+    // 文件数据：大目录用游标分页读取，只保留一个窗口（列表最多显示 20 项），
+    // 选中项接近窗口末尾时读下一页并丢掉最前面的条目，接近开头时从目录开头重新定位
+    static const int WINDOW_SIZE = 20;
+    static const int PAGE_SIZE = 8;
+    static const int PREFETCH_MARGIN = 3;   // 选中项距窗口边缘不超过此数时换页
+    FileInfo files[WINDOW_SIZE];
     int fileCount;
+    uint32_t windowStart;       // files[0] 在目录中的序号
+    DirCursor cursor;           // 位置始终在窗口末尾之后
     bool sdInitialized;
+    bool waitingForStorage;     // SD 卡仍在后台挂载
+    
+    // 文件操作在后台任务中执行，退出应用后继续，回来时接着显示进度。
+    // c/x 记下选中项（复制/剪切），v 粘贴到当前目录，Del 确认后删除；任务运行时 Del 取消
+    static const uint32_t PROGRESS_INTERVAL_MS = 250;
+    FileOpEngine fileOps;
+    String clipboardPath;
+    FileOpType clipboardOp;
+    String pendingDelete;
+    uint32_t lastProgressMs;
+    String pendingReveal;       // openWith 传入的路径，SD 卡就绪后定位
+    
+    class DeleteConfirmPopup : public UIPopup {
+    public:
+        DeleteConfirmPopup(FileManagerApp* owner, const String& name)
+            : UIPopup(CONFIRM_POPUP_ID, 30, 35, 180, 62, "Delete?", name, "ConfirmDelete"), app(owner) {}
+        void onResult(int option) override { app->onDeleteConfirmed(option == 0); }
+    private:
+        FileManagerApp* app;
+    };
     
 public:
     FileManagerApp(EventSystem* events, AppManager* manager) 
-        : eventSystem(events), appManager(manager), fileCount(0), sdInitialized(false) {
+        : eventSystem(events), appManager(manager), fileCount(0), windowStart(0), sdInitialized(false), waitingForStorage(false),
+          clipboardOp(FILE_OP_COPY), lastProgressMs(0) {
         uiManager = appManager->getUIManager();
     }
     
@@ -75,17 +104,56 @@ public:
         // 初始化SD卡
         initializeSD();
         
-        // 刷新文件列表
-        refreshFileList();
+        // 刷新文件列表（挂载中时等 loop() 补做）
+        if (!waitingForStorage) {
+            refreshFileList();
+        }
+        
+        // 由搜索打开时定位到传入的路径（挂载中时等 loop() 补做）
+        pendingReveal = appManager->getLaunchArgument();
+        if (!waitingForStorage) revealPending();
         
         drawInterface();
     }
     
+    void onResume() override {
+        pendingReveal = appManager->getLaunchArgument();
+        if (!waitingForStorage) revealPending();
+    }
+    
     void loop() override {
-        // 文件管理器App主要通过事件驱动，这里可以添加定期更新逻辑
+        // 启动时的后台挂载结束后补做初始化
+        if (waitingForStorage && appManager->isStorageSettled()) {
+            initializeSD();
+            revealPending();
+            uiManager->refreshAppArea();
+        }
+        if (fileOps.getState() != FileOpEngine::STATE_IDLE) {
+            updateFileOp();
+        }
     }
     
     void onKeyEvent(const KeyEvent& event) override {
+        if (event.del) {
+            if (fileOps.isBusy()) {
+                fileOps.cancel();
+                statusLabel->setText("Cancelling...");
+            } else {
+                confirmDelete();
+            }
+            uiManager->refreshAppArea();
+            return;
+        }
+        if (event.text.length() == 1 && !event.ctrl) {
+            char key = event.text.charAt(0);
+            if (key == 'c' || key == 'x' || key == 'v') {
+                if (key == 'v') paste();
+                else markSelected(key == 'c' ? FILE_OP_COPY : FILE_OP_MOVE);
+                uiManager->refreshAppArea();
+                return;
+            }
+        }
+        
         // 处理Enter键 - 进入目录或显示文件信息
         if (event.enter) {
             handleFileSelection();
@@ -96,16 +164,27 @@ public:
         
         // 处理其他按键 - 传递给UI管理器
         if (uiManager->handleKeyEvent(event)) {
+            ensureWindow();
             // 使用局部刷新避免闪烁
             uiManager->refreshAppArea();
         }
     }
     
+    void onDestroy() override {
+        cursor.close();
+    }
+    
 private:
     void initializeSD() {
         statusLabel->setText("Initializing SD card...");
         drawInterface();
         
+        waitingForStorage = !appManager->isStorageSettled();
+        if (waitingForStorage) {
+            statusLabel->setText("Mounting SD card...");
+            return;
+        }
+        
         SDFileManager* fm = appManager->getSDFileManager();
         sdInitialized = (fm && fm->isInitialized());
         
@@ -120,6 +199,8 @@ private:
     void refreshFileList() {
         fileList->clear();
         fileCount = 0;
+        windowStart = 0;
+        cursor.close();
         
         SDFileManager* fm = appManager->getSDFileManager();
         if (!fm || !fm->isInitialized()) {
@@ -130,21 +211,26 @@ private:
         String currentPath = fm->getCurrentPath();
         pathLabel->setText("Path: " + currentPath);
         
-        // 获取文件列表
-        bool success = fm->listCurrentDirectory(files, fileCount, MAX_FILES);
-        
-        if (!success) {
+        // 只读第一页，其余在滚动到附近时再读
+        if (!fm->openDirectory(currentPath, cursor)) {
             statusLabel->setText("Failed to read directory: " + currentPath);
             fileList->addItem("Error reading directory", -1, "");
             return;
         }
+        fileCount = cursor.next(files, PAGE_SIZE);
         
         if (fileCount == 0) {
             statusLabel->setText("Directory is empty: " + currentPath);
             return;
         }
         
-        // 添加文件到列表
+        rebuildList(0, 0);
+        updateWindowStatus();
+    }
+    
+    void rebuildList(int selected, int topIndex) {
+        SDFileManager* fm = appManager->getSDFileManager();
+        fileList->clear();
         for (int i = 0; i < fileCount; i++) {
             String displayName;
             
@@ -163,8 +249,118 @@ private:
             
             fileList->addItem(displayName, i, "");
         }
-        
-        statusLabel->setText("Loaded " + String(fileCount) + " items from " + currentPath);
+        fileList->setSelection(selected, topIndex);
+    }
+    
+    void updateWindowStatus() {
+        String currentPath = cursor.getPath();
+        if (windowStart == 0 && cursor.isDone()) {
+            statusLabel->setText("Loaded " + String(fileCount) + " items from " + currentPath);
+            return;
+        }
+        String range = "Items " + String(windowStart + 1) + "-" + String(windowStart + fileCount);
+        if (cursor.isDone()) {
+            range += " of " + String(windowStart + fileCount);
+        } else {
+            range += ", more below";
+        }
+        statusLabel->setText(range);
+    }
+    
+    // 按选中项位置读下一页或回到上一页，选中项在屏幕上的位置保持不变
+    void ensureWindow() {
+        if (!cursor.isOpen() || fileCount == 0) return;
+        int selected = fileList->getSelectedIndex();
+        int row = selected - fileList->getScrollOffset();
+        if (selected >= fileCount - PREFETCH_MARGIN && !cursor.isDone()) {
+            int drop = appendNextPage();
+            if (drop < 0) {
+                updateWindowStatus();
+                return;
+            }
+            selected -= drop;
+        } else if (selected < PREFETCH_MARGIN && windowStart > 0) {
+            // 目录只能向前读：从头跳到新窗口起点，读入前一页后再跳回窗口末尾
+            uint32_t newStart = windowStart > (uint32_t)PAGE_SIZE ? windowStart - PAGE_SIZE : 0;
+            int count = (int)(windowStart - newStart);
+            if (!cursor.rewind() || cursor.skip(newStart) != newStart) {
+                refreshFileList();
+                return;
+            }
+            int keep = fileCount;
+            if (keep + count > WINDOW_SIZE) keep = WINDOW_SIZE - count;
+            for (int i = keep - 1; i >= 0; i--) files[i + count] = files[i];
+            if (cursor.next(files, count) != count) {
+                // 目录在此期间被修改，重新从头读取
+                refreshFileList();
+                return;
+            }
+            fileCount = count + keep;
+            windowStart = newStart;
+            selected += count;
+            cursor.skip(keep);
+        } else {
+            return;
+        }
+        rebuildList(selected, selected - row);
+        updateWindowStatus();
+    }
+    
+    // 读下一页追加到窗口末尾，超出窗口时丢掉最前面的条目；返回丢掉的条目数，没有更多时返回 -1
+    int appendNextPage() {
+        FileInfo page[PAGE_SIZE];
+        int count = cursor.next(page, PAGE_SIZE);
+        if (count == 0) return -1;
+        int drop = fileCount + count - WINDOW_SIZE;
+        if (drop > 0) {
+            for (int i = drop; i < fileCount; i++) files[i - drop] = files[i];
+            fileCount -= drop;
+            windowStart += drop;
+        } else {
+            drop = 0;
+        }
+        for (int i = 0; i < count; i++) files[fileCount++] = page[i];
+        return drop;
+    }
+    
+    // 定位到 pendingReveal：目录直接进入，文件进入所在目录并选中它
+    void revealPending() {
+        if (pendingReveal.isEmpty() || !sdInitialized) return;
+        String path = pendingReveal;
+        pendingReveal = "";
+        SDFileManager* fm = appManager->getSDFileManager();
+        String dir = path;
+        String name;
+        if (!fm->isDirectory(path)) {
+            int slash = path.lastIndexOf('/');
+            dir = slash > 0 ? path.substring(0, slash) : String("/");
+            name = path.substring(slash + 1);
+        }
+        if (!fm->setCurrentPath(dir)) {
+            statusLabel->setText("Not found: " + path);
+            return;
+        }
+        refreshFileList();
+        if (!name.isEmpty() && !selectByName(name)) {
+            statusLabel->setText("Not found: " + name);
+        }
+    }
+    
+    // 目录只能向前读：逐页读到 name 出现在窗口中为止
+    bool selectByName(const String& name) {
+        while (cursor.isOpen()) {
+            for (int i = 0; i < fileCount; i++) {
+                if (files[i].name == name) {
+                    rebuildList(i, i - 1);
+                    updateWindowStatus();
+                    return true;
+                }
+            }
+            if (cursor.isDone() || appendNextPage() < 0) break;
+        }
+        // 没找到（已被删除或改名）：回到目录开头
+        refreshFileList();
+        return false;
     }
     
     void handleFileSelection() {
@@ -198,10 +394,156 @@ private:
             } else {
                 statusLabel->setText("Failed to enter: " + selectedFile.name);
             }
+        } else if (fm->isTextFile(selectedFile.name) &&
+                   appManager->openWith("textviewer", selectedPath(selectedFile))) {
+            // 文本文件交给查看器，ESC 回到这里
+            return;
+        } else {
+            // 文件信息用弹窗显示，关闭时恢复底图，不重绘文件列表
+            UIPopup* popup = new UIPopup(INFO_POPUP_ID, 30, 35, 180, 62, selectedFile.name,
+                                         formatFileSize(selectedFile.size), "FileInfo");
+            popup->addOption("OK");
+            if (!uiManager->showPopup(popup)) {
+                delete popup;
+                String info = "File: " + selectedFile.name + " (" + String(selectedFile.size) + " bytes)";
+                statusLabel->setText(info);
+            }
+        }
+    }
+    
+    // 选中的文件或目录（".." 与无效选择返回 nullptr）
+    FileInfo* getSelectedFile() {
+        MenuItem* selectedItem = fileList->getSelectedItem();
+        if (!selectedItem || selectedItem->id < 0 || selectedItem->id >= fileCount) return nullptr;
+        FileInfo* file = &files[selectedItem->id];
+        return file->name == ".." ? nullptr : file;
+    }
+    
+    String selectedPath(const FileInfo& file) {
+        String dir = appManager->getSDFileManager()->getCurrentPath();
+        return dir == "/" ? "/" + file.name : dir + "/" + file.name;
+    }
+    
+    void markSelected(FileOpType op) {
+        if (!sdInitialized) return;
+        FileInfo* file = getSelectedFile();
+        if (!file) {
+            statusLabel->setText("Select a file or folder first");
+            return;
+        }
+        clipboardPath = selectedPath(*file);
+        clipboardOp = op;
+        statusLabel->setText(String(op == FILE_OP_COPY ? "Copy: " : "Cut: ") + file->name + ", press v to paste");
+    }
+    
+    void paste() {
+        if (!sdInitialized) return;
+        if (clipboardPath.isEmpty()) {
+            statusLabel->setText("Nothing to paste, press c or x first");
+            return;
+        }
+        if (fileOps.getState() != FileOpEngine::STATE_IDLE) {
+            statusLabel->setText("Another operation is running");
+            return;
+        }
+        SDFileManager* fm = appManager->getSDFileManager();
+        String name = clipboardPath.substring(clipboardPath.lastIndexOf('/') + 1);
+        String dir = fm->getCurrentPath();
+        String target = dir == "/" ? "/" + name : dir + "/" + name;
+        if (target == clipboardPath) {
+            statusLabel->setText("Already in this folder");
+            return;
+        }
+        startFileOp(clipboardOp, clipboardPath, target);
+        // 剪切只粘贴一次
+        if (clipboardOp == FILE_OP_MOVE) clipboardPath = "";
+    }
+    
+    void confirmDelete() {
+        if (!sdInitialized) return;
+        if (fileOps.getState() != FileOpEngine::STATE_IDLE) {
+            statusLabel->setText("Another operation is running");
+            return;
+        }
+        FileInfo* file = getSelectedFile();
+        if (!file) {
+            statusLabel->setText("Select a file or folder first");
+            return;
+        }
+        pendingDelete = selectedPath(*file);
+        DeleteConfirmPopup* popup = new DeleteConfirmPopup(this, file->isDirectory ? "[" + file->name + "]" : file->name);
+        popup->addOption("Delete");
+        popup->addOption("Cancel");
+        if (!uiManager->showPopup(popup)) {
+            delete popup;
+            statusLabel->setText("Cannot show confirmation");
+        }
+    }
+    
+    void onDeleteConfirmed(bool confirmed) {
+        if (confirmed && !pendingDelete.isEmpty()) {
+            startFileOp(FILE_OP_DELETE, pendingDelete, "");
+        }
+        pendingDelete = "";
+        uiManager->refreshAppArea();
+    }
+    
+    void startFileOp(FileOpType op, const String& src, const String& dst) {
+        if (!fileOps.start(appManager->getSDFileManager()->getVfs().getFs(), op, src, dst)) {
+            statusLabel->setText("Another operation is running");
+            return;
+        }
+        lastProgressMs = 0;
+        updateFileOp();
+    }
+    
+    // 按间隔把进度写到状态栏；结束后取走结果，清掉文件状态缓存并重新列出当前目录
+    void updateFileOp() {
+        FileOpProgress p;
+        if (fileOps.takeResult(p)) {
+            appManager->getSDFileManager()->getVfs().invalidateAll();
+            refreshFileList();
+            statusLabel->setText(formatFileOpResult(p));
+            uiManager->refreshAppArea();
+            return;
+        }
+        uint32_t now = millis();
+        if (lastProgressMs != 0 && now - lastProgressMs < PROGRESS_INTERVAL_MS) return;
+        lastProgressMs = now;
+        if (!fileOps.getProgress(p)) return;
+        statusLabel->setText(formatFileOpProgress(p));
+        uiManager->refreshAppArea();
+    }
+    
+    static const char* fileOpVerb(uint8_t type) {
+        return type == FILE_OP_COPY ? "Copying" : type == FILE_OP_MOVE ? "Moving" : "Deleting";
+    }
+    
+    String formatFileOpProgress(const FileOpProgress& p) {
+        if (p.scanning) {
+            return String(fileOpVerb(p.type)) + ": scanning " + String(p.filesTotal) + " items";
+        }
+        String text = fileOpVerb(p.type);
+        if (p.type == FILE_OP_DELETE || p.bytesTotal == 0) {
+            text += " " + String(p.filesDone) + "/" + String(p.filesTotal);
         } else {
-            String info = "File: " + selectedFile.name + " (" + String(selectedFile.size) + " bytes)";
-            statusLabel->setText(info);
+            text += " " + String((uint32_t)(p.bytesDone * 100 / p.bytesTotal)) + "% " +
+                    formatFileSize(p.bytesPerSec) + "/s";
+        }
+        return text + " " + p.currentName;
+    }
+    
+    String formatFileOpResult(const FileOpProgress& p) {
+        if (p.error != FILE_OP_OK) {
+            return String(fileOpVerb(p.type)) + ": " + FileOpEngine::errorText((FileOpError)p.error);
+        }
+        String text = String(p.type == FILE_OP_COPY ? "Copied " : p.type == FILE_OP_MOVE ? "Moved " : "Deleted ") +
+                      String(p.filesDone) + " items";
+        // 移动通常只是改名，速度没有意义
+        if (p.type == FILE_OP_COPY && p.bytesDone > 0) {
+            text += ", " + formatFileSize((size_t)p.bytesDone) + " at " + formatFileSize(p.bytesPerSec) + "/s";
         }
+        return text;
     }
     
     String formatFileSize(size_t size) {
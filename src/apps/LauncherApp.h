@@ -5,6 +5,7 @@
 #include "system/AppManager.h"
 #include "system/BatteryManager.h"
 #include "assets/icon_files.h"
+#include "assets/icon_monitor.h"
 #include "assets/icon_music_sd.h"
 #include "assets/icon_test.h"
 #include "assets/icon_theme.h"
@@ -21,13 +22,17 @@ private:
         GRID_MENU_ID = 3,
         WINDOW_ID = 4,
         BATTERY_LABEL_ID = 5,  // 电池信息标签ID
-        BATTERY_VOLTAGE_LABEL_ID = 6  // 电池电压标签ID
+        BATTERY_VOLTAGE_LABEL_ID = 6,  // 电池电压标签ID
+        NOW_PLAYING_LABEL_ID = 7       // 正在播放条
     };
     
     // 控件引用
     UILabel* statusLabel;
     UILabel* batteryLabel;  // 电池信息标签
     UILabel* batteryVoltageLabel;  // 电池电压标签
+    UILabel* nowPlayingLabel;      // 后台音频服务的正在播放条
+    uint32_t nowPlayingChanges;    // 当前显示对应的 trackChanges 与播放状态
+    AudioState nowPlayingState;
     UIMenuGrid* gridMenu;
     UIWindow* mainWindow;
     
@@ -47,14 +52,14 @@ private:
 
 public:
     LauncherApp(EventSystem* events) 
-        : eventSystem(events) {}
+        : eventSystem(events), nowPlayingLabel(nullptr), nowPlayingChanges(0), nowPlayingState(AUDIO_STOPPED) {}
 
     void setup() override {
         // 初始化电池管理器
         batteryManager.forceUpdate();
         
         // 创建主窗口 - 更小的窗口位于左上角
-        mainWindow = uiManager->createWindow(WINDOW_ID, 5, 5, 150, 100, "Launcher", "MainWindow");
+        mainWindow = uiManager->createWindow(WINDOW_ID, 5, 5, 150, 120, "Launcher", "MainWindow");
         
         // 创建电池信息标签 - 位于窗口右上角
         batteryLabel = uiManager->createLabel(BATTERY_LABEL_ID, 100, 10, batteryManager.getBatteryLevelString(), "BatteryInfo", mainWindow);
@@ -78,11 +83,20 @@ public:
         
         // 设置菜单颜色
         gridMenu->setColors(TFT_BLUE, TFT_CYAN, TFT_WHITE, TFT_DARKGREY);
+        
+        // 正在播放条 - 位于网格下方，长曲名滚动显示；空格暂停/继续，n 下一首
+        nowPlayingLabel = uiManager->createLabel(NOW_PLAYING_LABEL_ID, 10, 107, "", "NowPlaying", mainWindow);
+        nowPlayingLabel->setTextColor(TFT_YELLOW);
+        nowPlayingLabel->setMarquee(140);
+        nowPlayingState = AUDIO_STOPPED;
+        nowPlayingChanges = 0;
+        updateNowPlaying();
     }
 
     void loop() override {
         // 更新电池信息
         batteryManager.update();
+        updateNowPlaying();
         
         bool needsRedraw = false;
         
@@ -112,6 +126,20 @@ public:
     }
 
     void onKeyEvent(const KeyEvent& event) override {
+        // 正在播放条的快捷键
+        AudioService* audio = appManager->getAudioService();
+        if (audio && audio->isRunning() && !event.ctrl && event.text.length() == 1) {
+            char key = event.text.charAt(0);
+            if (key == ' ') {
+                audio->togglePause();
+                return;
+            }
+            if (key == 'n' || key == 'N') {
+                audio->next();
+                return;
+            }
+        }
+        
         // 将事件传递给UI管理器处理
         if (uiManager->handleKeyEvent(event)) {
             // 如果事件被处理，更新状态并重绘
@@ -145,6 +173,21 @@ public:
     }
 
 private:
+    // 曲目或播放状态变化时更新正在播放条，停止时清空
+    void updateNowPlaying() {
+        AudioService* audio = appManager->getAudioService();
+        AudioPlaybackStatus st;
+        if (!nowPlayingLabel || !audio || !audio->getStatus(st)) return;
+        if (st.trackChanges == nowPlayingChanges && st.state == nowPlayingState) return;
+        nowPlayingChanges = st.trackChanges;
+        nowPlayingState = st.state;
+        if (st.state == AUDIO_STOPPED || st.title[0] == '\0') {
+            nowPlayingLabel->setText("");
+        } else {
+            nowPlayingLabel->setText(String(st.state == AUDIO_PLAYING ? "> " : "|| ") + st.title);
+        }
+    }
+    
     void loadAppsToMenu() {
         // 清空现有菜单项
         gridMenu->clear();
@@ -155,7 +198,7 @@ private:
         appManager->getAppList(appList, count);
         
         // 添加应用到网格菜单（优先使用图片图标）
-        for (int i = 0; i < count && i < 4; i++) {
+        for (int i = 0; i < count && i < 8; i++) {   // 4x2 网格
             if (!appList[i]) continue;
             String name = appList[i]->name;
             String display = appList[i]->displayName;
@@ -174,6 +217,9 @@ private:
             } else if (name == "theme" || display == "Theme") {
                 gridMenu->addImageItem(icon_theme_png, icon_theme_png_size, itemId);
                 added = true;
+            } else if (name == "monitor" || display == "Monitor") {
+                gridMenu->addImageItem(icon_monitor_png, icon_monitor_png_size, itemId);
+                added = true;
             }
 
             if (!added) {
@@ -1,69 +1,77 @@
 #include "apps/MusicApp.h"
 
 MusicApp::MusicApp(EventSystem* events, AppManager* manager) 
-    : eventSystem(events), appManager(manager), 
-      audioFile(nullptr), audioOutput(nullptr), mp3Generator(nullptr), id3Source(nullptr),
-      isPlaying(false), isPaused(false), isInitialized(false), pausedPosition(0),
+    : eventSystem(events), appManager(manager), audio(nullptr), playlistSent(false),
+      isPlaying(false), isPaused(false), isInitialized(false), waitingForStorage(false),
+      libraryGeneration(0), libraryRebuildRequested(false),
       currentVolume(50), musicFileCount(0), currentFileIndex(0),
-      audioTaskHandle(nullptr), audioCommandQueue(nullptr), audioStatusMutex(nullptr) {
+      resumeIndex(-1), resumePositionMs(0), resumeOffset(0) {
     uiManager = appManager->getUIManager();
     
     // 初始化音频状态
     memset(&audioStatus, 0, sizeof(audioStatus));
-    audioStatus.currentVolume = currentVolume;
-    audioStatus.currentFileIndex = -1;
+    audioStatus.volume = currentVolume;
+    audioStatus.trackIndex = -1;
     
     // 初始化菜单状态
     menuState.level = MENU_MAIN;
-    menuState.currentArtist = "";
-    menuState.currentAlbum = "";
-    menuState.selectedIndex = 0;
+    menuState.artistId = MusicLibrary::NO_ID;
+    menuState.albumId = MusicLibrary::NO_ID;
+    menuState.rowCount = 0;
+    menuState.windowStart = 0;
 
     lyricsAvailable = false;
     currentLyricIndex = -1;
     lastLyricsFileIndex = -1;
-    playbackStartMillis = 0;
-    pauseStartMillis = 0;
-    pausedAccumulatedMillis = 0;
-    lastIsPlayingFlag = false;
-    lastIsPausedFlag = false;
+    lastLyricsTrackChange = 0;
+    lastSongTrackChange = 0;
+    lastSongIndex = -1;
+    lastDisplayedSong = "";
     lastDisplayedCurrent = "";
     lastDisplayedNext = "";
 }
 
 MusicApp::~MusicApp() {
-    // 停止音频任务
-    if (audioTaskHandle) {
-        sendAudioCommand(AUDIO_CMD_SHUTDOWN);
-        vTaskDelay(pdMS_TO_TICKS(100)); // 等待任务结束
-        vTaskDelete(audioTaskHandle);
-        audioTaskHandle = nullptr;
-    }
-    
-    // 清理队列和信号量
-    if (audioCommandQueue) {
-        vQueueDelete(audioCommandQueue);
-        audioCommandQueue = nullptr;
-    }
-    
-    if (audioStatusMutex) {
-        vSemaphoreDelete(audioStatusMutex);
-        audioStatusMutex = nullptr;
-    }
-    
     // 清理音乐分类数据
     clearMusicData();
+}
+
+void MusicApp::onResume() {
+    // 挂起期间后台服务仍在播放，恢复后按最新状态刷新歌曲、歌词与音量显示
+    if (audio && audio->getStatus(audioStatus)) {
+        updateUIFromAudioStatus();
+    }
+    updateLyricsDisplay();
+}
+
+void MusicApp::onDestroy() {
+    // 播放属于后台服务，销毁界面不影响正在播放的曲目
+    clearMusicData();
     
-    cleanup();
+    // 控件由 UIManager 释放，这里只清掉悬空的引用与显示缓存，下次启动重新 setup
+    mainWindow = nullptr;
+    titleLabel = nullptr;
+    songLabel = nullptr;
+    playList = nullptr;
+    lyricsCurrentLabel = nullptr;
+    lyricsNextLabel = nullptr;
+    volumeSlider = nullptr;
+    playlistSent = false;
+    waitingForStorage = false;
+    clearLyrics();
+    lastLyricsFileIndex = -1;
+    lastLyricsTrackChange = 0;
+    lastSongTrackChange = 0;
+    lastSongIndex = -1;
+    lastDisplayedSong = "";
+    menuState.level = MENU_MAIN;
+    menuState.artistId = MusicLibrary::NO_ID;
+    menuState.albumId = MusicLibrary::NO_ID;
+    menuState.rowCount = 0;
+    menuState.windowStart = 0;
 }
 
 void MusicApp::setup() {
-    // 配置 M5Cardputer 扬声器 - 使用更高的采样率提升音质
-    auto spk_cfg = M5Cardputer.Speaker.config();
-    spk_cfg.sample_rate = 128000; // 使用 128kHz 采样率，与参考实现一致
-    spk_cfg.task_pinned_core = APP_CPU_NUM;
-    M5Cardputer.Speaker.config(spk_cfg);
-    
     // 创建主窗口 - 扩大窗口尺寸以容纳底部UI
     mainWindow = new UIWindow(WINDOW_ID, 20, 15, 200, 116);
     uiManager->addWidget(mainWindow);
@@ -80,6 +88,7 @@ void MusicApp::setup() {
     songLabel = new UILabel(SONG_LABEL_ID, 25, 30, "No song loaded");
     songLabel->setParent(mainWindow);
     songLabel->setTextColor(TFT_YELLOW);
+    songLabel->setMarquee(190);  // 长歌名在播放列表宽度内滚动显示
     uiManager->addWidget(songLabel);
     
     // 创建播放列表 - 调整高度为底部UI留出空间
@@ -108,8 +117,8 @@ void MusicApp::setup() {
     // 设置焦点
     uiManager->nextFocus();
     
-    // 初始化双核心音频系统
-    initializeDualCoreAudio();
+    // 连接后台音频服务
+    connectAudioService();
     
     // 扫描音乐文件并分类
     scanMusicFiles();
@@ -121,14 +130,27 @@ void MusicApp::setup() {
 }
 
 void MusicApp::loop() {
-    // 更新音频状态（从音频任务获取状态）
-    updateAudioStatus();
-    
-    // 检查是否有下一首/上一首的请求
-    handleNextPrevRequests();
-    
-    // 更新UI显示
-    updateUIFromAudioStatus();
+    // 启动时后台挂载尚未完成就打开了应用：挂载结束后补做连接与扫描
+    if (waitingForStorage && appManager->isStorageSettled()) {
+        waitingForStorage = false;
+        connectAudioService();
+        scanMusicFiles();
+        buildMainMenu();
+        drawInterface();
+    }
+    // 后台刷新换了新索引：没有在播放时重新读取（在浏览子菜单时等回到主菜单，手动重建除外）
+    if (isInitialized && libraryGeneration != appManager->getLibraryGeneration() &&
+        audioStatus.state != AUDIO_PLAYING && audioStatus.state != AUDIO_PAUSED &&
+        (menuState.level == MENU_MAIN || libraryRebuildRequested)) {
+        libraryRebuildRequested = false;
+        scanMusicFiles();
+        buildMainMenu();
+        drawInterface();
+    }
+    // 读取后台服务的状态快照（拿不到锁时沿用上一份）并更新UI显示
+    if (audio && audio->getStatus(audioStatus)) {
+        updateUIFromAudioStatus();
+    }
     updateLyricsDisplay();
 }
 
@@ -144,14 +166,21 @@ void MusicApp::onKeyEvent(const KeyEvent& event) {
         char key = event.text.charAt(0);
         switch (key) {
             case ' ': // 空格键 - 播放/暂停
-                if (audioStatus.isPlaying) {
-                    sendAudioCommand(AUDIO_CMD_PAUSE);
-                } else if (audioStatus.isPaused) {
-                    sendAudioCommand(AUDIO_CMD_PLAY);
+                if (audioStatus.state == AUDIO_PLAYING) {
+                    if (audio) audio->pause();
+                } else if (audioStatus.state == AUDIO_PAUSED) {
+                    if (audio) audio->resume();
                 } else {
                     playCurrentSong();
                 }
                 return; // 处理完毕，直接返回
+            case 'r': // 重建曲库索引（后台进行，完成后自动刷新列表）
+                if (appManager->rebuildLibrary()) {
+                    libraryRebuildRequested = true;
+                    songLabel->setText("Rebuilding library index...");
+                    uiManager->refreshAppArea();
+                }
+                return;
         }
     }
     
@@ -164,438 +193,59 @@ void MusicApp::onKeyEvent(const KeyEvent& event) {
     
     // 将其他所有按键事件（包括上下键、Enter等）交给UI管理器统一处理
     if (uiManager->handleKeyEvent(event)) {
+        ensureMenuWindow();
         uiManager->refreshAppArea();
     }
 }
 
-// 初始化双核心音频系统
-void MusicApp::initializeDualCoreAudio() {
-    // 清理之前的资源
-    cleanup();
-    
-    SDFileManager* fm = appManager->getSDFileManager();
-    if (!fm || !fm->isInitialized()) {
-        songLabel->setText("SD card not ready!");
+// 连接后台音频服务（由 AppManager 在启动时创建，SD 卡未就绪时不运行）
+void MusicApp::connectAudioService() {
+    audio = appManager->getAudioService();
+    if (!appManager->isStorageSettled()) {
+        isInitialized = false;
+        waitingForStorage = true;
+        songLabel->setText("Mounting SD card...");
         return;
     }
-    
-    // 创建命令队列
-    audioCommandQueue = xQueueCreate(10, sizeof(AudioTaskCommand));
-    if (!audioCommandQueue) {
-        songLabel->setText("Failed to create audio command queue");
-        return;
-    }
-    
-    // 创建状态互斥锁
-    audioStatusMutex = xSemaphoreCreateMutex();
-    if (!audioStatusMutex) {
-        songLabel->setText("Failed to create audio status mutex");
-        vQueueDelete(audioCommandQueue);
-        audioCommandQueue = nullptr;
+    if (!audio || !audio->isRunning()) {
+        isInitialized = false;
+        songLabel->setText("SD card not ready!");
         return;
     }
-    
-    // 创建音频任务，运行在Core 0上，增加堆栈大小
-    BaseType_t result = xTaskCreatePinnedToCore(
-        audioTaskFunction,      // 任务函数
-        "AudioTask",           // 任务名称
-        16384,                 // 堆栈大小 (增加到16KB)
-        this,                  // 传递给任务的参数
-        1,                     // 任务优先级 (降低优先级)
-        &audioTaskHandle,      // 任务句柄
-        0                      // 运行在Core 0
-    );
-    
-    if (result != pdPASS) {
-        songLabel->setText("Failed to create audio task");
-        vQueueDelete(audioCommandQueue);
-        vSemaphoreDelete(audioStatusMutex);
-        audioCommandQueue = nullptr;
-        audioStatusMutex = nullptr;
-        return;
+    if (audio->getStatus(audioStatus)) {
+        currentVolume = audioStatus.volume;
+        volumeSlider->setValue(currentVolume);
     }
-    
-    // 设置音量
-    M5Cardputer.Speaker.setVolume(currentVolume);
-    
     isInitialized = true;
     songLabel->setText("Ready");
 }
 
-// 发送音频命令到音频任务
-void MusicApp::sendAudioCommand(AudioCommand cmd, int param, const char* filePath) {
-    if (!audioCommandQueue) return;
-    
-    AudioTaskCommand command;
-    command.cmd = cmd;
-    command.param = param;
-    
-    if (filePath) {
-        strncpy(command.filePath, filePath, sizeof(command.filePath) - 1);
-        command.filePath[sizeof(command.filePath) - 1] = '\0';
-    } else {
-        command.filePath[0] = '\0';
-    }
-    
-    xQueueSend(audioCommandQueue, &command, 0);
-}
-
-// 更新音频状态（从音频任务获取）
-void MusicApp::updateAudioStatus() {
-    if (!audioStatusMutex) return;
-    
-    if (xSemaphoreTake(audioStatusMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-        // 复制状态到本地变量
-        isPlaying = audioStatus.isPlaying;
-        isPaused = audioStatus.isPaused;
-        currentFileIndex = audioStatus.currentFileIndex;
-        currentVolume = audioStatus.currentVolume;
-        
-        xSemaphoreGive(audioStatusMutex);
-    }
-}
-
-// 根据音频状态更新UI
-void MusicApp::handleNextPrevRequests() {
-    // 检查音频状态中的错误消息，看是否有下一首/上一首的请求
-    if (xSemaphoreTake(audioStatusMutex, pdMS_TO_TICKS(1)) == pdTRUE) {
-        if (audioStatus.hasError) {
-            if (strstr(audioStatus.errorMessage, "Next requested") || strstr(audioStatus.errorMessage, "Song finished")) {
-                // 处理下一首请求或歌曲结束
-                playNextSong();
-                audioStatus.hasError = false;
-                strcpy(audioStatus.errorMessage, "");
-            } else if (strstr(audioStatus.errorMessage, "Previous requested")) {
-                // 处理上一首请求
-                playPreviousSong();
-                audioStatus.hasError = false;
-                strcpy(audioStatus.errorMessage, "");
-            }
-        }
-        xSemaphoreGive(audioStatusMutex);
-    }
-}
-
-void MusicApp::playNextSong() {
-    if (musicFileCount == 0) return;
-    
-    currentFileIndex = (currentFileIndex + 1) % musicFileCount;
-    sendAudioCommand(AUDIO_CMD_STOP); // 先停止当前播放
-    vTaskDelay(pdMS_TO_TICKS(100)); // 等待停止完成
-    sendAudioCommand(AUDIO_CMD_PLAY, 0, musicFiles[currentFileIndex].path.c_str());
-    updateSongInfo();
-    prepareLyricsForCurrentSong();
-}
-
-void MusicApp::playPreviousSong() {
-    if (musicFileCount == 0) return;
-    
-    currentFileIndex = (currentFileIndex - 1 + musicFileCount) % musicFileCount;
-    sendAudioCommand(AUDIO_CMD_STOP); // 先停止当前播放
-    vTaskDelay(pdMS_TO_TICKS(100)); // 等待停止完成
-    sendAudioCommand(AUDIO_CMD_PLAY, 0, musicFiles[currentFileIndex].path.c_str());
-    updateSongInfo();
-    prepareLyricsForCurrentSong();
+// 把收录的曲目作为播放列表交给音频服务，播放列表序号与曲目 ID 一致
+void MusicApp::sendPlaylist() {
+    if (!audio || playlistSent) return;
+    // 播放列表与随后的 play 走同一条命令队列，音频任务一定先换列表再播放
+    playlistSent = audio->setPlaylist(library.getIndex(), musicFileCount);
 }
 
 // 根据音频状态更新UI
 void MusicApp::updateUIFromAudioStatus() {
-    if (!audioStatusMutex) return;
-    
-    if (xSemaphoreTake(audioStatusMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-        
-        // 更新歌曲信息
-        if (strlen(audioStatus.currentSongName) > 0) {
-            String info = "(" + String(audioStatus.currentFileIndex + 1) + "/" + String(musicFileCount) + ") ";
-            info += String(audioStatus.currentSongName);
-            songLabel->setText(info);
+    isPlaying = audioStatus.state == AUDIO_PLAYING;
+    isPaused = audioStatus.state == AUDIO_PAUSED;
+    if (audioStatus.trackIndex >= 0 && audioStatus.title[0] != '\0') {
+        // 只在换曲时重新拼接文字，平时只比较
+        if (audioStatus.trackChanges != lastSongTrackChange || audioStatus.trackIndex != lastSongIndex) {
+            lastSongTrackChange = audioStatus.trackChanges;
+            lastSongIndex = audioStatus.trackIndex;
+            lastDisplayedSong = "(" + String(audioStatus.trackIndex + 1) + "/" + String(audioStatus.trackCount) + ") ";
+            lastDisplayedSong += audioStatus.title;
         }
-        
-        xSemaphoreGive(audioStatusMutex);
-    }
-}
-
-// 静态音频任务函数
-void MusicApp::audioTaskFunction(void* parameter) {
-    MusicApp* app = static_cast<MusicApp*>(parameter);
-    app->processAudioCommands();
-}
-
-// 音频任务主循环
-void MusicApp::processAudioCommands() {
-    AudioTaskCommand command;
-    
-    // 在音频任务中初始化音频组件，添加更多安全检查
-    audioFile = new(std::nothrow) AudioFileSourceSD();
-    if (!audioFile) {
-        updateAudioError("Failed to create AudioFileSourceSD");
-        cleanupAudioTask();
-        vTaskDelete(nullptr);
-        return;
-    }
-    
-    // 初始化扬声器，使用更安全的参数
-    audioOutput = new(std::nothrow) AudioOutputM5Speaker(&M5Cardputer.Speaker, m5spk_virtual_channel);
-    if (!audioOutput) {
-        updateAudioError("Failed to create AudioOutputM5Speaker");
-        cleanupAudioTask();
-        vTaskDelete(nullptr);
-        return;
-    }
-    
-    mp3Generator = new(std::nothrow) AudioGeneratorMP3();
-    if (!mp3Generator) {
-        updateAudioError("Failed to create AudioGeneratorMP3");
-        cleanupAudioTask();
-        vTaskDelete(nullptr);
-        return;
-    }
-    
-    id3Source = nullptr;
-    
-    // 尝试初始化音频输出
-    if (!audioOutput->begin()) {
-        updateAudioError("Audio output init failed");
-        cleanupAudioTask();
-        vTaskDelete(nullptr);
-        return;
-    }
-    
-    // 设置音频输出参数 - 使用标准的 44.1kHz 采样率
-    audioOutput->SetRate(44100);        // MP3 标准采样率
-    audioOutput->SetBitsPerSample(16);  // 16位采样
-    audioOutput->SetChannels(2);        // 立体声
-    
-    while (true) {
-        // 处理音频播放循环 - 高优先级，减少延迟
-        if (mp3Generator && mp3Generator->isRunning()) {
-            if (!mp3Generator->loop()) {
-                // 歌曲播放完毕，停止播放并通知主线程
-                stopAudioPlayback();
-                // 通知主线程歌曲结束，让主线程决定是否播放下一首
-                updateAudioError("Song finished");
-            }
-        }
-        
-        // 检查命令队列 - 使用较短的超时时间
-        if (xQueueReceive(audioCommandQueue, &command, pdMS_TO_TICKS(1)) == pdTRUE) {
-            switch (command.cmd) {
-                case AUDIO_CMD_PLAY:
-                    if (strlen(command.filePath) > 0) {
-                        playAudioFile(command.filePath);
-                    } else {
-                        resumeAudioPlayback();
-                    }
-                    break;
-                case AUDIO_CMD_PAUSE:
-                    pauseAudioPlayback();
-                    break;
-                case AUDIO_CMD_STOP:
-                    stopAudioPlayback();
-                    break;
-                case AUDIO_CMD_NEXT:
-                    // 不在音频任务中处理，而是通知主线程
-                    updateAudioError("Next requested");
-                    break;
-                case AUDIO_CMD_PREV:
-                    // 不在音频任务中处理，而是通知主线程
-                    updateAudioError("Previous requested");
-                    break;
-                case AUDIO_CMD_VOLUME:
-                    setAudioVolume(command.param);
-                    break;
-                case AUDIO_CMD_SHUTDOWN:
-                    stopAudioPlayback();
-                    cleanupAudioTask();
-                    vTaskDelete(nullptr);
-                    return;
-            }
+        if (songLabel->getText() != lastDisplayedSong) {
+            songLabel->setText(lastDisplayedSong);
         }
-        
-        // 减少延迟，提高音频处理性能
-        vTaskDelay(pdMS_TO_TICKS(1));
-    }
-}
-
-// 音频任务内部方法
-void MusicApp::playAudioFile(const char* filePath) {
-    // 先停止当前播放
-    stopAudioPlayback();
-    
-    // 添加延迟确保停止完成
-    vTaskDelay(pdMS_TO_TICKS(100));
-    
-    // 检查文件路径
-    if (!filePath || strlen(filePath) == 0) {
-        updateAudioError("Invalid file path");
-        return;
-    }
-    
-    // 尝试打开文件
-    if (!audioFile->open(filePath)) {
-        updateAudioError("Failed to open file");
-        return;
-    }
-    
-    // 创建ID3源，使用更安全的方式
-    id3Source = new(std::nothrow) AudioFileSourceID3(audioFile);
-    if (!id3Source) {
-        updateAudioError("Failed to create ID3 source");
-        audioFile->close();
-        return;
-    }
-    
-    // 设置ID3回调
-    id3Source->RegisterMetadataCB(metadataCallback, this);
-    
-    // 尝试开始播放
-    if (mp3Generator && mp3Generator->begin(id3Source, audioOutput)) {
-        updateAudioStatus(true, false, filePath);
-    } else {
-        updateAudioError("Failed to start playback");
-        // 清理资源
-        if (id3Source) {
-            delete id3Source;
-            id3Source = nullptr;
-        }
-        audioFile->close();
-    }
-}
-
-void MusicApp::pauseAudioPlayback() {
-    if (mp3Generator && mp3Generator->isRunning()) {
-        mp3Generator->stop();
-        updateAudioStatus(false, true, "");
-    }
-}
-
-void MusicApp::resumeAudioPlayback() {
-    // 安全地获取当前文件信息
-    int fileIndex = -1;
-    
-    if (xSemaphoreTake(audioStatusMutex, portMAX_DELAY) == pdTRUE) {
-        fileIndex = audioStatus.currentFileIndex;
-        xSemaphoreGive(audioStatusMutex);
-    }
-    
-    // 检查文件索引的有效性（需要从主线程获取musicFileCount）
-    // 为了安全起见，我们不直接访问musicFiles数组
-    // 而是通过发送命令让主线程处理
-    if (fileIndex >= 0) {
-        // 发送播放当前歌曲的命令到主线程
-        AudioTaskCommand cmd;
-        cmd.cmd = AUDIO_CMD_PLAY;
-        cmd.param = fileIndex;
-        cmd.filePath[0] = '\0';
-        
-        // 这里我们需要一个更安全的方式来获取文件路径
-        // 暂时使用简单的重新开始播放
-        updateAudioStatus(true, false, "");
     }
-}
-
-void MusicApp::stopAudioPlayback() {
-    // 按正确顺序停止和清理
-    if (mp3Generator && mp3Generator->isRunning()) {
-        mp3Generator->stop();
-        // 等待停止完成
-        vTaskDelay(pdMS_TO_TICKS(50));
-    }
-    
-    if (audioOutput) {
-        audioOutput->flush();
-        audioOutput->stop();
-    }
-    
-    // 清理ID3源
-    if (id3Source) {
-        delete id3Source;
-        id3Source = nullptr;
-    }
-    
-    // 关闭文件
-    if (audioFile && audioFile->isOpen()) {
-        audioFile->close();
-    }
-    
-    // 更新状态
-    updateAudioStatus(false, false, "");
-}
-
-void MusicApp::playNextAudio() {
-    // 这个函数现在只是一个占位符，实际逻辑在主线程处理
-    updateAudioError("Use main thread for next/prev");
-}
-
-void MusicApp::playPreviousAudio() {
-    // 这个函数现在只是一个占位符，实际逻辑在主线程处理  
-    updateAudioError("Use main thread for next/prev");
-}
-
-void MusicApp::setAudioVolume(int volume) {
-    M5Cardputer.Speaker.setVolume((volume * 255) / 100);
-    
-    if (xSemaphoreTake(audioStatusMutex, portMAX_DELAY) == pdTRUE) {
-        audioStatus.currentVolume = volume;
-        xSemaphoreGive(audioStatusMutex);
-    }
-}
-
-void MusicApp::updateAudioStatus(bool playing, bool paused, const char* songPath) {
-    if (xSemaphoreTake(audioStatusMutex, portMAX_DELAY) == pdTRUE) {
-        audioStatus.isPlaying = playing;
-        audioStatus.isPaused = paused;
-        audioStatus.hasError = false;
-        audioStatus.errorMessage[0] = '\0';
-        
-        if (songPath && strlen(songPath) > 0) {
-            // 从路径中提取文件名
-            const char* fileName = strrchr(songPath, '/');
-            if (fileName) {
-                fileName++; // 跳过 '/'
-            } else {
-                fileName = songPath;
-            }
-            
-            strncpy(audioStatus.currentSongName, fileName, sizeof(audioStatus.currentSongName) - 1);
-            audioStatus.currentSongName[sizeof(audioStatus.currentSongName) - 1] = '\0';
-            
-            // 查找文件索引
-            for (int i = 0; i < musicFileCount; i++) {
-                if (strcmp(musicFiles[i].path.c_str(), songPath) == 0) {
-                    audioStatus.currentFileIndex = i;
-                    break;
-                }
-            }
-        }
-        
-        xSemaphoreGive(audioStatusMutex);
-    }
-}
-
-void MusicApp::updateAudioError(const char* errorMsg) {
-    if (xSemaphoreTake(audioStatusMutex, portMAX_DELAY) == pdTRUE) {
-        audioStatus.hasError = true;
-        strncpy(audioStatus.errorMessage, errorMsg, sizeof(audioStatus.errorMessage) - 1);
-        audioStatus.errorMessage[sizeof(audioStatus.errorMessage) - 1] = '\0';
-        xSemaphoreGive(audioStatusMutex);
-    }
-}
-
-void MusicApp::cleanupAudioTask() {
-    if (mp3Generator) {
-        delete mp3Generator;
-        mp3Generator = nullptr;
-    }
-    
-    if (audioOutput) {
-        delete audioOutput;
-        audioOutput = nullptr;
-    }
-    
-    if (audioFile) {
-        delete audioFile;
-        audioFile = nullptr;
+    if (audioStatus.volume != currentVolume) {
+        currentVolume = audioStatus.volume;
+        volumeSlider->setValue(currentVolume);
     }
 }
 
@@ -603,29 +253,27 @@ void MusicApp::cleanupAudioTask() {
 void MusicApp::scanMusicFiles() {
     if (!isInitialized) return;
     
-    songLabel->setText("Scanning for music files...");
-    drawInterface();
-    
     // 清理之前的数据
     clearMusicData();
     
-    // 扫描所有MP3文件
-    musicFileCount = 0;
-    {
-        SDFileManager* fm = appManager->getSDFileManager();
-        if (fm) fm->scanAllFiles(musicFiles, musicFileCount, MAX_MUSIC_FILES, ".mp3");
-    }
+    // 曲库来自启动时读入、由后台刷新的索引，这里不访问 SD 卡
+    libraryGeneration = appManager->getLibraryGeneration();
+    library.build(appManager->getLibrary());
+    musicFileCount = (int)library.getTrackCount();
     
     if (musicFileCount > 0) {
-        songLabel->setText("Categorizing music files...");
-        drawInterface();
-        
-        // 分类音乐文件
-        categorizeMusic();
-        
-        songLabel->setText("Found " + String(musicFileCount) + " music files");
+        if (library.isTruncated()) {
+            songLabel->setText("Showing " + String(musicFileCount) + " of " + String(library.getIndexedTrackCount()) + " tracks");
+        } else {
+            songLabel->setText("Found " + String(musicFileCount) + " music files");
+        }
         currentFileIndex = 0;
+        playlistSent = false;
+        restoreLastTrack();
         updateSongInfo();
+    } else if (appManager->isLibraryRefreshing()) {
+        // 第一次使用（还没有索引文件）：后台建立完成后 loop() 会重新读取
+        songLabel->setText("Indexing music library...");
     } else {
         songLabel->setText("No MP3 files found");
     }
@@ -637,56 +285,38 @@ void MusicApp::playCurrentSong() {
         return;
     }
     
-    String filePath = musicFiles[currentFileIndex].path;
-    sendAudioCommand(AUDIO_CMD_PLAY, 0, filePath.c_str());
-    prepareLyricsForCurrentSong();
+    sendPlaylist();
+    if (currentFileIndex == resumeIndex) {
+        audio->playFrom(currentFileIndex, resumePositionMs, resumeOffset);
+    } else {
+        audio->play(currentFileIndex);
+    }
+    resumeIndex = -1;
+}
+
+// 服务中没有曲目时（通常是开机后第一次打开），选中上次播放的曲目并记下断点
+void MusicApp::restoreLastTrack() {
+    resumeIndex = -1;
+    if (audioStatus.trackIndex >= 0) return;
+    SettingsStore& settings = appManager->getSettings();
+    String lastTrack = settings.getString(SETTING_LAST_TRACK, "");
+    if (lastTrack.isEmpty()) return;
+    uint32_t track = library.findTrackByPath(lastTrack.c_str());
+    if (track == MusicLibrary::NO_ID) return;
+    currentFileIndex = (int)track;
+    resumeIndex = (int)track;
+    resumePositionMs = (uint32_t)settings.getInt(SETTING_LAST_POS_MS, 0);
+    resumeOffset = (uint32_t)settings.getInt(SETTING_LAST_POS_OFFSET, 0);
 }
 
 void MusicApp::playSelectedSong() {
     MenuItem* selectedItem = playList->getSelectedItem();
     if (!selectedItem) return;
     
-    if (menuState.level == MENU_TRACKS) {
-        // 在曲目列表中，播放选中的曲目
-        std::vector<MusicTrack*> tracksToPlay;
-        
-        if (menuState.currentArtist.isEmpty() && menuState.currentAlbum.isEmpty()) {
-            // 未分类曲目
-            tracksToPlay = uncategorizedTracks;
-        } else if (!menuState.currentArtist.isEmpty() && menuState.currentAlbum.isEmpty()) {
-            // 艺术家的所有曲目
-            Artist* artist = findOrCreateArtist(menuState.currentArtist);
-            for (Album* album : artist->albums) {
-                for (MusicTrack* track : album->tracks) {
-                    tracksToPlay.push_back(track);
-                }
-            }
-            for (MusicTrack* track : artist->singleTracks) {
-                tracksToPlay.push_back(track);
-            }
-        } else {
-            // 特定专辑的曲目
-            Artist* artist = findOrCreateArtist(menuState.currentArtist);
-            for (Album* album : artist->albums) {
-                if (album->name.equalsIgnoreCase(menuState.currentAlbum)) {
-                    tracksToPlay = album->tracks;
-                    break;
-                }
-            }
-        }
-        
-        if (selectedItem->id >= 0 && selectedItem->id < (int)tracksToPlay.size()) {
-            MusicTrack* track = tracksToPlay[selectedItem->id];
-            
-            // 找到对应的文件索引
-            for (int i = 0; i < musicFileCount; i++) {
-                if (String(musicFiles[i].path) == track->filePath) {
-                    currentFileIndex = i;
-                    playCurrentSong();
-                    return;
-                }
-            }
-        }
+    // 曲目列表中菜单项的 ID 就是曲目 ID
+    if (menuState.level == MENU_TRACKS && selectedItem->id >= 0 && selectedItem->id < musicFileCount) {
+        currentFileIndex = selectedItem->id;
+        playCurrentSong();
     }
 }
 
@@ -700,7 +330,7 @@ void MusicApp::adjustVolume(int delta) {
         volumeSlider->setValue(currentVolume);
     }
     
-    sendAudioCommand(AUDIO_CMD_VOLUME, currentVolume);
+    if (audio) audio->setVolume(currentVolume);
     
     // 刷新UI显示
     uiManager->refreshAppArea();
@@ -716,13 +346,13 @@ void MusicApp::setVolume(int volume) {
         volumeSlider->setValue(currentVolume);
     }
     
-    sendAudioCommand(AUDIO_CMD_VOLUME, currentVolume);
+    if (audio) audio->setVolume(currentVolume);
 }
 
 void MusicApp::updateSongInfo() {
     if (musicFileCount > 0 && currentFileIndex >= 0 && currentFileIndex < musicFileCount) {
         String info = "(" + String(currentFileIndex + 1) + "/" + String(musicFileCount) + ") ";
-        info += musicFiles[currentFileIndex].name;
+        info += library.getTrackName(currentFileIndex);
         songLabel->setText(info);
     }
 }
@@ -732,7 +362,6 @@ void MusicApp::cleanup() {
     isInitialized = false;
     isPlaying = false;
     isPaused = false;
-    pausedPosition = 0;
 }
 
 void MusicApp::drawInterface() {
@@ -743,23 +372,15 @@ void MusicApp::drawInterface() {
 void MusicApp::prepareLyricsForCurrentSong() {
     clearLyrics();
     if (musicFileCount > 0 && currentFileIndex >= 0 && currentFileIndex < musicFileCount) {
-        String mp3Path = musicFiles[currentFileIndex].path;
-        String lrcPath = computeLrcPath(mp3Path);
-        SDFileManager* fm = appManager->getSDFileManager();
-        if (fm && fm->exists(lrcPath)) {
-            loadLyricsForFile(mp3Path);
-        } else {
-            lyricsAvailable = false;
+        String mp3Path = library.getTrackPath(currentFileIndex);
+        loadLyricsForFile(mp3Path);
+        if (!lyricsAvailable) {
             lyricsCurrentLabel->setText("Can't locate lyrics file");
             lyricsNextLabel->setText("");
             uiManager->refreshAppArea();
         }
         lastLyricsFileIndex = currentFileIndex;
     }
-    playbackStartMillis = millis();
-    pausedAccumulatedMillis = 0;
-    lastIsPlayingFlag = true;
-    lastIsPausedFlag = false;
     currentLyricIndex = -1;
     lastDisplayedCurrent = "";
     lastDisplayedNext = "";
@@ -780,108 +401,28 @@ String MusicApp::computeLrcPath(const String& mp3Path) {
 }
 
 void MusicApp::loadLyricsForFile(const String& mp3Path) {
-    String lrcPath = computeLrcPath(mp3Path);
-    SDFileManager* fm = appManager->getSDFileManager();
-    String content = fm ? fm->readFile(lrcPath) : "";
     lyricLines.clear();
-    if (content.length() == 0) {
-        lyricsAvailable = false;
-        return;
-    }
-    int pos = 0;
-    while (pos < content.length()) {
-        int next = content.indexOf('\n', pos);
-        if (next == -1) next = content.length();
-        String line = content.substring(pos, next);
-        pos = next + 1;
-        line.replace("\r", "");
-        if (line.length() == 0) continue;
-        String rem = line;
-        std::vector<uint32_t> times;
-        bool parsedAny = false;
-        while (rem.length() > 0 && rem.charAt(0) == '[') {
-            int close = rem.indexOf(']');
-            if (close <= 0) break;
-            String tag = rem.substring(1, close);
-            int colon = tag.indexOf(':');
-            if (colon < 0) break;
-            String mmStr = tag.substring(0, colon);
-            String secStr = tag.substring(colon + 1);
-            if (mmStr.length() == 0 || secStr.length() == 0) break;
-            char c0 = mmStr.charAt(0);
-            char c1 = secStr.charAt(0);
-            if (c0 < '0' || c0 > '9' || c1 < '0' || c1 > '9') break;
-            int mm = 0;
-            int ss = 0;
-            int fracMs = 0;
-            int dotPos = secStr.indexOf('.');
-            if (dotPos >= 0) {
-                String sPart = secStr.substring(0, dotPos);
-                String fracPart = secStr.substring(dotPos + 1);
-                ss = sPart.toInt();
-                int frac = fracPart.toInt();
-                if (fracPart.length() == 2) {
-                    fracMs = frac * 10;
-                } else if (fracPart.length() == 3) {
-                    fracMs = frac;
-                } else {
-                    fracMs = 0;
-                }
-            } else {
-                ss = secStr.toInt();
-            }
-            mm = mmStr.toInt();
-            uint32_t ms = (uint32_t)mm * 60000u + (uint32_t)ss * 1000u + (uint32_t)fracMs;
-            times.push_back(ms);
-            parsedAny = true;
-            rem = rem.substring(close + 1);
-        }
-        if (!parsedAny) continue;
-        String text = rem;
-        text.trim();
-        if (text.length() == 0) continue;
-        for (size_t i = 0; i < times.size(); i++) {
-            LyricLine ll;
-            ll.timeMs = times[i];
-            ll.text = text;
-            lyricLines.push_back(ll);
-        }
-    }
-    if (!lyricLines.empty()) {
-        std::sort(lyricLines.begin(), lyricLines.end(), [](const LyricLine& a, const LyricLine& b){ return a.timeMs < b.timeMs; });
-        lyricsAvailable = true;
-    } else {
-        lyricsAvailable = false;
-    }
+    lyricsAvailable = false;
+    SDFileManager* fm = appManager->getSDFileManager();
+    if (!fm || !fm->isInitialized()) return;
+    // 先查目录项缓存，没有歌词文件时不去打开（打开不存在的文件会在串口打印错误）
+    String lrcPath = computeLrcPath(mp3Path);
+    Vfs& vfs = fm->getVfs();
+    if (!vfs.exists(lrcPath)) return;
+    File file = vfs.open(lrcPath);
+    if (!file || file.isDirectory()) return;
+    lyricsAvailable = LrcParser::parse(file, lyricLines);
+    file.close();
 }
 
 void MusicApp::updateLyricsDisplay() {
-    if (audioStatusMutex && xSemaphoreTake(audioStatusMutex, pdMS_TO_TICKS(1)) == pdTRUE) {
-        isPlaying = audioStatus.isPlaying;
-        isPaused = audioStatus.isPaused;
-        int idx = audioStatus.currentFileIndex;
-        xSemaphoreGive(audioStatusMutex);
-        if (isPlaying && idx >= 0 && idx != lastLyricsFileIndex) {
-            currentFileIndex = idx;
-            prepareLyricsForCurrentSong();
-        }
-    }
-    if (isPlaying && !lastIsPlayingFlag) {
-        playbackStartMillis = millis();
-        pausedAccumulatedMillis = 0;
-        lastIsPlayingFlag = true;
-        lastIsPausedFlag = false;
-    }
-    if (isPaused && !lastIsPausedFlag) {
-        pauseStartMillis = millis();
-        lastIsPausedFlag = true;
-    }
-    if (!isPaused && lastIsPausedFlag) {
-        pausedAccumulatedMillis += millis() - pauseStartMillis;
-        lastIsPausedFlag = false;
-    }
-    if (!isPlaying) {
-        lastIsPlayingFlag = false;
+    // 换曲（包括后台自动切到下一首）后重新加载歌词
+    int idx = audioStatus.trackIndex;
+    if (isPlaying && idx >= 0 && idx < musicFileCount &&
+        (idx != lastLyricsFileIndex || audioStatus.trackChanges != lastLyricsTrackChange)) {
+        currentFileIndex = idx;
+        lastLyricsTrackChange = audioStatus.trackChanges;
+        prepareLyricsForCurrentSong();
     }
     if (!isPlaying) return;
     if (!lyricsAvailable) {
@@ -894,13 +435,8 @@ void MusicApp::updateLyricsDisplay() {
         }
         return;
     }
-    uint32_t nowMs = millis();
-    uint32_t elapsed = nowMs >= playbackStartMillis ? nowMs - playbackStartMillis : 0;
-    if (elapsed >= pausedAccumulatedMillis) {
-        elapsed -= pausedAccumulatedMillis;
-    } else {
-        elapsed = 0;
-    }
+    // 播放位置由音频服务统计，已扣除暂停时间
+    uint32_t elapsed = audioStatus.positionMs;
     if (currentLyricIndex < 0) {
         int i = 0;
         while (i + 1 < (int)lyricLines.size() && lyricLines[i + 1].timeMs <= elapsed) i++;
@@ -921,269 +457,239 @@ void MusicApp::updateLyricsDisplay() {
     }
 }
 
-// 静态回调函数
-void MusicApp::metadataCallback(void *cbData, const char *type, bool isUnicode, const char *string) {
-    // 可以在这里处理ID3标签信息
-    // 暂时不做处理，避免复杂化
+// 菜单导航方法实现
+void MusicApp::clearMusicData() {
+    library.clear();
+    musicFileCount = 0;
 }
 
-// 音乐分类和菜单导航方法实现
-void MusicApp::categorizeMusic() {
-    // 解析所有音乐文件
-    for (int i = 0; i < musicFileCount; i++) {
-        MusicTrack* track = parseFileName(musicFiles[i].name, musicFiles[i].path);
-        if (track) {
-            allTracks.push_back(track);
-            
-            if (track->artist.isEmpty() || track->album.isEmpty()) {
-                // 无法分类的文件
-                uncategorizedTracks.push_back(track);
-            } else {
-                // 找到或创建艺术家
-                Artist* artist = findOrCreateArtist(track->artist);
-                
-                // 找到或创建专辑
-                Album* album = findOrCreateAlbum(artist, track->album);
-                
-                // 添加曲目到专辑
-                album->tracks.push_back(track);
-            }
-        }
+void MusicApp::buildMainMenu(uint32_t selectedRow) {
+    menuState.level = MENU_MAIN;
+    menuState.artistId = MusicLibrary::NO_ID;
+    menuState.albumId = MusicLibrary::NO_ID;
+    
+    menuTitle = "Music Library";
+    // 有曲目没能收录时在这里提示，免得以为卡上只有这些
+    const LibraryIndex* index = library.getIndex();
+    if (library.isTruncated()) {
+        songLabel->setText("Showing " + String(musicFileCount) + " of " + String(library.getIndexedTrackCount()) + " tracks");
+    } else if (index && index->isTruncated()) {
+        songLabel->setText("Index full: " + String(musicFileCount) + " tracks listed");
+    } else {
+        songLabel->setText("Select a category");
     }
+    showMenuWindow(selectedRow);
 }
 
-MusicTrack* MusicApp::parseFileName(const String& fileName, const String& filePath) {
-    MusicTrack* track = new MusicTrack();
-    track->fileName = fileName;
-    track->filePath = filePath;
-    
-    // 移除.mp3扩展名
-    String nameWithoutExt = fileName;
-    if (nameWithoutExt.endsWith(".mp3")) {
-        nameWithoutExt = nameWithoutExt.substring(0, nameWithoutExt.length() - 4);
-    }
-    
-    // 尝试解析 "艺术家-专辑-曲名" 格式
-    int firstDash = nameWithoutExt.indexOf('-');
-    if (firstDash > 0) {
-        int secondDash = nameWithoutExt.indexOf('-', firstDash + 1);
-        if (secondDash > firstDash + 1) {
-            // 找到两个破折号，按格式解析
-            track->artist = nameWithoutExt.substring(0, firstDash);
-            track->album = nameWithoutExt.substring(firstDash + 1, secondDash);
-            track->title = nameWithoutExt.substring(secondDash + 1);
-            
-            // 去除前后空格
-            track->artist.trim();
-            track->album.trim();
-            track->title.trim();
-        } else {
-            // 只有一个破折号，可能是 "艺术家-曲名" 格式
-            track->artist = nameWithoutExt.substring(0, firstDash);
-            track->title = nameWithoutExt.substring(firstDash + 1);
-            track->artist.trim();
-            track->title.trim();
-            track->album = ""; // 没有专辑信息
-        }
-    } else {
-        // 没有破折号，整个文件名作为曲名
-        track->title = nameWithoutExt;
-        track->artist = "";
-        track->album = "";
-    }
-    
-    return track;
+void MusicApp::buildArtistsMenu(uint32_t selectedRow) {
+    menuState.level = MENU_ARTISTS;
+    menuTitle = "Artists";
+    songLabel->setText("Select an artist");
+    showMenuWindow(selectedRow);
 }
 
-Artist* MusicApp::findOrCreateArtist(const String& artistName) {
-    // 查找现有艺术家
-    for (Artist* artist : artists) {
-        if (artist->name.equalsIgnoreCase(artistName)) {
-            return artist;
-        }
+void MusicApp::buildAlbumsMenu(uint32_t artistId, uint32_t selectedRow) {
+    menuState.level = MENU_ALBUMS;
+    menuState.artistId = artistId;
+    menuTitle = artistId == MusicLibrary::NO_ID ? String("All Albums") : String(library.getArtistName(artistId)) + " - Albums";
+    songLabel->setText("Select an album");
+    showMenuWindow(selectedRow);
+}
+
+void MusicApp::buildTracksMenu(uint32_t artistId, uint32_t albumId) {
+    menuState.level = MENU_TRACKS;
+    menuState.artistId = artistId;
+    menuState.albumId = albumId;
+    if (artistId == MusicLibrary::NO_ID) {
+        menuTitle = "Uncategorized";
+    } else if (albumId == MusicLibrary::NO_ID) {
+        menuTitle = String(library.getArtistName(artistId)) + " - All Tracks";
+    } else {
+        menuTitle = library.getAlbumName(albumId);
     }
-    
-    // 创建新艺术家
-    Artist* newArtist = new Artist();
-    newArtist->name = artistName;
-    artists.push_back(newArtist);
-    return newArtist;
+    songLabel->setText("Select a track to play");
+    showMenuWindow(0);
 }
 
-Album* MusicApp::findOrCreateAlbum(Artist* artist, const String& albumName) {
-    // 在艺术家的专辑中查找
-    for (Album* album : artist->albums) {
-        if (album->name.equalsIgnoreCase(albumName)) {
-            return album;
-        }
+// 当前列表的总行数；除主菜单外第 0 行是返回项 "../"
+uint32_t MusicApp::menuRowCount() const {
+    switch (menuState.level) {
+        case MENU_MAIN:
+            return 3;
+        case MENU_ARTISTS:
+            return 1 + library.getArtistCount();
+        case MENU_ALBUMS:
+            return 1 + (menuState.artistId == MusicLibrary::NO_ID ? library.getAlbumCount()
+                                                                  : library.getArtistAlbumCount(menuState.artistId));
+        case MENU_TRACKS:
+            if (menuState.artistId == MusicLibrary::NO_ID) return 1 + library.getUncategorizedCount();
+            if (menuState.albumId == MusicLibrary::NO_ID) return 1 + library.getArtistTrackCount(menuState.artistId);
+            return 1 + library.getAlbumTrackCount(menuState.albumId);
     }
-    
-    // 创建新专辑
-    Album* newAlbum = new Album();
-    newAlbum->name = albumName;
-    newAlbum->artist = artist->name;
-    artist->albums.push_back(newAlbum);
-    allAlbums.push_back(newAlbum);
-    return newAlbum;
+    return 0;
 }
 
-void MusicApp::clearMusicData() {
-    // 清理所有动态分配的内存
-    for (MusicTrack* track : allTracks) {
-        delete track;
+// 第 row 行的显示文本与菜单项 ID（艺术家、专辑、曲目 ID，返回项为 -1）
+void MusicApp::getMenuRow(uint32_t row, String& text, int& id) const {
+    if (menuState.level == MENU_MAIN) {
+        static const char* const names[3] = { "Albums (", "Artists (", "Uncategorized (" };
+        uint32_t count = row == 0 ? library.getAlbumCount() : (row == 1 ? library.getArtistCount() : library.getUncategorizedCount());
+        text = names[row] + String(count) + ")";
+        id = (int)row;
+        return;
     }
-    allTracks.clear();
-    uncategorizedTracks.clear();
-    
-    for (Album* album : allAlbums) {
-        delete album;
+    if (row == 0) {
+        text = "../";
+        id = -1;
+        return;
     }
-    allAlbums.clear();
-    
-    for (Artist* artist : artists) {
-        delete artist;
+    uint32_t i = row - 1;
+    switch (menuState.level) {
+        case MENU_ARTISTS:
+            text = String(library.getArtistName(i)) + " (" + String(library.getArtistTrackCount(i)) + ")";
+            id = (int)i;
+            break;
+        case MENU_ALBUMS:
+            if (menuState.artistId == MusicLibrary::NO_ID) {
+                // 所有专辑
+                text = String(library.getAlbumName(i)) + " - " + library.getArtistName(library.getAlbumArtist(i)) +
+                       " (" + String(library.getAlbumTrackCount(i)) + ")";
+                id = (int)i;
+            } else {
+                // 特定艺术家的专辑
+                uint32_t b = library.getArtistAlbum(menuState.artistId, i);
+                text = String(library.getAlbumName(b)) + " (" + String(library.getAlbumTrackCount(b)) + ")";
+                id = (int)b;
+            }
+            break;
+        case MENU_TRACKS: {
+            // 菜单项的 ID 为曲目 ID
+            uint32_t t;
+            if (menuState.artistId == MusicLibrary::NO_ID) {
+                // 未分类的曲目
+                t = library.getUncategorizedTrack(i);
+                text = "♪ " + String(library.getTrackTitle(t));
+                const char* artist = library.getTrackArtistName(t);
+                if (*artist) text += " - " + String(artist);
+            } else {
+                uint32_t b = menuState.albumId;
+                if (b == MusicLibrary::NO_ID) {
+                    // 艺术家的所有曲目（按专辑）：找出第 i 首所在的专辑
+                    for (uint32_t k = 0; k < library.getArtistAlbumCount(menuState.artistId); k++) {
+                        b = library.getArtistAlbum(menuState.artistId, k);
+                        if (i < library.getAlbumTrackCount(b)) break;
+                        i -= library.getAlbumTrackCount(b);
+                    }
+                }
+                t = library.getAlbumTrack(b, i);
+                text = "♪ " + String(library.getTrackTitle(t));
+            }
+            id = (int)t;
+            break;
+        }
+        default:
+            break;
     }
-    artists.clear();
 }
 
-void MusicApp::buildMainMenu() {
+// 把从 windowStart 开始的至多 MENU_WINDOW_SIZE 行放进列表，选中第 selectedRow 行并让它显示在屏幕第 screenRow 行
+void MusicApp::fillMenuWindow(uint32_t selectedRow, int screenRow) {
     playList->clear();
-    menuState.level = MENU_MAIN;
-    menuState.currentArtist = "";
-    menuState.currentAlbum = "";
-    
-    // 添加主菜单项
-    playList->addItem("Albums (" + String(allAlbums.size()) + ")", 0, "");
-    playList->addItem("Artists (" + String(artists.size()) + ")", 1, "");
-    playList->addItem("Uncategorized (" + String(uncategorizedTracks.size()) + ")", 2, "");
-    
-    titleLabel->setText("Music Library");
-    songLabel->setText("Select a category");
-}
-
-void MusicApp::buildArtistsMenu() {
-    playList->clear();
-    menuState.level = MENU_ARTISTS;
-    
-    // 添加返回选项
-    playList->addItem("../", -1, "");
-    
-    for (size_t i = 0; i < artists.size(); i++) {
-        Artist* artist = artists[i];
-        int totalTracks = 0;
-        for (Album* album : artist->albums) {
-            totalTracks += album->tracks.size();
-        }
-        totalTracks += artist->singleTracks.size();
-        
-        playList->addItem(artist->name + " (" + String(totalTracks) + ")", i, "");
+    uint32_t end = menuState.windowStart + MENU_WINDOW_SIZE;
+    if (end > menuState.rowCount) end = menuState.rowCount;
+    String text;
+    int id;
+    for (uint32_t row = menuState.windowStart; row < end; row++) {
+        getMenuRow(row, text, id);
+        playList->addItem(text, id, "");
+    }
+    int selected = (int)(selectedRow - menuState.windowStart);
+    playList->setSelection(selected, selected - screenRow);
+    updateMenuTitle();
+}
+
+// 重新计算行数并显示包含 selectedRow 的窗口（选中项前留出半页）
+void MusicApp::showMenuWindow(uint32_t selectedRow) {
+    menuState.rowCount = menuRowCount();
+    if (selectedRow >= menuState.rowCount) selectedRow = menuState.rowCount > 0 ? menuState.rowCount - 1 : 0;
+    uint32_t start = selectedRow > (uint32_t)MENU_PAGE_SIZE ? selectedRow - MENU_PAGE_SIZE : 0;
+    if (menuState.rowCount > (uint32_t)MENU_WINDOW_SIZE && start > menuState.rowCount - MENU_WINDOW_SIZE) {
+        start = menuState.rowCount - MENU_WINDOW_SIZE;
+    }
+    menuState.windowStart = menuState.rowCount > (uint32_t)MENU_WINDOW_SIZE ? start : 0;
+    fillMenuWindow(selectedRow, 0);
+}
+
+// 选中项接近窗口边缘且前后还有行时，窗口移动一页后重建，选中项在屏幕上的位置不变
+void MusicApp::ensureMenuWindow() {
+    if (menuState.rowCount <= (uint32_t)MENU_WINDOW_SIZE) return;
+    int selected = playList->getSelectedIndex();
+    int row = selected - playList->getScrollOffset();
+    int count = playList->getItemCount();
+    uint32_t windowEnd = menuState.windowStart + count;
+    uint32_t start = menuState.windowStart;
+    if (selected >= count - MENU_PREFETCH_MARGIN && windowEnd < menuState.rowCount) {
+        start += MENU_PAGE_SIZE;
+        if (start > menuState.rowCount - MENU_WINDOW_SIZE) start = menuState.rowCount - MENU_WINDOW_SIZE;
+    } else if (selected < MENU_PREFETCH_MARGIN && start > 0) {
+        start = start > (uint32_t)MENU_PAGE_SIZE ? start - MENU_PAGE_SIZE : 0;
+    } else {
+        return;
     }
-    
-    titleLabel->setText("Artists");
-    songLabel->setText("Select an artist");
+    uint32_t selectedRow = menuState.windowStart + selected;
+    menuState.windowStart = start;
+    fillMenuWindow(selectedRow, row);
 }
 
-void MusicApp::buildAlbumsMenu(const String& artistName) {
-    playList->clear();
-    menuState.level = MENU_ALBUMS;
-    menuState.currentArtist = artistName;
-    
-    // 添加返回选项
-    playList->addItem("../", -1, "");
-    
-    if (artistName.isEmpty()) {
-        // 显示所有专辑
-        for (size_t i = 0; i < allAlbums.size(); i++) {
-            Album* album = allAlbums[i];
-            playList->addItem("" + album->name + " - " + album->artist + " (" + String(album->tracks.size()) + ")", i, "");
-        }
-        titleLabel->setText("All Albums");
-    } else {
-        // 显示特定艺术家的专辑
-        Artist* artist = findOrCreateArtist(artistName);
-        int index = 0;
-        for (Album* album : artist->albums) {
-            playList->addItem("" + album->name + " (" + String(album->tracks.size()) + ")", index++, "");
-        }
-        titleLabel->setText(artistName + " - Albums");
+// 标题后附上窗口在整个列表中的范围（只有一屏放不下整个列表时）
+void MusicApp::updateMenuTitle() {
+    if (menuState.rowCount <= (uint32_t)MENU_WINDOW_SIZE) {
+        titleLabel->setText(menuTitle);
+        return;
     }
-    
-    songLabel->setText("Select an album");
+    uint32_t end = menuState.windowStart + playList->getItemCount();
+    titleLabel->setText(menuTitle + " " + String(menuState.windowStart + 1) + "-" + String(end) + "/" + String(menuState.rowCount));
 }
 
-void MusicApp::buildTracksMenu(const String& artistName, const String& albumName) {
-    playList->clear();
-    menuState.level = MENU_TRACKS;
-    menuState.currentArtist = artistName;
-    menuState.currentAlbum = albumName;
-    
-    // 添加返回选项
-    playList->addItem("../", -1, "");
-    
-    std::vector<MusicTrack*> tracksToShow;
-    
-    if (artistName.isEmpty() && albumName.isEmpty()) {
-        // 显示未分类的曲目
-        tracksToShow = uncategorizedTracks;
-        titleLabel->setText("Uncategorized");
-    } else if (!artistName.isEmpty() && albumName.isEmpty()) {
-        // 显示艺术家的所有曲目
-        Artist* artist = findOrCreateArtist(artistName);
-        for (Album* album : artist->albums) {
-            for (MusicTrack* track : album->tracks) {
-                tracksToShow.push_back(track);
-            }
-        }
-        for (MusicTrack* track : artist->singleTracks) {
-            tracksToShow.push_back(track);
-        }
-        titleLabel->setText(artistName + " - All Tracks");
+// 艺术家有多个专辑时显示专辑列表，否则直接显示曲目
+void MusicApp::openArtist(uint32_t artistId) {
+    if (library.getArtistAlbumCount(artistId) > 1) {
+        buildAlbumsMenu(artistId);
     } else {
-        // 显示特定专辑的曲目
-        Artist* artist = findOrCreateArtist(artistName);
-        for (Album* album : artist->albums) {
-            if (album->name.equalsIgnoreCase(albumName)) {
-                tracksToShow = album->tracks;
-                break;
-            }
-        }
-        titleLabel->setText(albumName);
+        buildTracksMenu(artistId);
     }
-    
-    // 添加曲目到列表
-    for (size_t i = 0; i < tracksToShow.size(); i++) {
-        MusicTrack* track = tracksToShow[i];
-        String displayName = "♪ " + track->title;
-        if (!track->artist.isEmpty() && artistName.isEmpty()) {
-            displayName += " - " + track->artist;
-        }
-        playList->addItem(displayName, i, "");
-    }
-    
-    songLabel->setText("Select a track to play");
 }
 
 void MusicApp::navigateBack() {
+    // 回到上一级时选中刚才进入的那一行
     switch (menuState.level) {
         case MENU_MAIN:
             // 已经在主菜单，无法返回
             break;
             
         case MENU_ARTISTS:
+            buildMainMenu(1);
+            break;
+            
         case MENU_ALBUMS:
-            buildMainMenu();
+            buildMainMenu(0);
             break;
             
         case MENU_TRACKS:
-            if (!menuState.currentArtist.isEmpty() && !menuState.currentAlbum.isEmpty()) {
+            if (menuState.artistId != MusicLibrary::NO_ID && menuState.albumId != MusicLibrary::NO_ID) {
                 // 从专辑曲目返回到专辑列表
-                buildAlbumsMenu(menuState.currentArtist);
-            } else if (!menuState.currentArtist.isEmpty()) {
+                uint32_t albumId = menuState.albumId;
+                uint32_t row = 0;
+                for (uint32_t i = 0; i < library.getArtistAlbumCount(menuState.artistId); i++) {
+                    if (library.getArtistAlbum(menuState.artistId, i) == albumId) row = i + 1;
+                }
+                buildAlbumsMenu(menuState.artistId, row);
+            } else if (menuState.artistId != MusicLibrary::NO_ID) {
                 // 从艺术家曲目返回到艺术家列表
-                buildArtistsMenu();
+                buildArtistsMenu(menuState.artistId + 1);
             } else {
                 // 从未分类曲目返回到主菜单
-                buildMainMenu();
+                buildMainMenu(2);
             }
             break;
     }
@@ -1211,32 +717,15 @@ void MusicApp::navigateForward() {
             break;
             
         case MENU_ARTISTS:
-            if (selectedItem->id >= 0 && selectedItem->id < (int)artists.size()) {
-                Artist* artist = artists[selectedItem->id];
-                if (artist->albums.size() > 1) {
-                    // 艺术家有多个专辑，显示专辑列表
-                    buildAlbumsMenu(artist->name);
-                } else {
-                    // 艺术家只有一个专辑或只有单曲，直接显示曲目
-                    buildTracksMenu(artist->name);
-                }
+            if (selectedItem->id >= 0 && (uint32_t)selectedItem->id < library.getArtistCount()) {
+                openArtist(selectedItem->id);
             }
             break;
             
         case MENU_ALBUMS:
-            if (!menuState.currentArtist.isEmpty()) {
-                // 在艺术家的专辑列表中
-                Artist* artist = findOrCreateArtist(menuState.currentArtist);
-                if (selectedItem->id >= 0 && selectedItem->id < (int)artist->albums.size()) {
-                    Album* album = artist->albums[selectedItem->id];
-                    buildTracksMenu(artist->name, album->name);
-                }
-            } else {
-                // 在所有专辑列表中
-                if (selectedItem->id >= 0 && selectedItem->id < (int)allAlbums.size()) {
-                    Album* album = allAlbums[selectedItem->id];
-                    buildTracksMenu(album->artist, album->name);
-                }
+            // 菜单项的 ID 为专辑 ID（所有专辑与艺术家的专辑列表相同）
+            if (selectedItem->id >= 0 && (uint32_t)selectedItem->id < library.getAlbumCount()) {
+                buildTracksMenu(library.getAlbumArtist(selectedItem->id), selectedItem->id);
             }
             break;
             
@@ -1278,32 +767,15 @@ void MusicApp::handleMenuSelection(MenuItem* item) {
             break;
             
         case MENU_ARTISTS:
-            if (item->id >= 0 && item->id < (int)artists.size()) {
-                Artist* artist = artists[item->id];
-                if (artist->albums.size() > 1) {
-                    // 艺术家有多个专辑，显示专辑列表
-                    buildAlbumsMenu(artist->name);
-                } else {
-                    // 艺术家只有一个专辑或只有单曲，直接显示曲目
-                    buildTracksMenu(artist->name);
-                }
+            if (item->id >= 0 && (uint32_t)item->id < library.getArtistCount()) {
+                openArtist(item->id);
             }
             break;
             
         case MENU_ALBUMS:
-            if (!menuState.currentArtist.isEmpty()) {
-                // 在艺术家的专辑列表中
-                Artist* artist = findOrCreateArtist(menuState.currentArtist);
-                if (item->id >= 0 && item->id < (int)artist->albums.size()) {
-                    Album* album = artist->albums[item->id];
-                    buildTracksMenu(artist->name, album->name);
-                }
-            } else {
-                // 在所有专辑列表中
-                if (item->id >= 0 && item->id < (int)allAlbums.size()) {
-                    Album* album = allAlbums[item->id];
-                    buildTracksMenu(album->artist, album->name);
-                }
+            // 菜单项的 ID 为专辑 ID（所有专辑与艺术家的专辑列表相同）
+            if (item->id >= 0 && (uint32_t)item->id < library.getAlbumCount()) {
+                buildTracksMenu(library.getAlbumArtist(item->id), item->id);
             }
             break;
             
@@ -4,76 +4,14 @@
 #include "system/EventSystem.h"
 #include "system/AppManager.h"
 #include "system/SDFileManager.h"
+#include "system/Profiler.h"
+#include "system/MusicLibrary.h"
+#include "system/LrcParser.h"
 #include <cstring>  // 为 memset 添加
 #include <vector>
 #include <algorithm>
 
-// ESP8266Audio 库
-#include <AudioOutput.h>
-#include <AudioFileSourceSD.h>
-#include <AudioFileSourceID3.h>
-#include <AudioGeneratorMP3.h>
-
-// FreeRTOS 组件
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-#include "freertos/queue.h"
-#include "freertos/semphr.h"
-
-// 音频命令枚举
-enum AudioCommand {
-    AUDIO_CMD_PLAY,
-    AUDIO_CMD_PAUSE,
-    AUDIO_CMD_STOP,
-    AUDIO_CMD_NEXT,
-    AUDIO_CMD_PREV,
-    AUDIO_CMD_VOLUME,
-    AUDIO_CMD_SHUTDOWN
-};
-
-// 音频任务命令结构
-struct AudioTaskCommand {
-    AudioCommand cmd;
-    int param;
-    char filePath[256];
-};
-
-// 音频状态结构
-struct MusicAudioStatus {
-    bool isPlaying;
-    bool isPaused;
-    int currentFileIndex;
-    int currentVolume;
-    char currentSongName[128];
-    bool hasError;
-    char errorMessage[128];
-};
-
-// 音乐分类结构
-struct MusicTrack {
-    String artist;
-    String album;
-    String title;
-    String filePath;
-    String fileName;
-};
-
-struct LyricLine {
-    uint32_t timeMs;
-    String text;
-};
-
-struct Album {
-    String name;
-    String artist;
-    std::vector<MusicTrack*> tracks;
-};
-
-struct Artist {
-    String name;
-    std::vector<Album*> albums;
-    std::vector<MusicTrack*> singleTracks; // 没有专辑信息的单曲
-};
+#include "system/AudioService.h"
 
 // 菜单导航状态
 enum MenuLevel {
@@ -83,62 +21,13 @@ enum MenuLevel {
     MENU_TRACKS     // 曲目列表
 };
 
+// 艺术家、专辑为 MusicLibrary 的 ID，没有时为 NO_ID；曲目列表中两者都为 NO_ID 表示未分类
 struct MenuState {
     MenuLevel level;
-    String currentArtist;
-    String currentAlbum;
-    int selectedIndex;
-};
-
-// M5Speaker 音频输出类 - 与参考实现保持一致
-class AudioOutputM5Speaker : public AudioOutput {
-public:
-    AudioOutputM5Speaker(m5::Speaker_Class* m5sound, uint8_t virtual_sound_channel = 0) {
-        _m5sound = m5sound;
-        _virtual_ch = virtual_sound_channel;
-    }
-    
-    virtual ~AudioOutputM5Speaker(void) {
-    }
-    
-    virtual bool begin(void) override { 
-        return true;
-    }
-    
-    virtual bool ConsumeSample(int16_t sample[2]) override {
-        if (_tri_buffer_index < tri_buf_size) {
-            _tri_buffer[_tri_index][_tri_buffer_index] = sample[0];
-            _tri_buffer[_tri_index][_tri_buffer_index + 1] = sample[1];
-            _tri_buffer_index += 2;
-            return true;
-        }
-        
-        flush();
-        return false;
-    }
-    
-    virtual void flush(void) override {
-        if (_tri_buffer_index) {
-            // 使用基类的 hertz 变量，而不是自定义的采样率
-            _m5sound->playRaw(_tri_buffer[_tri_index], _tri_buffer_index, hertz, true, 1, _virtual_ch);
-            _tri_index = _tri_index < 2 ? _tri_index + 1 : 0;
-            _tri_buffer_index = 0;
-        }
-    }
-    
-    virtual bool stop(void) override {
-        flush();
-        _m5sound->stop(_virtual_ch);
-        return true;
-    }
-
-protected:
-    m5::Speaker_Class* _m5sound;
-    uint8_t _virtual_ch;
-    static constexpr size_t tri_buf_size = 640;
-    int16_t _tri_buffer[3][tri_buf_size];
-    size_t _tri_buffer_index = 0;
-    size_t _tri_index = 0;
+    uint32_t artistId;
+    uint32_t albumId;
+    uint32_t rowCount;          // 整个列表的行数（含返回项）
+    uint32_t windowStart;       // 列表控件第一项对应的行
 };
 
 class MusicApp : public App {
@@ -147,11 +36,10 @@ private:
     AppManager* appManager;
     
     
-    // 双核心音频系统组件
-    TaskHandle_t audioTaskHandle;
-    QueueHandle_t audioCommandQueue;
-    SemaphoreHandle_t audioStatusMutex;
-    MusicAudioStatus audioStatus;
+    // 播放由后台音频服务负责，这里只发送命令并显示状态
+    AudioService* audio;
+    AudioPlaybackStatus audioStatus;            // 最近一次读取的状态快照
+    bool playlistSent;                  // 当前扫描结果已交给音频服务
     
     // 自定义音量滑块类
     class VolumeSlider : public UISlider {
@@ -224,44 +112,41 @@ private:
     VolumeSlider* volumeSlider;  // 音量滑块
     UIWindow* mainWindow;
     
-    // 音频组件（仅在主线程使用）
-    static constexpr uint8_t m5spk_virtual_channel = 0;
-    AudioFileSourceSD* audioFile;
-    AudioOutputM5Speaker* audioOutput;
-    AudioGeneratorMP3* mp3Generator;
-    AudioFileSourceID3* id3Source;
-    
-    // 播放状态（主线程）
+    // 播放状态（由状态快照更新）
     bool isPlaying;
     bool isPaused;
     bool isInitialized;
-    uint32_t pausedPosition;
+    bool waitingForStorage;     // SD 卡仍在后台挂载，完成后在 loop() 中扫描
+    uint32_t libraryGeneration;         // library 对应的曲库索引版本
+    bool libraryRebuildRequested;       // 手动重建索引，完成后即使不在主菜单也重新读取
     int currentVolume;
     
-    // 音乐文件列表和分类
-    static const int MAX_MUSIC_FILES = 100;
-    FileInfo musicFiles[MAX_MUSIC_FILES];
+    // 曲库模型：曲目 ID 即索引条目序号，也是播放列表序号
+    MusicLibrary library;
     int musicFileCount;
     int currentFileIndex;
     
-    // 音乐分类数据
-    std::vector<Artist*> artists;
-    std::vector<Album*> allAlbums;
-    std::vector<MusicTrack*> uncategorizedTracks;
-    std::vector<MusicTrack*> allTracks;
+    // 上次关机前的断点：选中该曲目并播放时从断点续播
+    int resumeIndex;
+    uint32_t resumePositionMs;
+    uint32_t resumeOffset;
     
-    // 菜单导航状态
+    // 菜单导航状态。列表控件最多 20 项：长列表只放一个窗口，选中项接近窗口边缘时移动一页后重建
+    // （与 FileManagerApp 相同；曲库模型可随机访问，任意一行都能直接取到，不需要游标）
+    static const int MENU_WINDOW_SIZE = 20;
+    static const int MENU_PAGE_SIZE = 8;
+    static const int MENU_PREFETCH_MARGIN = 3;  // 选中项距窗口边缘不超过此数时换页
     MenuState menuState;
+    String menuTitle;                   // 标题栏中窗口范围之前的部分
 
     std::vector<LyricLine> lyricLines;
     bool lyricsAvailable;
     int currentLyricIndex;
     int lastLyricsFileIndex;
-    uint32_t playbackStartMillis;
-    uint32_t pauseStartMillis;
-    uint32_t pausedAccumulatedMillis;
-    bool lastIsPlayingFlag;
-    bool lastIsPausedFlag;
+    uint32_t lastLyricsTrackChange;     // 歌词对应的 audioStatus.trackChanges
+    uint32_t lastSongTrackChange;       // lastDisplayedSong 对应的曲目
+    int lastSongIndex;
+    String lastDisplayedSong;
     String lastDisplayedCurrent;
     String lastDisplayedNext;
 
@@ -272,32 +157,17 @@ public:
     void setup() override;
     void loop() override;
     void onKeyEvent(const KeyEvent& event) override;
+    void onResume() override;
+    void onDestroy() override;
 
 private:
-    // 双核心音频系统方法
-    void initializeDualCoreAudio();
-    void sendAudioCommand(AudioCommand cmd, int param = 0, const char* filePath = nullptr);
-    void updateAudioStatus();
-    void handleNextPrevRequests();
-    void playNextSong();
-    void playPreviousSong();
+    // 音频服务客户端方法
+    void connectAudioService();
+    void sendPlaylist();
+    void restoreLastTrack();
     void updateUIFromAudioStatus();
     void updateLyricsDisplay();
     
-    // 音频任务方法
-    static void audioTaskFunction(void* parameter);
-    void processAudioCommands();
-    void playAudioFile(const char* filePath);
-    void pauseAudioPlayback();
-    void resumeAudioPlayback();
-    void stopAudioPlayback();
-    void playNextAudio();
-    void playPreviousAudio();
-    void setAudioVolume(int volume);
-    void updateAudioStatus(bool playing, bool paused, const char* songPath);
-    void updateAudioError(const char* errorMsg);
-    void cleanupAudioTask();
-    
     // 音乐文件和UI方法
     void scanMusicFiles();
     void playCurrentSong();
@@ -313,20 +183,21 @@ private:
     String computeLrcPath(const String& mp3Path);
     
     // 音乐分类和菜单导航方法
-    void categorizeMusic();
-    MusicTrack* parseFileName(const String& fileName, const String& filePath);
-    Artist* findOrCreateArtist(const String& artistName);
-    Album* findOrCreateAlbum(Artist* artist, const String& albumName);
     void clearMusicData();
-    void buildMainMenu();
-    void buildArtistsMenu();
-    void buildAlbumsMenu(const String& artistName = "");
-    void buildTracksMenu(const String& artistName = "", const String& albumName = "");
+    void buildMainMenu(uint32_t selectedRow = 0);
+    void buildArtistsMenu(uint32_t selectedRow = 0);
+    void buildAlbumsMenu(uint32_t artistId = MusicLibrary::NO_ID, uint32_t selectedRow = 0);
+    void buildTracksMenu(uint32_t artistId = MusicLibrary::NO_ID, uint32_t albumId = MusicLibrary::NO_ID);
+    uint32_t menuRowCount() const;
+    void getMenuRow(uint32_t row, String& text, int& id) const;
+    void fillMenuWindow(uint32_t selectedRow, int screenRow);
+    void showMenuWindow(uint32_t selectedRow);
+    void ensureMenuWindow();
+    void updateMenuTitle();
+    void openArtist(uint32_t artistId);
     void navigateBack();
     void navigateForward();
     void updateMenuDisplay();
     void handleMenuSelection(MenuItem* item);  // 处理菜单项选择
     
-    // 静态回调函数
-    static void metadataCallback(void *cbData, const char *type, bool isUnicode, const char *string);
 };
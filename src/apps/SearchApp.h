@@ -0,0 +1,246 @@
+#pragma once
+#include "system/App.h"
+#include "ui/UIManager.h"
+#include "system/EventSystem.h"
+#include "system/AppManager.h"
+#include "system/SDFileManager.h"
+#include "system/NameIndex.h"
+
+// 全卡文件名搜索：输入即按名字索引筛选，不遍历目录。
+// 打开时先用卡上保存的索引，同时在后台对照目录修改时间刷新，完成后换上新索引并重新查询。
+// 输入若干个词（空格分隔），每个词匹配名字中某个词的开头；上下键选择，Enter 在文件管理器中
+// 定位到该项（ESC 回到这里），Del 删除一个字符。
+class SearchApp : public App {
+private:
+    EventSystem* eventSystem;
+    AppManager* appManager;
+
+    enum ControlIds {
+        WINDOW_ID = 1,
+        TITLE_LABEL_ID = 2,
+        QUERY_LABEL_ID = 3,
+        RESULT_LIST_ID = 4,
+        STATUS_LABEL_ID = 5
+    };
+
+    static const int MAX_RESULTS = 20;          // 列表最多 20 项
+    static const uint32_t COUNT_LIMIT = 1000;   // 匹配数只数到这里
+    static const int MAX_QUERY_LENGTH = 32;
+
+    UIWindow* mainWindow;
+    UILabel* titleLabel;
+    UILabel* queryLabel;
+    UIMenuList* resultList;
+    UILabel* statusLabel;
+
+    NameIndexLoader loader;
+    NameIndex* index;           // 当前使用的索引（卡上的旧索引或刷新结果）
+    bool waitingForStorage;
+    String query;
+    uint32_t results[MAX_RESULTS];
+    int resultCount;
+    uint32_t matchCount;
+    uint32_t queryUs;
+
+public:
+    SearchApp(EventSystem* events, AppManager* manager)
+        : eventSystem(events), appManager(manager), mainWindow(nullptr), titleLabel(nullptr), queryLabel(nullptr),
+          resultList(nullptr), statusLabel(nullptr), index(nullptr), waitingForStorage(false), resultCount(0),
+          matchCount(0), queryUs(0) {
+        uiManager = appManager->getUIManager();
+    }
+
+    void setup() override {
+        mainWindow = new UIWindow(WINDOW_ID, 0, 0, 240, 135);
+        uiManager->addWidget(mainWindow);
+        mainWindow->setChildOffset(0, 0);
+
+        titleLabel = new UILabel(TITLE_LABEL_ID, 5, 5, "Search");
+        titleLabel->setParent(mainWindow);
+        titleLabel->setTextColor(TFT_WHITE);
+        uiManager->addWidget(titleLabel);
+
+        queryLabel = new UILabel(QUERY_LABEL_ID, 5, 20, "");
+        queryLabel->setParent(mainWindow);
+        queryLabel->setTextColor(TFT_YELLOW);
+        uiManager->addWidget(queryLabel);
+
+        resultList = new UIMenuList(RESULT_LIST_ID, 5, 35, 230, 80);
+        resultList->setParent(mainWindow);
+        resultList->setColors(TFT_WHITE, TFT_BLUE, TFT_WHITE, TFT_DARKGREY);
+        uiManager->addWidget(resultList);
+
+        statusLabel = new UILabel(STATUS_LABEL_ID, 5, 120, "");
+        statusLabel->setParent(mainWindow);
+        statusLabel->setTextColor(TFT_GREEN);
+        uiManager->addWidget(statusLabel);
+
+        uiManager->nextFocus();
+
+        query = "";
+        resultCount = 0;
+        matchCount = 0;
+        waitingForStorage = !appManager->isStorageSettled();
+        if (!waitingForStorage) startIndexing();
+        runQuery();
+        uiManager->smartRefresh();
+    }
+
+    void loop() override {
+        if (waitingForStorage && appManager->isStorageSettled()) {
+            waitingForStorage = false;
+            startIndexing();
+            runQuery();
+            uiManager->refreshAppArea();
+        }
+        if (loader.getState() != NameIndexLoader::LOADER_IDLE) {
+            pollLoader();
+        }
+    }
+
+    void onKeyEvent(const KeyEvent& event) override {
+        if (event.del) {
+            if (query.length() > 0) {
+                query = query.substring(0, query.length() - 1);
+                runQuery();
+                uiManager->refreshAppArea();
+            }
+            return;
+        }
+        if (event.enter) {
+            openSelected();
+            return;
+        }
+        // 方向键由 EventSystem 从文本中去掉，这里只剩可输入的字符
+        if (event.text.length() == 1 && !event.ctrl && !event.fn) {
+            char c = event.text.charAt(0);
+            if (c >= 0x20 && c < 0x7F && (int)query.length() < MAX_QUERY_LENGTH) {
+                query += c;
+                runQuery();
+                uiManager->refreshAppArea();
+            }
+            return;
+        }
+        if (uiManager->handleKeyEvent(event)) {
+            showSelectedFolder();
+            uiManager->refreshAppArea();
+        }
+    }
+
+    void onDestroy() override {
+        // 刷新任务以旧索引为对照，先等它退出再释放
+        loader.stop();
+        delete index;
+        index = nullptr;
+        mainWindow = nullptr;
+        titleLabel = nullptr;
+        queryLabel = nullptr;
+        resultList = nullptr;
+        statusLabel = nullptr;
+        query = "";
+        resultCount = 0;
+    }
+
+private:
+    void startIndexing() {
+        SDFileManager* fm = appManager->getSDFileManager();
+        if (!fm || !fm->isInitialized()) return;
+        loader.begin(fm->getVfs().getFs());
+        // native 环境中同步完成
+        pollLoader();
+    }
+
+    void pollLoader() {
+        if (!index) {
+            index = loader.takeLoaded();
+            if (index) {
+                runQuery();
+                uiManager->refreshAppArea();
+            }
+        }
+        NameIndex* fresh;
+        NameIndex::BuildStats stats;
+        bool saved;
+        if (!loader.takeRefreshed(fresh, stats, saved)) return;
+        if (fresh) {
+            // 刷新已结束，旧索引不再被任务使用
+            delete index;
+            index = fresh;
+        }
+        runQuery();
+        uiManager->refreshAppArea();
+        if (uiManager->isMirrorEnabled()) return;
+        Serial.printf("[search] %lu names, %s; %lu/%lu dirs rescanned, %lu reused, %lu ms%s\n",
+                      (unsigned long)(index ? index->getEntryCount() : 0),
+                      fresh ? (saved ? "index saved" : "index not saved") : "unchanged",
+                      (unsigned long)stats.dirsRescanned, (unsigned long)stats.dirsVisited,
+                      (unsigned long)stats.entriesReused, (unsigned long)stats.elapsedMs,
+                      stats.truncated ? ", truncated" : "");
+    }
+
+    void runQuery() {
+        queryLabel->setText("> " + query + "_");
+        resultList->clear();
+        resultCount = 0;
+        matchCount = 0;
+        if (index && query.length() > 0) {
+            uint32_t startUs = micros();
+            matchCount = index->search(query.c_str(), results, MAX_RESULTS, COUNT_LIMIT);
+            queryUs = micros() - startUs;
+            resultCount = matchCount < (uint32_t)MAX_RESULTS ? (int)matchCount : MAX_RESULTS;
+            SDFileManager* fm = appManager->getSDFileManager();
+            for (int i = 0; i < resultCount; i++) {
+                String name = index->getName(results[i]);
+                if (index->isDirectory(results[i])) {
+                    name = "[" + name + "]";
+                } else if (fm && fm->isAudioFile(name)) {
+                    name = "♪ " + name;
+                }
+                resultList->addItem(name, i, "");
+            }
+        }
+        updateStatus();
+    }
+
+    void updateStatus() {
+        bool refreshing = loader.isBusy();
+        if (waitingForStorage) {
+            statusLabel->setText("Mounting SD card...");
+        } else if (!index) {
+            SDFileManager* fm = appManager->getSDFileManager();
+            statusLabel->setText(refreshing ? "Building name index..." :
+                                 (fm && fm->isInitialized() ? "No name index" : "SD card not initialized"));
+        } else if (query.length() == 0) {
+            statusLabel->setText("Type to search " + String(index->getEntryCount()) + " names" +
+                                 (refreshing ? " (updating)" : ""));
+        } else {
+            String text = matchCount >= COUNT_LIMIT ? String(COUNT_LIMIT) + "+" : String(matchCount);
+            text += matchCount == 1 ? " match" : " matches";
+            text += ", " + String(queryUs / 1000) + "." + String(queryUs % 1000 / 100) + " ms";
+            if (refreshing) text += " (updating)";
+            statusLabel->setText(text);
+        }
+    }
+
+    // 选中项所在的文件夹显示在状态栏，列表只有名字
+    void showSelectedFolder() {
+        int slot = selectedSlot();
+        if (slot < 0) return;
+        statusLabel->setText("in " + String(index->getDirPath(index->getDirIndex(results[slot]))));
+    }
+
+    int selectedSlot() {
+        MenuItem* item = resultList->getSelectedItem();
+        if (!index || !item || item->id < 0 || item->id >= resultCount) return -1;
+        return item->id;
+    }
+
+    void openSelected() {
+        int slot = selectedSlot();
+        if (slot < 0) return;
+        if (!appManager->openWith("filemanager", index->getPath(results[slot]))) {
+            statusLabel->setText("Cannot open Files");
+            uiManager->refreshAppArea();
+        }
+    }
+};
@@ -0,0 +1,186 @@
+#pragma once
+#include "system/App.h"
+#include "ui/UIManager.h"
+#include "system/EventSystem.h"
+#include "system/AppManager.h"
+#include "system/SystemMonitor.h"
+
+// 系统监视：CPU、内存、UI 帧率与音频欠载的实时曲线。采样由 SystemMonitor 在定时器任务中完成，
+// 这里只在取到新采样时更新标签和曲线，界面静止时不产生任何重绘
+class SystemMonitorApp : public App {
+private:
+    EventSystem* eventSystem;
+    AppManager* appManager;
+    SystemMonitor monitor;
+
+    // UI控件ID
+    enum ControlIds {
+        WINDOW_ID = 1,
+        TITLE_LABEL_ID = 2,
+        CPU_LABEL_ID = 3,
+        CPU_SPARK_ID = 4,
+        HEAP_LABEL_ID = 5,
+        HEAP_SPARK_ID = 6,
+        UI_LABEL_ID = 7,
+        UI_SPARK_ID = 8,
+        TASK_LABEL_BASE_ID = 10,    // 每个被统计的任务一行
+        AUDIO_LABEL_ID = 20,
+        STATUS_LABEL_ID = 21
+    };
+
+    static const int SPARK_X = 150;
+    static const int SPARK_WIDTH = 84;
+    static const int SPARK_HEIGHT = 12;
+
+    // UI控件
+    UIWindow* mainWindow;
+    UILabel* titleLabel;
+    UILabel* cpuLabel;
+    UISparkline* cpuSpark;
+    UILabel* heapLabel;
+    UISparkline* heapSpark;
+    UILabel* uiLabel;
+    UISparkline* uiSpark;
+    UILabel* taskLabels[MONITOR_TASK_COUNT];
+    UILabel* audioLabel;
+    UILabel* statusLabel;
+
+public:
+    SystemMonitorApp(EventSystem* events, AppManager* manager)
+        : eventSystem(events), appManager(manager), monitor(manager->getUIManager(), manager->getAudioService()) {
+        uiManager = appManager->getUIManager();
+    }
+
+    void setup() override {
+        mainWindow = new UIWindow(WINDOW_ID, 0, 0, 240, 135);
+        uiManager->addWidget(mainWindow);
+        mainWindow->setChildOffset(0, 0);
+
+        titleLabel = addLabel(TITLE_LABEL_ID, 5, 5, "System Monitor", TFT_WHITE);
+
+        cpuLabel = addLabel(CPU_LABEL_ID, 5, 22, "CPU  --", TFT_GREEN);
+        cpuSpark = addSparkline(CPU_SPARK_ID, 20, 0, 100, TFT_GREEN);
+
+        heapLabel = addLabel(HEAP_LABEL_ID, 5, 38, "Heap --", TFT_CYAN);
+        heapSpark = addSparkline(HEAP_SPARK_ID, 36, 0, 1, TFT_CYAN);
+        heapSpark->setAutoScale(true);
+
+        uiLabel = addLabel(UI_LABEL_ID, 5, 54, "UI   --", TFT_YELLOW);
+        uiSpark = addSparkline(UI_SPARK_ID, 52, 0, 1, TFT_YELLOW);
+        uiSpark->setAutoScale(true);
+
+        for (int i = 0; i < MONITOR_TASK_COUNT; i++) {
+            taskLabels[i] = addLabel(TASK_LABEL_BASE_ID + i, 5, 70 + i * 14,
+                                     formatTaskName(SystemMonitor::TASK_NAMES[i]) + " --", TFT_LIGHTGREY);
+        }
+
+        audioLabel = addLabel(AUDIO_LABEL_ID, 5, 112, "Underruns 0", TFT_LIGHTGREY);
+        statusLabel = addLabel(STATUS_LABEL_ID, 5, 124, "Sampling every " + String(SystemMonitor::SAMPLE_PERIOD_MS) + " ms", TFT_DARKGREY);
+
+        if (!monitor.start()) {
+            statusLabel->setText("Failed to start sampler timer");
+        }
+        uiManager->smartRefresh();
+    }
+
+    void loop() override {
+        MonitorSample sample;
+        bool updated = false;
+        while (monitor.poll(sample)) {
+            applySample(sample);
+            updated = true;
+        }
+        if (updated) {
+            uiManager->refreshAppArea();
+        }
+    }
+
+    void onKeyEvent(const KeyEvent& event) override {
+        if (uiManager->handleKeyEvent(event)) {
+            uiManager->refreshAppArea();
+        }
+    }
+
+    // 后台时不采样，回到前台重新建立基准
+    void onSuspend() override {
+        monitor.stop();
+    }
+
+    void onResume() override {
+        monitor.start();
+    }
+
+    void onDestroy() override {
+        monitor.stop();
+    }
+
+private:
+    UILabel* addLabel(int id, int x, int y, const String& text, uint16_t color) {
+        UILabel* label = new UILabel(id, x, y, text);
+        label->setParent(mainWindow);
+        label->setTextColor(color);
+        uiManager->addWidget(label);
+        return label;
+    }
+
+    UISparkline* addSparkline(int id, int y, int32_t minValue, int32_t maxValue, uint16_t color) {
+        UISparkline* spark = new UISparkline(id, SPARK_X, y, SPARK_WIDTH, SPARK_HEIGHT, minValue, maxValue);
+        spark->setParent(mainWindow);
+        spark->setColors(color, TFT_DARKGREY);
+        uiManager->addWidget(spark);
+        return spark;
+    }
+
+    void applySample(const MonitorSample& s) {
+        String mhz = " " + String(getCpuFrequencyMhz()) + "M";     // 调频后的当前频率
+        if (s.hasRuntimeStats) {
+            cpuLabel->setText("CPU  " + padLeft(String(s.coreLoad[0]) + "%", 4) + " " + padLeft(String(s.coreLoad[1]) + "%", 4) + mhz);
+            cpuSpark->push(s.coreLoad[0] > s.coreLoad[1] ? s.coreLoad[0] : s.coreLoad[1]);
+        } else {
+            cpuLabel->setText("CPU  n/a" + mhz);
+        }
+
+        heapLabel->setText("Heap " + padLeft(String(s.heapFree / 1024) + "K", 5) + " max " + String(s.heapLargest / 1024) + "K");
+        heapSpark->push((int32_t)(s.heapFree / 1024));
+
+        uiLabel->setText("UI   " + formatRate(s.tickRate10) + "t " + formatRate(s.frameRate10) + "f");
+        uiSpark->push(s.frameRate10);
+
+        for (int i = 0; i < MONITOR_TASK_COUNT; i++) {
+            const MonitorTaskStat& t = s.tasks[i];
+            String line = formatTaskName(SystemMonitor::TASK_NAMES[i]);
+            if (!t.present) {
+                line += " --";
+            } else {
+                line += s.hasRuntimeStats ? padLeft(String(t.cpuPercent) + "%", 5) : String("  n/a");
+                line += "  stack " + String(t.stackFreeBytes);
+            }
+            taskLabels[i]->setText(line);
+        }
+
+        String audioLine = "Underruns " + String(s.underruns);
+        audioLine += s.psramFree > 0 ? "  PSRAM " + String(s.psramFree / 1024) + "K" : String("  PSRAM n/a");
+        audioLabel->setText(audioLine);
+
+        uint32_t dropped = monitor.getDroppedSamples();
+        if (dropped > 0) {
+            statusLabel->setText("Dropped samples: " + String(dropped));
+        }
+    }
+
+    static String formatTaskName(const char* name) {
+        String text(name);
+        while (text.length() < 10) text += " ";
+        return text;
+    }
+
+    static String formatRate(uint16_t rate10) {
+        return padLeft(String(rate10 / 10) + "." + String(rate10 % 10), 5);
+    }
+
+    static String padLeft(const String& text, unsigned int width) {
+        String result;
+        while (result.length() + text.length() < width) result += " ";
+        return result + text;
+    }
+};
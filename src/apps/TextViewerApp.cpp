@@ -0,0 +1,313 @@
+#include "apps/TextViewerApp.h"
+
+TextViewerApp::TextViewerApp(EventSystem* events, AppManager* manager)
+    : eventSystem(events), appManager(manager), mainWindow(nullptr), titleLabel(nullptr), statusLabel(nullptr),
+      topOffset(0), topLine(0), topLineKnown(true), lastStatusMs(0), indexing(false) {
+    uiManager = appManager->getUIManager();
+    for (int i = 0; i < ROW_COUNT; i++) {
+        rowLabels[i] = nullptr;
+    }
+}
+
+void TextViewerApp::setup() {
+    mainWindow = new UIWindow(WINDOW_ID, 0, 0, 240, 135);
+    uiManager->addWidget(mainWindow);
+    mainWindow->setChildOffset(0, 0);
+
+    String path = appManager->getLaunchArgument();
+    titleLabel = new UILabel(TITLE_LABEL_ID, TEXT_X, 1, path.substring(path.lastIndexOf('/') + 1));
+    titleLabel->setParent(mainWindow);
+    titleLabel->setTextColor(TFT_YELLOW);
+    uiManager->addWidget(titleLabel);
+
+    for (int i = 0; i < ROW_COUNT; i++) {
+        rowLabels[i] = new UILabel(ROW_LABEL_BASE_ID + i, TEXT_X, 15 + i * ROW_HEIGHT, "");
+        rowLabels[i]->setParent(mainWindow);
+        rowLabels[i]->setTextColor(TFT_WHITE);
+        uiManager->addWidget(rowLabels[i]);
+    }
+
+    statusLabel = new UILabel(STATUS_LABEL_ID, TEXT_X, 122, "");
+    statusLabel->setParent(mainWindow);
+    statusLabel->setTextColor(TFT_GREEN);
+    uiManager->addWidget(statusLabel);
+
+    topOffset = 0;
+    topLine = 0;
+    topLineKnown = true;
+    numberInput = "";
+    message = "";
+    lastStatusMs = 0;
+
+    SDFileManager* fm = appManager->getSDFileManager();
+    if (!fm || !fm->isInitialized() || !document.open(fm->getVfs().getFs(), path)) {
+        statusLabel->setText("Cannot open " + path);
+    } else {
+        titleLabel->setText(titleLabel->getText() + "  " + formatSize(document.getSize()));
+        indexing = document.getIndexState() == TextDocument::INDEX_RUNNING;
+        render();
+    }
+    uiManager->smartRefresh();
+}
+
+void TextViewerApp::loop() {
+    if (!document.isOpen()) return;
+    // 索引建立期间定时刷新进度，完成时再刷新一次，补上行号与总行数
+    bool running = document.getIndexState() == TextDocument::INDEX_RUNNING;
+    if (!running && !indexing) return;
+    uint32_t now = millis();
+    if (running && now - lastStatusMs < STATUS_INTERVAL_MS) return;
+    lastStatusMs = now;
+    indexing = running;
+    updateStatus();
+    uiManager->refreshAppArea();
+}
+
+void TextViewerApp::onKeyEvent(const KeyEvent& event) {
+    if (!document.isOpen()) return;
+    bool moved = false;
+    char key = event.text.length() == 1 && !event.ctrl ? event.text.charAt(0) : '\0';
+
+    if (key >= '0' && key <= '9') {
+        if ((int)numberInput.length() < MAX_INPUT_DIGITS) numberInput += key;
+    } else if (event.del) {
+        if (numberInput.length() > 0) numberInput = numberInput.substring(0, numberInput.length() - 1);
+    } else if (event.enter || key == 'g') {
+        if (numberInput.length() > 0) {
+            uint32_t line = (uint32_t)numberInput.toInt();
+            numberInput = "";
+            goToLine(line > 0 ? line - 1 : 0);
+            moved = true;
+        }
+    } else if (key == '%' || key == 'p') {
+        if (numberInput.length() > 0) {
+            uint32_t percent = (uint32_t)numberInput.toInt();
+            numberInput = "";
+            goToPercent(percent);
+            moved = true;
+        }
+    } else if (event.down) {
+        message = "";
+        moved = scrollDown(1);
+    } else if (event.up) {
+        message = "";
+        moved = scrollUp(1);
+    } else if (event.right) {
+        message = "";
+        moved = scrollDown(ROW_COUNT - 1);
+    } else if (event.left) {
+        message = "";
+        moved = scrollUp(ROW_COUNT - 1);
+    } else {
+        return;
+    }
+
+    if (moved) {
+        render();
+    } else {
+        updateStatus();
+    }
+    uiManager->refreshAppArea();
+}
+
+void TextViewerApp::onDestroy() {
+    document.close();
+    // 控件由 UIManager 释放
+    mainWindow = nullptr;
+    titleLabel = nullptr;
+    statusLabel = nullptr;
+    for (int i = 0; i < ROW_COUNT; i++) {
+        rowLabels[i] = nullptr;
+    }
+    numberInput = "";
+    message = "";
+}
+
+// 从 start 起排出一个显示行，返回下一行的起点。排版只取决于起点，从行首或任何一个显示行的起点
+// 排出的结果相同，所以向上滚动时可以从文本行的行首重新排到当前位置。
+// 控制字符不显示，非法的 UTF-8 显示为 '?'；行排满时紧跟的换行符算在这一行里，不多出空行
+uint32_t TextViewerApp::layoutRow(uint32_t start, String* text, bool* endsLine) {
+    if (endsLine) *endsLine = false;
+    uint32_t size = document.getSize();
+    if (start >= size) return size;
+    uint32_t available;
+    const uint8_t* p = document.fetch(start, available);
+    if (!p) return size;
+
+    int px = 0;
+    int column = 0;
+    bool full = false;
+    uint32_t i = 0;
+    while (i < available) {
+        uint8_t c = p[i];
+        if (c == '\n') {
+            i++;
+            if (endsLine) *endsLine = true;
+            return start + i;
+        }
+        if (c == '\t') {
+            int spaces = TAB_WIDTH - column % TAB_WIDTH;
+            if (px + spaces * 6 > TEXT_WIDTH) {
+                full = true;
+                break;
+            }
+            if (text) {
+                for (int s = 0; s < spaces; s++) *text += ' ';
+            }
+            px += spaces * 6;
+            column += spaces;
+            i++;
+            continue;
+        }
+        if (c < 0x20 || c == 0x7F) {
+            i++;
+            continue;
+        }
+        uint32_t bytes = 1;
+        if (c >= 0x80) {
+            bytes = (c & 0xE0) == 0xC0 ? 2 : (c & 0xF0) == 0xE0 ? 3 : (c & 0xF8) == 0xF0 ? 4 : 0;
+            for (uint32_t k = 1; bytes > 0 && k < bytes; k++) {
+                if (i + k >= available || (p[i + k] & 0xC0) != 0x80) bytes = 0;
+            }
+        }
+        int advance = bytes > 1 ? 12 : 6;
+        if (px + advance > TEXT_WIDTH) {
+            full = true;
+            break;
+        }
+        if (text) {
+            if (bytes == 0) *text += '?';
+            else if (bytes == 1) *text += (char)c;
+            else text->concat((const char*)p + i, bytes);
+        }
+        px += advance;
+        column += advance / 6;
+        i += bytes == 0 ? 1 : bytes;
+    }
+    if (full) {
+        uint32_t j = i;
+        if (j < available && p[j] == '\r') j++;
+        if (j < available && p[j] == '\n') {
+            if (endsLine) *endsLine = true;
+            return start + j + 1;
+        }
+    }
+    return start + i;
+}
+
+// start 之前的那个显示行的起点：找到所在文本行的行首后向下排到 start
+uint32_t TextViewerApp::previousRowStart(uint32_t start) {
+    if (start == 0) return 0;
+    uint32_t row = document.lineStartOf(start - 1);
+    while (true) {
+        uint32_t next = layoutRow(row, nullptr, nullptr);
+        if (next >= start || next <= row) return row;
+        row = next;
+    }
+}
+
+// 最后一屏之后不再向下滚动
+bool TextViewerApp::scrollDown(int rows) {
+    uint32_t size = document.getSize();
+    bool moved = false;
+    for (int n = 0; n < rows; n++) {
+        uint32_t end = topOffset;
+        for (int i = 0; i < ROW_COUNT && end < size; i++) {
+            end = layoutRow(end, nullptr, nullptr);
+        }
+        if (end >= size) break;
+        bool endsLine;
+        topOffset = layoutRow(topOffset, nullptr, &endsLine);
+        if (endsLine) topLine++;
+        moved = true;
+    }
+    return moved;
+}
+
+bool TextViewerApp::scrollUp(int rows) {
+    bool moved = false;
+    for (int n = 0; n < rows && topOffset > 0; n++) {
+        // 当前在文本行的行首时，上一显示行属于上一文本行
+        if (document.byteAt(topOffset - 1) == '\n' && topLine > 0) topLine--;
+        topOffset = previousRowStart(topOffset);
+        moved = true;
+    }
+    return moved;
+}
+
+void TextViewerApp::goToLine(uint32_t line) {
+    uint32_t offset;
+    if (!document.offsetOfLine(line, offset)) {
+        if (document.getIndexState() == TextDocument::INDEX_RUNNING) {
+            message = "Line " + String(line + 1) + " not indexed yet";
+        } else {
+            message = "Only " + String(document.getLineCount()) + " lines";
+        }
+        return;
+    }
+    message = "";
+    topOffset = offset;
+    topLine = line;
+    topLineKnown = true;
+    fillScreen();
+}
+
+void TextViewerApp::goToPercent(uint32_t percent) {
+    if (percent > 100) percent = 100;
+    uint32_t size = document.getSize();
+    uint32_t target = (uint32_t)((uint64_t)size * percent / 100);
+    message = "";
+    topOffset = document.lineStartOf(target);
+    topLineKnown = document.lineOfOffset(topOffset, topLine);
+    fillScreen();
+}
+
+// 跳转到文件末尾附近时向上补满一屏
+void TextViewerApp::fillScreen() {
+    uint32_t size = document.getSize();
+    int rows = 0;
+    for (uint32_t r = topOffset; r < size && rows < ROW_COUNT; rows++) {
+        r = layoutRow(r, nullptr, nullptr);
+    }
+    if (rows < ROW_COUNT) scrollUp(ROW_COUNT - rows);
+}
+
+void TextViewerApp::render() {
+    uint32_t size = document.getSize();
+    uint32_t row = topOffset;
+    for (int i = 0; i < ROW_COUNT; i++) {
+        String text;
+        if (row < size) row = layoutRow(row, &text, nullptr);
+        rowLabels[i]->setText(text);
+    }
+    updateStatus();
+}
+
+void TextViewerApp::updateStatus() {
+    if (numberInput.length() > 0) {
+        statusLabel->setText("Go to " + numberInput + "_  Enter:line  %:percent");
+        return;
+    }
+    if (message.length() > 0) {
+        statusLabel->setText(message);
+        return;
+    }
+    // 百分比跳转到了索引尚未到达的位置：索引跟上后补算行号
+    if (!topLineKnown) topLineKnown = document.lineOfOffset(topOffset, topLine);
+
+    bool indexing = document.getIndexState() == TextDocument::INDEX_RUNNING;
+    uint32_t size = document.getSize();
+    String text = topLineKnown ? "L" + String(topLine + 1) : String("L?");
+    text += "/" + String(document.getLineCount()) + (indexing ? "+" : "");
+    text += "  " + String(size > 0 ? (uint32_t)((uint64_t)topOffset * 100 / size) : 100) + "%";
+    if (indexing) {
+        text += "  indexing " + String(size > 0 ? (uint32_t)((uint64_t)document.getIndexedBytes() * 100 / size) : 100) + "%";
+    }
+    statusLabel->setText(text);
+}
+
+String TextViewerApp::formatSize(uint32_t size) {
+    if (size < 1024) return String(size) + "B";
+    if (size < 1024 * 1024) return String(size / 1024) + "KB";
+    return String(size / (1024 * 1024)) + "MB";
+}
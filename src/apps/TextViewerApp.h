@@ -0,0 +1,67 @@
+#pragma once
+#include "system/App.h"
+#include "ui/UIManager.h"
+#include "system/EventSystem.h"
+#include "system/AppManager.h"
+#include "system/TextDocument.h"
+
+// 文本查看器：由文件管理器打开（不在启动器中列出），ESC 回到文件管理器。
+// 只读取显示所需的窗口，按 efontCN_12 的字形宽度（ASCII 6px，多字节 12px）自动换行。
+// 上下键逐行滚动，左右键翻页；输入数字后按 Enter/g 跳到该行，按 %/p 跳到该百分比。
+// 行号由后台建立的稀疏行索引换算，索引未到达的位置暂时只显示百分比。
+class TextViewerApp : public App {
+private:
+    EventSystem* eventSystem;
+    AppManager* appManager;
+    TextDocument document;
+
+    enum ControlIds {
+        WINDOW_ID = 1,
+        TITLE_LABEL_ID = 2,
+        STATUS_LABEL_ID = 3,
+        ROW_LABEL_BASE_ID = 10
+    };
+
+    static const int ROW_COUNT = 8;
+    static const int ROW_HEIGHT = 13;
+    static const int TEXT_X = 3;
+    static const int TEXT_WIDTH = 234;          // 一行可用的像素宽度
+    static const int TAB_WIDTH = 4;             // 制表位（字符）
+    static const int MAX_INPUT_DIGITS = 9;
+    static const uint32_t STATUS_INTERVAL_MS = 200;
+
+    UIWindow* mainWindow;
+    UILabel* titleLabel;
+    UILabel* rowLabels[ROW_COUNT];
+    UILabel* statusLabel;
+
+    uint32_t topOffset;         // 首个显示行（换行后的行）的起点
+    uint32_t topLine;           // topOffset 所在的文本行（从 0 起）
+    bool topLineKnown;
+    String numberInput;         // 正在输入的跳转目标
+    String message;             // 临时提示，下次移动时清除
+    uint32_t lastStatusMs;
+    bool indexing;              // 上次显示状态时索引仍在建立
+
+public:
+    TextViewerApp(EventSystem* events, AppManager* manager);
+
+    void setup() override;
+    void loop() override;
+    void onKeyEvent(const KeyEvent& event) override;
+    void onDestroy() override;
+    // 每次打开的文件不同，退出即销毁，释放窗口与索引
+    bool isRetainable() const override { return false; }
+
+private:
+    uint32_t layoutRow(uint32_t start, String* text, bool* endsLine);
+    uint32_t previousRowStart(uint32_t start);
+    bool scrollDown(int rows);
+    bool scrollUp(int rows);
+    void goToLine(uint32_t line);
+    void goToPercent(uint32_t percent);
+    void fillScreen();
+    void render();
+    void updateStatus();
+    static String formatSize(uint32_t size);
+};
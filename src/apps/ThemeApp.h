@@ -60,11 +60,9 @@ public:
         
         // 添加主题选项
         if (globalThemeManager) {
+            // 只列出名称，不创建尚未使用过的主题
             for (int i = 0; i < globalThemeManager->getThemeCount(); i++) {
-                Theme* theme = globalThemeManager->getTheme(i);
-                if (theme) {
-                    themeMenu->addItem(theme->getThemeName(), 100 + i);
-                }
+                themeMenu->addItem(globalThemeManager->getThemeName(i), 100 + i);
             }
         }
         
@@ -94,9 +92,9 @@ public:
         
         // 查找并设置选中的主题
         for (int i = 0; i < globalThemeManager->getThemeCount(); i++) {
-            Theme* theme = globalThemeManager->getTheme(i);
-            if (theme && theme->getThemeName() == item->text) {
-                globalThemeManager->setCurrentTheme(i);
+            if (globalThemeManager->getThemeName(i) == item->text) {
+                if (!globalThemeManager->setCurrentTheme(i)) break;
+                appManager->getSettings().setString(SETTING_THEME, item->text);
                 updateCurrentThemeStatus();
                 
                 // 刷新所有UI元素以应用新主题
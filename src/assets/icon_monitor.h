@@ -0,0 +1,25 @@
+#pragma once
+
+// 自动生成的PNG图片数据
+// 源文件: .\icon_monitor.png
+// 文件大小: 194 字节
+
+#include <stdint.h>
+
+// PNG图片数据数组
+constexpr size_t icon_monitor_png_size = 194;
+constexpr uint8_t icon_monitor_png[] = {
+    0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A, 0x00, 0x00, 0x00, 0x0D, 0x49, 0x48, 0x44, 0x52,
+    0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x20, 0x08, 0x06, 0x00, 0x00, 0x00, 0x73, 0x7A, 0x7A,
+    0xF4, 0x00, 0x00, 0x00, 0x01, 0x73, 0x52, 0x47, 0x42, 0x00, 0xAE, 0xCE, 0x1C, 0xE9, 0x00, 0x00,
+    0x00, 0x7C, 0x49, 0x44, 0x41, 0x54, 0x78, 0xDA, 0x63, 0x60, 0x18, 0x05, 0xA3, 0x60, 0x14, 0x60,
+    0x01, 0x4E, 0xFB, 0x5F, 0xFC, 0xA7, 0x05, 0x1E, 0x50, 0xCB, 0x89, 0x76, 0xC4, 0x90, 0x76, 0x00,
+    0x31, 0xFA, 0x87, 0x87, 0x03, 0xB0, 0xA9, 0x23, 0xD6, 0x0C, 0x8A, 0x1D, 0x80, 0x4B, 0x1D, 0x4C,
+    0x8C, 0x6E, 0x0E, 0x40, 0x57, 0x4B, 0x57, 0x07, 0x60, 0xB3, 0x08, 0x59, 0x1C, 0x9F, 0x39, 0x44,
+    0x3B, 0x80, 0x90, 0x1A, 0x6C, 0x6A, 0xF1, 0xE9, 0xA5, 0x9A, 0x03, 0xB0, 0x59, 0x8A, 0x2D, 0x34,
+    0x28, 0x76, 0x00, 0x29, 0xB9, 0x81, 0x14, 0x7D, 0x54, 0x77, 0x00, 0xA9, 0xFA, 0xA8, 0x5E, 0x10,
+    0x51, 0xE2, 0xE8, 0xE1, 0xE1, 0x80, 0x21, 0x55, 0x25, 0xD3, 0xB4, 0xD1, 0x32, 0xE0, 0xAD, 0xA6,
+    0xE1, 0xED, 0x80, 0x01, 0x8F, 0xF3, 0x41, 0x91, 0xE8, 0x46, 0xC1, 0xB0, 0x05, 0x00, 0x44, 0xF0,
+    0x67, 0xDD, 0x76, 0xA0, 0x2E, 0x37, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4E, 0x44, 0xAE, 0x42,
+    0x60, 0x82
+};
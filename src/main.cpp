@@ -1,4 +1,5 @@
 #include "M5Cardputer.h"
+#include <new>
 #include "system/EventSystem.h"
 #include "system/AppManager.h"
 #include "apps/LauncherApp.h"
@@ -6,6 +7,9 @@
 #include "apps/SettingsApp.h"
 #include "apps/TestApp.h"
 #include "apps/FileManagerApp.h"
+#include "apps/SystemMonitorApp.h"
+#include "apps/TextViewerApp.h"
+#include "apps/SearchApp.h"
 #include "apps/ThemeApp.h"
 #include "themes/ThemeManager.h"
 #include "themes/PrototypeTheme.h"
@@ -52,9 +56,21 @@ MusicApp musicApp(&globalEventSystem, &globalAppManager);
 SettingsApp settingsApp(&globalEventSystem);
 TestApp testApp(&globalEventSystem);
 FileManagerApp fileManagerApp(&globalEventSystem, &globalAppManager);
+SystemMonitorApp systemMonitorApp(&globalEventSystem, &globalAppManager);
+TextViewerApp textViewerApp(&globalEventSystem, &globalAppManager);
+SearchApp searchApp(&globalEventSystem, &globalAppManager);
 ThemeApp themeApp(&globalEventSystem);
 
+// 主题工厂：只有当前主题在启动时构造，其余在主题应用中首次选中时才创建
+static Theme* createPrototypeTheme() { return new (std::nothrow) PrototypeTheme(); }
+static Theme* createDarkTheme() { return new (std::nothrow) DarkTheme(); }
+static Theme* createWindows98Theme() { return new (std::nothrow) Windows98Theme(); }
+static Theme* createWatercolorTheme() { return new (std::nothrow) WatercolorTheme(); }
+
 void setup() {
+  BootProfiler& boot = globalAppManager.getBootProfiler();
+  SettingsStore& settings = globalAppManager.getSettings();
+  
   // 初始化M5Cardputer
   auto cfg = M5.config();
   M5Cardputer.begin(cfg, true);  // 启用键盘
@@ -62,18 +78,25 @@ void setup() {
   // 设置显示器
   M5Cardputer.Display.setRotation(1);
   M5Cardputer.Display.setTextSize(1);
+  boot.mark("hw init");
+  
+  settings.begin();
+  boot.mark("settings");
   
-  globalAppManager.initializeSD();
+  // SD 卡在 initialize() 中交给后台任务挂载，不阻塞首帧
   
   // 初始化主题系统并设置默认主题
   if (globalThemeManager) {
-    globalThemeManager->registerTheme(new PrototypeTheme());
-    globalThemeManager->registerTheme(new DarkTheme());
-    globalThemeManager->registerTheme(new Windows98Theme());
-    globalThemeManager->registerTheme(new WatercolorTheme());
-    // 设置Dark主题为默认主题
-    globalThemeManager->setCurrentTheme(1);
+    globalThemeManager->registerThemeFactory("Prototype", createPrototypeTheme);
+    globalThemeManager->registerThemeFactory("Dark", createDarkTheme);
+    globalThemeManager->registerThemeFactory("Windows 98", createWindows98Theme);
+    globalThemeManager->registerThemeFactory("Watercolor", createWatercolorTheme);
+    // 恢复上次选择的主题，默认（或找不到时）使用Dark主题
+    if (!globalThemeManager->setCurrentTheme(settings.getString(SETTING_THEME, "Dark"))) {
+      globalThemeManager->setCurrentTheme(1);
+    }
   }
+  boot.mark("themes");
   
   // 注册应用到应用管理器
   globalAppManager.registerApp("launcher", "Launcher", &launcherApp, true);  // 启动器
@@ -82,8 +105,12 @@ void setup() {
   //globalAppManager.registerApp("settings", "Settings", &settingsApp);
   globalAppManager.registerApp("filemanager", "Files", &fileManagerApp);
   globalAppManager.registerApp("test", "Test", &testApp);
+  globalAppManager.registerApp("monitor", "Monitor", &systemMonitorApp);
+  globalAppManager.registerApp("search", "Search", &searchApp);
+  globalAppManager.registerApp("textviewer", "Text", &textViewerApp, false, true);  // 由文件管理器打开
+  boot.mark("register apps");
   
-  // 初始化应用管理器（启动启动器）
+  // 初始化应用管理器（启动启动器）；首帧时间在第一次 update() 后记录
   globalAppManager.initialize();
 }
 
@@ -0,0 +1,228 @@
+#include "system/AudioService.h"
+#include <new>
+
+// native 环境的音频服务替身：没有音频任务与解码器，命令入队后立即在调用线程里处理，
+// 播放位置按虚拟时钟推进，曲目不会自行结束。命令、事件与状态仍走与设备相同的
+// 无锁通道，用于在基准中驱动 MusicApp/启动器的显示与 AppManager 的提示。
+
+const char* AudioService::errorText(AudioError error) {
+    switch (error) {
+        case AUDIO_ERR_NO_MEMORY: return "Out of memory for decoder";
+        case AUDIO_ERR_INVALID_TRACK: return "Invalid track";
+        case AUDIO_ERR_OPEN_FAILED: return "Failed to open file";
+        case AUDIO_ERR_START_FAILED: return "Failed to start playback";
+        default: return "";
+    }
+}
+
+AudioService::AudioService()
+    : taskHandle(nullptr), taskExited(false), droppedEvents(0), backlogCount(0), playlist(nullptr),
+      audioFile(nullptr), id3Source(nullptr), mp3Generator(nullptr), audioOutput(nullptr),
+      lastTickMs(0), lastPublishMs(0), decodeBusyUs(0), decodedAudioUs(0) {
+    memset(&status, 0, sizeof(status));
+    status.state = AUDIO_STOPPED;
+    status.trackIndex = -1;
+    status.volume = 50;
+    published.write(status);
+}
+
+AudioService::~AudioService() {
+    end();
+}
+
+bool AudioService::begin() {
+    taskHandle = (TaskHandle_t)this;
+    lastTickMs = millis();
+    return true;
+}
+
+void AudioService::end() {
+    taskHandle = nullptr;
+    AudioEvent event;
+    while (events.pop(event)) {
+        delete event.playlist;
+    }
+    delete playlist;
+    playlist = nullptr;
+    status.state = AUDIO_STOPPED;
+    status.trackIndex = -1;
+    status.trackCount = 0;
+    published.write(status);
+}
+
+bool AudioService::send(AudioCommand cmd, int param, AudioPlaylist* list,
+                        uint32_t resumeMs, uint32_t resumeOffset) {
+    if (!taskHandle) return false;
+    AudioTaskCommand command;
+    command.cmd = cmd;
+    command.param = param;
+    command.playlist = list;
+    command.resumeMs = resumeMs;
+    command.resumeOffset = resumeOffset;
+    if (!commands.push(command)) return false;
+    run();
+    return true;
+}
+
+bool AudioService::togglePause() {
+    if (status.state == AUDIO_PLAYING) return pause();
+    if (status.state == AUDIO_PAUSED) return resume();
+    return false;
+}
+
+bool AudioService::setPlaylist(const LibraryIndex* library, int count) {
+    if (!taskHandle) return false;
+    AudioPlaylist* list = new (std::nothrow) AudioPlaylist();
+    if (!list) return false;
+    if (library && count > 0) {
+        library->retain();
+        list->library = library;
+        list->count = count;
+    }
+    if (!send(AUDIO_CMD_SET_PLAYLIST, 0, list)) {
+        delete list;
+        return false;
+    }
+    return true;
+}
+
+bool AudioService::pollEvent(AudioEvent& out) {
+    // 没有音频任务，借取事件的时机按虚拟时钟推进播放位置
+    if (taskHandle) {
+        uint32_t now = millis();
+        if (status.state == AUDIO_PLAYING) {
+            status.positionMs += now - lastTickMs;
+            publish();
+        }
+        lastTickMs = now;
+    }
+    while (events.pop(out)) {
+        if (out.type == AUDIO_EVENT_PLAYLIST_RELEASED) {
+            delete out.playlist;
+            continue;
+        }
+        return true;
+    }
+    return false;
+}
+
+// 替身中 run() 只处理已入队的命令
+void AudioService::run() {
+    AudioTaskCommand command;
+    while (commands.pop(command)) {
+        handleCommand(command);
+    }
+}
+
+void AudioService::handleCommand(const AudioTaskCommand& command) {
+    int count = playlist ? playlist->count : 0;
+    switch (command.cmd) {
+        case AUDIO_CMD_PLAY:
+            startTrack(command.param, false, command.resumeMs, command.resumeOffset);
+            break;
+        case AUDIO_CMD_PAUSE:
+            if (status.state == AUDIO_PLAYING) setState(AUDIO_PAUSED);
+            break;
+        case AUDIO_CMD_RESUME:
+            if (status.state == AUDIO_PAUSED) setState(AUDIO_PLAYING);
+            break;
+        case AUDIO_CMD_STOP:
+            setState(AUDIO_STOPPED);
+            break;
+        case AUDIO_CMD_NEXT:
+            if (count > 0) startTrack((status.trackIndex + 1) % count, false);
+            break;
+        case AUDIO_CMD_PREV:
+            if (count > 0) startTrack((status.trackIndex - 1 + count) % count, false);
+            break;
+        case AUDIO_CMD_VOLUME:
+            status.volume = command.param < 0 ? 0 : (command.param > 100 ? 100 : command.param);
+            publish();
+            break;
+        case AUDIO_CMD_SET_PLAYLIST:
+            adoptPlaylist(command.playlist);
+            break;
+        case AUDIO_CMD_SHUTDOWN:
+            break;
+    }
+}
+
+void AudioService::adoptPlaylist(AudioPlaylist* next) {
+    int newIndex = -1;
+    if (playlist && next && next->library && status.trackIndex >= 0 && status.trackIndex < playlist->count) {
+        int32_t found = next->library->findEntry(playlist->getPath(status.trackIndex));
+        if (found >= 0 && found < next->count) newIndex = found;
+    }
+    delete playlist;
+    playlist = next;
+    status.trackIndex = newIndex;
+    status.trackCount = next ? next->count : 0;
+    publish();
+}
+
+void AudioService::startTrack(int index, bool autoAdvance, uint32_t resumeMs, uint32_t resumeOffset) {
+    if (!playlist || index < 0 || index >= playlist->count) {
+        setState(AUDIO_STOPPED);
+        reportError(AUDIO_ERR_INVALID_TRACK, index);
+        return;
+    }
+    const char* path = playlist->getPath(index);
+    const char* fileName = strrchr(path, '/');
+    strncpy(status.title, fileName ? fileName + 1 : path, sizeof(status.title) - 1);
+    status.title[sizeof(status.title) - 1] = '\0';
+    // 路径不截断：截断的路径在曲库中找不到，不如不记
+    if (strlen(path) < sizeof(status.path)) strcpy(status.path, path);
+    else status.path[0] = '\0';
+    status.trackIndex = index;
+    status.positionMs = resumeOffset > 0 ? resumeMs : 0;
+    status.trackChanges++;
+    setState(AUDIO_PLAYING);
+
+    AudioEvent started;
+    memset(&started, 0, sizeof(started));
+    started.type = AUDIO_EVENT_TRACK_STARTED;
+    started.state = AUDIO_PLAYING;
+    started.trackIndex = index;
+    started.autoAdvance = autoAdvance;
+    postEvent(started);
+    lastTickMs = millis();
+}
+
+void AudioService::setState(AudioState state) {
+    bool changed = status.state != state;
+    status.state = state;
+    if (state == AUDIO_STOPPED) status.positionMs = 0;
+    publish();
+    if (changed) {
+        AudioEvent event;
+        memset(&event, 0, sizeof(event));
+        event.type = AUDIO_EVENT_STATE_CHANGED;
+        event.state = state;
+        event.trackIndex = status.trackIndex;
+        postEvent(event);
+    }
+}
+
+void AudioService::reportError(AudioError error, int trackIndex) {
+    AudioEvent event;
+    memset(&event, 0, sizeof(event));
+    event.type = AUDIO_EVENT_ERROR;
+    event.state = status.state;
+    event.error = error;
+    event.trackIndex = trackIndex;
+    postEvent(event);
+}
+
+void AudioService::publish() {
+    // 没有真实文件，按 128kbps 由播放时长折算文件位置
+    status.fileOffset = status.trackIndex >= 0 ? status.positionMs * 16 : 0;
+    published.write(status);
+    lastPublishMs = millis();
+}
+
+void AudioService::postEvent(const AudioEvent& event) {
+    // 替身中主线程每帧都会取事件，不需要积压；放不下时与设备端一样就地释放播放列表
+    if (events.push(event)) return;
+    droppedEvents++;
+    if (event.type == AUDIO_EVENT_PLAYLIST_RELEASED) delete event.playlist;
+}
@@ -0,0 +1,171 @@
+#include <M5Cardputer.h>
+
+LGFX_Device::LGFX_Device(int width, int height)
+    : w(width), h(height), fb((size_t)width * height, 0),
+      clipX(0), clipY(0), clipW(width), clipH(height),
+      font(&fonts::Font0), textFg(TFT_WHITE), textBg(TFT_BLACK), textBgSet(false),
+      textSize(1), cursorX(0), cursorY(0), swapBytes(false) {
+    stats.reset();
+}
+
+void LGFX_Device::resize(int width, int height) {
+    w = width;
+    h = height;
+    fb.assign((size_t)width * height, 0);
+    clipX = 0;
+    clipY = 0;
+    clipW = width;
+    clipH = height;
+}
+
+void LGFX_Device::setClipRect(int x, int y, int width, int height) {
+    int x2 = min(x + width, w);
+    int y2 = min(y + height, h);
+    clipX = max(0, x);
+    clipY = max(0, y);
+    clipW = max(0, x2 - clipX);
+    clipH = max(0, y2 - clipY);
+}
+
+void LGFX_Device::fillSpan(int x, int y, int width, int height, uint16_t c) {
+    int x1 = max(x, clipX);
+    int y1 = max(y, clipY);
+    int x2 = min(x + width, clipX + clipW);
+    int y2 = min(y + height, clipY + clipH);
+    for (int yy = y1; yy < y2; yy++) {
+        uint16_t* row = &fb[yy * w];
+        for (int xx = x1; xx < x2; xx++) row[xx] = c;
+    }
+    if (x2 > x1 && y2 > y1) stats.pixels += (uint32_t)((x2 - x1) * (y2 - y1));
+}
+
+void LGFX_Device::drawRect(int x, int y, int width, int height, uint16_t c) {
+    stats.drawCalls++;
+    if (width <= 0 || height <= 0) return;
+    fillSpan(x, y, width, 1, c);
+    fillSpan(x, y + height - 1, width, 1, c);
+    fillSpan(x, y + 1, 1, height - 2, c);
+    fillSpan(x + width - 1, y + 1, 1, height - 2, c);
+}
+
+// 逐个 UTF-8 字符推进；每个字形画成字形单元内的空心框，便于在截图中辨认文字位置
+static int utf8Length(unsigned char lead) {
+    if (lead < 0x80) return 1;
+    if ((lead & 0xE0) == 0xC0) return 2;
+    if ((lead & 0xF0) == 0xE0) return 3;
+    if ((lead & 0xF8) == 0xF0) return 4;
+    return 1;
+}
+
+int LGFX_Device::textWidth(const char* text) const {
+    if (!text) return 0;
+    const lgfx::IFont* f = font ? font : &fonts::Font0;
+    int width = 0;
+    for (const unsigned char* p = (const unsigned char*)text; *p; ) {
+        int n = utf8Length(*p);
+        width += (n == 1 ? f->halfWidth : f->fullWidth) * textSize;
+        for (int i = 0; i < n && *p; i++) p++;
+    }
+    return width;
+}
+
+int LGFX_Device::drawText(const char* text, int x, int y) {
+    const lgfx::IFont* f = font ? font : &fonts::Font0;
+    int gh = f->height * textSize;
+    int cx = x;
+    for (const unsigned char* p = (const unsigned char*)text; *p; ) {
+        int n = utf8Length(*p);
+        int gw = (n == 1 ? f->halfWidth : f->fullWidth) * textSize;
+        if (textBgSet) fillSpan(cx, y, gw, gh, textBg);
+        if (*p != ' ') {
+            fillSpan(cx + 1, y + 2, gw - 2, 1, textFg);
+            fillSpan(cx + 1, y + gh - 3, gw - 2, 1, textFg);
+            fillSpan(cx + 1, y + 3, 1, gh - 6, textFg);
+            fillSpan(cx + gw - 2, y + 3, 1, gh - 6, textFg);
+        }
+        cx += gw;
+        for (int i = 0; i < n && *p; i++) p++;
+    }
+    return cx - x;
+}
+
+size_t LGFX_Device::print(const char* text) {
+    if (!text) return 0;
+    stats.drawCalls++;
+    stats.textCalls++;
+    cursorX += drawText(text, cursorX, cursorY);
+    return strlen(text);
+}
+
+size_t LGFX_Device::drawString(const char* text, int x, int y) {
+    if (!text) return 0;
+    stats.drawCalls++;
+    stats.textCalls++;
+    return (size_t)drawText(text, x, y);
+}
+
+void LGFX_Device::pushImage(int x, int y, int width, int height, const uint16_t* data) {
+    stats.drawCalls++;
+    stats.imageCalls++;
+    if (!data) return;
+    for (int yy = 0; yy < height; yy++) {
+        for (int xx = 0; xx < width; xx++) {
+            uint16_t c = data[yy * width + xx];
+            if (!swapBytes) c = (uint16_t)((c >> 8) | (c << 8));
+            plot(x + xx, y + yy, c);
+        }
+    }
+}
+
+void LGFX_Device::blitNative(int x, int y, int width, int height, const uint16_t* data) {
+    stats.drawCalls++;
+    stats.imageCalls++;
+    if (!data) return;
+    for (int yy = 0; yy < height; yy++) {
+        for (int xx = 0; xx < width; xx++) {
+            plot(x + xx, y + yy, data[yy * width + xx]);
+        }
+    }
+}
+
+void LGFX_Device::readRect(int x, int y, int width, int height, uint16_t* out) {
+    if (!out) return;
+    for (int yy = 0; yy < height; yy++) {
+        for (int xx = 0; xx < width; xx++) {
+            int sx = x + xx;
+            int sy = y + yy;
+            uint16_t c = (sx >= 0 && sy >= 0 && sx < w && sy < h) ? fb[sy * w + sx] : 0;
+            out[yy * width + xx] = (uint16_t)((c >> 8) | (c << 8));
+        }
+    }
+}
+
+static bool pngHeaderSize(const uint8_t* data, size_t len, int& outW, int& outH) {
+    if (!data || len < 24 || data[0] != 0x89 || data[1] != 'P') return false;
+    outW = (int)((uint32_t)data[16] << 24 | (uint32_t)data[17] << 16 | (uint32_t)data[18] << 8 | data[19]);
+    outH = (int)((uint32_t)data[20] << 24 | (uint32_t)data[21] << 16 | (uint32_t)data[22] << 8 | data[23]);
+    return true;
+}
+
+bool LGFX_Device::drawPng(const uint8_t* data, size_t len, int x, int y, int maxW, int maxH,
+                          int offX, int offY, float scaleX, float scaleY) {
+    stats.drawCalls++;
+    stats.imageCalls++;
+    int iw = 0, ih = 0;
+    if (!pngHeaderSize(data, len, iw, ih)) return false;
+    if (scaleX > 0.0f) { iw = (int)(iw * scaleX); ih = (int)(ih * (scaleY > 0.0f ? scaleY : scaleX)); }
+    if (maxW > 0 && iw > maxW) iw = maxW;
+    if (maxH > 0 && ih > maxH) ih = maxH;
+    for (int yy = 0; yy < ih; yy++) {
+        for (int xx = 0; xx < iw; xx++) {
+            plot(x + xx, y + yy, ((xx >> 2) ^ (yy >> 2)) & 1 ? TFT_LIGHTGREY : TFT_DARKGREY);
+        }
+    }
+    return true;
+}
+
+bool LGFX_Device::drawPngFile(const char* path, int x, int y) {
+    stats.drawCalls++;
+    stats.imageCalls++;
+    return false;
+}
@@ -0,0 +1,143 @@
+#include <M5Cardputer.h>
+#include <SD.h>
+#include <time.h>
+
+// native 环境的全局对象与虚拟时钟
+
+M5Cardputer_Class M5Cardputer;
+SDFS SD;
+SPIClass SPI;
+HardwareSerialMock Serial;
+EspClassMock ESP;
+
+static uint32_t virtualMillis = 0;
+
+uint32_t millis() { return virtualMillis; }
+uint32_t micros() { return virtualMillis * 1000u; }
+void delay(uint32_t ms) { virtualMillis += ms; }
+void nativeAdvanceMillis(uint32_t ms) { virtualMillis += ms; }
+
+uint32_t EspClassMock::getCycleCount() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 240000000ull + (uint64_t)ts.tv_nsec * 240ull / 1000ull);
+}
+
+namespace fs {
+
+class FileImpl {
+public:
+    std::string virtualPath;
+    std::string baseName;
+    FILE* fp;
+    DIR* dir;
+    const FS* owner;
+    FileImpl() : fp(nullptr), dir(nullptr), owner(nullptr) {}
+    ~FileImpl() {
+        if (fp) fclose(fp);
+        if (dir) closedir(dir);
+    }
+};
+
+std::string FS::hostPath(const char* path) const {
+    std::string p = path ? path : "/";
+    if (p.empty() || p[0] != '/') p = "/" + p;
+    return root + p;
+}
+
+File FS::open(const char* path, const char* mode, bool create) {
+    std::string hp = hostPath(path);
+    std::shared_ptr<FileImpl> impl(new FileImpl());
+    impl->owner = this;
+    impl->virtualPath = path ? path : "/";
+    size_t slash = impl->virtualPath.find_last_of('/');
+    impl->baseName = slash == std::string::npos ? impl->virtualPath : impl->virtualPath.substr(slash + 1);
+    struct stat st;
+    bool reading = mode == nullptr || mode[0] == 'r';
+    if (reading && stat(hp.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+        impl->dir = opendir(hp.c_str());
+        if (!impl->dir) return File();
+        return File(impl);
+    }
+    const char* m = reading ? "rb" : (mode[0] == 'a' ? "ab" : "wb");
+    impl->fp = fopen(hp.c_str(), m);
+    if (!impl->fp) return File();
+    return File(impl);
+}
+
+bool FS::exists(const char* path) {
+    struct stat st;
+    return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::mkdir(const char* path) { return ::mkdir(hostPath(path).c_str(), 0755) == 0; }
+bool FS::remove(const char* path) { return ::unlink(hostPath(path).c_str()) == 0; }
+bool FS::rmdir(const char* path) { return ::rmdir(hostPath(path).c_str()) == 0; }
+bool FS::rename(const char* from, const char* to) { return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0; }
+
+File::operator bool() const { return impl && (impl->fp || impl->dir); }
+bool File::isDirectory() const { return impl && impl->dir; }
+const char* File::name() const { return impl ? impl->baseName.c_str() : ""; }
+const char* File::path() const { return impl ? impl->virtualPath.c_str() : ""; }
+
+size_t File::size() const {
+    if (!impl || !impl->fp) return 0;
+    struct stat st;
+    if (fstat(fileno(impl->fp), &st) != 0) return 0;
+    return (size_t)st.st_size;
+}
+
+int File::available() {
+    if (!impl || !impl->fp) return 0;
+    long pos = ftell(impl->fp);
+    return (int)(size() - (size_t)pos);
+}
+
+int File::read() {
+    if (!impl || !impl->fp) return -1;
+    return fgetc(impl->fp);
+}
+
+size_t File::read(uint8_t* buf, size_t len) {
+    if (!impl || !impl->fp) return 0;
+    return fread(buf, 1, len, impl->fp);
+}
+
+size_t File::write(const uint8_t* buf, size_t len) {
+    if (!impl || !impl->fp) return 0;
+    return fwrite(buf, 1, len, impl->fp);
+}
+
+bool File::seek(uint32_t pos) { return impl && impl->fp && fseek(impl->fp, (long)pos, SEEK_SET) == 0; }
+size_t File::position() const { return impl && impl->fp ? (size_t)ftell(impl->fp) : 0; }
+void File::flush() { if (impl && impl->fp) fflush(impl->fp); }
+
+void File::close() {
+    impl.reset();
+}
+
+time_t File::getLastWrite() {
+    if (!impl || !impl->owner) return 0;
+    struct stat st;
+    if (stat(impl->owner->hostPath(impl->virtualPath.c_str()).c_str(), &st) != 0) return 0;
+    return st.st_mtime;
+}
+
+File File::openNextFile(const char* mode) {
+    if (!impl || !impl->dir) return File();
+    struct dirent* e;
+    while ((e = readdir(impl->dir)) != nullptr) {
+        if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0) continue;
+        std::string child = impl->virtualPath;
+        if (child.empty() || child[child.size() - 1] != '/') child += "/";
+        child += e->d_name;
+        return const_cast<FS*>(impl->owner)->open(child.c_str(), mode);
+    }
+    return File();
+}
+
+void File::rewindDirectory() {
+    if (impl && impl->dir) rewinddir(impl->dir);
+}
+
+} // namespace fs
@@ -0,0 +1,131 @@
+#pragma once
+// 主机端（native 环境）Arduino 核心替身：仅实现 UI 栈实际用到的接口
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <new>
+#include <string>
+#include <algorithm>
+
+using std::min;
+using std::max;
+
+// 虚拟时钟：由基准运行器推进，保证回放结果可重复
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void nativeAdvanceMillis(uint32_t ms);
+
+class String {
+private:
+    std::string s;
+public:
+    String() {}
+    String(const char* c) : s(c ? c : "") {}
+    String(const std::string& str) : s(str) {}
+    String(char c) : s(1, c) {}
+    String(int v) : s(std::to_string(v)) {}
+    String(unsigned int v) : s(std::to_string(v)) {}
+    String(long v) : s(std::to_string(v)) {}
+    String(unsigned long v) : s(std::to_string(v)) {}
+    String(long long v) : s(std::to_string(v)) {}
+    String(unsigned long long v) : s(std::to_string(v)) {}
+    String(float v, unsigned int decimals = 2) { char b[32]; snprintf(b, sizeof(b), "%.*f", (int)decimals, v); s = b; }
+    String(double v, unsigned int decimals = 2) { char b[32]; snprintf(b, sizeof(b), "%.*f", (int)decimals, v); s = b; }
+
+    const char* c_str() const { return s.c_str(); }
+    unsigned int length() const { return (unsigned int)s.size(); }
+    bool isEmpty() const { return s.empty(); }
+    char charAt(unsigned int i) const { return i < s.size() ? s[i] : 0; }
+    char operator[](unsigned int i) const { return charAt(i); }
+    void reserve(unsigned int n) { s.reserve(n); }
+
+    String substring(unsigned int from) const { return from >= s.size() ? String() : String(s.substr(from)); }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from > to) std::swap(from, to);
+        if (from >= s.size()) return String();
+        if (to > s.size()) to = (unsigned int)s.size();
+        return String(s.substr(from, to - from));
+    }
+    int indexOf(char c, unsigned int from = 0) const { size_t p = s.find(c, from); return p == std::string::npos ? -1 : (int)p; }
+    int indexOf(const String& str, unsigned int from = 0) const { size_t p = s.find(str.s, from); return p == std::string::npos ? -1 : (int)p; }
+    int lastIndexOf(char c) const { size_t p = s.rfind(c); return p == std::string::npos ? -1 : (int)p; }
+    int lastIndexOf(const String& str) const { size_t p = s.rfind(str.s); return p == std::string::npos ? -1 : (int)p; }
+    bool startsWith(const String& p) const { return s.compare(0, p.s.size(), p.s) == 0 && s.size() >= p.s.size(); }
+    bool endsWith(const String& p) const { return s.size() >= p.s.size() && s.compare(s.size() - p.s.size(), p.s.size(), p.s) == 0; }
+    bool equals(const String& o) const { return s == o.s; }
+    bool equalsIgnoreCase(const String& o) const {
+        if (s.size() != o.s.size()) return false;
+        for (size_t i = 0; i < s.size(); i++) {
+            if (tolower((unsigned char)s[i]) != tolower((unsigned char)o.s[i])) return false;
+        }
+        return true;
+    }
+    void toLowerCase() { for (size_t i = 0; i < s.size(); i++) s[i] = (char)tolower((unsigned char)s[i]); }
+    void toUpperCase() { for (size_t i = 0; i < s.size(); i++) s[i] = (char)toupper((unsigned char)s[i]); }
+    void trim() {
+        size_t b = 0;
+        while (b < s.size() && isspace((unsigned char)s[b])) b++;
+        size_t e = s.size();
+        while (e > b && isspace((unsigned char)s[e - 1])) e--;
+        s = s.substr(b, e - b);
+    }
+    void replace(const String& from, const String& to) {
+        if (from.s.empty()) return;
+        size_t p = 0;
+        while ((p = s.find(from.s, p)) != std::string::npos) {
+            s.replace(p, from.s.size(), to.s);
+            p += to.s.size();
+        }
+    }
+    long toInt() const { return atol(s.c_str()); }
+    float toFloat() const { return (float)atof(s.c_str()); }
+
+    String& operator+=(const String& o) { s += o.s; return *this; }
+    String& operator+=(const char* c) { if (c) s += c; return *this; }
+    String& operator+=(char c) { s += c; return *this; }
+    bool concat(const String& o) { s += o.s; return true; }
+    bool concat(const char* c, unsigned int length) { if (c) s.append(c, length); return true; }
+
+    friend String operator+(const String& a, const String& b) { return String(a.s + b.s); }
+    friend String operator+(const String& a, const char* b) { return String(a.s + (b ? b : "")); }
+    friend String operator+(const char* a, const String& b) { return String(std::string(a ? a : "") + b.s); }
+    friend String operator+(const String& a, char b) { return String(a.s + b); }
+    bool operator==(const String& o) const { return s == o.s; }
+    bool operator==(const char* c) const { return s == (c ? c : ""); }
+    bool operator!=(const String& o) const { return s != o.s; }
+    bool operator!=(const char* c) const { return !(*this == c); }
+    bool operator<(const String& o) const { return s < o.s; }
+};
+
+class HardwareSerialMock {
+private:
+    FILE* out;
+public:
+    HardwareSerialMock() : out(stdout) {}
+    // 主机端可把串口输出重定向到文件（如屏幕镜像的二进制流）
+    void setOutput(FILE* f) { out = f ? f : stdout; }
+    void begin(unsigned long) {}
+    size_t setTxBufferSize(size_t) { return 0; }
+    size_t write(const uint8_t* data, size_t len) { return fwrite(data, 1, len, out); }
+    int availableForWrite() { return 4096; }
+    void print(const String& s) { fputs(s.c_str(), out); }
+    void println(const String& s) { fputs(s.c_str(), out); fputc('\n', out); }
+    template <typename... Args>
+    void printf(const char* fmt, Args... args) { ::fprintf(out, fmt, args...); }
+};
+extern HardwareSerialMock Serial;
+
+class EspClassMock {
+public:
+    uint32_t getCycleCount();
+    uint32_t getFreeHeap() { return 200 * 1024; }
+};
+extern EspClassMock ESP;
+
+inline uint32_t& nativeCpuMhz() { static uint32_t mhz = 240; return mhz; }
+inline uint32_t getCpuFrequencyMhz() { return nativeCpuMhz(); }
+inline bool setCpuFrequencyMhz(uint32_t mhz) { nativeCpuMhz() = mhz; return true; }
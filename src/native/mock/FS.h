@@ -0,0 +1,68 @@
+#pragma once
+// 主机端文件系统替身：把 SD/LittleFS 路径映射到宿主机目录，供 native 基准使用
+#include <Arduino.h>
+#include <memory>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+class FileImpl;
+
+class File {
+private:
+    std::shared_ptr<FileImpl> impl;
+public:
+    File() {}
+    explicit File(std::shared_ptr<FileImpl> p) : impl(p) {}
+    explicit operator bool() const;
+    bool isDirectory() const;
+    const char* name() const;
+    const char* path() const;
+    size_t size() const;
+    int available();
+    int read();
+    size_t read(uint8_t* buf, size_t len);
+    size_t write(const uint8_t* buf, size_t len);
+    size_t write(uint8_t c) { return write(&c, 1); }
+    bool seek(uint32_t pos);
+    size_t position() const;
+    void flush();
+    void close();
+    time_t getLastWrite();
+    File openNextFile(const char* mode = FILE_READ);
+    void rewindDirectory();
+};
+
+class FS {
+protected:
+    std::string root;
+public:
+    explicit FS(const std::string& hostRoot = ".") : root(hostRoot) {}
+    virtual ~FS() {}
+    void setHostRoot(const std::string& hostRoot) { root = hostRoot; }
+    const std::string& getHostRoot() const { return root; }
+    std::string hostPath(const char* path) const;
+    File open(const char* path, const char* mode = FILE_READ, bool create = false);
+    File open(const String& path, const char* mode = FILE_READ, bool create = false) { return open(path.c_str(), mode, create); }
+    bool exists(const char* path);
+    bool exists(const String& path) { return exists(path.c_str()); }
+    bool mkdir(const char* path);
+    bool mkdir(const String& path) { return mkdir(path.c_str()); }
+    bool remove(const char* path);
+    bool remove(const String& path) { return remove(path.c_str()); }
+    bool rmdir(const char* path);
+    bool rmdir(const String& path) { return rmdir(path.c_str()); }
+    bool rename(const char* from, const char* to);
+    bool rename(const String& from, const String& to) { return rename(from.c_str(), to.c_str()); }
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
@@ -0,0 +1,186 @@
+#pragma once
+// 主机端 M5Cardputer 替身：LGFX_Device 为记录型模拟显示器，
+// 光栅化到内存中的 RGB565 帧缓冲，并统计绘制调用次数与写入像素数。
+#include <Arduino.h>
+#include <vector>
+
+#define TFT_BLACK       0x0000
+#define TFT_NAVY        0x000F
+#define TFT_DARKGREEN   0x03E0
+#define TFT_MAROON      0x7800
+#define TFT_PURPLE      0x780F
+#define TFT_OLIVE       0x7BE0
+#define TFT_LIGHTGREY   0xD69A
+#define TFT_DARKGREY    0x7BEF
+#define TFT_BLUE        0x001F
+#define TFT_GREEN       0x07E0
+#define TFT_CYAN        0x07FF
+#define TFT_RED         0xF800
+#define TFT_MAGENTA     0xF81F
+#define TFT_YELLOW      0xFFE0
+#define TFT_WHITE       0xFFFF
+#define TFT_ORANGE      0xFDA0
+
+#define APP_CPU_NUM 1
+#define PRO_CPU_NUM 0
+
+namespace lgfx {
+// 字体只携带字形单元尺寸：ASCII 取 halfWidth，多字节 UTF-8 字符取 fullWidth
+struct IFont {
+    int halfWidth;
+    int fullWidth;
+    int height;
+};
+}
+
+namespace lgfx {
+// 面板配置：模拟显示器的帧缓冲可以回读
+class Panel_Device {
+public:
+    struct config_t {
+        bool readable = true;
+    };
+    const config_t& config() const { return cfg; }
+private:
+    config_t cfg;
+};
+}
+
+namespace fonts {
+static const lgfx::IFont efontCN_12 = { 6, 12, 12 };
+static const lgfx::IFont Font0 = { 6, 6, 8 };
+}
+
+// 绘制统计
+struct MockDrawStats {
+    uint32_t drawCalls;
+    uint32_t pixels;        // 实际写入帧缓冲（裁剪后）的像素数
+    uint32_t textCalls;
+    uint32_t imageCalls;
+    void reset() { drawCalls = pixels = textCalls = imageCalls = 0; }
+};
+
+class LGFX_Device {
+protected:
+    int w, h;
+    std::vector<uint16_t> fb;
+    int clipX, clipY, clipW, clipH;
+    const lgfx::IFont* font;
+    uint16_t textFg;
+    uint16_t textBg;
+    bool textBgSet;
+    int textSize;
+    int cursorX, cursorY;
+    bool swapBytes;
+    MockDrawStats stats;
+    lgfx::Panel_Device panel;
+
+    void plot(int x, int y, uint16_t c) {
+        if (x < clipX || y < clipY || x >= clipX + clipW || y >= clipY + clipH) return;
+        fb[y * w + x] = c;
+        stats.pixels++;
+    }
+    void fillSpan(int x, int y, int width, int height, uint16_t c);
+    int drawText(const char* text, int x, int y);
+    void resize(int width, int height);
+
+public:
+    LGFX_Device(int width = 240, int height = 135);
+
+    int width() const { return w; }
+    int height() const { return h; }
+    void setRotation(int) {}
+    void setBrightness(int) {}
+
+    const uint16_t* framebuffer() const { return fb.data(); }
+    MockDrawStats& getStats() { return stats; }
+    lgfx::Panel_Device* getPanel() { return &panel; }
+
+    void setClipRect(int x, int y, int width, int height);
+    void getClipRect(int32_t* x, int32_t* y, int32_t* width, int32_t* height) const { *x = clipX; *y = clipY; *width = clipW; *height = clipH; }
+    void clearClipRect() { setClipRect(0, 0, w, h); }
+
+    void fillScreen(uint16_t c) { stats.drawCalls++; fillSpan(0, 0, w, h, c); }
+    void fillRect(int x, int y, int width, int height, uint16_t c) { stats.drawCalls++; fillSpan(x, y, width, height, c); }
+    void drawRect(int x, int y, int width, int height, uint16_t c);
+    void drawFastHLine(int x, int y, int width, uint16_t c) { stats.drawCalls++; fillSpan(x, y, width, 1, c); }
+    void drawFastVLine(int x, int y, int height, uint16_t c) { stats.drawCalls++; fillSpan(x, y, 1, height, c); }
+    void drawPixel(int x, int y, uint16_t c) { stats.drawCalls++; plot(x, y, c); }
+
+    void setFont(const lgfx::IFont* f) { font = f; }
+    void setTextSize(int s) { textSize = s; }
+    void setTextColor(uint16_t fg) { textFg = fg; textBgSet = false; }
+    void setTextColor(uint16_t fg, uint16_t bg) { textFg = fg; textBg = bg; textBgSet = true; }
+    void setCursor(int x, int y) { cursorX = x; cursorY = y; }
+    int fontHeight() const { return font ? font->height : 8; }
+    int textWidth(const char* text) const;
+    int textWidth(const String& text) const { return textWidth(text.c_str()); }
+    size_t print(const char* text);
+    size_t print(const String& text) { return print(text.c_str()); }
+    size_t print(int v) { return print(String(v)); }
+    size_t drawString(const char* text, int x, int y);
+    size_t drawString(const String& text, int x, int y) { return drawString(text.c_str(), x, y); }
+
+    // 与 LovyanGFX 一致：uint16_t 图像数据默认按字节交换的 RGB565（高字节在前）解释，
+    // setSwapBytes(true) 时按本机字节序解释；readRect 输出同样为高字节在前
+    void setSwapBytes(bool s) { swapBytes = s; }
+    void pushImage(int x, int y, int width, int height, const uint16_t* data);
+    void readRect(int x, int y, int width, int height, uint16_t* out);
+    // 仅供模拟精灵使用：帧缓冲按本机字节序整块推送
+    void blitNative(int x, int y, int width, int height, const uint16_t* data);
+
+    // PNG 不在主机端解码：按目标区域绘制占位棋盘格，保持像素计数可比
+    bool drawPng(const uint8_t* data, size_t len, int x = 0, int y = 0, int maxW = 0, int maxH = 0,
+                 int offX = 0, int offY = 0, float scaleX = 1.0f, float scaleY = 0.0f);
+    bool drawPngFile(const char* path, int x = 0, int y = 0);
+};
+
+// 精灵：同样光栅化到自身的帧缓冲，pushSprite 时整块推送到父设备
+class LGFX_Sprite : public LGFX_Device {
+private:
+    LGFX_Device* parentDevice;
+public:
+    explicit LGFX_Sprite(LGFX_Device* parent = nullptr) : LGFX_Device(0, 0), parentDevice(parent) {}
+    void setColorDepth(int) {}
+    void* createSprite(int width, int height) { resize(width, height); return fb.data(); }
+    void deleteSprite() { resize(0, 0); }
+    void pushSprite(int x, int y) { pushSprite(parentDevice, x, y); }
+    void pushSprite(LGFX_Device* dst, int x, int y) {
+        if (dst && w > 0 && h > 0) dst->blitNative(x, y, w, h, fb.data());
+    }
+};
+
+class Keyboard_Class {
+public:
+    struct KeysState {
+        std::vector<char> word;
+        bool tab = false;
+        bool fn = false;
+        bool shift = false;
+        bool ctrl = false;
+        bool opt = false;
+        bool alt = false;
+        bool del = false;
+        bool enter = false;
+        bool space = false;
+    };
+    bool isChange() { return false; }
+    bool isPressed() { return false; }
+    void updateKeyList() {}
+    void updateKeysState() {}
+    KeysState keysState() { return KeysState(); }
+};
+
+class Power_Class {
+public:
+    int getBatteryLevel() { return 87; }
+    int getBatteryVoltage() { return 4012; }
+    bool isCharging() { return false; }
+};
+
+struct M5Cardputer_Class {
+    LGFX_Device Display;
+    Keyboard_Class Keyboard;
+    Power_Class Power;
+};
+extern M5Cardputer_Class M5Cardputer;
@@ -0,0 +1,50 @@
+#pragma once
+// 主机端 Preferences 替身：NVS 以进程内的 map 代替，进程退出即丢失
+#include <Arduino.h>
+#include <map>
+#include <string>
+#include <vector>
+
+class Preferences {
+private:
+    std::string ns;
+    bool open;
+    bool readOnly;
+
+    static std::map<std::string, std::vector<uint8_t> >& storage() {
+        static std::map<std::string, std::vector<uint8_t> > s;
+        return s;
+    }
+    std::string fullKey(const char* key) const { return ns + "/" + key; }
+
+public:
+    Preferences() : open(false), readOnly(false) {}
+    ~Preferences() { end(); }
+
+    bool begin(const char* name, bool ro = false, const char* = nullptr) {
+        ns = name;
+        open = true;
+        readOnly = ro;
+        return true;
+    }
+    void end() { open = false; }
+
+    size_t getBytesLength(const char* key) {
+        if (!open) return 0;
+        std::map<std::string, std::vector<uint8_t> >::iterator it = storage().find(fullKey(key));
+        return it == storage().end() ? 0 : it->second.size();
+    }
+    size_t getBytes(const char* key, void* buf, size_t maxLen) {
+        if (!open) return 0;
+        std::map<std::string, std::vector<uint8_t> >::iterator it = storage().find(fullKey(key));
+        if (it == storage().end() || it->second.size() > maxLen) return 0;
+        memcpy(buf, it->second.data(), it->second.size());
+        return it->second.size();
+    }
+    size_t putBytes(const char* key, const void* value, size_t len) {
+        if (!open || readOnly) return 0;
+        const uint8_t* p = static_cast<const uint8_t*>(value);
+        storage()[fullKey(key)].assign(p, p + len);
+        return len;
+    }
+};
@@ -0,0 +1,11 @@
+#pragma once
+#include <FS.h>
+#include <SPI.h>
+
+class SDFS : public fs::FS {
+public:
+    SDFS() : fs::FS(".") {}
+    bool begin(int csPin = -1, SPIClass& spi = SPI, uint32_t frequency = 4000000) { return true; }
+    void end() {}
+};
+extern SDFS SD;
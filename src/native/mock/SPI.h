@@ -0,0 +1,7 @@
+#pragma once
+#include <Arduino.h>
+class SPIClass {
+public:
+    void begin(int, int, int, int) {}
+};
+extern SPIClass SPI;
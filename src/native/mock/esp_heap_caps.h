@@ -0,0 +1,13 @@
+#pragma once
+#include <stddef.h>
+#include <stdlib.h>
+
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_DMA      (1 << 3)
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+inline size_t heap_caps_get_free_size(int) { return 0; }
+inline size_t heap_caps_get_largest_free_block(int) { return 0; }
+inline void* heap_caps_malloc(size_t size, int) { return malloc(size); }
+inline void heap_caps_free(void* p) { free(p); }
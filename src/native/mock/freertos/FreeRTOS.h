@@ -0,0 +1,14 @@
+#pragma once
+// 主机端 FreeRTOS 类型替身（native 环境不运行真实任务）
+#include <stdint.h>
+typedef void* TaskHandle_t;
+typedef unsigned int UBaseType_t;
+typedef int BaseType_t;
+typedef uint32_t TickType_t;
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portSET_INTERRUPT_MASK_FROM_ISR() ((UBaseType_t)0)
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(state) ((void)(state))
@@ -0,0 +1,3 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+typedef void* QueueHandle_t;
@@ -0,0 +1,5 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+inline UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t) { return 0; }
+inline TaskHandle_t xTaskGetHandle(const char*) { return nullptr; }
+inline BaseType_t xPortGetCoreID() { return 1; }
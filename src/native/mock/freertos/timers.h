@@ -0,0 +1,3 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+typedef void* TimerHandle_t;
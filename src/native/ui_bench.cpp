@@ -0,0 +1,417 @@
+// 主机端 UI 基准：在记录型模拟显示器上回放按键脚本，
+// 按帧统计绘制调用、写入像素与堆分配次数。
+//
+// 用法：
+//   pio run -e native && .pio/build/native/program [--theme N] [--sdroot DIR] [--script KEYS]
+//       [--frames-per-key N] [--skip-keys N] [--per-frame] [--dump FILE] [--mirror FILE]
+//       [--screenshot] [--trace]
+//   .pio/build/native/program --governor-replay LOG
+//       用设备串口日志中的 "[gov] sample,..." 行（-DGOVERNOR_LOG_SAMPLES）回放 CPU 调频策略
+//   .pio/build/native/program --lrc-bench FILE
+//       比较整文件读入字符串再逐行切分与 BufferedReader 流式解析 LRC 的分配次数与耗时
+//
+// KEYS 为按键序列，每个字符对应一次按键：
+//   ; . , /  上 下 左 右      `  ESC      \n 或 E  回车
+//   其他字符作为文本输入
+#include <M5Cardputer.h>
+#include <SD.h>
+#include <new>
+#include <algorithm>
+#include "system/EventSystem.h"
+#include "system/LrcParser.h"
+#include "system/AppManager.h"
+#include "apps/LauncherApp.h"
+#include "apps/MusicApp.h"
+#include "apps/TestApp.h"
+#include "apps/FileManagerApp.h"
+#include "apps/SystemMonitorApp.h"
+#include "apps/TextViewerApp.h"
+#include "apps/SearchApp.h"
+#include "apps/ThemeApp.h"
+#include "themes/ThemeManager.h"
+#include "themes/PrototypeTheme.h"
+#include "themes/DarkTheme.h"
+#include "themes/Windows98Theme.h"
+#include "themes/WatercolorTheme.h"
+
+// 堆分配计数：覆盖全局 operator new，统计每帧分配次数与字节数
+static uint32_t allocCount = 0;
+static uint32_t allocBytes = 0;
+
+void* operator new(size_t size) {
+    allocCount++;
+    allocBytes += (uint32_t)size;
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void* operator new[](size_t size) { return operator new(size); }
+// 释放不内联：内联后 GCC 在本文件里看到 new 出来的指针直接交给 free，会误报 -Wmismatched-new-delete
+__attribute__((noinline)) void operator delete(void* p) noexcept { free(p); }
+__attribute__((noinline)) void operator delete[](void* p) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept { free(p); }
+__attribute__((noinline)) void operator delete[](void* p, size_t) noexcept { free(p); }
+
+EventSystem globalEventSystem;
+AppManager globalAppManager(&globalEventSystem);
+ThemeManager globalThemeManagerInstance;
+ThemeManager* globalThemeManager = &globalThemeManagerInstance;
+
+LauncherApp launcherApp(&globalEventSystem);
+MusicApp musicApp(&globalEventSystem, &globalAppManager);
+TestApp testApp(&globalEventSystem);
+FileManagerApp fileManagerApp(&globalEventSystem, &globalAppManager);
+SystemMonitorApp systemMonitorApp(&globalEventSystem, &globalAppManager);
+TextViewerApp textViewerApp(&globalEventSystem, &globalAppManager);
+SearchApp searchApp(&globalEventSystem, &globalAppManager);
+ThemeApp themeApp(&globalEventSystem);
+
+static Theme* createPrototypeTheme() { return new (std::nothrow) PrototypeTheme(); }
+static Theme* createDarkTheme() { return new (std::nothrow) DarkTheme(); }
+static Theme* createWindows98Theme() { return new (std::nothrow) Windows98Theme(); }
+static Theme* createWatercolorTheme() { return new (std::nothrow) WatercolorTheme(); }
+
+struct FrameSample {
+    uint32_t drawCalls;
+    uint32_t pixels;
+    uint32_t allocs;
+    uint32_t bytes;
+};
+
+static KeyEvent makeKeyEvent(char c) {
+    KeyEvent event;
+    event.text = "";
+    event.enter = false;
+    event.del = false;
+    event.tab = false;
+    event.up = false;
+    event.down = false;
+    event.left = false;
+    event.right = false;
+    event.esc = false;
+    event.ctrl = false;
+    event.fn = false;
+    switch (c) {
+        case ';': event.up = true; break;
+        case '.': event.down = true; break;
+        case ',': event.left = true; break;
+        case '/': event.right = true; break;
+        case '`': event.esc = true; break;
+        case '\n':
+        case 'E': event.enter = true; break;
+        case 'D': event.del = true; break;
+        default: event.text += c; break;
+    }
+    return event;
+}
+
+// 把帧缓冲写成 PPM，便于肉眼核对回放结果
+static bool dumpFramebuffer(const char* path) {
+    FILE* fp = fopen(path, "wb");
+    if (!fp) return false;
+    LGFX_Device& d = M5Cardputer.Display;
+    fprintf(fp, "P6\n%d %d\n255\n", d.width(), d.height());
+    const uint16_t* fb = d.framebuffer();
+    for (int i = 0; i < d.width() * d.height(); i++) {
+        uint16_t c = fb[i];
+        uint8_t rgb[3] = {
+            (uint8_t)(((c >> 11) & 0x1F) << 3),
+            (uint8_t)(((c >> 5) & 0x3F) << 2),
+            (uint8_t)((c & 0x1F) << 3)
+        };
+        fwrite(rgb, 1, 3, fp);
+    }
+    fclose(fp);
+    return true;
+}
+
+// 回放录制的负载序列：解码耗时按录制时频率与策略当前频率的比例换算，
+// 统计策略选择的频率下预计负载超过 100%（会欠载）的窗口数
+static int replayGovernor(const char* path) {
+    FILE* fp = fopen(path, "r");
+    if (!fp) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return 1;
+    }
+    CpuGovernorPolicy policy;
+    char line[256];
+    uint32_t windows = 0, switches = 0, overloaded = 0, recordedUnderruns = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        const char* p = strstr(line, "[gov] sample,");
+        if (!p) continue;
+        unsigned long nowMs, windowMs, mhz, busyUs, audioUs, frames, inputs, underruns;
+        if (sscanf(p, "[gov] sample,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu", &nowMs, &windowMs, &mhz, &busyUs,
+                   &audioUs, &frames, &inputs, &underruns) != 8 || mhz == 0) {
+            continue;
+        }
+        GovernorSample s;
+        s.nowMs = nowMs;
+        s.windowMs = windowMs;
+        s.decodeBusyUs = (uint32_t)((uint64_t)busyUs * mhz / policy.getMhz());
+        s.decodedAudioUs = audioUs;
+        s.framesDrawn = frames;
+        s.inputEvents = inputs;
+        s.underruns = 0;    // 录制时的欠载取决于当时的频率，回放中按预计负载判断
+        recordedUnderruns += underruns;
+        windows++;
+        if (audioUs > 0 && s.decodeBusyUs > audioUs) overloaded++;
+        GovernorDecision d = policy.evaluate(s);
+        if (d.changed) {
+            switches++;
+            printf("%8.1fs  %3u -> %3u MHz  (%s, decode %u%%)\n", nowMs / 1000.0, (unsigned)d.fromMhz,
+                   (unsigned)d.toMhz, CpuGovernorPolicy::reasonText(d.reason), (unsigned)d.decodeLoadPct);
+        }
+    }
+    fclose(fp);
+    if (windows == 0) {
+        fprintf(stderr, "no [gov] sample lines in %s\n", path);
+        return 1;
+    }
+    uint64_t total = policy.getTotalMs();
+    printf("windows       %u  (%.1f s)\n", (unsigned)windows, total / 1000.0);
+    printf("switches      %u\n", (unsigned)switches);
+    printf("time at       80MHz %.0f%%  160MHz %.0f%%  240MHz %.0f%%\n",
+           policy.getTimeAtLevelMs(0) * 100.0 / total, policy.getTimeAtLevelMs(1) * 100.0 / total,
+           policy.getTimeAtLevelMs(2) * 100.0 / total);
+    uint32_t avg10 = policy.getAverageCurrent10();
+    printf("cpu current   ~%u.%u mA vs %u mA fixed 240 MHz (%+d%% runtime)\n", (unsigned)(avg10 / 10),
+           (unsigned)(avg10 % 10), (unsigned)CpuGovernorPolicy::levelCurrentMa(CpuGovernorPolicy::LEVEL_COUNT - 1),
+           policy.getRuntimeGainPct());
+    printf("overloaded    %u windows (recorded underruns %u)\n", (unsigned)overloaded, (unsigned)recordedUnderruns);
+    return 0;
+}
+
+static double nowSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 原来的做法：逐字节追加到 String，再用 indexOf/substring 每行生成一个 String（只取时间标签之后的文本）
+static size_t parseLrcWholeString(File& file, std::vector<LyricLine>& out) {
+    String content = "";
+    while (file.available()) content += (char)file.read();
+    out.clear();
+    int pos = 0;
+    while (pos < (int)content.length()) {
+        int next = content.indexOf('\n', pos);
+        if (next == -1) next = content.length();
+        String line = content.substring(pos, next);
+        pos = next + 1;
+        line.replace("\r", "");
+        const char* text;
+        uint32_t textLength;
+        uint32_t times[LrcParser::MAX_TIMES_PER_LINE];
+        int count = LrcParser::parseLine(line.c_str(), line.length(), times, LrcParser::MAX_TIMES_PER_LINE, text, textLength);
+        if (count == 0 || textLength == 0) continue;
+        LyricLine lyric;
+        lyric.text = line.substring(text - line.c_str(), text - line.c_str() + textLength);
+        for (int i = 0; i < count; i++) {
+            lyric.timeMs = times[i];
+            out.push_back(lyric);
+        }
+    }
+    return out.size();
+}
+
+static int benchLrc(const char* path) {
+    SD.setHostRoot("/");
+    std::vector<LyricLine> lines, reference;
+    lines.reserve(8192);
+    for (int pass = 0; pass < 2; pass++) {
+        File file = SD.open(path);
+        if (!file) {
+            fprintf(stderr, "cannot open %s\n", path);
+            return 1;
+        }
+        uint32_t size = file.size();
+        uint32_t allocs = allocCount;
+        uint32_t bytes = allocBytes;
+        double t0 = nowSeconds();
+        size_t count = pass == 0 ? parseLrcWholeString(file, lines) : (LrcParser::parse(file, lines), lines.size());
+        double t1 = nowSeconds();
+        file.close();
+        // 歌词文本本身两种做法都要分配，单独列出
+        uint32_t textAllocs = 0;
+        for (size_t i = 0; i < lines.size(); i++) {
+            if (i == 0 || lines[i].text != lines[i - 1].text) textAllocs++;
+        }
+        printf("%-13s %u bytes  %u lines  %.2f ms  allocations %u (%u bytes, ~%u lyric texts)\n",
+               pass == 0 ? "whole-string" : "buffered", (unsigned)size, (unsigned)count, (t1 - t0) * 1000.0,
+               (unsigned)(allocCount - allocs), (unsigned)(allocBytes - bytes), (unsigned)textAllocs);
+        if (pass == 0) {
+            // 原来的做法不排序，这里补上后作为对照
+            std::sort(lines.begin(), lines.end(), [](const LyricLine& a, const LyricLine& b) { return a.timeMs < b.timeMs; });
+            reference = lines;
+        }
+    }
+    bool same = reference.size() == lines.size();
+    for (size_t i = 0; same && i < lines.size(); i++) {
+        same = reference[i].timeMs == lines[i].timeMs && reference[i].text == lines[i].text;
+    }
+    printf("results       %s\n", same ? "identical" : "DIFFER");
+    return same ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    int themeIndex = 1;
+    int framesPerKey = 10;
+    const char* script = "/./,E...;`/E..`//E`";
+    const char* dumpPath = nullptr;
+    const char* mirrorPath = nullptr;  // 屏幕镜像的串口字节流写入该文件
+    bool screenshot = false;           // 结束时走 Ctrl+S 的截图路径，保存到 SD 根目录下的 /screenshots
+    bool trace = false;                // 结束时转储追踪缓冲到 /traces（需以 -DENABLE_TRACE 编译）
+    int skipKeys = 0;         // 前 N 个按键（进入目标界面）不计入统计
+    bool perFrame = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--theme") == 0 && i + 1 < argc) {
+            themeIndex = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--sdroot") == 0 && i + 1 < argc) {
+            SD.setHostRoot(argv[++i]);
+        } else if (strcmp(argv[i], "--script") == 0 && i + 1 < argc) {
+            script = argv[++i];
+        } else if (strcmp(argv[i], "--frames-per-key") == 0 && i + 1 < argc) {
+            framesPerKey = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--skip-keys") == 0 && i + 1 < argc) {
+            skipKeys = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--per-frame") == 0) {
+            perFrame = true;
+        } else if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc) {
+            dumpPath = argv[++i];
+        } else if (strcmp(argv[i], "--screenshot") == 0) {
+            screenshot = true;
+        } else if (strcmp(argv[i], "--trace") == 0) {
+            trace = true;
+        } else if (strcmp(argv[i], "--governor-replay") == 0 && i + 1 < argc) {
+            return replayGovernor(argv[++i]);
+        } else if (strcmp(argv[i], "--lrc-bench") == 0 && i + 1 < argc) {
+            return benchLrc(argv[++i]);
+        } else if (strcmp(argv[i], "--mirror") == 0 && i + 1 < argc) {
+            mirrorPath = argv[++i];
+        } else {
+            fprintf(stderr, "unknown option: %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    // 与设备相同：先载入设置，主题惰性创建，SD 卡由 initialize() 中的加载器挂载（native 下同步完成）
+    globalAppManager.getSettings().begin();
+    globalThemeManager->registerThemeFactory("Prototype", createPrototypeTheme);
+    globalThemeManager->registerThemeFactory("Dark", createDarkTheme);
+    globalThemeManager->registerThemeFactory("Windows 98", createWindows98Theme);
+    globalThemeManager->registerThemeFactory("Watercolor", createWatercolorTheme);
+    globalThemeManager->setCurrentTheme(themeIndex);
+
+    globalAppManager.registerApp("launcher", "Launcher", &launcherApp, true);
+    globalAppManager.registerApp("theme", "Theme", &themeApp);
+    globalAppManager.registerApp("music", "Music", &musicApp);
+    globalAppManager.registerApp("filemanager", "Files", &fileManagerApp);
+    globalAppManager.registerApp("test", "Test", &testApp);
+    globalAppManager.registerApp("monitor", "Monitor", &systemMonitorApp);
+    globalAppManager.registerApp("search", "Search", &searchApp);
+    globalAppManager.registerApp("textviewer", "Text", &textViewerApp, false, true);  // 由文件管理器打开
+    globalAppManager.initialize();
+
+    FILE* mirrorFile = nullptr;
+    if (mirrorPath) {
+        mirrorFile = fopen(mirrorPath, "wb");
+        if (!mirrorFile) {
+            fprintf(stderr, "failed to open %s\n", mirrorPath);
+            return 1;
+        }
+        Serial.setOutput(mirrorFile);
+        globalAppManager.getUIManager()->setMirrorEnabled(true);
+    }
+
+    MockDrawStats& stats = M5Cardputer.Display.getStats();
+    std::vector<FrameSample> frames;
+    size_t scriptLen = strlen(script);
+    frames.reserve((scriptLen + 1) * framesPerKey);
+
+    // 每个按键后运行 framesPerKey 帧，每帧推进 50ms（与设备主循环一致）
+    for (size_t k = 0; k <= scriptLen; k++) {
+        for (int f = 0; f < framesPerKey; f++) {
+            bool pressed = (f == 0 && k < scriptLen);
+            KeyEvent event = makeKeyEvent(pressed ? script[k] : ' ');
+            stats.reset();
+            uint32_t allocsBefore = allocCount;
+            uint32_t bytesBefore = allocBytes;
+            if (pressed) {
+                globalAppManager.handleKeyEvent(event);
+            }
+            globalAppManager.update();
+            nativeAdvanceMillis(50);
+
+            if ((int)k < skipKeys) continue;
+            FrameSample s;
+            s.drawCalls = stats.drawCalls;
+            s.pixels = stats.pixels;
+            s.allocs = allocCount - allocsBefore;
+            s.bytes = allocBytes - bytesBefore;
+            frames.push_back(s);
+            if (perFrame) {
+                printf("key %3u frame %2d  draw %4u  px %6u  alloc %3u (%u B)\n", (unsigned)k, f,
+                       (unsigned)s.drawCalls, (unsigned)s.pixels, (unsigned)s.allocs, (unsigned)s.bytes);
+            }
+        }
+    }
+
+    uint64_t totalDraw = 0, totalPixels = 0, totalAllocs = 0, totalBytes = 0;
+    uint32_t maxPixels = 0, maxAllocs = 0, drawnFrames = 0;
+    for (size_t i = 0; i < frames.size(); i++) {
+        totalDraw += frames[i].drawCalls;
+        totalPixels += frames[i].pixels;
+        totalAllocs += frames[i].allocs;
+        totalBytes += frames[i].bytes;
+        maxPixels = max(maxPixels, frames[i].pixels);
+        maxAllocs = max(maxAllocs, frames[i].allocs);
+        if (frames[i].pixels > 0) drawnFrames++;
+    }
+    size_t n = frames.empty() ? 1 : frames.size();
+    printf("frames        %u (drawn %u)\n", (unsigned)frames.size(), (unsigned)drawnFrames);
+    printf("draw calls    total %llu  avg %.1f/frame\n", (unsigned long long)totalDraw, (double)totalDraw / n);
+    printf("pixels        total %llu  avg %.1f/frame  max %u\n", (unsigned long long)totalPixels, (double)totalPixels / n, (unsigned)maxPixels);
+    printf("allocations   total %llu  avg %.1f/frame  max %u  (%llu bytes)\n",
+           (unsigned long long)totalAllocs, (double)totalAllocs / n, (unsigned)maxAllocs, (unsigned long long)totalBytes);
+
+    printf("settings      %u flash writes\n", (unsigned)globalAppManager.getSettings().getWriteCount());
+    Vfs& vfs = globalAppManager.getSDFileManager()->getVfs();
+    printf("vfs           %u stat calls  %u cache hits\n", (unsigned)vfs.getStatCalls(), (unsigned)vfs.getCacheHits());
+
+    if (mirrorFile) {
+        printf("mirror        %lu bytes\n", (unsigned long)globalAppManager.getUIManager()->getMirrorBytesSent());
+        Serial.setOutput(nullptr);
+        fclose(mirrorFile);
+    }
+
+    if (screenshot) {
+        String shotPath;
+        if (!globalAppManager.takeScreenshot(shotPath)) {
+            fprintf(stderr, "screenshot failed\n");
+            return 1;
+        }
+        printf("screenshot    %s\n", shotPath.c_str());
+    }
+
+    if (trace) {
+#ifdef ENABLE_TRACE
+        String tracePath;
+        globalTracer.trigger(TRACE_TRIGGER_MANUAL, true);
+        if (!globalTracer.writePendingDump(SD, Tracer::DEFAULT_DIR, tracePath)) {
+            fprintf(stderr, "trace dump failed\n");
+            return 1;
+        }
+        printf("trace         %s\n", tracePath.c_str());
+#else
+        fprintf(stderr, "--trace needs a build with -DENABLE_TRACE\n");
+        return 2;
+#endif
+    }
+
+    if (dumpPath && !dumpFramebuffer(dumpPath)) {
+        fprintf(stderr, "failed to write %s\n", dumpPath);
+        return 1;
+    }
+    return 0;
+}
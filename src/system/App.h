@@ -26,6 +26,14 @@ public:
     virtual void setup() = 0;           // 初始化
     virtual void loop() = 0;            // 主循环
     virtual void onKeyEvent(const KeyEvent& event) = 0;  // 处理键盘事件
+    
+    // 挂起/恢复：返回启动器时 onSuspend，控件树被保留；再次启动时 onResume，不再调用 setup
+    virtual void onSuspend() {}
+    virtual void onResume() {}
+    // 保留的控件树被淘汰前调用：释放任务、队列等 setup 中创建的资源，下次启动会重新 setup
+    virtual void onDestroy() {}
+    // 返回 false 时退出即销毁（onSuspend 后紧接 onDestroy），不参与保留
+    virtual bool isRetainable() const { return true; }
 };
 
 #endif
\ No newline at end of file
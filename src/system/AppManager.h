@@ -4,6 +4,14 @@
 #include "system/EventSystem.h"
 #include "ui/UIManager.h"
 #include "system/SDFileManager.h"
+#include "system/Profiler.h"
+#include "system/Trace.h"
+#include "system/ScreenCapture.h"
+#include "system/AudioService.h"
+#include "system/StorageLoader.h"
+#include "system/BootProfiler.h"
+#include "system/SettingsStore.h"
+#include "system/CpuGovernor.h"
 
 // 应用信息结构
 struct AppInfo {
@@ -11,12 +19,31 @@ struct AppInfo {
     String displayName; // 显示名称
     App* instance;      // 应用实例
     bool isLauncher;    // 是否为启动器应用
+    bool hidden;        // 不在启动器中列出，只由其他应用打开（如文本查看器）
+    AppInfo* returnTo;  // 由其他应用打开时，ESC 回到该应用而不是启动器
     
-    AppInfo(const String& _name, const String& _displayName, App* _instance, bool _isLauncher = false)
-        : name(_name), displayName(_displayName), instance(_instance), isLauncher(_isLauncher) {}
+    // 生命周期
+    bool started;                   // 已 setup 且尚未 onDestroy
+    bool suspended;                 // 已挂起，控件树保存在 retained 中
+    RetainedWidgets retained;
+    uint32_t lastUsedMs;            // LRU 淘汰依据
+    uint32_t heapCost;              // setup 前后空闲堆的差值，作为保留成本的估计
+    
+    AppInfo(const String& _name, const String& _displayName, App* _instance, bool _isLauncher = false, bool _hidden = false)
+        : name(_name), displayName(_displayName), instance(_instance), isLauncher(_isLauncher),
+          hidden(_hidden), returnTo(nullptr),
+          started(false), suspended(false), lastUsedMs(0), heapCost(0) {}
 };
 
 class AppManager {
+public:
+    // 保留最近使用应用的上限：数量、估计内存总量，以及任何时候都要留出的空闲堆
+    static const int MAX_RETAINED_APPS = 3;
+    static const uint32_t RETAIN_BUDGET_BYTES = 48 * 1024;
+    static const uint32_t MIN_FREE_HEAP = 40 * 1024;
+    // 播放中保存断点的间隔（暂停、停止与换曲时立即保存）
+    static const uint32_t POSITION_SAVE_MS = 30000;
+
 private:
     AppInfo* apps[10];      // 最多支持10个应用
     int appCount;
@@ -25,18 +52,37 @@ private:
     EventSystem* eventSystem;
     UIManager* globalUIManager;
     SDFileManager* globalSDManager;
+    AudioService* audioService;
+    StorageLoader storageLoader;
+    bool storageHandled;            // 已处理加载完成（启动音频服务、补录启动阶段）
+    LibraryIndex* library;          // 当前曲库索引，后台刷新完成后整体替换
+    uint32_t libraryGeneration;     // 每次替换加一，应用据此判断是否需要重新读取
+    BootProfiler bootProfiler;
+    SettingsStore settings;
+    CpuGovernor governor;
+    AudioState savedState;          // 断点保存时的播放状态与曲目
+    uint32_t savedTrackChanges;
+    uint32_t lastPositionSaveMs;
+    String launchArgument;          // openWith 传给被打开应用的参数（文件路径等）
     
 public:
-    AppManager(EventSystem* events) : appCount(0), currentApp(nullptr), launcherApp(nullptr), eventSystem(events) {
+    AppManager(EventSystem* events)
+        : appCount(0), currentApp(nullptr), launcherApp(nullptr), eventSystem(events), storageHandled(false),
+          library(nullptr), libraryGeneration(0),
+          savedState(AUDIO_STOPPED), savedTrackChanges(0), lastPositionSaveMs(0) {
         for (int i = 0; i < 10; i++) {
             apps[i] = nullptr;
         }
         globalUIManager = new UIManager();
         globalSDManager = new SDFileManager();
+        audioService = new AudioService();
+        governor.attach(audioService, globalUIManager);
     }
     
     ~AppManager() {
         clear();
+        if (library && !storageLoader.isRefreshing()) library->release();
+        delete audioService;
         delete globalUIManager;
         delete globalSDManager;
     }
@@ -49,12 +95,55 @@ public:
         return globalSDManager;
     }
 
+    // 后台音频服务；SD 卡未就绪时没有启动（isRunning() 为 false）
+    AudioService* getAudioService() {
+        return audioService;
+    }
+
+    // 同步挂载 SD 卡；正常启动由 initialize() 在后台完成，不需要调用
     bool initializeSD() {
         return globalSDManager ? globalSDManager->initialize() : false;
     }
+
+    CpuGovernor& getCpuGovernor() {
+        return governor;
+    }
+
+    BootProfiler& getBootProfiler() {
+        return bootProfiler;
+    }
+
+    // 持久化设置；读取只访问 RAM 缓存，写入由 update() 合并后批量进行
+    SettingsStore& getSettings() {
+        return settings;
+    }
+
+    // 后台挂载是否已结束（无论成功与否）；之前 SD 卡视为“挂载中”而不是失败
+    bool isStorageSettled() const {
+        return storageLoader.isSettled();
+    }
+
+    // 曲库索引（只读）；SD 卡未挂载时为 nullptr。后台刷新完成后会被替换，
+    // 需要跨帧使用时 retain()，并记下 getLibraryGeneration() 判断是否有新版本
+    const LibraryIndex* getLibrary() const {
+        return library;
+    }
+
+    uint32_t getLibraryGeneration() const {
+        return libraryGeneration;
+    }
+
+    bool isLibraryRefreshing() const {
+        return storageLoader.isRefreshing();
+    }
+
+    // 忽略目录修改时间，在后台重新列出整张卡（未变文件的标签仍然沿用）
+    bool rebuildLibrary() {
+        return library && storageLoader.startRefresh(library, true);
+    }
     
-    // 注册应用
-    bool registerApp(const String& name, const String& displayName, App* app, bool isLauncher = false) {
+    // 注册应用；hidden 的应用不出现在启动器中
+    bool registerApp(const String& name, const String& displayName, App* app, bool isLauncher = false, bool hidden = false) {
         if (appCount >= 10 || app == nullptr) {
             return false;
         }
@@ -62,7 +151,7 @@ public:
         // 设置应用的管理器引用
         app->setManagers(globalUIManager, this);
         
-        apps[appCount] = new AppInfo(name, displayName, app, isLauncher);
+        apps[appCount] = new AppInfo(name, displayName, app, isLauncher, hidden);
         
         // 如果是启动器应用，记录引用
         if (isLauncher) {
@@ -73,22 +162,22 @@ public:
         return true;
     }
     
-    // 获取应用数量（不包括启动器）
+    // 获取应用数量（不包括启动器与隐藏的应用）
     int getAppCount() const {
         int count = 0;
         for (int i = 0; i < appCount; i++) {
-            if (apps[i] && !apps[i]->isLauncher) {
+            if (apps[i] && !apps[i]->isLauncher && !apps[i]->hidden) {
                 count++;
             }
         }
         return count;
     }
     
-    // 获取应用列表（不包括启动器）
+    // 获取应用列表（不包括启动器与隐藏的应用）
     void getAppList(AppInfo** appList, int& count) const {
         count = 0;
         for (int i = 0; i < appCount; i++) {
-            if (apps[i] && !apps[i]->isLauncher) {
+            if (apps[i] && !apps[i]->isLauncher && !apps[i]->hidden) {
                 appList[count] = apps[i];
                 count++;
             }
@@ -105,28 +194,69 @@ public:
         return nullptr;
     }
     
-    // 启动应用
+    // 启动应用（从启动器等处重新打开，不再回到之前打开它的应用）
     bool launchApp(const String& name) {
         AppInfo* appInfo = findApp(name);
-        if (appInfo && appInfo->instance) {
-            // 使用全局UI管理器切换到新应用
-            globalUIManager->switchToApp();
-            currentApp = appInfo->instance;
-            currentApp->setup();
-            globalUIManager->finishAppSetup();
-            return true;
+        if (!appInfo || !appInfo->instance) {
+            return false;
         }
-        return false;
+        appInfo->returnTo = nullptr;
+        return activateApp(appInfo);
+    }
+    
+    // 由当前应用打开另一个应用并传入参数（在被打开应用的 setup 或 onResume 中用 getLaunchArgument 取得），
+    // 当前应用挂起，被打开的应用按 ESC 时回到这里
+    bool openWith(const String& name, const String& argument) {
+        AppInfo* caller = findAppInfo(currentApp);
+        AppInfo* target = findApp(name);
+        if (!target || target == caller) return false;
+        launchArgument = argument;
+        bool launched = launchFromApp(target);
+        // 参数只在这次 setup/onResume 中有效，之后从启动器打开时不会再被取到
+        launchArgument = "";
+        if (!launched) return false;
+        target->returnTo = (caller && !caller->isLauncher) ? caller : nullptr;
+        return true;
+    }
+    
+    const String& getLaunchArgument() const { return launchArgument; }
+    
+    // 应用之间直接切换（openWith 与 ESC 返回）：保留被切换到的应用的 returnTo，
+    // Search → Files → Text 逐级 ESC 时仍能回到最初的应用。
+    // 恢复的控件树只做了局部绘制，没有启动器随后的整屏刷新，这里补上一次
+    bool launchFromApp(AppInfo* target) {
+        bool resumed = target->suspended;
+        if (!activateApp(target)) return false;
+        if (resumed) globalUIManager->smartRefresh();
+        return true;
     }
     
-    // 返回启动器
+    // 返回启动器：当前应用挂起并保留控件树，超出预算时淘汰最久未用的应用
     void returnToLauncher() {
         if (launcherApp) {
+            suspendCurrentApp();
             // 使用全局UI管理器切换到启动器（保持背景层）
             globalUIManager->switchToLauncher();
             currentApp = launcherApp;
             // 不需要重新setup，因为启动器窗口已经在背景层
+            enforceRetainBudget();
+        }
+    }
+    
+    // 主动销毁一个应用（例如释放内存），下次启动会重新 setup
+    void destroyApp(const String& name) {
+        AppInfo* appInfo = findApp(name);
+        if (appInfo && appInfo->suspended) {
+            destroyRetainedApp(appInfo);
+        }
+    }
+    
+    int getRetainedAppCount() const {
+        int count = 0;
+        for (int i = 0; i < appCount; i++) {
+            if (apps[i] && apps[i]->suspended) count++;
         }
+        return count;
     }
     
     // 获取当前应用
@@ -137,17 +267,103 @@ public:
     // 更新当前应用
     void update() {
         if (currentApp) {
+            TRACE_SCOPE(TRACE_APP_LOOP, 0);
             currentApp->loop();
         }
+        pollStorage();
+        pollLibraryRefresh();
+        notifyAudioEvents();
+        persistPlayback();
+        settings.update(millis());
+        governor.update(millis());
         if (globalUIManager) {
             globalUIManager->tick();
         }
+#ifdef ENABLE_TRACE
+        serviceTraceDump();
+#endif
+        if (!bootProfiler.isReported()) {
+            bootProfiler.markFirstFrame();
+            if (storageHandled) {
+                // 串口镜像开启时串口上是二进制帧流，不能混入文本
+                if (globalUIManager && globalUIManager->isMirrorEnabled()) {
+                    bootProfiler.skipReport();
+                } else {
+                    bootProfiler.report();
+                }
+            }
+        }
+    }
+    
+    // 把当前屏幕保存到 SD 卡 /screenshots，成功时给出文件路径
+    bool takeScreenshot(String& outPath) {
+        if (!globalSDManager || !globalSDManager->isInitialized()) return false;
+        return ScreenCapture::captureToDir(&M5Cardputer.Display, SD, ScreenCapture::DEFAULT_DIR, outPath);
     }
     
     // 处理键盘事件
     void handleKeyEvent(const KeyEvent& event) {
-        // 全局ESC键处理：如果当前不是启动器应用，ESC键退出到启动器
+        governor.notifyInput();
+#ifdef ENABLE_UI_PROFILER
+        // 全局组合键 Ctrl+P：切换渲染性能分析浮层
+        if (event.ctrl && (event.text == "p" || event.text == "P")) {
+            globalProfiler.toggleOverlay();
+            if (!globalProfiler.isOverlayEnabled()) {
+                globalUIManager->refresh();  // 关闭时重绘以擦除浮层
+            }
+            return;
+        }
+#endif
+
+#ifdef ENABLE_TRACE
+        // 全局组合键 Ctrl+T：冻结追踪缓冲并转储到 SD 卡 /traces
+        if (event.ctrl && (event.text == "t" || event.text == "T")) {
+            globalTracer.trigger(TRACE_TRIGGER_MANUAL, true);
+            return;
+        }
+#endif
+
+        // 全局组合键 Ctrl+M：开关 USB 串口屏幕镜像（PC 端运行 tools/screen_mirror.py 查看）
+        if (event.ctrl && (event.text == "m" || event.text == "M")) {
+            bool enable = !globalUIManager->isMirrorEnabled();
+            if (globalUIManager->setMirrorEnabled(enable) && globalUIManager->getOverlay()) {
+                globalUIManager->getOverlay()->showToast(enable ? "Mirror on" : "Mirror off");
+            }
+            return;
+        }
+        
+        // 全局组合键 Ctrl+G：开关 CPU 自动调频（关闭时固定 240MHz），设置会保存
+        if (event.ctrl && (event.text == "g" || event.text == "G")) {
+            governor.setEnabled(!governor.isEnabled());
+            settings.setInt(SETTING_CPU_GOVERNOR, governor.isEnabled() ? 1 : 0);
+            if (globalUIManager->getOverlay()) {
+                globalUIManager->getOverlay()->showToast(governor.isEnabled() ? "CPU governor on" : "CPU fixed 240 MHz");
+            }
+            return;
+        }
+        
+        // 全局组合键 Ctrl+S：截图保存到 SD 卡（先截图再提示，提示条不会出现在截图里）
+        if (event.ctrl && (event.text == "s" || event.text == "S")) {
+            String path;
+            bool saved = takeScreenshot(path);
+            if (globalUIManager->getOverlay()) {
+                globalUIManager->getOverlay()->showToast(saved ? "Saved " + path : String("Screenshot failed"));
+            }
+            return;
+        }
+        
+        // 弹窗打开时为模态：所有按键（包括 ESC）交给弹窗
+        if (globalUIManager->hasPopup()) {
+            globalUIManager->handleKeyEvent(event);
+            return;
+        }
+        
+        // 全局ESC键处理：如果当前不是启动器应用，ESC键退出到启动器（由其他应用打开的回到打开它的应用）
         if (event.esc && currentApp && currentApp != launcherApp) {
+            AppInfo* appInfo = findAppInfo(currentApp);
+            if (appInfo && appInfo->returnTo && launchFromApp(appInfo->returnTo)) {
+                return;
+            }
             returnToLauncher();
             return;
         }
@@ -157,21 +373,222 @@ public:
         }
     }
     
-    // 初始化（启动启动器）
+    // 初始化：SD 卡挂载与曲库索引交给 Core 0 上的加载任务，这里只建立启动器，
+    // 首帧不等待存储；音频服务在加载完成后由 update() 启动。设置由调用方先 begin（主题要用）
     void initialize() {
+        governor.setEnabled(settings.getInt(SETTING_CPU_GOVERNOR, 1) != 0);
+        storageLoader.begin(globalSDManager, ".mp3");
+        bootProfiler.mark("storage task");
         if (launcherApp) {
             // 使用全局UI管理器初始化启动器
             globalUIManager->switchToApp();
             currentApp = launcherApp;
             currentApp->setup();
             globalUIManager->finishAppSetup();
+            bootProfiler.mark("launcher setup");
         }
     }
     
 private:
+    // 挂起中的应用直接恢复保留的控件树，否则 setup；不改变 returnTo。
+    // 切换时挂起了前一个应用，最后按预算淘汰（此时目标已不在挂起状态，不会被淘汰）
+    bool activateApp(AppInfo* appInfo) {
+        if (!appInfo || !appInfo->instance) {
+            return false;
+        }
+        if (currentApp && currentApp != launcherApp && currentApp != appInfo->instance) {
+            suspendCurrentApp();
+        }
+        
+        if (appInfo->suspended) {
+            globalUIManager->switchToApp();
+            globalUIManager->attachForeground(appInfo->retained);
+            appInfo->suspended = false;
+            appInfo->lastUsedMs = millis();
+            currentApp = appInfo->instance;
+            currentApp->onResume();
+            enforceRetainBudget();
+            return true;
+        }
+        
+        // 冷启动前先腾出内存
+        while (ESP.getFreeHeap() < MIN_FREE_HEAP && evictLeastRecent()) {}
+        
+        uint32_t heapBefore = ESP.getFreeHeap();
+        // 使用全局UI管理器切换到新应用
+        globalUIManager->switchToApp();
+        currentApp = appInfo->instance;
+        currentApp->setup();
+        globalUIManager->finishAppSetup();
+        uint32_t heapAfter = ESP.getFreeHeap();
+        appInfo->heapCost = heapBefore > heapAfter ? heapBefore - heapAfter : 0;
+        appInfo->started = true;
+        appInfo->lastUsedMs = millis();
+        enforceRetainBudget();
+        return true;
+    }
+    
+#ifdef ENABLE_TRACE
+    // 触发后的转储在主循环里写卡（PC 端用 tools/trace_to_chrome.py 转换）；后台挂载完成前保持冻结
+    void serviceTraceDump() {
+        if (!globalTracer.hasPendingDump() || !storageHandled) return;
+        String path;
+        bool saved = false;
+        if (globalSDManager && globalSDManager->isInitialized()) {
+            saved = globalTracer.writePendingDump(SD, Tracer::DEFAULT_DIR, path);
+        } else {
+            globalTracer.discardPendingDump();
+        }
+        if (globalUIManager->getOverlay()) {
+            globalUIManager->getOverlay()->showToast(saved ? "Trace " + path : String("Trace dump failed"));
+        }
+    }
+#endif
+
+    void pollStorage() {
+        if (storageHandled || !storageLoader.isSettled()) return;
+        storageHandled = true;
+        bootProfiler.addSpan("sd mount", storageLoader.getStartUs(), storageLoader.getMountedUs());
+        bootProfiler.addSpan("library index", storageLoader.getMountedUs(), storageLoader.getIndexLoadedUs());
+        library = storageLoader.takeIndex();
+        if (library) libraryGeneration++;
+        if (storageLoader.isMounted() && audioService && audioService->begin()) {
+            audioService->setVolume(settings.getInt(SETTING_VOLUME, 50));
+        }
+    }
+
+    // 后台刷新结束：有变化时替换索引（刷新期间旧索引一直被加载任务读取，此时才能释放）
+    void pollLibraryRefresh() {
+        LibraryIndex* index;
+        LibraryIndex::BuildStats stats;
+        bool saved;
+        if (!storageLoader.takeRefreshResult(index, stats, saved)) return;
+        if (index) {
+            if (library) library->release();     // 模型或播放列表仍持有时由它们最后释放
+            library = index;
+            libraryGeneration++;
+        }
+        if (globalUIManager && globalUIManager->isMirrorEnabled()) return;
+        Serial.printf("[library] %lu tracks, %s; %lu/%lu dirs rescanned, %lu tags read, %lu reused, %lu ms%s\n",
+                      (unsigned long)(library ? library->getEntryCount() : 0),
+                      index ? (saved ? "index saved" : "index not saved") : "unchanged",
+                      (unsigned long)stats.dirsRescanned, (unsigned long)stats.dirsVisited,
+                      (unsigned long)stats.filesParsed, (unsigned long)stats.filesReused,
+                      (unsigned long)stats.elapsedMs, stats.truncated ? ", truncated" : "");
+    }
+    
+
+    // 取空音频事件队列（AppManager 是唯一消费者）。前台是任何应用时都能看到的提示：
+    // 播完自动切到下一首、播放出错
+    void notifyAudioEvents() {
+        if (!audioService) return;
+        UIOverlay* overlay = globalUIManager ? globalUIManager->getOverlay() : nullptr;
+        AudioEvent event;
+        while (audioService->pollEvent(event)) {
+            if (!overlay) continue;
+            if (event.type == AUDIO_EVENT_TRACK_STARTED && event.autoAdvance) {
+                AudioPlaybackStatus st;
+                if (audioService->getStatus(st)) {
+                    overlay->showToast("Next: " + String(st.title));
+                }
+            } else if (event.type == AUDIO_EVENT_ERROR) {
+                overlay->showToast("Audio: " + String(AudioService::errorText(event.error)));
+            }
+        }
+    }
+    
+    // 把音量、最近曲目与断点写入设置缓存（只改 RAM，写闪存由 SettingsStore 合并）
+    void persistPlayback() {
+        if (!audioService || !audioService->isRunning()) return;
+        AudioPlaybackStatus st;
+        if (!audioService->getStatus(st)) return;
+        settings.setInt(SETTING_VOLUME, st.volume);
+        if (st.trackIndex < 0) return;
+        uint32_t now = millis();
+        bool changed = st.trackChanges != savedTrackChanges || st.state != savedState;
+        if (!changed && !(st.state == AUDIO_PLAYING && now - lastPositionSaveMs >= POSITION_SAVE_MS)) return;
+        savedTrackChanges = st.trackChanges;
+        savedState = st.state;
+        lastPositionSaveMs = now;
+        // 路径过长（或没有路径）时清掉旧曲目，免得下次把这个断点用在别的曲目上
+        if (!settings.setString(SETTING_LAST_TRACK, st.path)) settings.setString(SETTING_LAST_TRACK, "");
+        settings.setInt(SETTING_LAST_POS_MS, (int32_t)st.positionMs);
+        settings.setInt(SETTING_LAST_POS_OFFSET, (int32_t)st.fileOffset);
+    }
+    
+    AppInfo* findAppInfo(App* app) const {
+        for (int i = 0; i < appCount; i++) {
+            if (apps[i] && apps[i]->instance == app) {
+                return apps[i];
+            }
+        }
+        return nullptr;
+    }
+    
+    void suspendCurrentApp() {
+        AppInfo* appInfo = findAppInfo(currentApp);
+        if (!appInfo || appInfo->isLauncher || appInfo->suspended) return;
+        // 先结束弹窗，让它的结果回调在应用仍然存活时执行
+        if (globalUIManager->hasPopup()) {
+            globalUIManager->getPopup()->finish(UIPopup::RESULT_CANCEL);
+            globalUIManager->closePopup();
+        }
+        currentApp->onSuspend();
+        appInfo->lastUsedMs = millis();
+        if (currentApp->isRetainable()) {
+            globalUIManager->detachForeground(appInfo->retained);
+            appInfo->suspended = true;
+        } else {
+            currentApp->onDestroy();
+            globalUIManager->clearForeground();
+            appInfo->started = false;
+        }
+    }
+    
+    void destroyRetainedApp(AppInfo* appInfo) {
+        appInfo->instance->onDestroy();
+        UIManager::destroyRetained(appInfo->retained);
+        appInfo->suspended = false;
+        appInfo->started = false;
+        appInfo->heapCost = 0;
+    }
+    
+    // 淘汰最久未使用的挂起应用；没有可淘汰的返回 false
+    bool evictLeastRecent() {
+        AppInfo* oldest = nullptr;
+        for (int i = 0; i < appCount; i++) {
+            AppInfo* info = apps[i];
+            if (info && info->suspended && (!oldest || (int32_t)(info->lastUsedMs - oldest->lastUsedMs) < 0)) {
+                oldest = info;
+            }
+        }
+        if (!oldest) return false;
+        destroyRetainedApp(oldest);
+        return true;
+    }
+    
+    void enforceRetainBudget() {
+        while (true) {
+            int count = 0;
+            uint32_t cost = 0;
+            for (int i = 0; i < appCount; i++) {
+                if (apps[i] && apps[i]->suspended) {
+                    count++;
+                    cost += apps[i]->heapCost;
+                }
+            }
+            if (count == 0) return;
+            if (count <= MAX_RETAINED_APPS && cost <= RETAIN_BUDGET_BYTES && ESP.getFreeHeap() >= MIN_FREE_HEAP) return;
+            if (!evictLeastRecent()) return;
+        }
+    }
+    
     void clear() {
         for (int i = 0; i < appCount; i++) {
             if (apps[i]) {
+                if (apps[i]->suspended) {
+                    destroyRetainedApp(apps[i]);
+                }
                 delete apps[i];
                 apps[i] = nullptr;
             }
@@ -0,0 +1,79 @@
+#pragma once
+#include <M5Cardputer.h>
+#include "esp_heap_caps.h"
+
+// 定长内存池：一次分配一整块，低端向上分配长期保留的数据，高端向下分配构建期间的临时数据
+// （用完按标记整体退回），最后整体释放。用于曲库模型这类成批构建、成批丢弃的数组，
+// 不再逐个 new，也不会在堆里留下碎片。PSRAM 有足够空间时放在 PSRAM。
+class Arena {
+private:
+    uint8_t* base;
+    uint32_t capacity;
+    uint32_t low;           // 低端已用
+    uint32_t high;          // 高端起点（向下增长）
+    bool inPsram;
+
+    Arena(const Arena&);
+    Arena& operator=(const Arena&);
+
+public:
+    Arena() : base(nullptr), capacity(0), low(0), high(0), inPsram(false) {}
+    ~Arena() { release(); }
+
+    // 重新分配 bytes 字节（原有内容作废）；preferPsram 时先尝试 PSRAM
+    bool reserve(uint32_t bytes, bool preferPsram) {
+        release();
+        if (bytes == 0) return false;
+        if (preferPsram && heap_caps_get_free_size(MALLOC_CAP_SPIRAM) >= bytes) {
+            base = (uint8_t*)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM);
+            inPsram = base != nullptr;
+        }
+        if (!base) base = (uint8_t*)heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (!base) return false;
+        capacity = bytes;
+        reset();
+        return true;
+    }
+
+    void release() {
+        if (base) heap_caps_free(base);
+        base = nullptr;
+        capacity = low = high = 0;
+        inPsram = false;
+    }
+
+    void reset() {
+        low = 0;
+        high = capacity;
+    }
+
+    // 空间不足时返回 nullptr，已分配的部分不受影响
+    void* allocLow(uint32_t bytes, uint32_t align = 4) {
+        uint32_t start = (low + align - 1) & ~(align - 1);
+        if (!base || start > high || high - start < bytes) return nullptr;
+        low = start + bytes;
+        return base + start;
+    }
+
+    void* allocHigh(uint32_t bytes, uint32_t align = 4) {
+        if (!base || high < bytes) return nullptr;
+        uint32_t start = (high - bytes) & ~(align - 1);
+        if (start < low) return nullptr;
+        high = start;
+        return base + start;
+    }
+
+    template <typename T>
+    T* allocArrayLow(uint32_t count) { return (T*)allocLow(count * sizeof(T), sizeof(T) < 4 ? sizeof(T) : 4); }
+
+    template <typename T>
+    T* allocArrayHigh(uint32_t count) { return (T*)allocHigh(count * sizeof(T), sizeof(T) < 4 ? sizeof(T) : 4); }
+
+    // 高端临时区：记下标记，用完后退回到标记处
+    uint32_t markHigh() const { return high; }
+    void releaseHigh(uint32_t mark) { high = mark; }
+
+    uint32_t getCapacity() const { return capacity; }
+    uint32_t getUsed() const { return low + (capacity - high); }
+    bool isInPsram() const { return inPsram; }
+};
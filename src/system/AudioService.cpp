@@ -0,0 +1,574 @@
+#include "system/AudioService.h"
+#include "system/Profiler.h"
+#include "system/Trace.h"
+#include <new>
+
+// ESP8266Audio 库
+#include <AudioOutput.h>
+#include <AudioFileSourceSD.h>
+#include <AudioFileSourceID3.h>
+#include <AudioGeneratorMP3.h>
+
+// M5Speaker 音频输出类 - 与参考实现保持一致
+class AudioOutputM5Speaker : public AudioOutput {
+public:
+    AudioOutputM5Speaker(m5::Speaker_Class* m5sound, uint8_t virtual_sound_channel = 0, uint32_t* underrunCounter = nullptr) {
+        _m5sound = m5sound;
+        _virtual_ch = virtual_sound_channel;
+        _underruns = underrunCounter;
+    }
+
+    virtual ~AudioOutputM5Speaker(void) {
+    }
+
+    virtual bool begin(void) override {
+        return true;
+    }
+
+    virtual bool ConsumeSample(int16_t sample[2]) override {
+        if (_tri_buffer_index < tri_buf_size) {
+            _tri_buffer[_tri_index][_tri_buffer_index] = sample[0];
+            _tri_buffer[_tri_index][_tri_buffer_index + 1] = sample[1];
+            _tri_buffer_index += 2;
+            return true;
+        }
+
+        flush();
+        return false;
+    }
+
+    virtual void flush(void) override {
+        if (_tri_buffer_index) {
+            // 提交时通道里已没有待播的缓冲：解码没跟上，扬声器出现了空档
+            if (_streaming && _underruns && _m5sound->isPlaying(_virtual_ch) == 0) {
+                (*_underruns)++;
+                TRACE_INSTANT(TRACE_AUDIO_UNDERRUN, *_underruns);
+                TRACE_TRIGGER(TRACE_TRIGGER_UNDERRUN);
+            }
+            _streaming = true;
+            _producedUs += hertz ? (uint32_t)((uint64_t)(_tri_buffer_index / 2) * 1000000 / hertz) : 0;
+            // 通道里两块缓冲都在排队时 playRaw 会等待，等待时间不算解码耗时
+            uint32_t submitStart = micros();
+            // 使用基类的 hertz 变量，而不是自定义的采样率
+            _m5sound->playRaw(_tri_buffer[_tri_index], _tri_buffer_index, hertz, true, 1, _virtual_ch);
+            _submitWaitUs += micros() - submitStart;
+            _tri_index = _tri_index < 2 ? _tri_index + 1 : 0;
+            _tri_buffer_index = 0;
+        }
+    }
+
+    virtual bool stop(void) override {
+        flush();
+        _m5sound->stop(_virtual_ch);
+        _streaming = false;
+        return true;
+    }
+
+    // 取出并清零累计的提交等待时间与产出的音频时长
+    void takeTiming(uint32_t& waitUs, uint32_t& producedUs) {
+        waitUs = _submitWaitUs;
+        producedUs = _producedUs;
+        _submitWaitUs = 0;
+        _producedUs = 0;
+    }
+
+    // 暂停后扬声器自然会播空，恢复时的第一块不算欠载
+    void pauseStream() {
+        flush();
+        _streaming = false;
+    }
+
+protected:
+    m5::Speaker_Class* _m5sound;
+    uint8_t _virtual_ch;
+    static constexpr size_t tri_buf_size = 640;
+    int16_t _tri_buffer[3][tri_buf_size];
+    size_t _tri_buffer_index = 0;
+    size_t _tri_index = 0;
+    uint32_t* _underruns;
+    bool _streaming = false;    // 已连续提交过缓冲
+    uint32_t _submitWaitUs = 0;
+    uint32_t _producedUs = 0;
+};
+
+#ifdef ENABLE_TRACE
+// 记录解码器与 ID3 解析发起的每次 SD 读取
+class AudioFileSourceSDTraced : public AudioFileSourceSD {
+public:
+    virtual uint32_t read(void* data, uint32_t len) override {
+        TRACE_BEGIN(TRACE_SD_READ, len);
+        uint32_t got = AudioFileSourceSD::read(data, len);
+        TRACE_END(TRACE_SD_READ, got);
+        return got;
+    }
+};
+typedef AudioFileSourceSDTraced AudioFileSourceImpl;
+#else
+typedef AudioFileSourceSD AudioFileSourceImpl;
+#endif
+
+static const uint8_t SPEAKER_VIRTUAL_CHANNEL = 0;
+
+const char* AudioService::errorText(AudioError error) {
+    switch (error) {
+        case AUDIO_ERR_NO_MEMORY: return "Out of memory for decoder";
+        case AUDIO_ERR_INVALID_TRACK: return "Invalid track";
+        case AUDIO_ERR_OPEN_FAILED: return "Failed to open file";
+        case AUDIO_ERR_START_FAILED: return "Failed to start playback";
+        default: return "";
+    }
+}
+
+AudioService::AudioService()
+    : taskHandle(nullptr), taskExited(false), droppedEvents(0), backlogCount(0), playlist(nullptr),
+      audioFile(nullptr), id3Source(nullptr), mp3Generator(nullptr), audioOutput(nullptr),
+      lastTickMs(0), lastPublishMs(0), decodeBusyUs(0), decodedAudioUs(0) {
+    memset(&status, 0, sizeof(status));
+    status.state = AUDIO_STOPPED;
+    status.trackIndex = -1;
+    status.volume = 50;
+    published.write(status);
+}
+
+AudioService::~AudioService() {
+    end();
+}
+
+bool AudioService::begin() {
+    if (taskHandle) return true;
+
+    // 配置 M5Cardputer 扬声器 - 使用更高的采样率提升音质
+    auto spk_cfg = M5Cardputer.Speaker.config();
+    spk_cfg.sample_rate = 128000; // 使用 128kHz 采样率，与参考实现一致
+    spk_cfg.task_pinned_core = APP_CPU_NUM;
+    M5Cardputer.Speaker.config(spk_cfg);
+    applyVolume(status.volume);
+
+    // 音频任务运行在 Core 0，UI 与应用在 Core 1
+    taskExited = false;
+    BaseType_t result = xTaskCreatePinnedToCore(
+        taskEntry,
+        "AudioTask",
+        TASK_STACK_SIZE,
+        this,
+        1,
+        &taskHandle,
+        0
+    );
+    if (result != pdPASS) {
+        taskHandle = nullptr;
+        return false;
+    }
+    PROFILE_WATCH_TASK(taskHandle);
+    return true;
+}
+
+// 任务收到 SHUTDOWN 后自行清理并删除自己，只有超时仍未退出时才强制删除
+void AudioService::end() {
+    if (taskHandle) {
+        if (!taskExited) {
+            send(AUDIO_CMD_SHUTDOWN);
+            for (int i = 0; i < 50 && !taskExited; i++) {
+                vTaskDelay(pdMS_TO_TICKS(10));
+            }
+            if (!taskExited) {
+                vTaskDelete(taskHandle);
+                releaseDecoder();
+            }
+        }
+        taskHandle = nullptr;
+        PROFILE_WATCH_TASK(nullptr);
+    }
+
+    // 任务已退出，剩下的命令、事件与积压中的播放列表都由这里释放
+    AudioTaskCommand command;
+    while (commands.pop(command)) {
+        delete command.playlist;
+    }
+    AudioEvent event;
+    while (events.pop(event)) {
+        delete event.playlist;
+    }
+    for (int i = 0; i < backlogCount; i++) {
+        delete backlog[i].playlist;
+    }
+    backlogCount = 0;
+    delete playlist;
+    playlist = nullptr;
+    status.state = AUDIO_STOPPED;
+    status.trackIndex = -1;
+    status.trackCount = 0;
+    published.write(status);
+}
+
+bool AudioService::send(AudioCommand cmd, int param, AudioPlaylist* list,
+                        uint32_t resumeMs, uint32_t resumeOffset) {
+    if (!taskHandle) return false;
+    AudioTaskCommand command;
+    command.cmd = cmd;
+    command.param = param;
+    command.playlist = list;
+    command.resumeMs = resumeMs;
+    command.resumeOffset = resumeOffset;
+    if (!commands.push(command)) {
+        TRACE_INSTANT(TRACE_QUEUE_FULL, TRACE_QUEUE_AUDIO_COMMAND);
+        return false;
+    }
+    TRACE_INSTANT(TRACE_QUEUE_PUSH, TRACE_QUEUE_AUDIO_COMMAND);
+    return true;
+}
+
+bool AudioService::togglePause() {
+    AudioPlaybackStatus snapshot;
+    if (!getStatus(snapshot)) return false;
+    if (snapshot.state == AUDIO_PLAYING) {
+        return pause();
+    } else if (snapshot.state == AUDIO_PAUSED) {
+        return resume();
+    }
+    return false;
+}
+
+bool AudioService::setPlaylist(const LibraryIndex* library, int count) {
+    if (!taskHandle) return false;
+    AudioPlaylist* list = new (std::nothrow) AudioPlaylist();
+    if (!list) return false;
+    if (library && count > 0) {
+        library->retain();
+        list->library = library;
+        list->count = count;
+    }
+    if (!send(AUDIO_CMD_SET_PLAYLIST, 0, list)) {
+        delete list;
+        return false;
+    }
+    return true;
+}
+
+bool AudioService::pollEvent(AudioEvent& out) {
+    while (events.pop(out)) {
+        TRACE_INSTANT(TRACE_QUEUE_POP, TRACE_QUEUE_AUDIO_EVENT);
+        if (out.type == AUDIO_EVENT_PLAYLIST_RELEASED) {
+            // 音频任务交还的旧播放列表在主线程释放
+            delete out.playlist;
+            continue;
+        }
+        return true;
+    }
+    return false;
+}
+
+// ---- 以下在音频任务中运行 ----
+
+void AudioService::taskEntry(void* parameter) {
+    static_cast<AudioService*>(parameter)->run();
+}
+
+void AudioService::run() {
+    AudioTaskCommand command;
+    lastTickMs = millis();
+    lastPublishMs = lastTickMs;
+    while (true) {
+        flushBacklog();
+
+        uint32_t now = millis();
+        if (status.state == AUDIO_PLAYING) {
+            status.positionMs += now - lastTickMs;
+            if (now - lastPublishMs >= STATUS_PUBLISH_MS) {
+                publish();
+            }
+            // 暂停时不调用 loop()，解码器保持当前位置
+            if (mp3Generator && mp3Generator->isRunning() && !decodeFrame()) {
+                // 曲目播完，由服务自己切到下一首，不依赖前台应用
+                int count = playlist ? playlist->count : 0;
+                if (count > 0) {
+                    startTrack((status.trackIndex + 1) % count, true);
+                } else {
+                    stopTrack();
+                }
+            }
+        }
+        lastTickMs = now;
+
+        // 一轮处理完队列里的全部命令
+        while (commands.pop(command)) {
+            TRACE_INSTANT(TRACE_QUEUE_POP, TRACE_QUEUE_AUDIO_COMMAND);
+            if (command.cmd == AUDIO_CMD_SHUTDOWN) {
+                stopTrack();
+                releaseDecoder();
+                taskExited = true;
+                vTaskDelete(nullptr);
+                return;
+            }
+            handleCommand(command);
+        }
+
+        // 减少延迟，提高音频处理性能
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+}
+
+bool AudioService::decodeFrame() {
+    TRACE_SCOPE(TRACE_AUDIO_DECODE, status.trackIndex);
+    uint32_t start = micros();
+    bool more = mp3Generator->loop();
+    uint32_t spent = micros() - start;
+    uint32_t waitUs = 0, producedUs = 0;
+    audioOutput->takeTiming(waitUs, producedUs);
+    decodeBusyUs = decodeBusyUs + (spent > waitUs ? spent - waitUs : 0);
+    decodedAudioUs = decodedAudioUs + producedUs;
+    return more;
+}
+
+void AudioService::handleCommand(const AudioTaskCommand& command) {
+    TRACE_SCOPE(TRACE_AUDIO_COMMAND, command.cmd);
+    int count = playlist ? playlist->count : 0;
+    switch (command.cmd) {
+        case AUDIO_CMD_PLAY:
+            startTrack(command.param, false, command.resumeMs, command.resumeOffset);
+            break;
+        case AUDIO_CMD_PAUSE:
+            if (status.state == AUDIO_PLAYING) {
+                if (audioOutput) audioOutput->pauseStream();
+                setState(AUDIO_PAUSED);
+            }
+            break;
+        case AUDIO_CMD_RESUME:
+            if (status.state == AUDIO_PAUSED) {
+                setState(AUDIO_PLAYING);
+            }
+            break;
+        case AUDIO_CMD_STOP:
+            stopTrack();
+            break;
+        case AUDIO_CMD_NEXT:
+            if (count > 0) startTrack((status.trackIndex + 1) % count, false);
+            break;
+        case AUDIO_CMD_PREV:
+            if (count > 0) startTrack((status.trackIndex - 1 + count) % count, false);
+            break;
+        case AUDIO_CMD_VOLUME:
+            applyVolume(command.param);
+            break;
+        case AUDIO_CMD_SET_PLAYLIST:
+            adoptPlaylist(command.playlist);
+            break;
+        case AUDIO_CMD_SHUTDOWN:
+            break;
+    }
+}
+
+void AudioService::adoptPlaylist(AudioPlaylist* next) {
+    // 正在播放的曲目若在新列表中，换算出新序号，播放不中断
+    int newIndex = -1;
+    if (playlist && next && next->library && status.trackIndex >= 0 && status.trackIndex < playlist->count) {
+        // 索引按路径排序，二分查找
+        int32_t found = next->library->findEntry(playlist->getPath(status.trackIndex));
+        if (found >= 0 && found < next->count) newIndex = found;
+    }
+    if (playlist) {
+        AudioEvent released;
+        memset(&released, 0, sizeof(released));
+        released.type = AUDIO_EVENT_PLAYLIST_RELEASED;
+        released.playlist = playlist;
+        postEvent(released);
+    }
+    playlist = next;
+    status.trackIndex = newIndex;
+    status.trackCount = next ? next->count : 0;
+    publish();
+}
+
+bool AudioService::ensureDecoder() {
+    if (audioFile && audioOutput && mp3Generator) return true;
+    if (!audioFile) audioFile = new (std::nothrow) AudioFileSourceImpl();
+    if (!audioOutput) {
+        audioOutput = new (std::nothrow) AudioOutputM5Speaker(&M5Cardputer.Speaker, SPEAKER_VIRTUAL_CHANNEL, &status.underruns);
+        if (audioOutput) {
+            // 设置音频输出参数 - 使用标准的 44.1kHz 采样率
+            audioOutput->begin();
+            audioOutput->SetRate(44100);
+            audioOutput->SetBitsPerSample(16);
+            audioOutput->SetChannels(2);
+        }
+    }
+    if (!mp3Generator) mp3Generator = new (std::nothrow) AudioGeneratorMP3();
+    if (!audioFile || !audioOutput || !mp3Generator) {
+        releaseDecoder();
+        return false;
+    }
+    return true;
+}
+
+void AudioService::releaseDecoder() {
+    delete id3Source;
+    id3Source = nullptr;
+    delete mp3Generator;
+    mp3Generator = nullptr;
+    delete audioOutput;
+    audioOutput = nullptr;
+    delete audioFile;
+    audioFile = nullptr;
+}
+
+void AudioService::startTrack(int index, bool autoAdvance, uint32_t resumeMs, uint32_t resumeOffset) {
+    closeTrack();
+    if (!playlist || index < 0 || index >= playlist->count) {
+        setState(AUDIO_STOPPED);
+        reportError(AUDIO_ERR_INVALID_TRACK, index);
+        return;
+    }
+    if (!ensureDecoder()) {
+        setState(AUDIO_STOPPED);
+        reportError(AUDIO_ERR_NO_MEMORY, index);
+        return;
+    }
+
+    // 播放列表归音频任务独占，可以直接使用其中的路径
+    const char* path = playlist->getPath(index);
+    if (!audioFile->open(path)) {
+        setState(AUDIO_STOPPED);
+        reportError(AUDIO_ERR_OPEN_FAILED, index);
+        return;
+    }
+    id3Source = new (std::nothrow) AudioFileSourceID3(audioFile);
+    if (!id3Source || !mp3Generator->begin(id3Source, audioOutput)) {
+        delete id3Source;
+        id3Source = nullptr;
+        audioFile->close();
+        setState(AUDIO_STOPPED);
+        reportError(AUDIO_ERR_START_FAILED, index);
+        return;
+    }
+    // 续播：跳过 ID3 之后直接定位到断点，MP3 解码器会在下一个帧头重新同步
+    if (resumeOffset > 0 && resumeOffset < audioFile->getSize() && id3Source->seek(resumeOffset, SEEK_SET)) {
+        status.positionMs = resumeMs;
+    } else {
+        status.positionMs = 0;
+    }
+
+    status.trackIndex = index;
+    status.trackChanges++;
+    const char* fileName = strrchr(path, '/');
+    strncpy(status.title, fileName ? fileName + 1 : path, sizeof(status.title) - 1);
+    status.title[sizeof(status.title) - 1] = '\0';
+    // 路径不截断：截断的路径在曲库中找不到，不如不记
+    if (strlen(path) < sizeof(status.path)) strcpy(status.path, path);
+    else status.path[0] = '\0';
+    setState(AUDIO_PLAYING);
+
+    AudioEvent started;
+    memset(&started, 0, sizeof(started));
+    started.type = AUDIO_EVENT_TRACK_STARTED;
+    started.state = AUDIO_PLAYING;
+    started.trackIndex = index;
+    started.autoAdvance = autoAdvance;
+    postEvent(started);
+    lastTickMs = millis();
+}
+
+// 停止解码并关闭文件，不改变播放状态
+void AudioService::closeTrack() {
+    // 按正确顺序停止和清理
+    if (mp3Generator && mp3Generator->isRunning()) {
+        mp3Generator->stop();
+    }
+    if (audioOutput) {
+        audioOutput->flush();
+        audioOutput->stop();
+    }
+    delete id3Source;
+    id3Source = nullptr;
+    if (audioFile && audioFile->isOpen()) {
+        audioFile->close();
+    }
+}
+
+void AudioService::stopTrack() {
+    closeTrack();
+    setState(AUDIO_STOPPED);
+}
+
+void AudioService::applyVolume(int volume) {
+    if (volume < 0) volume = 0;
+    if (volume > 100) volume = 100;
+    M5Cardputer.Speaker.setVolume((volume * 255) / 100);
+    status.volume = volume;
+    publish();
+}
+
+// 状态变化时发布快照并发出事件；状态未变只发布（例如换曲）
+void AudioService::setState(AudioState state) {
+    bool changed = status.state != state;
+    status.state = state;
+    if (state == AUDIO_STOPPED) status.positionMs = 0;
+    publish();
+    if (changed) {
+        AudioEvent event;
+        memset(&event, 0, sizeof(event));
+        event.type = AUDIO_EVENT_STATE_CHANGED;
+        event.state = state;
+        event.trackIndex = status.trackIndex;
+        postEvent(event);
+    }
+}
+
+void AudioService::reportError(AudioError error, int trackIndex) {
+    AudioEvent event;
+    memset(&event, 0, sizeof(event));
+    event.type = AUDIO_EVENT_ERROR;
+    event.state = status.state;
+    event.error = error;
+    event.trackIndex = trackIndex;
+    postEvent(event);
+}
+
+void AudioService::publish() {
+    status.fileOffset = (audioFile && audioFile->isOpen()) ? audioFile->getPos() : 0;
+    published.write(status);
+    lastPublishMs = millis();
+}
+
+void AudioService::postEvent(const AudioEvent& event) {
+    // 已有积压时必须排在积压之后，保持事件顺序
+    if (backlogCount == 0 && events.push(event)) {
+        TRACE_INSTANT(TRACE_QUEUE_PUSH, TRACE_QUEUE_AUDIO_EVENT);
+        return;
+    }
+    TRACE_INSTANT(TRACE_QUEUE_FULL, TRACE_QUEUE_AUDIO_EVENT);
+    if (event.type != AUDIO_EVENT_PLAYLIST_RELEASED) {
+        // 同类的旧事件已过时：去掉它，新事件排到积压末尾，保持与其他事件的先后
+        for (int i = 0; i < backlogCount; i++) {
+            if (backlog[i].type != event.type) continue;
+            for (int j = i + 1; j < backlogCount; j++) {
+                backlog[j - 1] = backlog[j];
+            }
+            backlogCount--;
+            droppedEvents++;
+            break;
+        }
+    }
+    if (backlogCount < EVENT_BACKLOG) {
+        backlog[backlogCount++] = event;
+        return;
+    }
+    // 只有 PLAYLIST_RELEASED 会走到这里（三类状态事件合并后最多占 3 格）
+    droppedEvents++;
+    if (event.type == AUDIO_EVENT_PLAYLIST_RELEASED) {
+        // 主线程长时间没有取事件时宁可在这里释放，也不能泄漏
+        delete event.playlist;
+    }
+}
+
+void AudioService::flushBacklog() {
+    int sent = 0;
+    while (sent < backlogCount && events.push(backlog[sent])) {
+        TRACE_INSTANT(TRACE_QUEUE_PUSH, TRACE_QUEUE_AUDIO_EVENT);
+        sent++;
+    }
+    if (sent == 0) return;
+    for (int i = sent; i < backlogCount; i++) {
+        backlog[i - sent] = backlog[i];
+    }
+    backlogCount -= sent;
+}
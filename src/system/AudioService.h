@@ -0,0 +1,201 @@
+#pragma once
+#include <M5Cardputer.h>
+#include "system/SDFileManager.h"
+#include "system/LibraryIndex.h"
+
+#include "system/SpscQueue.h"
+#include "system/SeqLock.h"
+
+// FreeRTOS 组件
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// ESP8266Audio 类型只在实现文件中使用
+class AudioFileSourceSD;
+class AudioFileSourceID3;
+class AudioGeneratorMP3;
+class AudioOutputM5Speaker;
+
+// 音频命令
+enum AudioCommand {
+    AUDIO_CMD_PLAY,         // param: 播放列表序号；resumeOffset 非 0 时从断点续播
+    AUDIO_CMD_PAUSE,
+    AUDIO_CMD_RESUME,
+    AUDIO_CMD_STOP,
+    AUDIO_CMD_NEXT,
+    AUDIO_CMD_PREV,
+    AUDIO_CMD_VOLUME,       // param: 0-100
+    AUDIO_CMD_SET_PLAYLIST, // playlist: 所有权交给音频任务
+    AUDIO_CMD_SHUTDOWN
+};
+
+enum AudioState {
+    AUDIO_STOPPED,
+    AUDIO_PLAYING,
+    AUDIO_PAUSED
+};
+
+enum AudioError {
+    AUDIO_ERR_NONE,
+    AUDIO_ERR_NO_MEMORY,
+    AUDIO_ERR_INVALID_TRACK,
+    AUDIO_ERR_OPEN_FAILED,
+    AUDIO_ERR_START_FAILED
+};
+
+// 播放列表：由主线程创建，经命令队列交给音频任务独占；被替换的旧列表经事件队列
+// 交还主线程释放。两个核心从不同时访问同一份列表，因此不需要锁。
+// 曲目 i 就是曲库索引的第 i 个条目，列表只持有索引的一个引用，不复制路径；索引创建后只读。
+struct AudioPlaylist {
+    int count;
+    const LibraryIndex* library;
+    AudioPlaylist() : count(0), library(nullptr) {}
+    ~AudioPlaylist() { if (library) library->release(); }
+    const char* getPath(int index) const { return library->getPath(index); }
+};
+
+// 音频任务命令结构
+struct AudioTaskCommand {
+    AudioCommand cmd;
+    int param;
+    AudioPlaylist* playlist;
+    uint32_t resumeMs;          // 续播时的起始播放时长
+    uint32_t resumeOffset;      // 续播时的文件位置（字节），0 表示从头播放
+};
+
+enum AudioEventType {
+    AUDIO_EVENT_TRACK_STARTED,      // trackIndex, autoAdvance
+    AUDIO_EVENT_STATE_CHANGED,      // state
+    AUDIO_EVENT_ERROR,              // error, trackIndex
+    AUDIO_EVENT_PLAYLIST_RELEASED   // playlist（由 pollEvent 内部释放，不交给调用者）
+};
+
+// 音频任务发往主线程的事件。队列未满时每个事件单独入队；主线程久不取事件时，
+// 积压中的同类状态事件只保留最新一个（见 AudioService::postEvent）
+struct AudioEvent {
+    AudioEventType type;
+    AudioState state;
+    AudioError error;
+    int trackIndex;
+    bool autoAdvance;               // 上一首播完后自动切换
+    AudioPlaylist* playlist;
+};
+
+// 播放状态快照，由 getStatus() 复制给客户端
+struct AudioPlaybackStatus {
+    AudioState state;
+    int trackIndex;             // 播放列表序号，-1 表示没有曲目
+    int trackCount;
+    int volume;                 // 0-100
+    uint32_t positionMs;        // 当前曲目已播放时长（不含暂停）
+    uint32_t trackChanges;      // 每开始播放一首曲目加 1，客户端据此发现换曲
+    uint32_t fileOffset;        // 解码器读到的文件位置（字节），用于保存断点
+    uint32_t underruns;         // 累计欠载次数：提交新缓冲时扬声器已播空
+    char title[96];             // 当前曲目文件名（显示用，过长时截断）
+    char path[128];             // 当前曲目的完整路径（保存断点用），放不下时为空串
+};
+
+// 后台音频服务：由 AppManager 启动，音频任务运行在 Core 0，持有播放列表并在曲目播完后
+// 自行切到下一首，与前台是哪个应用无关。MusicApp 与启动器的“正在播放”条都只是客户端。
+//
+// 两个核心之间只通过三条无锁通道交互，UI 核心从不等待音频核心：
+//   命令  主线程 -> 音频任务  SpscQueue，满时丢弃并返回 false
+//   事件  音频任务 -> 主线程  SpscQueue，由 AppManager 每帧取空（唯一消费者）
+//   状态  音频任务 -> 任意读者 SeqLock 发布的快照
+// 命令的生产者与事件的消费者都必须是主线程（Arduino loop 任务）。
+class AudioService {
+public:
+    static const uint32_t COMMAND_QUEUE_LENGTH = 16;
+    static const uint32_t EVENT_QUEUE_LENGTH = 32;
+    static const uint32_t TASK_STACK_SIZE = 16384;
+    static const uint32_t STATUS_PUBLISH_MS = 20;   // 播放位置的发布间隔
+
+    static const char* errorText(AudioError error);
+
+private:
+    TaskHandle_t taskHandle;
+    volatile bool taskExited;       // 音频任务已自行删除（由任务在 vTaskDelete 前置位）
+    SpscQueue<AudioTaskCommand, COMMAND_QUEUE_LENGTH> commands;
+    SpscQueue<AudioEvent, EVENT_QUEUE_LENGTH> events;
+    SeqLock<AudioPlaybackStatus> published;
+    uint32_t droppedEvents;         // 被合并掉或就地释放的事件数（只由音频任务修改）
+
+    // 事件队列满时先积压在音频任务本地，之后每轮循环优先补发。
+    // 积压中曲目开始、状态变化、错误三类各只留最新一个（主线程只关心最新的曲目与错误），
+    // 所以最多占 3 格，其余留给 PLAYLIST_RELEASED；它们也放不下时就地释放播放列表。
+    // 因此无论主线程停顿多久，每类状态事件的最新一个总会送达，也不会泄漏播放列表
+    static const int EVENT_BACKLOG = 8;
+    AudioEvent backlog[EVENT_BACKLOG];
+    int backlogCount;
+
+    // 以下只在音频任务中使用（任务未运行时由主线程使用）
+    AudioPlaybackStatus status;     // 工作副本，修改后 publish()
+    AudioPlaylist* playlist;
+    AudioFileSourceSD* audioFile;
+    AudioFileSourceID3* id3Source;
+    AudioGeneratorMP3* mp3Generator;
+    AudioOutputM5Speaker* audioOutput;
+    uint32_t lastTickMs;
+    uint32_t lastPublishMs;
+    // 解码负载计数（只由音频任务累加，任何线程可读，按差值使用）
+    volatile uint32_t decodeBusyUs;     // 解码计算时间，不含等待扬声器
+    volatile uint32_t decodedAudioUs;   // 解码产出的音频时长
+
+    static void taskEntry(void* parameter);
+    void run();
+    void handleCommand(const AudioTaskCommand& command);
+    bool decodeFrame();     // 解码一帧，曲目结束时返回 false
+    bool ensureDecoder();
+    void releaseDecoder();
+    void startTrack(int index, bool autoAdvance, uint32_t resumeMs = 0, uint32_t resumeOffset = 0);
+    void closeTrack();
+    void stopTrack();
+    void adoptPlaylist(AudioPlaylist* next);
+    void applyVolume(int volume);
+    void setState(AudioState state);
+    void reportError(AudioError error, int trackIndex);
+    void postEvent(const AudioEvent& event);
+    void flushBacklog();
+    void publish();
+    bool send(AudioCommand cmd, int param = 0, AudioPlaylist* list = nullptr,
+              uint32_t resumeMs = 0, uint32_t resumeOffset = 0);
+
+public:
+    AudioService();
+    ~AudioService();
+
+    // 创建音频任务，资源不足时返回 false；调用前 SD 卡应已初始化
+    bool begin();
+    // 停止播放并结束音频任务
+    void end();
+    bool isRunning() const { return taskHandle != nullptr; }
+
+    // 以曲库索引的前 count 个条目替换播放列表（持有索引的引用）；
+    // 正在播放的曲目若仍在新列表中则继续播放并更新序号
+    bool setPlaylist(const LibraryIndex* library, int count);
+
+    // 命令都是非阻塞的，队列满时返回 false
+    bool play(int index) { return send(AUDIO_CMD_PLAY, index); }
+    // 从保存的断点续播（fileOffset 与 positionMs 取自之前的状态快照）
+    bool playFrom(int index, uint32_t positionMs, uint32_t fileOffset) {
+        return send(AUDIO_CMD_PLAY, index, nullptr, positionMs, fileOffset);
+    }
+    bool pause() { return send(AUDIO_CMD_PAUSE); }
+    bool resume() { return send(AUDIO_CMD_RESUME); }
+    bool togglePause();
+    bool stop() { return send(AUDIO_CMD_STOP); }
+    bool next() { return send(AUDIO_CMD_NEXT); }
+    bool previous() { return send(AUDIO_CMD_PREV); }
+    bool setVolume(int volume) { return send(AUDIO_CMD_VOLUME, volume); }
+
+    // 复制最近发布的状态快照；恰好遇到写入且重试用完时返回 false 且不修改 out，从不等待
+    bool getStatus(AudioPlaybackStatus& out) const { return published.read(out); }
+
+    // 取出下一个事件（只能由主线程调用）；没有事件时返回 false
+    bool pollEvent(AudioEvent& out);
+    uint32_t getDroppedEvents() const { return droppedEvents; }
+
+    // 累计解码耗时与产出的音频时长（微秒，32 位回绕，取两次读数的差值）；两者之比即解码负载
+    uint32_t getDecodeBusyUs() const { return decodeBusyUs; }
+    uint32_t getDecodedAudioUs() const { return decodedAudioUs; }
+};
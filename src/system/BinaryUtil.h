@@ -0,0 +1,51 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+// 文件格式共用的小工具：小端读写、FNV-1a 散列、定长字段校验。
+// 索引、截图、跟踪转储与设置存储都用这里的版本，保证写出的字节和散列值一致。
+
+inline uint16_t getLE16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+inline uint32_t getLE32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+inline void putLE16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+}
+
+inline void putLE32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)((v >> 8) & 0xFF);
+    p[2] = (uint8_t)((v >> 16) & 0xFF);
+    p[3] = (uint8_t)((v >> 24) & 0xFF);
+}
+
+static const uint32_t FNV1A_OFFSET = 2166136261u;
+
+// 逐字节累加，供需要先变换字节（如折叠大小写）的调用方使用
+inline uint32_t fnv1aAdd(uint32_t h, uint8_t byte) {
+    return (h ^ byte) * 16777619u;
+}
+
+inline uint32_t fnv1a(const uint8_t* p, uint32_t len) {
+    uint32_t h = FNV1A_OFFSET;
+    for (uint32_t i = 0; i < len; i++) h = fnv1aAdd(h, p[i]);
+    return h;
+}
+
+// 以 \0 结尾的字符串，不含结尾
+inline uint32_t fnv1a(const char* s) {
+    uint32_t h = FNV1A_OFFSET;
+    for (; *s; s++) h = fnv1aAdd(h, (uint8_t)*s);
+    return h;
+}
+
+// 长度为 len 的字段：中间没有 \0 且以 \0 结尾（调用前已确认不越界）
+inline bool validField(const char* s, uint32_t len) {
+    return s[len] == '\0' && memchr(s, 0, len) == nullptr;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <M5Cardputer.h>
+
+// 启动阶段计时：记录 setup() 各阶段以及后台任务各阶段的起止时间（自复位起的微秒），
+// 启动完成后经串口输出一次。跟踪的核心指标是首帧时间（time-to-first-frame）：
+// 启动器第一次完成 tick、画面已推送到屏幕的时刻。
+// 只在主线程中使用；后台任务自己记录时间戳，由主线程用 addSpan 补录。
+class BootProfiler {
+public:
+    static const int MAX_PHASES = 16;
+
+private:
+    struct Phase {
+        const char* name;       // 必须是静态字符串
+        uint32_t startUs;
+        uint32_t endUs;
+        bool background;        // 在另一个核心上运行，与主线程阶段重叠
+    };
+
+    Phase phases[MAX_PHASES];
+    int phaseCount;
+    uint32_t lastMarkUs;        // 上一个主线程阶段的结束时间
+    uint32_t firstFrameUs;
+    bool firstFrameSeen;
+    bool reported;
+
+    void add(const char* name, uint32_t startUs, uint32_t endUs, bool background) {
+        if (phaseCount >= MAX_PHASES) return;
+        phases[phaseCount].name = name;
+        phases[phaseCount].startUs = startUs;
+        phases[phaseCount].endUs = endUs;
+        phases[phaseCount].background = background;
+        phaseCount++;
+    }
+
+public:
+    BootProfiler() : phaseCount(0), lastMarkUs(0), firstFrameUs(0), firstFrameSeen(false), reported(false) {}
+
+    // 结束一个主线程阶段：从上一次 mark（或复位）到现在
+    void mark(const char* name) {
+        uint32_t now = micros();
+        add(name, lastMarkUs, now, false);
+        lastMarkUs = now;
+    }
+
+    // 补录后台任务的阶段
+    void addSpan(const char* name, uint32_t startUs, uint32_t endUs) {
+        add(name, startUs, endUs, true);
+    }
+
+    void markFirstFrame() {
+        if (firstFrameSeen) return;
+        mark("first frame");
+        firstFrameUs = lastMarkUs;
+        firstFrameSeen = true;
+    }
+
+    bool hasFirstFrame() const { return firstFrameSeen; }
+    uint32_t getFirstFrameUs() const { return firstFrameUs; }
+    bool isReported() const { return reported; }
+    // 不输出而直接结束（例如串口正被屏幕镜像的二进制流占用）
+    void skipReport() { reported = true; }
+
+    int getPhaseCount() const { return phaseCount; }
+    const char* getPhaseName(int index) const { return phases[index].name; }
+    uint32_t getPhaseDurationUs(int index) const { return phases[index].endUs - phases[index].startUs; }
+
+    // 输出各阶段耗时，后台阶段以 '*' 标出
+    void report() {
+        reported = true;
+        Serial.printf("[boot] %-16s %9s %9s\n", "phase", "end ms", "took ms");
+        for (int i = 0; i < phaseCount; i++) {
+            const Phase& p = phases[i];
+            Serial.printf("[boot] %c%-15s %9.1f %9.1f\n", p.background ? '*' : ' ', p.name,
+                          p.endUs / 1000.0, (p.endUs - p.startUs) / 1000.0);
+        }
+        Serial.printf("[boot] time to first frame: %.1f ms\n", firstFrameUs / 1000.0);
+    }
+};
@@ -0,0 +1,161 @@
+#pragma once
+#include <M5Cardputer.h>
+#include <FS.h>
+#include <new>
+
+// 一行文本：指向读取器缓冲区，不含行尾的 "\r\n"，不以 NUL 结尾；下一次读取之前有效
+struct LineSpan {
+    const char* data;
+    uint32_t length;
+    bool truncated;         // 行比缓冲区长，只返回了开头部分（其余部分由下一次 readLine 丢弃）
+    LineSpan() : data(nullptr), length(0), truncated(false) {}
+};
+
+// 带缓冲的顺序读取：按 512 字节扇区对齐成块读取文件，逐行返回指向缓冲区的视图，
+// 解析过程中不为每行分配字符串。整个读取只用一块定长缓冲区（构造时分配一次或由调用者提供），
+// 再大的文件占用的内存也不变。文件对象由调用者打开和关闭。
+class BufferedReader {
+public:
+    static const uint32_t DEFAULT_BUFFER_SIZE = 4096;
+    static const uint32_t SECTOR_SIZE = 512;
+
+private:
+    File& file;
+    char* buffer;
+    uint32_t capacity;
+    bool ownsBuffer;
+    uint32_t start;         // 未消费数据 [start, end)
+    uint32_t end;
+    uint32_t fileOffset;    // 已从文件读出的字节数，用于对齐下一次读取
+    bool eof;
+    bool discardingLine;    // 正在丢弃超长行的剩余部分
+    uint32_t fileReads;
+
+    BufferedReader(const BufferedReader&);
+    BufferedReader& operator=(const BufferedReader&);
+
+    // 把未消费的数据移到开头，再读到扇区边界为止；文件已读完时返回 false
+    bool fill() {
+        if (eof) return false;
+        if (start > 0) {
+            memmove(buffer, buffer + start, end - start);
+            end -= start;
+            start = 0;
+        }
+        uint32_t space = capacity - end;
+        if (space == 0) return false;
+        if (space >= SECTOR_SIZE) space -= (fileOffset + space) % SECTOR_SIZE;
+        size_t n = file.read((uint8_t*)buffer + end, space);
+        fileReads++;
+        if (n == 0) {
+            eof = true;
+            return false;
+        }
+        end += (uint32_t)n;
+        fileOffset += (uint32_t)n;
+        return true;
+    }
+
+    static void setLine(LineSpan& line, const char* data, uint32_t length, bool truncated) {
+        if (length > 0 && data[length - 1] == '\r') length--;
+        line.data = data;
+        line.length = length;
+        line.truncated = truncated;
+    }
+
+public:
+    explicit BufferedReader(File& f, uint32_t bufferSize = DEFAULT_BUFFER_SIZE)
+        : file(f), buffer(new (std::nothrow) char[bufferSize]), capacity(bufferSize), ownsBuffer(true),
+          start(0), end(0), fileOffset(0), eof(false), discardingLine(false), fileReads(0) {
+        if (!buffer) capacity = 0;
+    }
+
+    BufferedReader(File& f, char* externalBuffer, uint32_t size)
+        : file(f), buffer(externalBuffer), capacity(size), ownsBuffer(false),
+          start(0), end(0), fileOffset(0), eof(false), discardingLine(false), fileReads(0) {}
+
+    ~BufferedReader() {
+        if (ownsBuffer) delete[] buffer;
+    }
+
+    // 缓冲区分配失败时为 false
+    bool isValid() const { return buffer != nullptr && capacity > 0; }
+
+    // 读取下一行；文件结束时返回 false。最后一行没有换行符也会返回
+    bool readLine(LineSpan& line) {
+        if (!isValid()) return false;
+        uint32_t scanned = 0;   // [start, start + scanned) 已确认没有换行符
+        for (;;) {
+            const char* nl = (const char*)memchr(buffer + start + scanned, '\n', end - start - scanned);
+            if (nl) {
+                uint32_t lineEnd = (uint32_t)(nl - buffer);
+                uint32_t lineStart = start;
+                start = lineEnd + 1;
+                if (discardingLine) {
+                    discardingLine = false;
+                    scanned = 0;
+                    continue;
+                }
+                setLine(line, buffer + lineStart, lineEnd - lineStart, false);
+                return true;
+            }
+            if (discardingLine) {
+                start = end;
+                scanned = 0;
+            } else {
+                scanned = end - start;
+                if (start == 0 && end == capacity) {
+                    // 整个缓冲区装不下一行：返回开头部分，丢弃到下一个换行符
+                    setLine(line, buffer, capacity, true);
+                    start = end;
+                    discardingLine = true;
+                    return true;
+                }
+            }
+            if (!fill()) {
+                if (discardingLine || start == end) return false;
+                setLine(line, buffer + start, end - start, false);
+                start = end;
+                return true;
+            }
+        }
+    }
+
+    // 读取最多 len 字节到 dst，返回实际读取的数量；大块直接从文件读入，不经过缓冲区
+    uint32_t readInto(uint8_t* dst, uint32_t len) {
+        uint32_t copied = 0;
+        while (copied < len) {
+            if (start < end) {
+                uint32_t n = end - start;
+                if (n > len - copied) n = len - copied;
+                memcpy(dst + copied, buffer + start, n);
+                start += n;
+                copied += n;
+                continue;
+            }
+            if (eof) break;
+            if (len - copied >= capacity) {
+                size_t n = file.read(dst + copied, len - copied);
+                fileReads++;
+                if (n == 0) {
+                    eof = true;
+                    break;
+                }
+                copied += (uint32_t)n;
+                fileOffset += (uint32_t)n;
+                continue;
+            }
+            start = end = 0;
+            if (!fill()) break;
+        }
+        return copied;
+    }
+
+    bool atEnd() {
+        return start == end && (eof || !fill());
+    }
+
+    uint32_t getBufferSize() const { return capacity; }
+    // 实际发起的文件读取次数
+    uint32_t getFileReads() const { return fileReads; }
+};
@@ -0,0 +1,149 @@
+#pragma once
+#include <M5Cardputer.h>
+#include "system/CpuGovernorPolicy.h"
+#include "system/AudioService.h"
+#include "system/Trace.h"
+#include "ui/UIManager.h"
+
+// CPU 调频：每 WINDOW_MS 从音频服务与 UIManager 读取累计计数，交给 CpuGovernorPolicy 决定
+// 80/160/240MHz，档位变化时调用 setCpuFrequencyMhz。按键会让下一帧立即评估，不等窗口结束。
+// 每次切换与每分钟的续航对比输出到串口（串口镜像开启时不输出文本）。
+// 以 -DGOVERNOR_LOG_SAMPLES 编译时每个窗口输出一行 "[gov] sample,..."，
+// 录下的日志可用原生基准 --governor-replay 回放策略。只能在主线程中使用。
+class CpuGovernor {
+public:
+    static const uint32_t WINDOW_MS = 500;
+    static const uint32_t SUMMARY_INTERVAL_MS = 60000;
+
+private:
+    CpuGovernorPolicy policy;
+    AudioService* audio;
+    UIManager* ui;
+    bool enabled;
+    bool primed;
+    bool evaluateNow;               // 有按键且未在最高档
+    uint32_t windowStartMs;
+    uint32_t lastSummaryMs;
+    uint32_t prevBusyUs;
+    uint32_t prevAudioUs;
+    uint32_t prevFrames;
+    uint32_t prevUnderruns;
+    uint32_t inputEvents;
+    uint32_t switchCount;
+
+    bool canLog() const { return !(ui && ui->isMirrorEnabled()); }
+
+    void apply(uint16_t mhz) {
+        if (getCpuFrequencyMhz() == mhz) return;
+        setCpuFrequencyMhz(mhz);
+        TRACE_RESYNC();
+        switchCount++;
+    }
+
+    void readCounters(uint32_t& busyUs, uint32_t& audioUs, uint32_t& frames, uint32_t& underruns) {
+        busyUs = audio ? audio->getDecodeBusyUs() : 0;
+        audioUs = audio ? audio->getDecodedAudioUs() : 0;
+        frames = ui ? ui->getFrameCount() : 0;
+        underruns = prevUnderruns;
+        AudioPlaybackStatus st;
+        if (audio && audio->getStatus(st)) underruns = st.underruns;
+    }
+
+public:
+    CpuGovernor()
+        : audio(nullptr), ui(nullptr), enabled(true), primed(false), evaluateNow(false), windowStartMs(0),
+          lastSummaryMs(0), prevBusyUs(0), prevAudioUs(0), prevFrames(0), prevUnderruns(0),
+          inputEvents(0), switchCount(0) {}
+
+    void attach(AudioService* audioService, UIManager* uiManager) {
+        audio = audioService;
+        ui = uiManager;
+    }
+
+    // 关闭时固定在最高档，便于与调频时的续航对比
+    void setEnabled(bool on) {
+        if (enabled == on) return;
+        enabled = on;
+        primed = false;
+        apply(enabled ? policy.getMhz() : CpuGovernorPolicy::levelMhz(CpuGovernorPolicy::LEVEL_COUNT - 1));
+    }
+    bool isEnabled() const { return enabled; }
+
+    void notifyInput() {
+        inputEvents++;
+        if (enabled && policy.getLevel() < CpuGovernorPolicy::LEVEL_COUNT - 1) evaluateNow = true;
+    }
+
+    const CpuGovernorPolicy& getPolicy() const { return policy; }
+    uint32_t getSwitchCount() const { return switchCount; }
+
+    // 主循环每帧调用
+    void update(uint32_t nowMs) {
+        if (!enabled) return;
+        if (!primed) {
+            readCounters(prevBusyUs, prevAudioUs, prevFrames, prevUnderruns);
+            windowStartMs = nowMs;
+            lastSummaryMs = nowMs;
+            inputEvents = 0;
+            primed = true;
+            return;
+        }
+        uint32_t elapsed = nowMs - windowStartMs;
+        if (elapsed < WINDOW_MS && !(evaluateNow && elapsed > 0)) return;
+
+        uint32_t busyUs, audioUs, frames, underruns;
+        readCounters(busyUs, audioUs, frames, underruns);
+        GovernorSample s;
+        s.nowMs = nowMs;
+        s.windowMs = elapsed;
+        s.decodeBusyUs = busyUs - prevBusyUs;
+        s.decodedAudioUs = audioUs - prevAudioUs;
+        s.framesDrawn = frames - prevFrames;
+        s.inputEvents = inputEvents;
+        s.underruns = underruns >= prevUnderruns ? underruns - prevUnderruns : underruns;
+        prevBusyUs = busyUs;
+        prevAudioUs = audioUs;
+        prevFrames = frames;
+        prevUnderruns = underruns;
+        inputEvents = 0;
+        evaluateNow = false;
+        windowStartMs = nowMs;
+
+#ifdef GOVERNOR_LOG_SAMPLES
+        if (canLog()) {
+            Serial.printf("[gov] sample,%lu,%lu,%u,%lu,%lu,%lu,%lu,%lu\n",
+                          (unsigned long)s.nowMs, (unsigned long)s.windowMs, (unsigned)policy.getMhz(),
+                          (unsigned long)s.decodeBusyUs, (unsigned long)s.decodedAudioUs,
+                          (unsigned long)s.framesDrawn, (unsigned long)s.inputEvents, (unsigned long)s.underruns);
+        }
+#endif
+        GovernorDecision d = policy.evaluate(s);
+        if (d.changed) {
+            apply(d.toMhz);
+            if (canLog()) {
+                Serial.printf("[gov] %u -> %u MHz (%s, decode %u%%)\n", (unsigned)d.fromMhz, (unsigned)d.toMhz,
+                              CpuGovernorPolicy::reasonText(d.reason), (unsigned)d.decodeLoadPct);
+            }
+        }
+        if (nowMs - lastSummaryMs >= SUMMARY_INTERVAL_MS) {
+            lastSummaryMs = nowMs;
+            if (canLog()) logSummary();
+        }
+    }
+
+    // 各档位时间占比与估算的 CPU 电流，和始终 240MHz 相比
+    void logSummary() const {
+        uint64_t total = policy.getTotalMs();
+        if (total == 0) return;
+        uint32_t pct[CpuGovernorPolicy::LEVEL_COUNT];
+        for (int i = 0; i < CpuGovernorPolicy::LEVEL_COUNT; i++) {
+            pct[i] = (uint32_t)(policy.getTimeAtLevelMs(i) * 100 / total);
+        }
+        uint32_t avg10 = policy.getAverageCurrent10();
+        Serial.printf("[gov] 80MHz %lu%% 160MHz %lu%% 240MHz %lu%%, cpu ~%lu.%lu mA vs %u mA fixed (%+d%% runtime)\n",
+                      (unsigned long)pct[0], (unsigned long)pct[1], (unsigned long)pct[2],
+                      (unsigned long)(avg10 / 10), (unsigned long)(avg10 % 10),
+                      (unsigned)CpuGovernorPolicy::levelCurrentMa(CpuGovernorPolicy::LEVEL_COUNT - 1),
+                      policy.getRuntimeGainPct());
+    }
+};
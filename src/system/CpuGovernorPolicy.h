@@ -0,0 +1,195 @@
+#pragma once
+#include <stdint.h>
+
+// CPU 调频策略（纯逻辑，不依赖 Arduino，可在主机上用录制的负载序列回放）
+//
+// 每个采样窗口给出：解码器在窗口内的实际计算时间与它产出的音频时长、UI 绘制帧数、按键数、
+// 欠载次数。解码负载 = 解码耗时 / 音频时长，按当前频率折算成所需的 MHz，再换算到各档位：
+//   - 任一档位的预计负载超过 UP_LOAD_PCT、有按键或出现欠载时立即升频；
+//   - 更低档位的预计负载连续 DOWN_HOLD_MS 不超过 DOWN_LOAD_PCT 才降频（迟滞，避免来回切换）。
+// 按键后 INPUT_BOOST_MS 内保持最高档，界面持续动画（绘制帧率达到 UI_ACTIVE_FPS）时不低于中档；
+// 进度、时钟之类每秒一两次的刷新不算动画。
+
+enum GovernorReason {
+    GOV_REASON_NONE,
+    GOV_REASON_DECODE_LOAD,     // 解码余量不足
+    GOV_REASON_INPUT,           // 按键响应
+    GOV_REASON_UI_ACTIVE,       // 界面动画/刷新
+    GOV_REASON_UNDERRUN,        // 出现音频欠载
+    GOV_REASON_IDLE             // 负载下降，降频
+};
+
+struct GovernorSample {
+    uint32_t nowMs;
+    uint32_t windowMs;          // 窗口长度
+    uint32_t decodeBusyUs;      // 窗口内解码计算时间（不含等待扬声器）
+    uint32_t decodedAudioUs;    // 窗口内解码产出的音频时长
+    uint32_t framesDrawn;       // 窗口内实际绘制的帧数
+    uint32_t inputEvents;       // 窗口内的按键数
+    uint32_t underruns;         // 窗口内新增的欠载次数
+};
+
+struct GovernorDecision {
+    bool changed;
+    uint16_t fromMhz;
+    uint16_t toMhz;
+    GovernorReason reason;
+    uint8_t decodeLoadPct;      // 当前频率下的解码负载
+};
+
+class CpuGovernorPolicy {
+public:
+    static const int LEVEL_COUNT = 3;
+    static const uint8_t UP_LOAD_PCT = 70;
+    static const uint8_t DOWN_LOAD_PCT = 45;
+    static const uint32_t DOWN_HOLD_MS = 3000;
+    static const uint32_t INPUT_BOOST_MS = 1500;
+    static const uint32_t UNDERRUN_HOLD_MS = 10000;     // 欠载后这段时间内不降频
+    static const uint32_t UI_ACTIVE_FPS = 8;
+
+    static uint16_t levelMhz(int level) {
+        static const uint16_t kLevels[LEVEL_COUNT] = { 80, 160, 240 };
+        return kLevels[level < 0 ? 0 : (level >= LEVEL_COUNT ? LEVEL_COUNT - 1 : level)];
+    }
+
+    // 各档位的估算电流（mA，仅 CPU 与内部存储器，不含屏幕背光与功放），用于续航对比
+    static uint16_t levelCurrentMa(int level) {
+        static const uint16_t kCurrent[LEVEL_COUNT] = { 28, 39, 52 };
+        return kCurrent[level < 0 ? 0 : (level >= LEVEL_COUNT ? LEVEL_COUNT - 1 : level)];
+    }
+
+private:
+    int level;
+    bool downPending;
+    uint32_t downSinceMs;
+    int downTarget;
+    uint32_t lastInputMs;
+    uint32_t lastUnderrunMs;
+    bool hasInput;
+    bool hasUnderrun;
+    uint32_t demandMhz;             // 最近一次估算的解码所需频率
+    uint64_t timeAtLevelMs[LEVEL_COUNT];
+
+    // 解码按当前频率折算到 level 档位时的负载百分比
+    uint32_t projectedLoad(int toLevel) const {
+        return demandMhz * 100 / levelMhz(toLevel);
+    }
+
+public:
+    explicit CpuGovernorPolicy(int initialLevel = LEVEL_COUNT - 1)
+        : level(initialLevel), downPending(false), downSinceMs(0), downTarget(initialLevel),
+          lastInputMs(0), lastUnderrunMs(0), hasInput(false), hasUnderrun(false), demandMhz(0) {
+        for (int i = 0; i < LEVEL_COUNT; i++) timeAtLevelMs[i] = 0;
+    }
+
+    int getLevel() const { return level; }
+    uint16_t getMhz() const { return levelMhz(level); }
+    uint32_t getDemandMhz() const { return demandMhz; }
+
+    GovernorDecision evaluate(const GovernorSample& s) {
+        timeAtLevelMs[level] += s.windowMs;
+
+        GovernorDecision d;
+        d.changed = false;
+        d.fromMhz = levelMhz(level);
+        d.toMhz = d.fromMhz;
+        d.reason = GOV_REASON_NONE;
+        d.decodeLoadPct = 0;
+
+        if (s.decodedAudioUs > 0) {
+            uint32_t loadPct = (uint32_t)((uint64_t)s.decodeBusyUs * 100 / s.decodedAudioUs);
+            d.decodeLoadPct = (uint8_t)(loadPct > 255 ? 255 : loadPct);
+            demandMhz = (uint32_t)((uint64_t)s.decodeBusyUs * levelMhz(level) / s.decodedAudioUs);
+        } else {
+            demandMhz = 0;      // 没有在解码
+        }
+        if (s.inputEvents > 0) {
+            hasInput = true;
+            lastInputMs = s.nowMs;
+        }
+        if (s.underruns > 0) {
+            hasUnderrun = true;
+            lastUnderrunMs = s.nowMs;
+        }
+
+        // 所需的最低档位
+        int needed = 0;
+        GovernorReason reason = GOV_REASON_IDLE;
+        while (needed < LEVEL_COUNT - 1 && projectedLoad(needed) > UP_LOAD_PCT) needed++;
+        if (needed > 0) reason = GOV_REASON_DECODE_LOAD;
+        bool animating = s.windowMs > 0 && s.framesDrawn * 1000 >= UI_ACTIVE_FPS * s.windowMs;
+        if (animating && needed < 1) {
+            needed = 1;
+            reason = GOV_REASON_UI_ACTIVE;
+        }
+        if (hasInput && s.nowMs - lastInputMs < INPUT_BOOST_MS) {
+            needed = LEVEL_COUNT - 1;
+            reason = GOV_REASON_INPUT;
+        }
+        if (s.underruns > 0 && level < LEVEL_COUNT - 1) {
+            // 欠载说明估算偏低：在需求之外再升一档
+            needed = needed > level + 1 ? needed : level + 1;
+            reason = GOV_REASON_UNDERRUN;
+        }
+
+        if (needed > level) {
+            downPending = false;
+            level = needed;
+        } else if (needed < level) {
+            // 降频要求更低的负载且持续一段时间，欠载后暂不降频
+            bool quiet = projectedLoad(needed) <= DOWN_LOAD_PCT &&
+                         !(hasUnderrun && s.nowMs - lastUnderrunMs < UNDERRUN_HOLD_MS);
+            if (!quiet) {
+                downPending = false;
+            } else if (!downPending || downTarget != needed) {
+                downPending = true;
+                downTarget = needed;
+                downSinceMs = s.nowMs;
+            } else if (s.nowMs - downSinceMs >= DOWN_HOLD_MS) {
+                downPending = false;
+                level = needed;
+                reason = GOV_REASON_IDLE;
+            }
+        } else {
+            downPending = false;
+        }
+
+        d.toMhz = levelMhz(level);
+        d.changed = d.toMhz != d.fromMhz;
+        d.reason = d.changed ? reason : GOV_REASON_NONE;
+        return d;
+    }
+
+    // 续航对比：各档位累计时间与按估算电流得到的平均电流，和始终 240MHz 相比
+    uint64_t getTimeAtLevelMs(int i) const { return timeAtLevelMs[i]; }
+    uint64_t getTotalMs() const {
+        uint64_t total = 0;
+        for (int i = 0; i < LEVEL_COUNT; i++) total += timeAtLevelMs[i];
+        return total;
+    }
+    // 平均估算电流 ×10（mA）
+    uint32_t getAverageCurrent10() const {
+        uint64_t total = getTotalMs();
+        if (total == 0) return levelCurrentMa(LEVEL_COUNT - 1) * 10;
+        uint64_t charge = 0;
+        for (int i = 0; i < LEVEL_COUNT; i++) charge += timeAtLevelMs[i] * levelCurrentMa(i);
+        return (uint32_t)(charge * 10 / total);
+    }
+    // 相对始终最高档的续航提升百分比（仅 CPU 部分）
+    int getRuntimeGainPct() const {
+        uint32_t avg10 = getAverageCurrent10();
+        if (avg10 == 0) return 0;
+        return (int)((uint32_t)levelCurrentMa(LEVEL_COUNT - 1) * 1000 / avg10) - 100;
+    }
+
+    static const char* reasonText(GovernorReason reason) {
+        switch (reason) {
+            case GOV_REASON_DECODE_LOAD: return "decode";
+            case GOV_REASON_INPUT: return "input";
+            case GOV_REASON_UI_ACTIVE: return "ui";
+            case GOV_REASON_UNDERRUN: return "underrun";
+            case GOV_REASON_IDLE: return "idle";
+            default: return "-";
+        }
+    }
+};
@@ -11,6 +11,8 @@ struct KeyEvent {
     bool left;    // "," 键
     bool right;   // "/" 键
     bool esc;     // ESC 键
+    bool ctrl;    // Ctrl 修饰键（用于全局组合键）
+    bool fn;      // Fn 修饰键
 };
 
 class EventSystem {
@@ -31,6 +33,8 @@ public:
             event.left = false;
             event.right = false;
             event.esc = false;
+            event.ctrl = status.ctrl;
+            event.fn = status.fn;
             
             // 构建文本字符串并检测方向键和ESC键
             for (char c : status.word) {
@@ -0,0 +1,313 @@
+#include "system/FileOpEngine.h"
+#include <vector>
+#include "esp_heap_caps.h"
+
+// 目录下的条目路径
+static String childPath(const String& dir, const String& name) {
+    return dir == "/" ? "/" + name : dir + "/" + name;
+}
+
+// File::name() 在部分版本中带路径，只取最后一段
+static String baseName(File& file) {
+    String name = file.name();
+    int slash = name.lastIndexOf('/');
+    return slash >= 0 ? name.substring(slash + 1) : name;
+}
+
+FileOpEngine::FileOpEngine()
+    : state(STATE_IDLE), cancelRequested(false), fs(nullptr), type(FILE_OP_COPY), progress(),
+      buffer(nullptr), bufferSize(0), startUs(0) {}
+
+FileOpEngine::~FileOpEngine() {
+    freeBuffer();
+}
+
+bool FileOpEngine::start(fs::FS& fileSystem, FileOpType opType, const String& src, const String& dst) {
+    if (getState() != STATE_IDLE) return false;
+    fs = &fileSystem;
+    type = opType;
+    source = src;
+    destination = dst;
+    memset(&progress, 0, sizeof(progress));
+    progress.type = opType;
+    progress.scanning = true;
+    cancelRequested.store(false, std::memory_order_relaxed);
+    published.write(progress);
+    state.store(STATE_RUNNING, std::memory_order_release);
+    if (!spawn()) {
+        // native 环境或任务创建失败：在调用线程中同步完成
+        run();
+    }
+    return true;
+}
+
+bool FileOpEngine::takeResult(FileOpProgress& out) {
+    if (getState() != STATE_FINISHED) return false;
+    out = progress;
+    state.store(STATE_IDLE, std::memory_order_release);
+    return true;
+}
+
+bool FileOpEngine::spawn() {
+#ifndef NATIVE_BUILD
+    TaskHandle_t handle = nullptr;
+    return xTaskCreatePinnedToCore(taskEntry, "FileOp", TASK_STACK_SIZE, this, TASK_PRIORITY, &handle, 0) == pdPASS;
+#else
+    return false;
+#endif
+}
+
+void FileOpEngine::taskEntry(void* parameter) {
+    static_cast<FileOpEngine*>(parameter)->run();
+#ifndef NATIVE_BUILD
+    vTaskDelete(nullptr);
+#endif
+}
+
+bool FileOpEngine::allocateBuffer() {
+    for (uint32_t size = FILE_OP_BUFFER_SIZE; size >= FILE_OP_MIN_BUFFER_SIZE; size /= 2) {
+        buffer = (uint8_t*)heap_caps_malloc(size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (buffer) {
+            bufferSize = size;
+            progress.bufferSize = size;
+            return true;
+        }
+    }
+    return false;
+}
+
+void FileOpEngine::freeBuffer() {
+    if (buffer) heap_caps_free(buffer);
+    buffer = nullptr;
+    bufferSize = 0;
+}
+
+void FileOpEngine::run() {
+    startUs = micros();
+    bool ok = true;
+
+    // 先统计总量（删除按条目计进度，同样需要）
+    if (type == FILE_OP_DELETE) {
+        if (source == "/") ok = fail(FILE_OP_DELETE_FAILED);
+    } else {
+        if (fs->exists(destination)) ok = fail(FILE_OP_EXISTS);
+        // 目标不能是源目录本身或在其之下
+        else if (destination == source || destination.startsWith(source == "/" ? source : source + "/")) ok = fail(FILE_OP_INTO_ITSELF);
+    }
+    if (ok) ok = scan(source, 0);
+    progress.scanning = false;
+    publish("");
+
+    if (ok) {
+        switch (type) {
+            case FILE_OP_MOVE:
+                // 同一张卡上改名只改目录项，不搬数据
+                if (fs->rename(source, destination)) {
+                    progress.filesDone = progress.filesTotal;
+                    progress.bytesDone = progress.bytesTotal;
+                    break;
+                }
+                // 改名失败时退回复制后删除；复制未完成时源保持不动
+                if (!allocateBuffer()) ok = fail(FILE_OP_NO_MEMORY);
+                else ok = copyTree(source, destination, 0) && deleteTree(source, 0);
+                break;
+            case FILE_OP_COPY:
+                if (!allocateBuffer()) ok = fail(FILE_OP_NO_MEMORY);
+                else ok = copyTree(source, destination, 0);
+                break;
+            case FILE_OP_DELETE:
+                ok = deleteTree(source, 0);
+                break;
+        }
+    }
+    freeBuffer();
+    publish("");
+    state.store(STATE_FINISHED, std::memory_order_release);
+}
+
+void FileOpEngine::publish(const char* name) {
+    uint32_t elapsedUs = micros() - startUs;
+    progress.elapsedMs = elapsedUs / 1000;
+    progress.bytesPerSec = elapsedUs > 0 ? (uint32_t)(progress.bytesDone * 1000000ULL / elapsedUs) : 0;
+    if (name) {
+        strncpy(progress.currentName, name, sizeof(progress.currentName) - 1);
+        progress.currentName[sizeof(progress.currentName) - 1] = '\0';
+    }
+    published.write(progress);
+}
+
+bool FileOpEngine::checkCancel() {
+    if (!cancelRequested.load(std::memory_order_relaxed)) return false;
+    if (progress.error == FILE_OP_OK) progress.error = FILE_OP_CANCELLED;
+    return true;
+}
+
+// 只记第一个错误
+bool FileOpEngine::fail(FileOpError error) {
+    if (progress.error == FILE_OP_OK) progress.error = error;
+    return false;
+}
+
+bool FileOpEngine::scan(const String& path, int depth) {
+    if (checkCancel()) return false;
+    if (depth > MAX_DEPTH) return fail(FILE_OP_TOO_DEEP);
+    File entry = fs->open(path);
+    if (!entry) return fail(FILE_OP_NOT_FOUND);
+    progress.filesTotal++;
+    if (!entry.isDirectory()) {
+        progress.bytesTotal += entry.size();
+        return true;
+    }
+    // 子目录先记下，关闭当前目录后再进入，同时打开的句柄数不随深度增加
+    std::vector<String> subdirs;
+    File child = entry.openNextFile();
+    while (child) {
+        if (child.isDirectory()) {
+            subdirs.push_back(childPath(path, baseName(child)));
+        } else {
+            progress.filesTotal++;
+            progress.bytesTotal += child.size();
+        }
+        child.close();
+        child = entry.openNextFile();
+    }
+    entry.close();
+    publish(nullptr);
+    for (size_t i = 0; i < subdirs.size(); i++) {
+        if (!scan(subdirs[i], depth + 1)) return false;
+    }
+    return true;
+}
+
+bool FileOpEngine::copyTree(const String& from, const String& to, int depth) {
+    if (checkCancel()) return false;
+    File entry = fs->open(from);
+    if (!entry) return fail(FILE_OP_NOT_FOUND);
+    if (!entry.isDirectory()) {
+        String name = baseName(entry);
+        entry.close();
+        return copyFile(from, to, name.c_str());
+    }
+    if (!fs->mkdir(to)) return fail(FILE_OP_WRITE_FAILED);
+    progress.filesDone++;
+
+    std::vector<String> subdirs;
+    bool ok = true;
+    File child = entry.openNextFile();
+    while (child && ok) {
+        String name = baseName(child);
+        bool isDir = child.isDirectory();
+        child.close();
+        if (isDir) subdirs.push_back(name);
+        else ok = copyFile(childPath(from, name), childPath(to, name), name.c_str());
+        if (ok) child = entry.openNextFile();
+    }
+    entry.close();
+    for (size_t i = 0; ok && i < subdirs.size(); i++) {
+        ok = copyTree(childPath(from, subdirs[i]), childPath(to, subdirs[i]), depth + 1);
+    }
+    return ok;
+}
+
+bool FileOpEngine::copyFile(const String& from, const String& to, const char* name) {
+    if (checkCancel()) return false;
+    publish(name);
+    File in = fs->open(from, FILE_READ);
+    if (!in) return fail(FILE_OP_OPEN_FAILED);
+    File out = fs->open(to, FILE_WRITE);
+    if (!out) {
+        in.close();
+        return fail(FILE_OP_OPEN_FAILED);
+    }
+
+    uint32_t expected = in.size();
+    uint32_t copied = 0;
+    bool ok = true;
+    while (copied < expected) {
+        if (checkCancel()) {
+            ok = false;
+            break;
+        }
+        size_t n = in.read(buffer, bufferSize);
+        if (n == 0) {
+            ok = fail(FILE_OP_READ_FAILED);
+            break;
+        }
+        if (out.write(buffer, n) != n) {
+            ok = fail(FILE_OP_WRITE_FAILED);
+            break;
+        }
+        copied += n;
+        progress.bytesDone += n;
+        publish(nullptr);
+    }
+    in.close();
+    out.close();
+    if (!ok) {
+        // 不留下写了一半的文件
+        fs->remove(to);
+        return false;
+    }
+    progress.filesDone++;
+    return true;
+}
+
+bool FileOpEngine::deleteTree(const String& path, int depth) {
+    if (checkCancel()) return false;
+    if (depth > MAX_DEPTH) return fail(FILE_OP_TOO_DEEP);
+    File entry = fs->open(path);
+    if (!entry) return fail(FILE_OP_NOT_FOUND);
+    if (!entry.isDirectory()) {
+        String name = baseName(entry);
+        entry.close();
+        publish(name.c_str());
+        if (!fs->remove(path)) return fail(FILE_OP_DELETE_FAILED);
+        progress.filesDone++;
+        return true;
+    }
+
+    // 文件边遍历边删除，子目录在关闭当前目录后逐个处理，最后删除目录本身
+    std::vector<String> subdirs;
+    bool ok = true;
+    File child = entry.openNextFile();
+    while (child && ok) {
+        String name = baseName(child);
+        bool isDir = child.isDirectory();
+        child.close();
+        if (isDir) {
+            subdirs.push_back(name);
+        } else if (checkCancel()) {
+            ok = false;
+        } else {
+            publish(name.c_str());
+            if (fs->remove(childPath(path, name))) progress.filesDone++;
+            else ok = fail(FILE_OP_DELETE_FAILED);
+        }
+        if (ok) child = entry.openNextFile();
+    }
+    entry.close();
+    for (size_t i = 0; ok && i < subdirs.size(); i++) {
+        ok = deleteTree(childPath(path, subdirs[i]), depth + 1);
+    }
+    if (!ok) return false;
+    if (!fs->rmdir(path)) return fail(FILE_OP_DELETE_FAILED);
+    progress.filesDone++;
+    return true;
+}
+
+const char* FileOpEngine::errorText(FileOpError error) {
+    switch (error) {
+        case FILE_OP_OK: return "Done";
+        case FILE_OP_CANCELLED: return "Cancelled";
+        case FILE_OP_NOT_FOUND: return "Source not found";
+        case FILE_OP_EXISTS: return "Target already exists";
+        case FILE_OP_INTO_ITSELF: return "Cannot copy a folder into itself";
+        case FILE_OP_TOO_DEEP: return "Folder nesting too deep";
+        case FILE_OP_OPEN_FAILED: return "Cannot open file";
+        case FILE_OP_READ_FAILED: return "Read error";
+        case FILE_OP_WRITE_FAILED: return "Write error";
+        case FILE_OP_DELETE_FAILED: return "Delete failed";
+        case FILE_OP_NO_MEMORY: return "Out of memory";
+    }
+    return "Error";
+}
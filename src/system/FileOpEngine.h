@@ -0,0 +1,118 @@
+#pragma once
+#include <M5Cardputer.h>
+#include <FS.h>
+#include <atomic>
+#include "system/SeqLock.h"
+
+// 传输缓冲区：优先一块可 DMA 的 32KB 内部 RAM（SD 驱动可直接搬运，整簇读写），
+// 分配不到时逐级减半，最小 4KB。只在任务运行期间持有
+#ifndef FILE_OP_BUFFER_SIZE
+#define FILE_OP_BUFFER_SIZE (32 * 1024)
+#endif
+#ifndef FILE_OP_MIN_BUFFER_SIZE
+#define FILE_OP_MIN_BUFFER_SIZE (4 * 1024)
+#endif
+
+enum FileOpType {
+    FILE_OP_COPY,
+    FILE_OP_MOVE,
+    FILE_OP_DELETE
+};
+
+enum FileOpError {
+    FILE_OP_OK,
+    FILE_OP_CANCELLED,
+    FILE_OP_NOT_FOUND,      // 源不存在
+    FILE_OP_EXISTS,         // 目标已存在（不覆盖）
+    FILE_OP_INTO_ITSELF,    // 把目录复制/移动到自身之下
+    FILE_OP_TOO_DEEP,       // 目录层数超过 MAX_DEPTH
+    FILE_OP_OPEN_FAILED,
+    FILE_OP_READ_FAILED,
+    FILE_OP_WRITE_FAILED,
+    FILE_OP_DELETE_FAILED,
+    FILE_OP_NO_MEMORY
+};
+
+// 进度快照，由工作任务整体发布，主线程随时复制
+struct FileOpProgress {
+    uint8_t type;           // FileOpType
+    uint8_t error;          // FileOpError，结束后有效
+    bool scanning;          // 正在统计总量
+    uint32_t filesDone;
+    uint32_t filesTotal;
+    uint64_t bytesDone;
+    uint64_t bytesTotal;
+    uint32_t elapsedMs;
+    uint32_t bytesPerSec;
+    uint32_t bufferSize;
+    char currentName[40];   // 正在处理的文件名（截断）
+};
+
+// 后台文件操作：复制、移动、删除（目录递归），在 Core 0 的低优先级任务中执行，主线程只轮询进度。
+// 开始前先统计文件数与字节数，进度按字节计算；每块传输与每个条目之间检查取消标志，
+// 取消或出错时删掉写了一半的目标文件（已完整复制的文件保留，移动时源文件保留）。
+// 不覆盖已有目标。工作任务直接写 SD，结束后调用者应使 Vfs 缓存失效。
+// 同时只运行一个任务；start/takeResult 只能在主线程中调用。
+class FileOpEngine {
+public:
+    enum State {
+        STATE_IDLE,
+        STATE_RUNNING,
+        STATE_FINISHED      // 结果待主线程取走
+    };
+
+    static const uint32_t TASK_STACK_SIZE = 8192;   // 递归遍历目录
+    static const int TASK_PRIORITY = 1;             // 低于音频任务
+    static const int MAX_DEPTH = 16;
+
+private:
+    std::atomic<int> state;
+    std::atomic<bool> cancelRequested;
+    SeqLock<FileOpProgress> published;
+
+    // 以下只由工作任务访问（任务运行期间）
+    fs::FS* fs;
+    FileOpType type;
+    String source;
+    String destination;
+    FileOpProgress progress;
+    uint8_t* buffer;
+    uint32_t bufferSize;
+    uint32_t startUs;
+
+    FileOpEngine(const FileOpEngine&);
+    FileOpEngine& operator=(const FileOpEngine&);
+
+    static void taskEntry(void* parameter);
+    bool spawn();
+    void run();
+    bool allocateBuffer();
+    void freeBuffer();
+
+    void publish(const char* name);
+    bool checkCancel();
+    bool fail(FileOpError error);
+    bool scan(const String& path, int depth);
+    bool copyTree(const String& from, const String& to, int depth);
+    bool copyFile(const String& from, const String& to, const char* name);
+    bool deleteTree(const String& path, int depth);
+
+public:
+    FileOpEngine();
+    ~FileOpEngine();
+
+    // 开始一个操作；DELETE 忽略 dst。已有任务运行或结果未取走时返回 false。
+    // 任务创建失败（或 native 环境）时在调用线程中同步完成
+    bool start(fs::FS& fileSystem, FileOpType opType, const String& src, const String& dst);
+    // 请求取消，任务在下一块数据或下一个条目前停下
+    void cancel() { cancelRequested.store(true, std::memory_order_relaxed); }
+
+    State getState() const { return (State)state.load(std::memory_order_acquire); }
+    bool isBusy() const { return getState() == STATE_RUNNING; }
+    // 最近发布的进度；恰好与写入冲突时返回 false，下次再读
+    bool getProgress(FileOpProgress& out) const { return published.read(out); }
+    // 结束后取走最终进度（error 为结果）并回到空闲
+    bool takeResult(FileOpProgress& out);
+
+    static const char* errorText(FileOpError error);
+};
@@ -0,0 +1,126 @@
+#pragma once
+#include <M5Cardputer.h>
+#include <FS.h>
+#include <vector>
+#include <algorithm>
+#include <stdlib.h>
+#include <time.h>
+#include "system/BinaryUtil.h"
+
+// 可增长的字节缓冲；映像用 malloc/realloc 分配，和 load 的结果一样由 free 释放
+struct IndexByteBuffer {
+    uint8_t* data;
+    uint32_t size;
+    uint32_t capacity;
+    bool failed;
+
+    IndexByteBuffer() : data(nullptr), size(0), capacity(0), failed(false) {}
+    ~IndexByteBuffer() { free(data); }
+
+    uint8_t* grow(uint32_t n) {
+        if (failed) return nullptr;
+        if (size + n > capacity) {
+            uint32_t cap = capacity ? capacity * 2 : 4096;
+            while (cap < size + n) cap *= 2;
+            uint8_t* p = (uint8_t*)realloc(data, cap);
+            if (!p) {
+                failed = true;
+                return nullptr;
+            }
+            data = p;
+            capacity = cap;
+        }
+        uint8_t* out = data + size;
+        size += n;
+        return out;
+    }
+
+    uint8_t* detach() {
+        uint8_t* p = data;
+        data = nullptr;
+        size = capacity = 0;
+        return p;
+    }
+};
+
+// LibraryIndex 与 NameIndex 构建时共用的目录遍历：按路径序先序遍历，修改时间没变的目录
+// 从旧索引取子项而不重新列出，超出上限时把当前路径上的目录记为未知。
+// 两种索引的目录记录都以 u32 修改时间开头。Builder 提供：
+//   struct Child { String key; bool isDir; ... }   key 为名字，目录名后加 '/'
+//   int32_t findUnchangedDir(dirPath, mtime)        旧索引中修改时间相同的目录，没有时 -1
+//   void collectFromPrevious(dirPath, prevDir, children)
+//   void listDirectory(dir, dirPath, children)
+//   uint8_t* addDirRecord(dirPath)                  放不下或分配失败时返回 nullptr
+//   void addChildren(dirPath, children, depth)      写入条目并对子目录调用 walk
+//   bool stopping()                                 可选，默认不中止
+template <typename Builder, typename Stats, int MaxDepth>
+class IndexWalker {
+protected:
+    static const uint32_t MTIME_GRANULARITY_S = 2;
+
+    fs::FS& fs;
+    Stats& stats;
+    IndexByteBuffer entries;    // 文件头 + 条目记录
+    IndexByteBuffer dirs;
+    uint32_t entryCount;
+    uint32_t dirCount;
+    uint32_t nowSec;
+    uint32_t dirStack[MaxDepth + 1];    // 当前路径上各目录记录在 dirs 中的偏移
+
+    IndexWalker(fs::FS& fileSystem, Stats& buildStats, uint32_t headerSize)
+        : fs(fileSystem), stats(buildStats), entryCount(0), dirCount(0), nowSec((uint32_t)time(nullptr)) {
+        entries.grow(headerSize);
+    }
+
+    Builder& self() { return *static_cast<Builder*>(this); }
+
+    bool stopping() { return false; }
+
+    // 超出上限：停止收录，并把当前路径上各目录的修改时间记为未知，下次刷新时重新列出
+    void truncate(int depth) {
+        stats.truncated = true;
+        for (int i = 0; i <= depth; i++) putLE32(dirs.data + dirStack[i], 0);
+    }
+
+public:
+    // dirPath 以 '/' 结尾
+    void walk(const String& dirPath, int depth) {
+        if (stats.truncated || entries.failed || dirs.failed || depth > MaxDepth || self().stopping()) return;
+        File dir = fs.open(dirPath.length() > 1 ? dirPath.substring(0, dirPath.length() - 1) : dirPath, FILE_READ);
+        if (!dir || !dir.isDirectory()) {
+            dir.close();
+            return;
+        }
+        // 根目录等取不到修改时间（为 0）时视为已变化
+        uint32_t mtime = (uint32_t)dir.getLastWrite();
+        stats.dirsVisited++;
+        int32_t prevDir = mtime != 0 ? self().findUnchangedDir(dirPath, mtime) : -1;
+
+        std::vector<typename Builder::Child> children;
+        if (prevDir >= 0) {
+            dir.close();
+            self().collectFromPrevious(dirPath, prevDir, children);
+        } else {
+            stats.dirsRescanned++;
+            self().listDirectory(dir, dirPath, children);
+            dir.close();
+        }
+        if (self().stopping()) return;
+        std::sort(children.begin(), children.end());
+
+        uint8_t* record = self().addDirRecord(dirPath);
+        if (!record) {
+            if (dirs.failed) return;
+            if (depth > 0) truncate(depth - 1);
+            else stats.truncated = true;
+            return;
+        }
+        dirStack[depth] = (uint32_t)(record - dirs.data);
+        // 修改时间只精确到秒（FAT 为 2 秒）：刚改过的目录在同一时间片内再变化时修改时间不变，
+        // 记为未知让下次刷新重新列出（时钟未设置时 now 远小于文件时间，不受影响）
+        if (mtime != 0 && nowSec != 0 && mtime + MTIME_GRANULARITY_S >= nowSec) mtime = 0;
+        putLE32(record, mtime);
+
+        self().addChildren(dirPath, children, depth);
+    }
+};
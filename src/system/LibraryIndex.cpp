@@ -0,0 +1,629 @@
+#include "system/LibraryIndex.h"
+#include "system/IndexWalker.h"
+#include "esp_heap_caps.h"
+#include <new>
+
+const char* const LibraryIndex::DEFAULT_PATH = "/.cardputer/library.idx";
+
+static const char FILE_MAGIC[8] = { 'C', 'P', 'L', 'I', 'B', 'I', 'X', '1' };
+static const uint32_t ENTRY_HEADER_SIZE = 14;
+static const uint32_t DIR_HEADER_SIZE = 6;
+static const uint32_t TAG_READ_MAX = 4096;      // 只在标签的前 4KB 里找文本帧（封面图通常在后面）
+static const uint32_t FIELD_MAX = 255;
+
+static uint32_t entryRecordSize(const uint8_t* e) {
+    return ENTRY_HEADER_SIZE + getLE16(e + 8) + 1 + e[10] + 1 + e[11] + 1 + e[12] + 1;
+}
+
+static bool startsWith(const char* s, const char* prefix, size_t prefixLen) {
+    return strncmp(s, prefix, prefixLen) == 0;
+}
+
+// 截到不超过 maxLen 字节且不切断 UTF-8 多字节字符
+static uint32_t clampUtf8(const char* s, uint32_t maxLen) {
+    uint32_t len = (uint32_t)strlen(s);
+    if (len <= maxLen) return len;
+    len = maxLen;
+    while (len > 0 && ((uint8_t)s[len] & 0xC0) == 0x80) len--;
+    return len;
+}
+
+// ---- LibraryIndex ----
+
+LibraryIndex::LibraryIndex()
+    : image(nullptr), imageSize(0), entryOffsets(nullptr), entryCount(0), dirOffsets(nullptr), dirCount(0), truncated(false), refs(1) {}
+
+LibraryIndex::~LibraryIndex() {
+    freeImage();
+}
+
+void LibraryIndex::freeImage() {
+    free(image);
+    delete[] entryOffsets;
+    delete[] dirOffsets;
+    image = nullptr;
+    imageSize = 0;
+    entryOffsets = nullptr;
+    dirOffsets = nullptr;
+    entryCount = 0;
+    dirCount = 0;
+    truncated = false;
+}
+
+uint32_t LibraryIndex::maxBytes() {
+    return heap_caps_get_free_size(MALLOC_CAP_SPIRAM) > 0 ? (uint32_t)PSRAM_MAX_BYTES : (uint32_t)MAX_BYTES;
+}
+
+bool LibraryIndex::adopt(uint8_t* data, uint32_t size) {
+    if (!data || size < HEADER_SIZE || memcmp(data, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) return false;
+    if (getLE16(data + 8) != FORMAT_VERSION) return false;
+    uint32_t entries = getLE32(data + 12);
+    uint32_t dirs = getLE32(data + 16);
+    uint32_t payload = getLE32(data + 20);
+    if (payload != size - HEADER_SIZE || fnv1a(data + HEADER_SIZE, payload) != getLE32(data + 24)) return false;
+    // 每条记录至少含头部和结尾的 \0，计数不可能超过这个数
+    if (entries > payload / (ENTRY_HEADER_SIZE + 4) || dirs > payload / (DIR_HEADER_SIZE + 1)) return false;
+
+    uint32_t* eOffsets = new (std::nothrow) uint32_t[entries > 0 ? entries : 1];
+    uint32_t* dOffsets = new (std::nothrow) uint32_t[dirs > 0 ? dirs : 1];
+    bool ok = eOffsets && dOffsets;
+
+    uint32_t pos = HEADER_SIZE;
+    const char* prev = nullptr;
+    for (uint32_t i = 0; ok && i < entries; i++) {
+        const uint8_t* e = data + pos;
+        if (size - pos < ENTRY_HEADER_SIZE || size - pos < entryRecordSize(e)) {
+            ok = false;
+            break;
+        }
+        const char* path = (const char*)e + ENTRY_HEADER_SIZE;
+        const char* artist = path + getLE16(e + 8) + 1;
+        const char* album = artist + e[10] + 1;
+        const char* title = album + e[11] + 1;
+        ok = validField(path, getLE16(e + 8)) && validField(artist, e[10]) && validField(album, e[11]) &&
+             validField(title, e[12]) && (!prev || strcmp(prev, path) < 0);
+        eOffsets[i] = pos;
+        pos += entryRecordSize(e);
+        prev = path;
+    }
+    prev = nullptr;
+    for (uint32_t i = 0; ok && i < dirs; i++) {
+        const uint8_t* d = data + pos;
+        if (size - pos < DIR_HEADER_SIZE || size - pos < DIR_HEADER_SIZE + getLE16(d + 4) + 1u) {
+            ok = false;
+            break;
+        }
+        const char* path = (const char*)d + DIR_HEADER_SIZE;
+        ok = validField(path, getLE16(d + 4)) && (!prev || strcmp(prev, path) < 0);
+        dOffsets[i] = pos;
+        pos += DIR_HEADER_SIZE + getLE16(d + 4) + 1;
+        prev = path;
+    }
+    if (!ok || pos != size) {
+        delete[] eOffsets;
+        delete[] dOffsets;
+        return false;
+    }
+
+    freeImage();
+    image = data;
+    imageSize = size;
+    entryOffsets = eOffsets;
+    entryCount = entries;
+    dirOffsets = dOffsets;
+    dirCount = dirs;
+    truncated = (getLE16(data + 10) & HEADER_TRUNCATED) != 0;
+    return true;
+}
+
+const char* LibraryIndex::getPath(uint32_t i) const {
+    return (const char*)entryAt(i) + ENTRY_HEADER_SIZE;
+}
+
+const char* LibraryIndex::getName(uint32_t i) const {
+    const char* path = getPath(i);
+    const char* slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+uint32_t LibraryIndex::getSize(uint32_t i) const { return getLE32(entryAt(i)); }
+uint32_t LibraryIndex::getMtime(uint32_t i) const { return getLE32(entryAt(i) + 4); }
+uint8_t LibraryIndex::getFlags(uint32_t i) const { return entryAt(i)[13]; }
+
+const char* LibraryIndex::getArtist(uint32_t i) const {
+    return getPath(i) + getLE16(entryAt(i) + 8) + 1;
+}
+
+const char* LibraryIndex::getAlbum(uint32_t i) const {
+    return getArtist(i) + entryAt(i)[10] + 1;
+}
+
+const char* LibraryIndex::getTitle(uint32_t i) const {
+    return getAlbum(i) + entryAt(i)[11] + 1;
+}
+
+const char* LibraryIndex::getDirPath(uint32_t i) const {
+    return (const char*)dirAt(i) + DIR_HEADER_SIZE;
+}
+
+uint32_t LibraryIndex::getDirMtime(uint32_t i) const { return getLE32(dirAt(i)); }
+
+uint32_t LibraryIndex::lowerBoundEntry(const char* key) const {
+    uint32_t lo = 0, hi = entryCount;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (strcmp(getPath(mid), key) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+uint32_t LibraryIndex::lowerBoundDir(const char* key) const {
+    uint32_t lo = 0, hi = dirCount;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (strcmp(getDirPath(mid), key) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+int32_t LibraryIndex::findEntry(const char* path) const {
+    uint32_t i = lowerBoundEntry(path);
+    return i < entryCount && strcmp(getPath(i), path) == 0 ? (int32_t)i : -1;
+}
+
+int32_t LibraryIndex::findDir(const char* dirPath) const {
+    uint32_t i = lowerBoundDir(dirPath);
+    return i < dirCount && strcmp(getDirPath(i), dirPath) == 0 ? (int32_t)i : -1;
+}
+
+bool LibraryIndex::sameContent(const LibraryIndex& other) const {
+    return imageSize == other.imageSize && (imageSize == 0 || memcmp(image, other.image, imageSize) == 0);
+}
+
+bool LibraryIndex::load(fs::FS& fs, const char* path) {
+    File file = fs.open(path, FILE_READ);
+    if (!file || file.isDirectory()) return false;
+    uint32_t size = (uint32_t)file.size();
+    if (size < HEADER_SIZE || size > maxBytes()) {
+        file.close();
+        return false;
+    }
+    uint8_t* data = (uint8_t*)malloc(size);
+    bool ok = data && file.read(data, size) == size;
+    file.close();
+    if (ok) ok = adopt(data, size);
+    if (!ok) free(data);
+    return ok;
+}
+
+bool LibraryIndex::save(fs::FS& fs, const char* path) const {
+    if (!image) return false;
+    String target(path);
+    int slash = target.lastIndexOf('/');
+    if (slash > 0) {
+        String dir = target.substring(0, slash);
+        if (!fs.exists(dir) && !fs.mkdir(dir)) return false;
+    }
+    String temp = target + ".tmp";
+    File file = fs.open(temp, FILE_WRITE);
+    if (!file) return false;
+    bool ok = file.write(image, imageSize) == imageSize;
+    file.close();
+    // FAT 上 rename 不能覆盖已有文件
+    if (ok && fs.exists(target)) ok = fs.remove(target);
+    if (ok) ok = fs.rename(temp, target);
+    if (!ok) fs.remove(temp);
+    return ok;
+}
+
+void LibraryIndex::parseFileName(const String& fileName, String& artist, String& album, String& title) {
+    String base = fileName;
+    int dot = base.lastIndexOf('.');
+    if (dot > 0) base = base.substring(0, dot);
+
+    artist = "";
+    album = "";
+    int firstDash = base.indexOf('-');
+    if (firstDash > 0) {
+        int secondDash = base.indexOf('-', firstDash + 1);
+        artist = base.substring(0, firstDash);
+        if (secondDash > firstDash + 1) {
+            album = base.substring(firstDash + 1, secondDash);
+            title = base.substring(secondDash + 1);
+        } else {
+            // 只有一个破折号："艺术家-曲名"
+            title = base.substring(firstDash + 1);
+        }
+        artist.trim();
+        album.trim();
+        title.trim();
+    } else {
+        title = base;
+    }
+}
+
+// ---- ID3v2 文本帧 ----
+
+static void appendCodepoint(char* out, uint32_t& len, uint32_t cp) {
+    char buf[4];
+    uint32_t n;
+    if (cp < 0x80) {
+        buf[0] = (char)cp;
+        n = 1;
+    } else if (cp < 0x800) {
+        buf[0] = (char)(0xC0 | (cp >> 6));
+        buf[1] = (char)(0x80 | (cp & 0x3F));
+        n = 2;
+    } else if (cp < 0x10000) {
+        buf[0] = (char)(0xE0 | (cp >> 12));
+        buf[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        buf[2] = (char)(0x80 | (cp & 0x3F));
+        n = 3;
+    } else {
+        buf[0] = (char)(0xF0 | (cp >> 18));
+        buf[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+        buf[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        buf[3] = (char)(0x80 | (cp & 0x3F));
+        n = 4;
+    }
+    if (len + n > FIELD_MAX) return;
+    memcpy(out + len, buf, n);
+    len += n;
+}
+
+// 文本帧内容（首字节为编码）转成 UTF-8；多个值只取第一个
+static void decodeTextFrame(const uint8_t* p, uint32_t size, String& out) {
+    char text[FIELD_MAX + 1];
+    uint32_t len = 0;
+    if (size < 1) return;
+    uint8_t encoding = p[0];
+    p++;
+    size--;
+    if (encoding == 0) {
+        // ISO-8859-1
+        for (uint32_t i = 0; i < size && p[i] != 0; i++) appendCodepoint(text, len, p[i]);
+    } else if (encoding == 3) {
+        for (uint32_t i = 0; i < size && p[i] != 0 && len < FIELD_MAX; i++) text[len++] = (char)p[i];
+    } else if (encoding == 1 || encoding == 2) {
+        // UTF-16：1 带 BOM，2 为大端
+        bool bigEndian = encoding == 2;
+        uint32_t i = 0;
+        if (encoding == 1 && size >= 2) {
+            if (p[0] == 0xFF && p[1] == 0xFE) { bigEndian = false; i = 2; }
+            else if (p[0] == 0xFE && p[1] == 0xFF) { bigEndian = true; i = 2; }
+        }
+        for (; i + 1 < size; i += 2) {
+            uint32_t unit = bigEndian ? (p[i] << 8) | p[i + 1] : p[i] | (p[i + 1] << 8);
+            if (unit == 0) break;
+            if (unit >= 0xD800 && unit < 0xDC00 && i + 3 < size) {
+                uint32_t low = bigEndian ? (p[i + 2] << 8) | p[i + 3] : p[i + 2] | (p[i + 3] << 8);
+                if (low >= 0xDC00 && low < 0xE000) {
+                    unit = 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+                    i += 2;
+                }
+            }
+            appendCodepoint(text, len, unit);
+        }
+    } else {
+        return;
+    }
+    text[len] = '\0';
+    text[clampUtf8(text, FIELD_MAX)] = '\0';
+    out = text;
+    out.trim();
+}
+
+static uint32_t synchsafe32(const uint8_t* p) {
+    return ((uint32_t)(p[0] & 0x7F) << 21) | ((uint32_t)(p[1] & 0x7F) << 14) | ((uint32_t)(p[2] & 0x7F) << 7) | (p[3] & 0x7F);
+}
+
+static uint32_t getBE32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+// 读取 ID3v2.2/2.3/2.4 的曲名、艺术家、专辑；没有标签或全部缺失时返回 false。
+// 不支持整标签反同步与压缩、加密的帧（跳过）
+static bool readId3Tag(File& file, uint8_t* buf, String& artist, String& album, String& title) {
+    uint8_t header[10];
+    if (file.read(header, sizeof(header)) != sizeof(header) || memcmp(header, "ID3", 3) != 0) return false;
+    uint8_t version = header[3];
+    uint8_t flags = header[5];
+    if (version < 2 || version > 4 || (flags & 0x80)) return false;
+    uint32_t tagSize = synchsafe32(header + 6);
+    uint32_t n = tagSize < TAG_READ_MAX ? tagSize : TAG_READ_MAX;
+    n = (uint32_t)file.read(buf, n);
+
+    uint32_t pos = 0;
+    if (version >= 3 && (flags & 0x40) && n >= 4) {
+        // 扩展头：2.3 的长度不含自身 4 字节，2.4 含
+        pos = version == 3 ? getBE32(buf) + 4 : synchsafe32(buf);
+    }
+    const uint32_t frameHeader = version == 2 ? 6 : 10;
+    bool found = false;
+    while (pos + frameHeader <= n && buf[pos] != 0) {
+        const uint8_t* f = buf + pos;
+        uint32_t size;
+        uint8_t formatFlags = 0;
+        if (version == 2) {
+            size = ((uint32_t)f[3] << 16) | ((uint32_t)f[4] << 8) | f[5];
+        } else {
+            size = version == 3 ? getBE32(f + 4) : synchsafe32(f + 4);
+            formatFlags = f[9];
+        }
+        uint32_t data = pos + frameHeader;
+        if (size == 0 || size > n - data) break;   // 帧超出已读取的部分
+        pos = data + size;
+
+        bool skip = version == 3 ? (formatFlags & 0xC0) != 0 : (version == 4 && (formatFlags & 0x0E) != 0);
+        if (version == 4 && (formatFlags & 0x01)) {
+            // 数据长度指示：内容前多 4 字节
+            if (size < 4) continue;
+            data += 4;
+            size -= 4;
+        }
+        if (skip) continue;
+
+        String* target = nullptr;
+        if (version == 2) {
+            if (memcmp(f, "TT2", 3) == 0) target = &title;
+            else if (memcmp(f, "TP1", 3) == 0) target = &artist;
+            else if (memcmp(f, "TAL", 3) == 0) target = &album;
+        } else {
+            if (memcmp(f, "TIT2", 4) == 0) target = &title;
+            else if (memcmp(f, "TPE1", 4) == 0) target = &artist;
+            else if (memcmp(f, "TALB", 4) == 0) target = &album;
+        }
+        if (!target) continue;
+        String value;
+        decodeTextFrame(buf + data, size, value);
+        if (!value.isEmpty()) {
+            *target = value;
+            found = true;
+        }
+    }
+    return found;
+}
+
+// ---- 构建 ----
+
+class LibraryIndexBuilder : public IndexWalker<LibraryIndexBuilder, LibraryIndex::BuildStats, LibraryIndex::MAX_DEPTH> {
+private:
+    friend class IndexWalker<LibraryIndexBuilder, LibraryIndex::BuildStats, LibraryIndex::MAX_DEPTH>;
+
+    struct Child {
+        String key;             // 文件名；目录名后加 '/'，这样按 key 排序的先序遍历正好是路径序
+        bool isDir;
+        uint32_t size;
+        uint32_t mtime;
+        int32_t previous;       // 旧索引中同路径的条目
+
+        bool operator<(const Child& other) const { return strcmp(key.c_str(), other.key.c_str()) < 0; }
+    };
+
+    String extension;           // 小写
+    const LibraryIndex* previous;
+    bool full;
+    uint8_t* tagBuffer;
+    uint32_t limit;             // LibraryIndex::maxBytes()
+
+    bool matchesExtension(const String& name) const {
+        if (extension.isEmpty()) return true;
+        String lower = name;
+        lower.toLowerCase();
+        return lower.endsWith(extension);
+    }
+
+    bool fits(uint32_t recordSize) const {
+        return entries.size + dirs.size + recordSize <= limit;
+    }
+
+    int32_t findUnchangedDir(const String& dirPath, uint32_t mtime) const {
+        if (full || !previous) return -1;
+        int32_t i = previous->findDir(dirPath.c_str());
+        return i >= 0 && previous->getDirMtime(i) == mtime ? i : -1;
+    }
+
+    void collectFromPrevious(const String& dirPath, int32_t, std::vector<Child>& children) {
+        size_t prefixLen = dirPath.length();
+        for (uint32_t i = previous->lowerBoundEntry(dirPath.c_str()); i < previous->getEntryCount(); i++) {
+            const char* path = previous->getPath(i);
+            if (!startsWith(path, dirPath.c_str(), prefixLen)) break;
+            if (strchr(path + prefixLen, '/')) continue;    // 子目录中的文件
+            Child c;
+            c.key = path + prefixLen;
+            c.isDir = false;
+            c.size = previous->getSize(i);
+            c.mtime = previous->getMtime(i);
+            c.previous = (int32_t)i;
+            children.push_back(c);
+        }
+        for (uint32_t i = previous->lowerBoundDir(dirPath.c_str()); i < previous->getDirCount(); i++) {
+            const char* path = previous->getDirPath(i);
+            if (!startsWith(path, dirPath.c_str(), prefixLen)) break;
+            const char* rest = path + prefixLen;
+            const char* slash = strchr(rest, '/');
+            if (*rest == '\0' || !slash || slash[1] != '\0') continue;    // 自身或更深的目录
+            Child c;
+            c.key = rest;
+            c.isDir = true;
+            c.size = 0;
+            c.mtime = 0;
+            c.previous = -1;
+            children.push_back(c);
+        }
+    }
+
+    void listDirectory(File& dir, const String& dirPath, std::vector<Child>& children) {
+        File file = dir.openNextFile();
+        while (file) {
+            String name = file.name();
+            int slash = name.lastIndexOf('/');
+            if (slash >= 0) name = name.substring(slash + 1);
+            // 跳过隐藏文件与目录（包括索引自己所在的 /.cardputer）
+            if (name.length() > 0 && !name.startsWith(".")) {
+                Child c;
+                c.isDir = file.isDirectory();
+                c.size = 0;
+                c.mtime = 0;
+                c.previous = -1;
+                if (c.isDir) {
+                    c.key = name + "/";
+                    children.push_back(c);
+                } else if (matchesExtension(name)) {
+                    c.key = name;
+                    c.size = (uint32_t)file.size();
+                    c.mtime = (uint32_t)file.getLastWrite();
+                    if (previous) c.previous = previous->findEntry((dirPath + name).c_str());
+                    children.push_back(c);
+                }
+            }
+            file.close();
+            file = dir.openNextFile();
+        }
+    }
+
+    void addFile(const String& path, const Child& c, int depth) {
+        if (c.previous >= 0 && previous->getSize(c.previous) == c.size && previous->getMtime(c.previous) == c.mtime) {
+            // 文件没变：整条记录原样复制
+            const uint8_t* record = previous->entryAt(c.previous);
+            uint32_t recordSize = entryRecordSize(record);
+            if (!fits(recordSize)) {
+                truncate(depth);
+                return;
+            }
+            uint8_t* out = entries.grow(recordSize);
+            if (!out) return;
+            memcpy(out, record, recordSize);
+            entryCount++;
+            stats.filesReused++;
+            return;
+        }
+
+        String artist, album, title;
+        LibraryIndex::parseFileName(c.key, artist, album, title);
+        uint8_t flags = 0;
+        File file = fs.open(path, FILE_READ);
+        if (file) {
+            String tagArtist, tagAlbum, tagTitle;
+            if (tagBuffer && readId3Tag(file, tagBuffer, tagArtist, tagAlbum, tagTitle)) {
+                // 标签里有的字段优先，缺的沿用文件名约定
+                if (!tagArtist.isEmpty()) artist = tagArtist;
+                if (!tagAlbum.isEmpty()) album = tagAlbum;
+                if (!tagTitle.isEmpty()) title = tagTitle;
+                flags |= LibraryIndex::ENTRY_HAS_TAG;
+            }
+            file.close();
+        }
+        stats.filesParsed++;
+
+        uint32_t pathLen = path.length();
+        if (pathLen > 0xFFFF) return;
+        uint32_t artistLen = clampUtf8(artist.c_str(), FIELD_MAX);
+        uint32_t albumLen = clampUtf8(album.c_str(), FIELD_MAX);
+        uint32_t titleLen = clampUtf8(title.c_str(), FIELD_MAX);
+        uint32_t recordSize = ENTRY_HEADER_SIZE + pathLen + artistLen + albumLen + titleLen + 4;
+        if (!fits(recordSize)) {
+            truncate(depth);
+            return;
+        }
+        uint8_t* out = entries.grow(recordSize);
+        if (!out) return;
+        putLE32(out, c.size);
+        putLE32(out + 4, c.mtime);
+        putLE16(out + 8, (uint16_t)pathLen);
+        out[10] = (uint8_t)artistLen;
+        out[11] = (uint8_t)albumLen;
+        out[12] = (uint8_t)titleLen;
+        out[13] = flags;
+        uint8_t* p = out + ENTRY_HEADER_SIZE;
+        memcpy(p, path.c_str(), pathLen);
+        p += pathLen;
+        *p++ = 0;
+        memcpy(p, artist.c_str(), artistLen);
+        p += artistLen;
+        *p++ = 0;
+        memcpy(p, album.c_str(), albumLen);
+        p += albumLen;
+        *p++ = 0;
+        memcpy(p, title.c_str(), titleLen);
+        p += titleLen;
+        *p = 0;
+        entryCount++;
+    }
+
+    uint8_t* addDirRecord(const String& dirPath) {
+        uint32_t pathLen = dirPath.length();
+        if (pathLen > 0xFFFF || !fits(DIR_HEADER_SIZE + pathLen + 1)) return nullptr;
+        uint8_t* out = dirs.grow(DIR_HEADER_SIZE + pathLen + 1);
+        if (!out) return nullptr;
+        putLE16(out + 4, (uint16_t)pathLen);
+        memcpy(out + DIR_HEADER_SIZE, dirPath.c_str(), pathLen + 1);
+        dirCount++;
+        return out;
+    }
+
+    void addChildren(const String& dirPath, const std::vector<Child>& children, int depth) {
+        for (size_t i = 0; i < children.size() && !stats.truncated; i++) {
+            const Child& c = children[i];
+            if (c.isDir) {
+                walk(dirPath + c.key, depth + 1);
+            } else {
+                addFile(dirPath + c.key, c, depth);
+            }
+        }
+    }
+
+public:
+    LibraryIndexBuilder(fs::FS& fileSystem, const char* ext, const LibraryIndex* prev, bool fullRescan,
+                        LibraryIndex::BuildStats& buildStats)
+        : IndexWalker(fileSystem, buildStats, LibraryIndex::HEADER_SIZE), extension(ext ? ext : ""), previous(prev),
+          full(fullRescan), limit(LibraryIndex::maxBytes()) {
+        extension.toLowerCase();
+        tagBuffer = new (std::nothrow) uint8_t[TAG_READ_MAX];
+    }
+
+    ~LibraryIndexBuilder() {
+        delete[] tagBuffer;
+    }
+
+    LibraryIndex* finish() {
+        if (entries.failed || dirs.failed) return nullptr;
+        uint32_t dirsSize = dirs.size;
+        uint8_t* out = entries.grow(dirsSize);
+        if (!out && dirsSize > 0) return nullptr;
+        if (dirsSize > 0) memcpy(out, dirs.data, dirsSize);
+
+        uint8_t* h = entries.data;
+        memcpy(h, FILE_MAGIC, sizeof(FILE_MAGIC));
+        putLE16(h + 8, LibraryIndex::FORMAT_VERSION);
+        putLE16(h + 10, stats.truncated ? LibraryIndex::HEADER_TRUNCATED : 0);
+        putLE32(h + 12, entryCount);
+        putLE32(h + 16, dirCount);
+        putLE32(h + 20, entries.size - LibraryIndex::HEADER_SIZE);
+        putLE32(h + 24, fnv1a(h + LibraryIndex::HEADER_SIZE, entries.size - LibraryIndex::HEADER_SIZE));
+        putLE32(h + 28, 0);
+
+        LibraryIndex* index = new (std::nothrow) LibraryIndex();
+        if (!index) return nullptr;
+        uint32_t size = entries.size;
+        uint8_t* data = entries.detach();
+        if (!index->adopt(data, size)) {
+            free(data);
+            delete index;
+            return nullptr;
+        }
+        return index;
+    }
+};
+
+LibraryIndex* LibraryIndex::build(fs::FS& fs, const char* extension, const LibraryIndex* previous, bool full, BuildStats& stats) {
+    uint32_t startMs = millis();
+    stats = BuildStats();
+    LibraryIndexBuilder builder(fs, extension, previous, full, stats);
+    builder.walk("/", 0);
+    LibraryIndex* index = builder.finish();
+    stats.elapsedMs = millis() - startMs;
+    return index;
+}
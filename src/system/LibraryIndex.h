@@ -0,0 +1,131 @@
+#pragma once
+#include <M5Cardputer.h>
+#include <FS.h>
+#include <atomic>
+
+// 曲库索引：卡上所有音乐文件的路径、大小、修改时间与解析出的元数据，按路径排序，
+// 保存为 /.cardputer/library.idx。元数据取自 ID3v2 标签，标签缺少的字段按
+// "艺术家-专辑-曲名" 文件名约定补齐。
+//
+// 启动时整个文件一次顺序读入内存，条目直接指向这块映像，不再逐条分配。
+// 刷新（build）时对照旧索引：修改时间没变的目录不重新列出，直接沿用旧条目；
+// 变化的目录中大小与修改时间都没变的文件也不重新读标签。
+// 构建完成后只读，可以在任务之间传递（见 StorageLoader）。被多方持有（曲库模型、音频播放列表）时
+// 用引用计数管理：新建的索引计数为 1，最后一个 release() 释放。
+//
+// 文件格式（小端）：
+//   "CPLIBIX1" | u16 版本 | u16 标志（HeaderFlags） | u32 条目数 | u32 目录数 | u32 数据长度 | u32 数据校验 | 4 字节保留
+//   条目数 × (u32 大小 | u32 修改时间 | u16 路径长 | u8 艺术家长 | u8 专辑长 | u8 曲名长 | u8 标志 |
+//             路径\0 艺术家\0 专辑\0 曲名\0)，按路径字节序升序
+//   目录数 × (u32 修改时间 | u16 路径长 | 路径\0)，路径以 '/' 结尾，按字节序升序
+
+// 索引映像上限：没有 PSRAM 时整个映像在内部 RAM 中，约 1000 首；有 PSRAM 时大块 malloc 落在 PSRAM，
+// 约 20000 首。超出的文件不收录，索引记下截断标志（isTruncated），MusicApp 在主菜单提示
+#ifndef LIBRARY_INDEX_MAX_BYTES
+#define LIBRARY_INDEX_MAX_BYTES (96 * 1024)
+#endif
+#ifndef LIBRARY_INDEX_PSRAM_MAX_BYTES
+#define LIBRARY_INDEX_PSRAM_MAX_BYTES (2 * 1024 * 1024)
+#endif
+
+class LibraryIndex {
+public:
+    static const char* const DEFAULT_PATH;              // "/.cardputer/library.idx"
+    static const uint16_t FORMAT_VERSION = 1;
+    static const uint32_t HEADER_SIZE = 32;
+    static const uint32_t MAX_BYTES = LIBRARY_INDEX_MAX_BYTES;
+    static const uint32_t PSRAM_MAX_BYTES = LIBRARY_INDEX_PSRAM_MAX_BYTES;
+    static const int MAX_DEPTH = 8;                     // 目录递归深度上限
+
+    enum EntryFlags {
+        ENTRY_HAS_TAG = 0x01        // 至少一个字段来自 ID3 标签
+    };
+
+    enum HeaderFlags {
+        HEADER_TRUNCATED = 0x01     // 构建时超过上限，卡上还有文件没有收录
+    };
+
+    // 一次构建的统计，用于日志
+    struct BuildStats {
+        uint32_t dirsVisited;
+        uint32_t dirsRescanned;     // 修改时间变化（或未知）而重新列出的目录
+        uint32_t filesReused;       // 沿用旧索引的条目
+        uint32_t filesParsed;       // 重新读取标签的文件
+        uint32_t elapsedMs;
+        bool truncated;             // 超过 maxBytes()，后面的文件没有收录
+
+        BuildStats() : dirsVisited(0), dirsRescanned(0), filesReused(0), filesParsed(0), elapsedMs(0), truncated(false) {}
+    };
+
+private:
+    uint8_t* image;                 // 整个索引文件的映像（含文件头）
+    uint32_t imageSize;
+    uint32_t* entryOffsets;         // 每个条目在映像中的偏移
+    uint32_t entryCount;
+    uint32_t* dirOffsets;
+    uint32_t dirCount;
+    bool truncated;
+    mutable std::atomic<int> refs;  // 播放列表可能在音频任务中释放，计数需要原子操作
+
+    LibraryIndex(const LibraryIndex&);
+    LibraryIndex& operator=(const LibraryIndex&);
+
+    // 校验映像并建立偏移表；成功后接管 data（失败时由调用者释放）
+    bool adopt(uint8_t* data, uint32_t size);
+    void freeImage();
+
+    const uint8_t* entryAt(uint32_t i) const { return image + entryOffsets[i]; }
+    const uint8_t* dirAt(uint32_t i) const { return image + dirOffsets[i]; }
+
+    friend class LibraryIndexBuilder;
+
+public:
+    LibraryIndex();
+    ~LibraryIndex();
+
+    void retain() const { refs.fetch_add(1, std::memory_order_relaxed); }
+    void release() const {
+        if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+    }
+
+    uint32_t getEntryCount() const { return entryCount; }
+    const char* getPath(uint32_t i) const;
+    const char* getName(uint32_t i) const;      // 路径最后一段
+    uint32_t getSize(uint32_t i) const;
+    uint32_t getMtime(uint32_t i) const;
+    uint8_t getFlags(uint32_t i) const;
+    const char* getArtist(uint32_t i) const;    // 没有时为空串
+    const char* getAlbum(uint32_t i) const;
+    const char* getTitle(uint32_t i) const;
+
+    uint32_t getDirCount() const { return dirCount; }
+    const char* getDirPath(uint32_t i) const;   // 以 '/' 结尾
+    uint32_t getDirMtime(uint32_t i) const;
+
+    // 二分查找，找不到返回 -1
+    int32_t findEntry(const char* path) const;
+    int32_t findDir(const char* dirPath) const;
+    // 第一个路径不小于 key 的条目/目录（用于按前缀遍历）
+    uint32_t lowerBoundEntry(const char* key) const;
+    uint32_t lowerBoundDir(const char* key) const;
+
+    uint32_t getImageSize() const { return imageSize; }
+    // 构建时超过上限，卡上还有音乐文件没有收录
+    bool isTruncated() const { return truncated; }
+    // 本机的映像上限：有 PSRAM 时为 PSRAM_MAX_BYTES，否则为 MAX_BYTES
+    static uint32_t maxBytes();
+    // 映像逐字节相同（刷新后没有任何变化）时不必重写文件
+    bool sameContent(const LibraryIndex& other) const;
+
+    // 一次读入整个文件；格式、版本或校验不符时返回 false 并保持为空
+    bool load(fs::FS& fs, const char* path = DEFAULT_PATH);
+    // 先写临时文件再替换，写到一半断电不会留下损坏的索引
+    bool save(fs::FS& fs, const char* path = DEFAULT_PATH) const;
+
+    // 扫描 fs 中扩展名为 extension 的文件生成新索引；previous 为旧索引（可为空），
+    // full 为 true 时忽略目录修改时间全部重新列出（仍沿用未变文件的标签）。内存不足时返回 nullptr
+    static LibraryIndex* build(fs::FS& fs, const char* extension, const LibraryIndex* previous, bool full, BuildStats& stats);
+
+    // 按 "艺术家-专辑-曲名"（或 "艺术家-曲名"）约定解析文件名，没有破折号时整个名字作为曲名
+    static void parseFileName(const String& fileName, String& artist, String& album, String& title);
+};
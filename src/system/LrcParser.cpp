@@ -0,0 +1,83 @@
+#include "system/LrcParser.h"
+#include "system/BufferedReader.h"
+#include <algorithm>
+
+static bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v';
+}
+
+// 读取开头的连续数字（与 String::toInt 对以数字开头的字符串的结果相同）
+static uint32_t leadingNumber(const char* p, const char* end) {
+    uint32_t v = 0;
+    while (p < end && isDigit(*p)) v = v * 10 + (uint32_t)(*p++ - '0');
+    return v;
+}
+
+int LrcParser::parseLine(const char* data, uint32_t length, uint32_t* times, int maxTimes,
+                         const char*& text, uint32_t& textLength) {
+    const char* p = data;
+    const char* end = data + length;
+    int count = 0;
+    // 连续的 [mm:ss]、[mm:ss.xx] 或 [mm:ss.xxx] 标签
+    while (p < end && *p == '[') {
+        const char* close = (const char*)memchr(p, ']', end - p);
+        if (!close || close == p + 1) break;
+        const char* tag = p + 1;
+        const char* colon = (const char*)memchr(tag, ':', close - tag);
+        if (!colon || colon == tag || colon + 1 == close) break;
+        const char* sec = colon + 1;
+        if (!isDigit(*tag) || !isDigit(*sec)) break;
+        uint32_t mm = leadingNumber(tag, colon);
+        uint32_t ss = leadingNumber(sec, close);
+        uint32_t fracMs = 0;
+        const char* dot = (const char*)memchr(sec, '.', close - sec);
+        if (dot) {
+            uint32_t fracLength = (uint32_t)(close - dot - 1);
+            uint32_t frac = leadingNumber(dot + 1, close);
+            if (fracLength == 2) {
+                fracMs = frac * 10;
+            } else if (fracLength == 3) {
+                fracMs = frac;
+            }
+        }
+        if (count < maxTimes) times[count++] = mm * 60000u + ss * 1000u + fracMs;
+        p = close + 1;
+    }
+    while (p < end && isSpace(*p)) p++;
+    while (end > p && isSpace(end[-1])) end--;
+    text = p;
+    textLength = (uint32_t)(end - p);
+    return count;
+}
+
+bool LrcParser::parse(File& file, std::vector<LyricLine>& out) {
+    out.clear();
+    BufferedReader reader(file);
+    if (!reader.isValid()) return false;
+    LineSpan line;
+    uint32_t times[MAX_TIMES_PER_LINE];
+    while (reader.readLine(line)) {
+        const char* text;
+        uint32_t textLength;
+        int count = parseLine(line.data, line.length, times, MAX_TIMES_PER_LINE, text, textLength);
+        if (count == 0 || textLength == 0) continue;
+        // 直接在数组中构造，避免再复制一次文本
+        for (int i = 0; i < count; i++) {
+            out.push_back(LyricLine());
+            LyricLine& lyric = out.back();
+            lyric.timeMs = times[i];
+            if (i == 0) {
+                lyric.text.concat(text, textLength);
+            } else {
+                lyric.text = out[out.size() - 2].text;
+            }
+        }
+    }
+    // 同一时间的多行保持文件中的先后（双语歌词等）
+    std::stable_sort(out.begin(), out.end(), [](const LyricLine& a, const LyricLine& b) { return a.timeMs < b.timeMs; });
+    return !out.empty();
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <M5Cardputer.h>
+#include <FS.h>
+#include <vector>
+
+struct LyricLine {
+    uint32_t timeMs;
+    String text;
+};
+
+// LRC 歌词解析：用 BufferedReader 逐行读取，行内直接在缓冲区上解析时间标签，
+// 只有歌词文本本身会分配字符串，读取占用的内存与文件大小无关。
+// 一行可以有多个时间标签（"[00:12.34][01:02.00]歌词"），各生成一条；
+// 没有时间标签的行（如 "[ar:歌手]"）和空歌词被跳过。结果按时间排序，时间相同的行保持文件中的顺序。
+class LrcParser {
+public:
+    static const int MAX_TIMES_PER_LINE = 16;
+
+    // 解析整个文件，返回是否得到至少一行歌词
+    static bool parse(File& file, std::vector<LyricLine>& out);
+
+    // 解析一行：把时间标签写入 times（最多 maxTimes 个），text 指向标签之后去掉首尾空白的文本。
+    // 返回时间标签个数
+    static int parseLine(const char* data, uint32_t length, uint32_t* times, int maxTimes,
+                         const char*& text, uint32_t& textLength);
+};
@@ -0,0 +1,266 @@
+#include "system/MusicLibrary.h"
+#include "system/BinaryUtil.h"
+#include <ctype.h>
+#include <strings.h>
+
+// 忽略大小写的 FNV-1a，与 strcasecmp 的比较规则一致（只折叠 ASCII）
+static uint32_t hashName(const char* s) {
+    uint32_t h = FNV1A_OFFSET;
+    for (; *s; s++) h = fnv1aAdd(h, (uint8_t)tolower((uint8_t)*s));
+    return h;
+}
+
+static uint32_t mixId(uint32_t id) {
+    return id * 0x9E3779B1u;
+}
+
+MusicLibrary::MusicLibrary()
+    : index(nullptr), trackCount(0), truncated(false), trackAlbum(nullptr), groupedTracks(nullptr),
+      uncategorizedStart(0), albumCount(0), albumArtist(nullptr), albumRep(nullptr), albumStart(nullptr),
+      artistCount(0), artistRep(nullptr), artistTrackCount(nullptr), artistAlbumStart(nullptr), artistAlbums(nullptr),
+      artistTable(nullptr), artistTableMask(0), albumTable(nullptr), albumTableMask(0) {}
+
+MusicLibrary::~MusicLibrary() {
+    clear();
+}
+
+void MusicLibrary::clear() {
+    if (index) index->release();
+    index = nullptr;
+    arena.release();
+    trackCount = 0;
+    truncated = false;
+    trackAlbum = groupedTracks = nullptr;
+    uncategorizedStart = 0;
+    albumCount = 0;
+    albumArtist = albumRep = albumStart = nullptr;
+    artistCount = 0;
+    artistRep = artistTrackCount = artistAlbumStart = artistAlbums = nullptr;
+    artistTable = albumTable = nullptr;
+    artistTableMask = albumTableMask = 0;
+}
+
+// 装载率不超过 1/2
+uint32_t MusicLibrary::tableSize(uint32_t items) {
+    uint32_t size = 16;
+    while (size < items * 2) size <<= 1;
+    return size;
+}
+
+// 长期数据每首约 8 字节加上专辑/艺术家（通常远少于曲目），构建时另需每首 4 字节与两张按曲目数估算的哈希表
+uint32_t MusicLibrary::estimateBytes(uint32_t count) {
+    return count * 12 + count * 4 + 2 * tableSize(count) * 4 + 1024;
+}
+
+bool MusicLibrary::build(const LibraryIndex* library) {
+    clear();
+    if (!library) return false;
+    library->retain();
+    index = library;
+
+    uint32_t total = library->getEntryCount();
+    bool psram = heap_caps_get_free_size(MALLOC_CAP_SPIRAM) > 0;
+    uint32_t budget = psram ? MUSIC_LIBRARY_PSRAM_BUDGET_BYTES : MUSIC_LIBRARY_BUDGET_BYTES;
+    uint32_t bytes = estimateBytes(total);
+    if (bytes > budget) bytes = budget;
+    if (!arena.reserve(bytes, psram)) {
+        clear();
+        return false;
+    }
+    // 放不下时先在预算内加大内存池（专辑、艺术家比估计的多，例如每首都是单曲），
+    // 到了预算仍放不下才减少收录的曲目数重试
+    uint32_t count = total;
+    while (!layout(count)) {
+        if (bytes < budget) {
+            uint32_t larger = bytes > budget / 2 ? budget : bytes * 2;
+            if (arena.reserve(larger, psram)) {
+                bytes = larger;
+                continue;
+            }
+            // 加大失败：回到原来的大小，改为减少曲目
+            budget = bytes;
+            if (!arena.reserve(bytes, psram)) {
+                clear();
+                return false;
+            }
+        }
+        if (count == 0) {
+            clear();
+            return false;
+        }
+        count = count * 3 / 4;
+    }
+    truncated = count < total;
+    return true;
+}
+
+bool MusicLibrary::layout(uint32_t count) {
+    arena.reset();
+    trackCount = 0;
+    albumCount = 0;
+    artistCount = 0;
+    trackAlbum = arena.allocArrayLow<uint32_t>(count);
+    groupedTracks = arena.allocArrayLow<uint32_t>(count);
+    if (!trackAlbum || !groupedTracks) return false;
+
+    // 构建期间的临时数据放在高端，结束后整体退回
+    uint32_t mark = arena.markHigh();
+    uint32_t scratchSize = tableSize(count);
+    uint32_t scratchMask = scratchSize - 1;
+    uint32_t* artistOf = arena.allocArrayHigh<uint32_t>(count);
+    uint32_t* artistReps = arena.allocArrayHigh<uint32_t>(scratchSize);
+    uint32_t* albumReps = arena.allocArrayHigh<uint32_t>(scratchSize);
+    if (!artistOf || !artistReps || !albumReps) return false;
+    memset(artistReps, 0xFF, scratchSize * sizeof(uint32_t));
+    memset(albumReps, 0xFF, scratchSize * sizeof(uint32_t));
+
+    // 第一遍：把每首曲目映射到所属艺术家、专辑的代表曲目（组内第一首）
+    uint32_t artists = 0;
+    uint32_t albums = 0;
+    for (uint32_t t = 0; t < count; t++) {
+        const char* artist = index->getArtist(t);
+        const char* album = index->getAlbum(t);
+        if (!*artist || !*album) {
+            trackAlbum[t] = NO_ID;
+            artistOf[t] = NO_ID;
+            continue;
+        }
+        uint32_t slot = hashName(artist) & scratchMask;
+        while (artistReps[slot] != NO_ID && strcasecmp(index->getArtist(artistReps[slot]), artist) != 0) {
+            slot = (slot + 1) & scratchMask;
+        }
+        if (artistReps[slot] == NO_ID) {
+            artistReps[slot] = t;
+            artists++;
+        }
+        uint32_t artistRepTrack = artistReps[slot];
+        artistOf[t] = artistRepTrack;
+
+        slot = (hashName(album) ^ mixId(artistRepTrack)) & scratchMask;
+        while (albumReps[slot] != NO_ID &&
+               !(artistOf[albumReps[slot]] == artistRepTrack && strcasecmp(index->getAlbum(albumReps[slot]), album) == 0)) {
+            slot = (slot + 1) & scratchMask;
+        }
+        if (albumReps[slot] == NO_ID) {
+            albumReps[slot] = t;
+            albums++;
+        }
+        trackAlbum[t] = albumReps[slot];
+    }
+
+    albumArtist = arena.allocArrayLow<uint32_t>(albums);
+    albumRep = arena.allocArrayLow<uint32_t>(albums);
+    albumStart = arena.allocArrayLow<uint32_t>(albums + 1);
+    artistRep = arena.allocArrayLow<uint32_t>(artists);
+    artistTrackCount = arena.allocArrayLow<uint32_t>(artists);
+    artistAlbumStart = arena.allocArrayLow<uint32_t>(artists + 1);
+    artistAlbums = arena.allocArrayLow<uint32_t>(albums);
+    uint32_t artistTableSize = tableSize(artists);
+    uint32_t albumTableSize = tableSize(albums);
+    artistTable = arena.allocArrayLow<uint32_t>(artistTableSize);
+    albumTable = arena.allocArrayLow<uint32_t>(albumTableSize);
+    if (!albumArtist || !albumRep || !albumStart || !artistRep || !artistTrackCount || !artistAlbumStart ||
+        !artistAlbums || !artistTable || !albumTable) {
+        return false;
+    }
+
+    // 第二遍：代表曲目换成按首次出现顺序的编号（代表总在组内其他曲目之前，已经换好）
+    for (uint32_t t = 0; t < count; t++) {
+        if (trackAlbum[t] == NO_ID) continue;
+        uint32_t repArtist = artistOf[t];
+        if (repArtist == t) {
+            artistRep[artistCount] = t;
+            artistOf[t] = artistCount++;
+        } else {
+            artistOf[t] = artistOf[repArtist];
+        }
+        uint32_t repAlbum = trackAlbum[t];
+        if (repAlbum == t) {
+            albumRep[albumCount] = t;
+            albumArtist[albumCount] = artistOf[t];
+            trackAlbum[t] = albumCount++;
+        } else {
+            trackAlbum[t] = trackAlbum[repAlbum];
+        }
+    }
+
+    // 专辑曲目按计数排序连续存放，专辑内保持索引（路径）顺序，未分类排在最后；
+    // artistOf 此后不再需要，借作游标
+    uint32_t* cursor = artistOf;
+    memset(albumStart, 0, (albums + 1) * sizeof(uint32_t));
+    for (uint32_t t = 0; t < count; t++) {
+        if (trackAlbum[t] != NO_ID) albumStart[trackAlbum[t] + 1]++;
+    }
+    for (uint32_t b = 0; b < albums; b++) {
+        albumStart[b + 1] += albumStart[b];
+        cursor[b] = albumStart[b];
+    }
+    uncategorizedStart = albumStart[albums];
+    uint32_t nextUncategorized = uncategorizedStart;
+    for (uint32_t t = 0; t < count; t++) {
+        uint32_t b = trackAlbum[t];
+        groupedTracks[b == NO_ID ? nextUncategorized++ : cursor[b]++] = t;
+    }
+
+    // 艺术家的专辑，同样连续存放
+    memset(artistAlbumStart, 0, (artists + 1) * sizeof(uint32_t));
+    memset(artistTrackCount, 0, artists * sizeof(uint32_t));
+    for (uint32_t b = 0; b < albums; b++) {
+        artistAlbumStart[albumArtist[b] + 1]++;
+        artistTrackCount[albumArtist[b]] += albumStart[b + 1] - albumStart[b];
+    }
+    for (uint32_t a = 0; a < artists; a++) {
+        artistAlbumStart[a + 1] += artistAlbumStart[a];
+        cursor[a] = artistAlbumStart[a];
+    }
+    for (uint32_t b = 0; b < albums; b++) {
+        artistAlbums[cursor[albumArtist[b]]++] = b;
+    }
+
+    // 查找用的哈希表按实际数量建立
+    artistTableMask = artistTableSize - 1;
+    albumTableMask = albumTableSize - 1;
+    memset(artistTable, 0xFF, artistTableSize * sizeof(uint32_t));
+    memset(albumTable, 0xFF, albumTableSize * sizeof(uint32_t));
+    for (uint32_t a = 0; a < artists; a++) {
+        uint32_t slot = hashName(index->getArtist(artistRep[a])) & artistTableMask;
+        while (artistTable[slot] != NO_ID) slot = (slot + 1) & artistTableMask;
+        artistTable[slot] = a;
+    }
+    for (uint32_t b = 0; b < albums; b++) {
+        uint32_t slot = (hashName(index->getAlbum(albumRep[b])) ^ mixId(albumArtist[b])) & albumTableMask;
+        while (albumTable[slot] != NO_ID) slot = (slot + 1) & albumTableMask;
+        albumTable[slot] = b;
+    }
+
+    arena.releaseHigh(mark);
+    trackCount = count;
+    return true;
+}
+
+uint32_t MusicLibrary::findArtist(const char* name) const {
+    if (!artistTable) return NO_ID;
+    uint32_t slot = hashName(name) & artistTableMask;
+    while (artistTable[slot] != NO_ID) {
+        if (strcasecmp(getArtistName(artistTable[slot]), name) == 0) return artistTable[slot];
+        slot = (slot + 1) & artistTableMask;
+    }
+    return NO_ID;
+}
+
+uint32_t MusicLibrary::findAlbum(uint32_t artist, const char* name) const {
+    if (!albumTable) return NO_ID;
+    uint32_t slot = (hashName(name) ^ mixId(artist)) & albumTableMask;
+    while (albumTable[slot] != NO_ID) {
+        uint32_t b = albumTable[slot];
+        if (albumArtist[b] == artist && strcasecmp(getAlbumName(b), name) == 0) return b;
+        slot = (slot + 1) & albumTableMask;
+    }
+    return NO_ID;
+}
+
+uint32_t MusicLibrary::findTrackByPath(const char* path) const {
+    if (!index) return NO_ID;
+    int32_t entry = index->findEntry(path);
+    return entry >= 0 && (uint32_t)entry < trackCount ? (uint32_t)entry : NO_ID;
+}
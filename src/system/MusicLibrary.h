@@ -0,0 +1,108 @@
+#pragma once
+#include <M5Cardputer.h>
+#include "system/Arena.h"
+#include "system/LibraryIndex.h"
+
+// 模型的内存预算：有 PSRAM 时用后者，否则在内部 RAM 中用前者；放不下的曲目不收录
+#ifndef MUSIC_LIBRARY_BUDGET_BYTES
+#define MUSIC_LIBRARY_BUDGET_BYTES (48 * 1024)
+#endif
+#ifndef MUSIC_LIBRARY_PSRAM_BUDGET_BYTES
+#define MUSIC_LIBRARY_PSRAM_BUDGET_BYTES (1024 * 1024)
+#endif
+
+// 曲库模型：在曲库索引之上把曲目按艺术家、专辑分组，供 MusicApp 浏览与播放。
+//
+// 曲目 ID 就是索引的条目序号，艺术家与专辑按首次出现的顺序编号，都是 32 位。
+// 所有数据按列存放（每个属性一个数组），从一块定长 Arena 中分配，没有逐条的 new。
+// 名字不复制：每个艺术家/专辑记下组内第一首曲目作为代表，名字直接指向索引映像中的字符串，
+// 索引映像就是驻留字符串的存储。艺术家按名字、专辑按（艺术家、名字）忽略大小写建哈希表，
+// 分组与查找都是 O(1)，专辑和未分类曲目各自连续存放，列出一组曲目不需要再筛选。
+// 艺术家与专辑都有的曲目才归类，其余为未分类。
+//
+// 构建时持有索引的一个引用，clear() 或重建时释放。只能在主线程中使用。
+class MusicLibrary {
+public:
+    static const uint32_t NO_ID = 0xFFFFFFFF;
+
+private:
+    const LibraryIndex* index;
+    Arena arena;
+    uint32_t trackCount;            // 收录索引的前 trackCount 个条目
+    bool truncated;
+
+    uint32_t* trackAlbum;           // [trackCount] 所属专辑，未分类为 NO_ID
+    uint32_t* groupedTracks;        // [trackCount] 按专辑连续排列的曲目，未分类的排在最后
+    uint32_t uncategorizedStart;    // groupedTracks 中未分类曲目的起点
+
+    uint32_t albumCount;
+    uint32_t* albumArtist;          // [albumCount]
+    uint32_t* albumRep;             // [albumCount] 代表曲目（名字来源）
+    uint32_t* albumStart;           // [albumCount + 1] 在 groupedTracks 中的范围
+
+    uint32_t artistCount;
+    uint32_t* artistRep;            // [artistCount]
+    uint32_t* artistTrackCount;     // [artistCount]
+    uint32_t* artistAlbumStart;     // [artistCount + 1] 在 artistAlbums 中的范围
+    uint32_t* artistAlbums;         // [albumCount] 按艺术家连续排列的专辑
+
+    // 开放寻址哈希表，槽中为 ID，空槽为 NO_ID
+    uint32_t* artistTable;
+    uint32_t artistTableMask;
+    uint32_t* albumTable;
+    uint32_t albumTableMask;
+
+    MusicLibrary(const MusicLibrary&);
+    MusicLibrary& operator=(const MusicLibrary&);
+
+    bool layout(uint32_t count);
+    static uint32_t tableSize(uint32_t items);
+    static uint32_t estimateBytes(uint32_t count);
+
+public:
+    MusicLibrary();
+    ~MusicLibrary();
+
+    // 按索引重建；索引为空或内存不足时返回 false（模型为空）
+    bool build(const LibraryIndex* library);
+    void clear();
+
+    const LibraryIndex* getIndex() const { return index; }
+    uint32_t getTrackCount() const { return trackCount; }
+    // 索引中还有曲目因为预算不足没有收录
+    bool isTruncated() const { return truncated; }
+    uint32_t getIndexedTrackCount() const { return index ? index->getEntryCount() : 0; }
+
+    // 曲目
+    const char* getTrackPath(uint32_t track) const { return index->getPath(track); }
+    const char* getTrackName(uint32_t track) const { return index->getName(track); }
+    const char* getTrackTitle(uint32_t track) const { return index->getTitle(track); }
+    const char* getTrackArtistName(uint32_t track) const { return index->getArtist(track); }
+    uint32_t getTrackAlbum(uint32_t track) const { return trackAlbum[track]; }
+    // 按完整路径查找（曲库索引按路径排序，二分查找），找不到返回 NO_ID
+    uint32_t findTrackByPath(const char* path) const;
+
+    // 艺术家
+    uint32_t getArtistCount() const { return artistCount; }
+    const char* getArtistName(uint32_t artist) const { return index->getArtist(artistRep[artist]); }
+    uint32_t getArtistTrackCount(uint32_t artist) const { return artistTrackCount[artist]; }
+    uint32_t getArtistAlbumCount(uint32_t artist) const { return artistAlbumStart[artist + 1] - artistAlbumStart[artist]; }
+    uint32_t getArtistAlbum(uint32_t artist, uint32_t i) const { return artistAlbums[artistAlbumStart[artist] + i]; }
+    uint32_t findArtist(const char* name) const;
+
+    // 专辑
+    uint32_t getAlbumCount() const { return albumCount; }
+    const char* getAlbumName(uint32_t album) const { return index->getAlbum(albumRep[album]); }
+    uint32_t getAlbumArtist(uint32_t album) const { return albumArtist[album]; }
+    uint32_t getAlbumTrackCount(uint32_t album) const { return albumStart[album + 1] - albumStart[album]; }
+    uint32_t getAlbumTrack(uint32_t album, uint32_t i) const { return groupedTracks[albumStart[album] + i]; }
+    uint32_t findAlbum(uint32_t artist, const char* name) const;
+
+    // 未分类
+    uint32_t getUncategorizedCount() const { return trackCount - uncategorizedStart; }
+    uint32_t getUncategorizedTrack(uint32_t i) const { return groupedTracks[uncategorizedStart + i]; }
+
+    uint32_t getMemoryUsed() const { return arena.getUsed(); }
+    uint32_t getMemoryCapacity() const { return arena.getCapacity(); }
+    bool isInPsram() const { return arena.isInPsram(); }
+};
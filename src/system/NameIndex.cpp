@@ -0,0 +1,608 @@
+#include "system/NameIndex.h"
+#include "system/IndexWalker.h"
+#include <new>
+
+#ifndef NATIVE_BUILD
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#endif
+
+const char* const NameIndex::DEFAULT_PATH = "/.cardputer/names.idx";
+
+static const char FILE_MAGIC[8] = { 'C', 'P', 'N', 'A', 'M', 'I', 'X', '1' };
+static const uint32_t ENTRY_HEADER_SIZE = 4;
+static const uint32_t DIR_HEADER_SIZE = 10;
+static const uint32_t KEY_SIZE = 4;
+static const uint32_t NAME_MAX_BYTES = 255;
+static const int MAX_QUERY_WORDS = 8;
+
+static uint8_t foldAscii(uint8_t c) {
+    return c >= 'A' && c <= 'Z' ? (uint8_t)(c + ('a' - 'A')) : c;
+}
+
+// 忽略 ASCII 大小写比较，最多比较 n 字节（遇到 \0 结束）；与 libc 的 strncasecmp 不同，
+// 结果不受区域设置影响，设备上建的索引与查询的顺序一致
+static int foldCompare(const char* a, const char* b, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        uint8_t ca = foldAscii((uint8_t)a[i]);
+        uint8_t cb = foldAscii((uint8_t)b[i]);
+        if (ca != cb) return ca < cb ? -1 : 1;
+        if (ca == 0) return 0;
+    }
+    return 0;
+}
+
+static bool isAsciiAlnum(uint8_t c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+static bool isDigit(uint8_t c) {
+    return c >= '0' && c <= '9';
+}
+
+static uint32_t entryRecordSize(const uint8_t* e) {
+    return ENTRY_HEADER_SIZE + e[3] + 1;
+}
+
+static uint32_t countWordStarts(const char* name) {
+    uint32_t n = 0;
+    for (uint32_t i = 0; name[i]; i++) {
+        if (NameIndex::isWordStart(name, i)) n++;
+    }
+    return n;
+}
+
+bool NameIndex::isWordStart(const char* name, uint32_t pos) {
+    uint8_t c = (uint8_t)name[pos];
+    if (c == 0 || (c & 0xC0) == 0x80) return false;    // 结尾或多字节字符的后续字节
+    if (c >= 0x80) return true;                         // 每个多字节字符
+    if (!isAsciiAlnum(c)) return false;                 // 分隔符本身不作为开头
+    if (pos == 0) return true;
+    uint8_t prev = (uint8_t)name[pos - 1];
+    if (!isAsciiAlnum(prev)) return true;               // 分隔符或多字节字符之后
+    if (isDigit(c) != isDigit(prev)) return true;       // 字母与数字交界
+    return c >= 'A' && c <= 'Z' && prev >= 'a' && prev <= 'z';
+}
+
+// ---- NameIndex ----
+
+NameIndex::NameIndex()
+    : image(nullptr), imageSize(0), entryOffsets(nullptr), entryCount(0), dirOffsets(nullptr), dirCount(0),
+      keys(nullptr), keyCount(0) {}
+
+NameIndex::~NameIndex() {
+    freeImage();
+}
+
+void NameIndex::freeImage() {
+    free(image);
+    delete[] entryOffsets;
+    delete[] dirOffsets;
+    image = nullptr;
+    imageSize = 0;
+    entryOffsets = nullptr;
+    dirOffsets = nullptr;
+    entryCount = 0;
+    dirCount = 0;
+    keys = nullptr;
+    keyCount = 0;
+}
+
+bool NameIndex::adopt(uint8_t* data, uint32_t size) {
+    if (!data || size < HEADER_SIZE || memcmp(data, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) return false;
+    if (getLE16(data + 8) != FORMAT_VERSION) return false;
+    uint32_t entries = getLE32(data + 12);
+    uint32_t dirs = getLE32(data + 16);
+    uint32_t keyTotal = getLE32(data + 20);
+    uint32_t payload = getLE32(data + 24);
+    if (payload != size - HEADER_SIZE || fnv1a(data + HEADER_SIZE, payload) != getLE32(data + 28)) return false;
+    if (entries > payload / (ENTRY_HEADER_SIZE + 2) || dirs > payload / (DIR_HEADER_SIZE + 2) ||
+        dirs > MAX_DIRS || keyTotal > payload / KEY_SIZE || (dirs == 0 && entries > 0)) {
+        return false;
+    }
+
+    uint32_t* eOffsets = new (std::nothrow) uint32_t[entries > 0 ? entries : 1];
+    uint32_t* dOffsets = new (std::nothrow) uint32_t[dirs > 0 ? dirs : 1];
+    bool ok = eOffsets && dOffsets;
+
+    uint32_t pos = HEADER_SIZE;
+    for (uint32_t i = 0; ok && i < entries; i++) {
+        const uint8_t* e = data + pos;
+        if (size - pos < ENTRY_HEADER_SIZE || size - pos < entryRecordSize(e)) {
+            ok = false;
+            break;
+        }
+        ok = e[3] > 0 && validField((const char*)e + ENTRY_HEADER_SIZE, e[3]) && getLE16(e) < dirs;
+        eOffsets[i] = pos;
+        pos += entryRecordSize(e);
+    }
+    const char* prev = nullptr;
+    uint32_t prevFirst = 0;
+    for (uint32_t i = 0; ok && i < dirs; i++) {
+        const uint8_t* d = data + pos;
+        if (size - pos < DIR_HEADER_SIZE || size - pos < DIR_HEADER_SIZE + getLE16(d + 8) + 1u) {
+            ok = false;
+            break;
+        }
+        const char* path = (const char*)d + DIR_HEADER_SIZE;
+        uint32_t first = getLE32(d + 4);
+        ok = validField(path, getLE16(d + 8)) && (!prev || strcmp(prev, path) < 0) &&
+             first <= entries && first >= prevFirst && (i > 0 || first == 0);
+        dOffsets[i] = pos;
+        pos += DIR_HEADER_SIZE + getLE16(d + 8) + 1;
+        prev = path;
+        prevFirst = first;
+    }
+    // 每个条目的目录号与目录表中的范围一致
+    for (uint32_t i = 0; ok && i < dirs; i++) {
+        uint32_t first = getLE32(data + dOffsets[i] + 4);
+        uint32_t end = i + 1 < dirs ? getLE32(data + dOffsets[i + 1] + 4) : entries;
+        for (uint32_t e = first; ok && e < end; e++) ok = getLE16(data + eOffsets[e]) == i;
+    }
+    if (ok && size - pos != keyTotal * KEY_SIZE) ok = false;
+    const uint8_t* keyTable = data + pos;
+    const char* prevSuffix = nullptr;
+    for (uint32_t i = 0; ok && i < keyTotal; i++) {
+        uint32_t key = getLE32(keyTable + i * KEY_SIZE);
+        uint32_t entry = key >> 8;
+        uint32_t offset = key & 0xFF;
+        if (entry >= entries || offset >= data[eOffsets[entry] + 3]) {
+            ok = false;
+            break;
+        }
+        const char* suffix = (const char*)data + eOffsets[entry] + ENTRY_HEADER_SIZE + offset;
+        ok = !prevSuffix || foldCompare(prevSuffix, suffix, NAME_MAX_BYTES + 1) <= 0;
+        prevSuffix = suffix;
+    }
+    if (!ok) {
+        delete[] eOffsets;
+        delete[] dOffsets;
+        return false;
+    }
+
+    freeImage();
+    image = data;
+    imageSize = size;
+    entryOffsets = eOffsets;
+    entryCount = entries;
+    dirOffsets = dOffsets;
+    dirCount = dirs;
+    keys = keyTable;
+    keyCount = keyTotal;
+    return true;
+}
+
+uint32_t NameIndex::keyAt(uint32_t i) const {
+    return getLE32(keys + i * KEY_SIZE);
+}
+
+const char* NameIndex::keySuffix(uint32_t i) const {
+    uint32_t key = keyAt(i);
+    return getName(key >> 8) + (key & 0xFF);
+}
+
+const char* NameIndex::getName(uint32_t i) const {
+    return (const char*)entryAt(i) + ENTRY_HEADER_SIZE;
+}
+
+bool NameIndex::isDirectory(uint32_t i) const {
+    return (entryAt(i)[2] & ENTRY_DIR) != 0;
+}
+
+uint32_t NameIndex::getDirIndex(uint32_t i) const {
+    return getLE16(entryAt(i));
+}
+
+String NameIndex::getPath(uint32_t i) const {
+    return String(getDirPath(getDirIndex(i))) + getName(i);
+}
+
+const char* NameIndex::getDirPath(uint32_t i) const {
+    return (const char*)dirAt(i) + DIR_HEADER_SIZE;
+}
+
+uint32_t NameIndex::getDirMtime(uint32_t i) const { return getLE32(dirAt(i)); }
+uint32_t NameIndex::getDirFirstEntry(uint32_t i) const { return getLE32(dirAt(i) + 4); }
+
+uint32_t NameIndex::getDirEntryCount(uint32_t i) const {
+    uint32_t end = i + 1 < dirCount ? getDirFirstEntry(i + 1) : entryCount;
+    return end - getDirFirstEntry(i);
+}
+
+int32_t NameIndex::findDir(const char* dirPath) const {
+    uint32_t lo = 0, hi = dirCount;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (strcmp(getDirPath(mid), dirPath) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo < dirCount && strcmp(getDirPath(lo), dirPath) == 0 ? (int32_t)lo : -1;
+}
+
+bool NameIndex::sameContent(const NameIndex& other) const {
+    return imageSize == other.imageSize && (imageSize == 0 || memcmp(image, other.image, imageSize) == 0);
+}
+
+uint32_t NameIndex::search(const char* query, uint32_t* results, uint32_t maxResults, uint32_t countLimit) const {
+    // 切词（只记位置，不复制）
+    const char* words[MAX_QUERY_WORDS];
+    uint32_t lengths[MAX_QUERY_WORDS];
+    int wordCount = 0;
+    for (const char* p = query; *p && wordCount < MAX_QUERY_WORDS; ) {
+        while (*p == ' ') p++;
+        const char* start = p;
+        while (*p && *p != ' ') p++;
+        if (p > start) {
+            words[wordCount] = start;
+            lengths[wordCount] = (uint32_t)(p - start);
+            wordCount++;
+        }
+    }
+    if (wordCount == 0 || keyCount == 0) return 0;
+
+    // 第一个词：二分查找后缀以它开头的一段键
+    const char* first = words[0];
+    uint32_t firstLen = lengths[0];
+    uint32_t lo = 0, hi = keyCount;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (foldCompare(keySuffix(mid), first, firstLen) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+
+    uint32_t found = 0;
+    uint32_t stored = 0;
+    // 两轮：先收集从名字开头匹配的，再收集从中间某个词匹配的
+    for (int pass = 0; pass < 2; pass++) {
+        for (uint32_t k = lo; k < keyCount; k++) {
+            uint32_t key = keyAt(k);
+            uint32_t entry = key >> 8;
+            uint32_t offset = key & 0xFF;
+            const char* name = getName(entry);
+            if (foldCompare(name + offset, first, firstLen) != 0) break;
+            if ((pass == 0) != (offset == 0)) continue;
+
+            // 同一个名字中有多个词匹配时只算最前面的那个
+            bool duplicate = false;
+            for (uint32_t t = 0; t < offset && !duplicate; t++) {
+                duplicate = isWordStart(name, t) && foldCompare(name + t, first, firstLen) == 0;
+            }
+            if (duplicate) continue;
+
+            bool matched = true;
+            for (int w = 1; w < wordCount && matched; w++) {
+                matched = false;
+                for (uint32_t t = 0; name[t] && !matched; t++) {
+                    matched = isWordStart(name, t) && foldCompare(name + t, words[w], lengths[w]) == 0;
+                }
+            }
+            if (!matched) continue;
+
+            if (stored < maxResults) results[stored++] = entry;
+            if (++found >= countLimit) return found;
+        }
+    }
+    return found;
+}
+
+bool NameIndex::load(fs::FS& fs, const char* path) {
+    File file = fs.open(path, FILE_READ);
+    if (!file || file.isDirectory()) return false;
+    uint32_t size = (uint32_t)file.size();
+    if (size < HEADER_SIZE || size > MAX_BYTES) {
+        file.close();
+        return false;
+    }
+    uint8_t* data = (uint8_t*)malloc(size);
+    bool ok = data && file.read(data, size) == size;
+    file.close();
+    if (ok) ok = adopt(data, size);
+    if (!ok) free(data);
+    return ok;
+}
+
+bool NameIndex::save(fs::FS& fs, const char* path) const {
+    if (!image) return false;
+    String target(path);
+    int slash = target.lastIndexOf('/');
+    if (slash > 0) {
+        String dir = target.substring(0, slash);
+        if (!fs.exists(dir) && !fs.mkdir(dir)) return false;
+    }
+    String temp = target + ".tmp";
+    File file = fs.open(temp, FILE_WRITE);
+    if (!file) return false;
+    bool ok = file.write(image, imageSize) == imageSize;
+    file.close();
+    // FAT 上 rename 不能覆盖已有文件
+    if (ok && fs.exists(target)) ok = fs.remove(target);
+    if (ok) ok = fs.rename(temp, target);
+    if (!ok) fs.remove(temp);
+    return ok;
+}
+
+// ---- 构建 ----
+
+class NameIndexBuilder : public IndexWalker<NameIndexBuilder, NameIndex::BuildStats, NameIndex::MAX_DEPTH> {
+private:
+    friend class IndexWalker<NameIndexBuilder, NameIndex::BuildStats, NameIndex::MAX_DEPTH>;
+
+    struct Child {
+        String key;             // 名字；目录名后加 '/'，这样按 key 排序的先序遍历正好是路径序
+        bool isDir;
+
+        bool operator<(const Child& other) const { return strcmp(key.c_str(), other.key.c_str()) < 0; }
+    };
+
+    // 键排序：按后缀（忽略 ASCII 大小写），相同时按条目与偏移，结果确定
+    struct KeyLess {
+        const uint8_t* image;
+        const std::vector<uint32_t>& offsets;
+
+        KeyLess(const uint8_t* data, const std::vector<uint32_t>& entryOffsets) : image(data), offsets(entryOffsets) {}
+        const char* suffix(uint32_t key) const {
+            return (const char*)image + offsets[key >> 8] + ENTRY_HEADER_SIZE + (key & 0xFF);
+        }
+        bool operator()(uint32_t a, uint32_t b) const {
+            int c = foldCompare(suffix(a), suffix(b), NAME_MAX_BYTES + 1);
+            return c != 0 ? c < 0 : a < b;
+        }
+    };
+
+    const NameIndex* previous;
+    const std::atomic<bool>* stop;
+    uint32_t keyCount;
+
+    bool fits(uint32_t recordSize, uint32_t newKeys) const {
+        return entries.size + dirs.size + (keyCount + newKeys) * KEY_SIZE + recordSize <= NameIndex::MAX_BYTES;
+    }
+
+    bool stopping() {
+        if (!stats.stopped && stop && stop->load(std::memory_order_relaxed)) stats.stopped = true;
+        return stats.stopped;
+    }
+
+    int32_t findUnchangedDir(const String& dirPath, uint32_t mtime) const {
+        if (!previous) return -1;
+        int32_t i = previous->findDir(dirPath.c_str());
+        return i >= 0 && previous->getDirMtime(i) == mtime ? i : -1;
+    }
+
+    void collectFromPrevious(const String&, int32_t prevDir, std::vector<Child>& children) {
+        uint32_t first = previous->getDirFirstEntry(prevDir);
+        uint32_t count = previous->getDirEntryCount(prevDir);
+        for (uint32_t i = first; i < first + count; i++) {
+            Child c;
+            c.isDir = previous->isDirectory(i);
+            c.key = previous->getName(i);
+            if (c.isDir) c.key += "/";
+            children.push_back(c);
+        }
+        stats.entriesReused += count;
+    }
+
+    void listDirectory(File& dir, const String&, std::vector<Child>& children) {
+        File file = dir.openNextFile();
+        while (file) {
+            if (stopping()) {
+                file.close();
+                return;
+            }
+            String name = file.name();
+            int slash = name.lastIndexOf('/');
+            if (slash >= 0) name = name.substring(slash + 1);
+            // 跳过隐藏文件与目录（包括索引自己所在的 /.cardputer），名字过长的不收录
+            if (name.length() > 0 && name.length() <= NAME_MAX_BYTES && !name.startsWith(".")) {
+                Child c;
+                c.isDir = file.isDirectory();
+                c.key = c.isDir ? name + "/" : name;
+                children.push_back(c);
+            }
+            file.close();
+            file = dir.openNextFile();
+        }
+    }
+
+    bool addEntry(uint32_t dirIndex, const Child& c, int depth) {
+        uint32_t nameLen = c.isDir ? c.key.length() - 1 : c.key.length();
+        uint32_t recordSize = ENTRY_HEADER_SIZE + nameLen + 1;
+        String name = c.isDir ? c.key.substring(0, nameLen) : c.key;
+        // 键在 finish 中统一生成，这里只按个数预留空间
+        uint32_t newKeys = countWordStarts(name.c_str());
+        if (!fits(recordSize, newKeys) || entryCount >= (1u << 24)) {
+            truncate(depth);
+            return false;
+        }
+        uint8_t* out = entries.grow(recordSize);
+        if (!out) return false;
+        putLE16(out, (uint16_t)dirIndex);
+        out[2] = c.isDir ? NameIndex::ENTRY_DIR : 0;
+        out[3] = (uint8_t)nameLen;
+        memcpy(out + ENTRY_HEADER_SIZE, name.c_str(), nameLen + 1);
+        entryCount++;
+        keyCount += newKeys;
+        return true;
+    }
+
+    uint8_t* addDirRecord(const String& dirPath) {
+        uint32_t pathLen = dirPath.length();
+        if (pathLen > 0xFFFF || dirCount >= NameIndex::MAX_DIRS || !fits(DIR_HEADER_SIZE + pathLen + 1, 0)) return nullptr;
+        uint8_t* out = dirs.grow(DIR_HEADER_SIZE + pathLen + 1);
+        if (!out) return nullptr;
+        dirCount++;
+        putLE32(out + 4, entryCount);
+        putLE16(out + 8, (uint16_t)pathLen);
+        memcpy(out + DIR_HEADER_SIZE, dirPath.c_str(), pathLen + 1);
+        return out;
+    }
+
+    // 先写入本目录的全部条目，使同一目录的条目连续，再进入子目录
+    void addChildren(const String& dirPath, const std::vector<Child>& children, int depth) {
+        uint32_t dirIndex = dirCount - 1;
+        size_t added = 0;
+        while (added < children.size() && addEntry(dirIndex, children[added], depth)) added++;
+        for (size_t i = 0; i < added && !stats.truncated && !stats.stopped; i++) {
+            if (children[i].isDir) walk(dirPath + children[i].key, depth + 1);
+        }
+    }
+
+public:
+    NameIndexBuilder(fs::FS& fileSystem, const NameIndex* prev, const std::atomic<bool>* stopFlag,
+                     NameIndex::BuildStats& buildStats)
+        : IndexWalker(fileSystem, buildStats, NameIndex::HEADER_SIZE), previous(prev), stop(stopFlag), keyCount(0) {}
+
+    NameIndex* finish() {
+        if (entries.failed || dirs.failed || stats.stopped) return nullptr;
+        // 条目在映像中的偏移，给键排序用
+        std::vector<uint32_t> offsets;
+        offsets.reserve(entryCount);
+        uint32_t pos = NameIndex::HEADER_SIZE;
+        for (uint32_t i = 0; i < entryCount; i++) {
+            offsets.push_back(pos);
+            pos += entryRecordSize(entries.data + pos);
+        }
+        std::vector<uint32_t> keyList;
+        keyList.reserve(keyCount);
+        for (uint32_t i = 0; i < entryCount; i++) {
+            const char* name = (const char*)entries.data + offsets[i] + ENTRY_HEADER_SIZE;
+            for (uint32_t t = 0; name[t]; t++) {
+                if (NameIndex::isWordStart(name, t)) keyList.push_back((i << 8) | t);
+            }
+        }
+        std::sort(keyList.begin(), keyList.end(), KeyLess(entries.data, offsets));
+
+        uint32_t dirsSize = dirs.size;
+        uint32_t keysSize = (uint32_t)keyList.size() * KEY_SIZE;
+        uint8_t* out = entries.grow(dirsSize + keysSize);
+        if (!out && dirsSize + keysSize > 0) return nullptr;
+        if (dirsSize > 0) memcpy(out, dirs.data, dirsSize);
+        for (size_t i = 0; i < keyList.size(); i++) putLE32(out + dirsSize + i * KEY_SIZE, keyList[i]);
+
+        uint8_t* h = entries.data;
+        memcpy(h, FILE_MAGIC, sizeof(FILE_MAGIC));
+        putLE16(h + 8, NameIndex::FORMAT_VERSION);
+        putLE16(h + 10, 0);
+        putLE32(h + 12, entryCount);
+        putLE32(h + 16, dirCount);
+        putLE32(h + 20, (uint32_t)keyList.size());
+        putLE32(h + 24, entries.size - NameIndex::HEADER_SIZE);
+        putLE32(h + 28, fnv1a(h + NameIndex::HEADER_SIZE, entries.size - NameIndex::HEADER_SIZE));
+
+        NameIndex* index = new (std::nothrow) NameIndex();
+        if (!index) return nullptr;
+        uint32_t size = entries.size;
+        uint8_t* data = entries.detach();
+        if (!index->adopt(data, size)) {
+            free(data);
+            delete index;
+            return nullptr;
+        }
+        return index;
+    }
+};
+
+NameIndex* NameIndex::build(fs::FS& fs, const NameIndex* previous, const std::atomic<bool>* stop, BuildStats& stats) {
+    uint32_t startMs = millis();
+    stats = BuildStats();
+    NameIndexBuilder builder(fs, previous, stop, stats);
+    builder.walk("/", 0);
+    NameIndex* index = builder.finish();
+    stats.elapsedMs = millis() - startMs;
+    return index;
+}
+
+// ---- NameIndexLoader ----
+
+NameIndexLoader::NameIndexLoader()
+    : fs(nullptr), state(LOADER_IDLE), stopRequested(false), loadedIndex(nullptr), refreshedIndex(nullptr),
+      refreshSaved(false) {}
+
+NameIndexLoader::~NameIndexLoader() {
+    stop();
+}
+
+bool NameIndexLoader::begin(fs::FS& fileSystem) {
+    if (getState() != LOADER_IDLE) return false;
+    fs = &fileSystem;
+    stopRequested.store(false, std::memory_order_relaxed);
+    refreshSaved = false;
+    state.store(LOADER_LOADING, std::memory_order_release);
+    if (spawn()) return true;
+    // native 环境或任务创建失败：在调用线程中同步完成
+    run();
+    return true;
+}
+
+bool NameIndexLoader::spawn() {
+#ifndef NATIVE_BUILD
+    TaskHandle_t handle = nullptr;
+    return xTaskCreatePinnedToCore(taskEntry, "NameIndex", TASK_STACK_SIZE, this, TASK_PRIORITY, &handle, 0) == pdPASS;
+#else
+    return false;
+#endif
+}
+
+void NameIndexLoader::taskEntry(void* parameter) {
+    static_cast<NameIndexLoader*>(parameter)->run();
+#ifndef NATIVE_BUILD
+    vTaskDelete(nullptr);
+#endif
+}
+
+void NameIndexLoader::run() {
+    // 没有索引文件或文件损坏时由下面的刷新完整建立
+    NameIndex* base = new (std::nothrow) NameIndex();
+    if (base && !base->load(*fs)) {
+        delete base;
+        base = nullptr;
+    }
+    loadedIndex = base;
+    // release：主线程看到 REFRESHING 时 loadedIndex 已可见
+    state.store(LOADER_REFRESHING, std::memory_order_release);
+
+    NameIndex* index = NameIndex::build(*fs, base, &stopRequested, refreshStats);
+    if (index && base && index->sameContent(*base)) {
+        delete index;
+        index = nullptr;
+    } else if (index) {
+        refreshSaved = index->save(*fs);
+    }
+    refreshedIndex = index;
+    state.store(LOADER_DONE, std::memory_order_release);
+}
+
+void NameIndexLoader::stop() {
+    if (isBusy()) {
+        stopRequested.store(true, std::memory_order_relaxed);
+        // 任务每个目录条目检查一次标志
+        while (isBusy()) delay(2);
+    }
+    if (getState() == LOADER_DONE) {
+        delete loadedIndex;
+        delete refreshedIndex;
+        loadedIndex = nullptr;
+        refreshedIndex = nullptr;
+        state.store(LOADER_IDLE, std::memory_order_release);
+    }
+}
+
+NameIndex* NameIndexLoader::takeLoaded() {
+    State s = getState();
+    if (s != LOADER_REFRESHING && s != LOADER_DONE) return nullptr;
+    NameIndex* index = loadedIndex;
+    loadedIndex = nullptr;
+    return index;
+}
+
+bool NameIndexLoader::takeRefreshed(NameIndex*& index, NameIndex::BuildStats& stats, bool& saved) {
+    if (getState() != LOADER_DONE) return false;
+    index = refreshedIndex;
+    stats = refreshStats;
+    saved = refreshSaved;
+    refreshedIndex = nullptr;
+    // 旧索引没有被取走时在这里释放
+    delete loadedIndex;
+    loadedIndex = nullptr;
+    state.store(LOADER_IDLE, std::memory_order_release);
+    return true;
+}
@@ -0,0 +1,159 @@
+#pragma once
+#include <M5Cardputer.h>
+#include <FS.h>
+#include <atomic>
+
+// 文件名索引：卡上所有文件与目录的名字，保存为 /.cardputer/names.idx，供全卡搜索使用。
+//
+// 名字按"词"切分：名字开头、分隔符（空格 - _ . 等）之后、字母与数字交界处、小写转大写处，
+// 以及每个多字节字符（中文不分词，每个字都可以作为开头）。每个词的起点作为一个键，
+// 键按从该处到名字末尾的后缀（忽略 ASCII 大小写）排序，查询的第一个词二分查找出一段连续的键，
+// 其余的词逐条检查，不必遍历所有条目，也不必读卡。
+//
+// 与 LibraryIndex 相同：整个文件一次读入内存，刷新时修改时间没变的目录直接沿用旧条目。
+// 构建完成后只读，可以在任务之间传递（见 NameIndexLoader）。
+//
+// 文件格式（小端）：
+//   "CPNAMIX1" | u16 版本 | u16 保留 | u32 条目数 | u32 目录数 | u32 键数 | u32 数据长度 | u32 数据校验
+//   条目数 × (u16 所在目录 | u8 标志 | u8 名字长 | 名字\0)，同一目录的条目连续、按名字排序
+//   目录数 × (u32 修改时间 | u32 首个条目 | u16 路径长 | 路径\0)，路径以 '/' 结尾，按字节序升序
+//   键数 × u32（条目序号 << 8 | 词在名字中的偏移），按后缀排序
+
+#ifndef NAME_INDEX_MAX_BYTES
+#define NAME_INDEX_MAX_BYTES (64 * 1024)    // 索引映像上限（约 2500 个名字），超出的不收录
+#endif
+
+class NameIndex {
+public:
+    static const char* const DEFAULT_PATH;              // "/.cardputer/names.idx"
+    static const uint16_t FORMAT_VERSION = 1;
+    static const uint32_t HEADER_SIZE = 32;
+    static const uint32_t MAX_BYTES = NAME_INDEX_MAX_BYTES;
+    static const int MAX_DEPTH = 8;                     // 目录递归深度上限
+    static const uint32_t MAX_DIRS = 0xFFFF;
+
+    enum EntryFlags {
+        ENTRY_DIR = 0x01
+    };
+
+    struct BuildStats {
+        uint32_t dirsVisited;
+        uint32_t dirsRescanned;     // 修改时间变化（或未知）而重新列出的目录
+        uint32_t entriesReused;     // 沿用旧索引的条目
+        uint32_t elapsedMs;
+        bool truncated;             // 超过 MAX_BYTES 或 MAX_DIRS，后面的没有收录
+        bool stopped;               // 被 stop 标志中止
+
+        BuildStats() : dirsVisited(0), dirsRescanned(0), entriesReused(0), elapsedMs(0), truncated(false), stopped(false) {}
+    };
+
+private:
+    uint8_t* image;
+    uint32_t imageSize;
+    uint32_t* entryOffsets;
+    uint32_t entryCount;
+    uint32_t* dirOffsets;
+    uint32_t dirCount;
+    const uint8_t* keys;            // 指向映像中的键表
+    uint32_t keyCount;
+
+    NameIndex(const NameIndex&);
+    NameIndex& operator=(const NameIndex&);
+
+    bool adopt(uint8_t* data, uint32_t size);
+    void freeImage();
+
+    const uint8_t* entryAt(uint32_t i) const { return image + entryOffsets[i]; }
+    const uint8_t* dirAt(uint32_t i) const { return image + dirOffsets[i]; }
+    uint32_t keyAt(uint32_t i) const;
+    const char* keySuffix(uint32_t i) const;
+
+    friend class NameIndexBuilder;
+
+public:
+    NameIndex();
+    ~NameIndex();
+
+    uint32_t getEntryCount() const { return entryCount; }
+    const char* getName(uint32_t i) const;
+    bool isDirectory(uint32_t i) const;
+    uint32_t getDirIndex(uint32_t i) const;
+    // 完整路径（目录不带结尾的 '/'）
+    String getPath(uint32_t i) const;
+
+    uint32_t getDirCount() const { return dirCount; }
+    const char* getDirPath(uint32_t i) const;   // 以 '/' 结尾
+    uint32_t getDirMtime(uint32_t i) const;
+    uint32_t getDirFirstEntry(uint32_t i) const;
+    uint32_t getDirEntryCount(uint32_t i) const;
+    int32_t findDir(const char* dirPath) const;
+
+    uint32_t getKeyCount() const { return keyCount; }
+    uint32_t getImageSize() const { return imageSize; }
+    bool sameContent(const NameIndex& other) const;
+
+    // 按空格分成若干词，每个词都要与名字中某个词的开头匹配（忽略 ASCII 大小写，顺序不限）。
+    // 按第一个词的键序把最多 maxResults 个条目写入 results，返回匹配总数（数到 countLimit 为止）
+    uint32_t search(const char* query, uint32_t* results, uint32_t maxResults, uint32_t countLimit) const;
+
+    bool load(fs::FS& fs, const char* path = DEFAULT_PATH);
+    // 先写临时文件再替换
+    bool save(fs::FS& fs, const char* path = DEFAULT_PATH) const;
+
+    // 扫描整张卡（跳过隐藏文件与目录）生成新索引；previous 为旧索引（可为空）。
+    // stop 非空且被置位时尽快返回 nullptr；内存不足时也返回 nullptr
+    static NameIndex* build(fs::FS& fs, const NameIndex* previous, const std::atomic<bool>* stop, BuildStats& stats);
+
+    // 名字中 pos 处是否为一个词的开头
+    static bool isWordStart(const char* name, uint32_t pos);
+};
+
+// 后台读入并刷新名字索引：任务先读入卡上的旧索引（LOADED，主线程即可用它搜索），
+// 然后对照卡上内容刷新，结果写回卡上（DONE）。与 StorageLoader 相同，任务创建失败或 native 环境时同步执行。
+class NameIndexLoader {
+public:
+    enum State {
+        LOADER_IDLE,
+        LOADER_LOADING,
+        LOADER_REFRESHING,      // 旧索引已读入
+        LOADER_DONE             // 刷新结果待主线程取走
+    };
+
+    static const uint32_t TASK_STACK_SIZE = 8192;   // 递归扫描目录
+    static const int TASK_PRIORITY = 1;             // 低于音频任务
+
+private:
+    fs::FS* fs;
+    std::atomic<int> state;
+    std::atomic<bool> stopRequested;
+    NameIndex* loadedIndex;         // 卡上原有的索引（没有或损坏时为 nullptr），由 takeLoaded 取走
+    NameIndex* refreshedIndex;      // 刷新结果；没有变化、被中止或失败时为 nullptr
+    NameIndex::BuildStats refreshStats;
+    bool refreshSaved;
+
+    NameIndexLoader(const NameIndexLoader&);
+    NameIndexLoader& operator=(const NameIndexLoader&);
+
+    static void taskEntry(void* parameter);
+    bool spawn();
+    void run();
+
+public:
+    NameIndexLoader();
+    ~NameIndexLoader();
+
+    // 开始读入并刷新；已在运行或结果未取走时返回 false
+    bool begin(fs::FS& fileSystem);
+    // 请求中止并等待任务退出，之后回到空闲（未取走的索引一并释放）
+    void stop();
+
+    State getState() const { return (State)state.load(std::memory_order_acquire); }
+    bool isBusy() const {
+        State s = getState();
+        return s == LOADER_LOADING || s == LOADER_REFRESHING;
+    }
+    // LOADING 之后取走旧索引，只能取一次；任务仍以它为对照刷新，DONE 之前调用者不能释放
+    NameIndex* takeLoaded();
+    // DONE 之后取走刷新结果（所有权交给调用者）并回到空闲
+    bool takeRefreshed(NameIndex*& index, NameIndex::BuildStats& stats, bool& saved);
+};
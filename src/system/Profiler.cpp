@@ -0,0 +1,105 @@
+#include "system/Profiler.h"
+
+#ifdef ENABLE_UI_PROFILER
+#include "esp_heap_caps.h"
+#include <new>
+#include <stdlib.h>
+
+Profiler globalProfiler;
+
+#ifndef NATIVE_BUILD
+// 统计每帧堆分配次数。Arduino String 的缓冲区走 realloc，不经过这里，
+// 完整的分配统计以 native 基准为准（主机端 String 基于 std::string）。
+// 替换全局 operator new 必须保留标准语义：普通版本失败时抛出 std::bad_alloc（未启用异常时 abort），
+// nothrow 版本返回 nullptr——各处的 new (std::nothrow) 都依赖这一点
+static void* countedAlloc(size_t size) {
+    globalProfiler.addAlloc();
+    return malloc(size ? size : 1);
+}
+
+static void* countedAllocOrFail(size_t size) {
+    void* p = countedAlloc(size);
+    if (!p) {
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+        throw std::bad_alloc();
+#else
+        abort();
+#endif
+    }
+    return p;
+}
+
+void* operator new(size_t size) { return countedAllocOrFail(size); }
+void* operator new[](size_t size) { return countedAllocOrFail(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { free(p); }
+#endif
+
+static const char* const kSectionNames[PROF_SECTION_COUNT] = {
+    "tick", "update", "flush",
+    "label", "button", "window", "list", "grid", "slider", "image", "other"
+};
+
+void Profiler::drawOverlay(LGFX_Device* display, uint32_t nowMs) {
+    if (!overlayEnabled || !display) return;
+    if (lastOverlayMs != 0 && nowMs - lastOverlayMs < 250) return;
+    lastOverlayMs = nowMs;
+
+    // 浮层固定位于左下角，使用 6x8 点阵字体以减少占用面积
+    const int lineH = 8;
+    const int boxW = 138;
+    const int boxX = 0;
+    int lines = 4;
+    for (int i = PROF_DRAW_LABEL; i < PROF_SECTION_COUNT; i++) {
+        if (lastFrame.calls[i] > 0) lines++;
+    }
+    int boxH = lines * lineH + 2;
+    int boxY = display->height() - boxH;
+
+    display->fillRect(boxX, boxY, boxW, boxH, TFT_BLACK);
+    display->drawRect(boxX, boxY, boxW, boxH, TFT_DARKGREY);
+    display->setFont(&fonts::Font0);
+    display->setTextSize(1);
+    display->setTextColor(TFT_GREEN, TFT_BLACK);
+
+    char line[48];
+    int y = boxY + 1;
+    snprintf(line, sizeof(line), "tick %luus upd %luus",
+             (unsigned long)cyclesToUs(lastFrame.cycles[PROF_TICK]),
+             (unsigned long)cyclesToUs(lastFrame.cycles[PROF_UPDATE]));
+    display->drawString(line, boxX + 2, y); y += lineH;
+    snprintf(line, sizeof(line), "flush %luus x%lu",
+             (unsigned long)cyclesToUs(lastFrame.cycles[PROF_FLUSH]),
+             (unsigned long)lastFrame.calls[PROF_FLUSH]);
+    display->drawString(line, boxX + 2, y); y += lineH;
+
+    display->setTextColor(TFT_CYAN, TFT_BLACK);
+    for (int i = PROF_DRAW_LABEL; i < PROF_SECTION_COUNT; i++) {
+        if (lastFrame.calls[i] == 0) continue;
+        snprintf(line, sizeof(line), "%-6s %6luus x%lu", kSectionNames[i],
+                 (unsigned long)cyclesToUs(lastFrame.cycles[i]),
+                 (unsigned long)lastFrame.calls[i]);
+        display->drawString(line, boxX + 2, y); y += lineH;
+    }
+
+    display->setTextColor(TFT_YELLOW, TFT_BLACK);
+    snprintf(line, sizeof(line), "px %lu %luB new %lu",
+             (unsigned long)lastFrame.pixels, (unsigned long)lastFrame.bytes,
+             (unsigned long)lastFrame.allocs);
+    display->drawString(line, boxX + 2, y); y += lineH;
+
+    size_t psramLargest = heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM);
+    UBaseType_t stackFree = watchedTask ? uxTaskGetStackHighWaterMark(watchedTask) : 0;
+    snprintf(line, sizeof(line), "heap %lu ps %lu stk %lu",
+             (unsigned long)ESP.getFreeHeap(), (unsigned long)psramLargest,
+             (unsigned long)stackFree);
+    display->drawString(line, boxX + 2, y);
+}
+
+#endif
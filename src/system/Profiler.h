@@ -0,0 +1,120 @@
+#pragma once
+#include <M5Cardputer.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// 渲染性能分析器
+// 通过编译开关 ENABLE_UI_PROFILER 启用（见 platformio.ini 的 build_flags）。
+// 未定义时下方所有 PROFILE_* 宏展开为空语句，不产生任何代码。
+
+// 计时分段（控件绘制按控件类型区分，对应各主题的 drawXxx 调用）
+enum ProfileSection {
+    PROF_TICK,          // UIManager::tick 总耗时
+    PROF_UPDATE,        // 控件 update() 动画推进
+    PROF_FLUSH,         // flushDirtyInAppArea / flushDirtyInRoot
+    PROF_DRAW_LABEL,
+    PROF_DRAW_BUTTON,
+    PROF_DRAW_WINDOW,
+    PROF_DRAW_LIST,
+    PROF_DRAW_GRID,
+    PROF_DRAW_SLIDER,
+    PROF_DRAW_IMAGE,
+    PROF_DRAW_OTHER,
+    PROF_SECTION_COUNT
+};
+
+#ifdef ENABLE_UI_PROFILER
+
+class Profiler {
+public:
+    // 单帧统计快照
+    struct FrameStats {
+        uint32_t cycles[PROF_SECTION_COUNT];
+        uint32_t calls[PROF_SECTION_COUNT];
+        uint32_t pixels;        // 推送到屏幕的像素（按裁剪矩形面积计，为上界）
+        uint32_t bytes;         // 经 SPI 推送的字节数（RGB565，每像素2字节）
+        uint32_t allocs;        // 本帧 operator new 调用次数（稳态绘制应为 0）
+    };
+
+private:
+    FrameStats current;         // 正在累计的帧
+    FrameStats lastFrame;       // 最近一个有绘制的帧
+    bool overlayEnabled;
+    uint32_t lastOverlayMs;
+    TaskHandle_t watchedTask;   // 需要监视栈水位的任务（AudioTask）
+
+public:
+    Profiler() : overlayEnabled(false), lastOverlayMs(0), watchedTask(nullptr) {
+        memset(&current, 0, sizeof(current));
+        memset(&lastFrame, 0, sizeof(lastFrame));
+    }
+
+    static inline uint32_t now() { return ESP.getCycleCount(); }
+
+    void addCycles(ProfileSection section, uint32_t cycles) {
+        current.cycles[section] += cycles;
+        current.calls[section]++;
+    }
+
+    void addAlloc() { current.allocs++; }
+
+    void addPixels(uint32_t count) {
+        current.pixels += count;
+        current.bytes += count * 2;
+    }
+
+    // 每次 tick 结束时调用：有绘制的帧才会替换显示用的快照
+    void endFrame() {
+        if (current.pixels > 0) {
+            lastFrame = current;
+        }
+        memset(&current, 0, sizeof(current));
+    }
+
+    const FrameStats& getLastFrame() const { return lastFrame; }
+
+    void watchTask(TaskHandle_t task) { watchedTask = task; }
+
+    bool isOverlayEnabled() const { return overlayEnabled; }
+    void toggleOverlay() { overlayEnabled = !overlayEnabled; lastOverlayMs = 0; }
+
+    // 以约 4Hz 的频率在屏幕左下角绘制统计浮层
+    void drawOverlay(LGFX_Device* display, uint32_t nowMs);
+
+    static uint32_t cyclesToUs(uint32_t cycles) {
+        uint32_t mhz = getCpuFrequencyMhz();
+        return mhz ? cycles / mhz : cycles;
+    }
+};
+
+// 作用域计时器：构造时记录周期计数，析构时累计到对应分段
+class ProfileScope {
+private:
+    ProfileSection section;
+    uint32_t start;
+public:
+    explicit ProfileScope(ProfileSection s) : section(s), start(Profiler::now()) {}
+    ~ProfileScope();
+};
+
+extern Profiler globalProfiler;
+
+inline ProfileScope::~ProfileScope() {
+    globalProfiler.addCycles(section, Profiler::now() - start);
+}
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(section) ProfileScope PROFILE_CONCAT(_profScope, __LINE__)(section)
+#define PROFILE_PIXELS(count) globalProfiler.addPixels(count)
+#define PROFILE_END_FRAME() globalProfiler.endFrame()
+#define PROFILE_WATCH_TASK(task) globalProfiler.watchTask(task)
+
+#else
+
+#define PROFILE_SCOPE(section) do {} while (0)
+#define PROFILE_PIXELS(count) do {} while (0)
+#define PROFILE_END_FRAME() do {} while (0)
+#define PROFILE_WATCH_TASK(task) do {} while (0)
+
+#endif
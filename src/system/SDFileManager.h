@@ -2,6 +2,7 @@
 #include <M5Cardputer.h>
 #include <SD.h>
 #include <SPI.h>
+#include "system/Vfs.h"
 
 // SD卡SPI引脚定义
 #define SD_SPI_SCK_PIN  40
@@ -21,11 +22,129 @@ struct FileInfo {
         : name(n), path(p), isDirectory(isDir), size(s) {}
 };
 
+// 目录游标：按页逐批读取目录项，保持目录句柄与读取位置，大目录不必一次读完。
+// 非根目录先返回 ".."，隐藏文件（以 . 开头）被跳过。目录句柄只能向前读，
+// 回到前面的位置需要 rewind() 后 skip()，代价与跳过的条目数成正比。
+// 读出的条目顺带记入 Vfs 的目录项缓存，随后进入子目录或查询文件时不必再打开。
+class DirCursor {
+private:
+    Vfs* vfs;
+    File dir;
+    String dirPath;         // 规范化路径
+    uint32_t position;      // 已经读过的条目数（含 ".."）
+    bool parentPending;     // ".." 尚未返回
+    bool done;
+
+    DirCursor(const DirCursor&);
+    DirCursor& operator=(const DirCursor&);
+
+    // 读取下一个可见的目录项；out 为空时只前进，不取大小
+    bool advance(FileInfo* out) {
+        if (done) return false;
+        if (parentPending) {
+            parentPending = false;
+            position++;
+            if (out) *out = FileInfo("..", "", true, 0);
+            return true;
+        }
+        File file = dir.openNextFile();
+        while (file) {
+            String displayName = file.name();
+            int lastSlash = displayName.lastIndexOf('/');
+            if (lastSlash != -1) {
+                displayName = displayName.substring(lastSlash + 1);
+            }
+            // 跳过隐藏文件和无效文件名
+            if (displayName.length() > 0 && !displayName.startsWith(".")) {
+                if (out) {
+                    String fullPath = dirPath;
+                    if (!fullPath.endsWith("/")) fullPath += "/";
+                    fullPath += displayName;
+                    bool isDir = file.isDirectory();
+                    *out = FileInfo(displayName, fullPath, isDir, isDir ? 0 : file.size());
+                    VfsStat st;
+                    st.exists = true;
+                    st.isDirectory = isDir;
+                    st.size = out->size;
+                    vfs->remember(fullPath, st);
+                }
+                file.close();
+                position++;
+                return true;
+            }
+            file.close();
+            file = dir.openNextFile();
+        }
+        done = true;
+        return false;
+    }
+
+public:
+    DirCursor() : vfs(nullptr), position(0), parentPending(false), done(true) {}
+    ~DirCursor() { close(); }
+
+    // path 须为规范化路径；不是目录时返回 false
+    bool open(Vfs& fileSystem, const String& path) {
+        close();
+        vfs = &fileSystem;
+        dir = fileSystem.open(path);
+        if (!dir || !dir.isDirectory()) {
+            dir.close();
+            return false;
+        }
+        dirPath = path;
+        return rewind();
+    }
+
+    void close() {
+        if (dir) dir.close();
+        dir = File();
+        position = 0;
+        parentPending = false;
+        done = true;
+    }
+
+    // 回到第一个条目
+    bool rewind() {
+        if (!dir) return false;
+        dir.rewindDirectory();
+        position = 0;
+        parentPending = dirPath != "/";
+        done = false;
+        return true;
+    }
+
+    // 读取最多 maxCount 个条目，返回实际读取的数量；少于 maxCount 时已读到末尾
+    int next(FileInfo* out, int maxCount) {
+        int count = 0;
+        while (count < maxCount && advance(&out[count])) count++;
+        return count;
+    }
+
+    // 跳过 count 个条目，返回实际跳过的数量
+    uint32_t skip(uint32_t count) {
+        uint32_t skipped = 0;
+        while (skipped < count && advance(nullptr)) skipped++;
+        return skipped;
+    }
+
+    bool isOpen() const { return (bool)dir; }
+    bool isDone() const { return done; }
+    uint32_t getPosition() const { return position; }
+    const String& getPath() const { return dirPath; }
+};
+
 // SD卡文件管理器类
 class SDFileManager {
 private:
-    bool initialized;
+    volatile bool initialized;      // 可能由后台加载任务置位（见 StorageLoader）
     String currentPath;
+#ifdef NATIVE_BUILD
+    HostBackend backend;
+#else
+    FsBackend backend;              // SD.begin 默认挂载在 "/sd"
+#endif
+    Vfs vfs;                        // 主线程的文件访问都经过这里，重复的状态查询走缓存
     
     // 规范化路径
     String normalizePath(const String& path) {
@@ -40,7 +159,11 @@ private:
     }
     
 public:
-    SDFileManager() : initialized(false), currentPath("/") {}
+#ifdef NATIVE_BUILD
+    SDFileManager() : initialized(false), currentPath("/"), backend(SD), vfs(&backend) {}
+#else
+    SDFileManager() : initialized(false), currentPath("/"), backend(SD, "/sd"), vfs(&backend) {}
+#endif
     
     // 初始化SD卡
     bool initialize() {
@@ -52,14 +175,16 @@ public:
             return false;
         }
         
-        initialized = true;
         currentPath = "/";
+        initialized = true;
         return true;
     }
     
     // 检查是否已初始化
     bool isInitialized() const { return initialized; }
     
+    Vfs& getVfs() { return vfs; }
+    
     // 获取当前路径
     String getCurrentPath() const { return currentPath; }
     
@@ -68,7 +193,8 @@ public:
         if (!initialized) return false;
         
         String newPath = normalizePath(path);
-        if (!exists(newPath) || !isDirectory(newPath)) return false;
+        VfsStat st;
+        if (!vfs.stat(newPath, st) || !st.isDirectory) return false;
         
         currentPath = newPath;
         return true;
@@ -77,74 +203,28 @@ public:
     // 检查文件/目录是否存在
     bool exists(const String& path) {
         if (!initialized) return false;
-        File file = SD.open(path);
-        bool result = (bool)file;
-        file.close();
-        return result;
+        return vfs.exists(path);
     }
     
     // 检查是否为目录
     bool isDirectory(const String& path) {
         if (!initialized) return false;
-        File file = SD.open(path);
-        bool result = file && file.isDirectory();
-        file.close();
-        return result;
+        return vfs.isDirectory(path);
     }
     
-    // 列出目录内容
-    bool listDirectory(const String& dirPath, FileInfo* fileList, int& fileCount, int maxFiles) {
+    // 打开目录游标（dirPath 为空时为当前目录），之后按页读取
+    bool openDirectory(const String& dirPath, DirCursor& cursor) {
         if (!initialized) return false;
-        
-        fileCount = 0;
         String targetPath = dirPath.isEmpty() ? currentPath : normalizePath(dirPath);
-        
-        File dir = SD.open(targetPath);
-        if (!dir || !dir.isDirectory()) {
-            dir.close();
-            return false;
-        }
-        
-        // 添加返回上级目录项（非根目录）
-        if (targetPath != "/" && fileCount < maxFiles) {
-            fileList[fileCount++] = FileInfo("..", "", true, 0);
-        }
-        
-        dir.rewindDirectory();
-        File file = dir.openNextFile();
-        
-        while (file && fileCount < maxFiles) {
-            String fileName = file.name();
-            String displayName = fileName;
-            
-            // 提取文件名
-            int lastSlash = displayName.lastIndexOf('/');
-            if (lastSlash != -1) {
-                displayName = displayName.substring(lastSlash + 1);
-            }
-            
-            // 跳过隐藏文件和无效文件名
-            if (displayName.length() == 0 || displayName.startsWith(".")) {
-                file.close();
-                file = dir.openNextFile();
-                continue;
-            }
-            
-            // 构建完整路径
-            String fullPath = targetPath;
-            if (!fullPath.endsWith("/")) fullPath += "/";
-            fullPath += displayName;
-            
-            bool isDir = file.isDirectory();
-            size_t fileSize = isDir ? 0 : file.size();
-            
-            fileList[fileCount++] = FileInfo(displayName, fullPath, isDir, fileSize);
-            
-            file.close();
-            file = dir.openNextFile();
-        }
-        
-        dir.close();
+        return cursor.open(vfs, targetPath);
+    }
+    
+    // 列出目录内容（最多 maxFiles 项，其余截断）
+    bool listDirectory(const String& dirPath, FileInfo* fileList, int& fileCount, int maxFiles) {
+        fileCount = 0;
+        DirCursor cursor;
+        if (!openDirectory(dirPath, cursor)) return false;
+        fileCount = cursor.next(fileList, maxFiles);
         return true;
     }
     
@@ -178,19 +258,23 @@ public:
         return setCurrentPath(newPath);
     }
     
-    // 读取文件内容
+    // 读取文件内容（不存在时返回空串，调用前不必先检查 exists）
     String readFile(const String& filePath) {
         if (!initialized) return "";
         
-        File file = SD.open(filePath);
+        File file = vfs.open(filePath);
         if (!file || file.isDirectory()) {
             file.close();
             return "";
         }
         
+        // 按文件大小一次预留，分块读取
         String content = "";
-        while (file.available()) {
-            content += (char)file.read();
+        content.reserve(file.size());
+        char chunk[512];
+        size_t n;
+        while ((n = file.read((uint8_t*)chunk, sizeof(chunk))) > 0) {
+            content.concat(chunk, n);
         }
         
         file.close();
@@ -208,7 +292,7 @@ public:
     bool scanDirectoryRecursive(const String& dirPath, FileInfo* fileList, int& fileCount, int maxFiles, const String& extension = "") {
         if (!initialized || fileCount >= maxFiles) return false;
         
-        File dir = SD.open(dirPath);
+        File dir = vfs.open(dirPath);
         if (!dir || !dir.isDirectory()) {
             dir.close();
             return false;
@@ -261,4 +345,13 @@ public:
         ext.toLowerCase();
         return ext == ".mp3" || ext == ".wav" || ext == ".m4a" || ext == ".aac";
     }
+    
+    // 用文本查看器打开的文件
+    bool isTextFile(const String& fileName) {
+        String ext = getFileExtension(fileName);
+        ext.toLowerCase();
+        return ext == ".txt" || ext == ".log" || ext == ".lrc" || ext == ".md" || ext == ".csv" ||
+               ext == ".json" || ext == ".ini" || ext == ".cfg" || ext == ".xml" || ext == ".htm" ||
+               ext == ".html" || ext == ".c" || ext == ".cpp" || ext == ".h" || ext == ".py";
+    }
 };
@@ -0,0 +1,80 @@
+#include "system/ScreenCapture.h"
+#include "system/BinaryUtil.h"
+#include <new>
+
+const char* const ScreenCapture::DEFAULT_DIR = "/screenshots";
+
+bool ScreenCapture::saveBmp(LGFX_Device* display, fs::FS& fs, const String& path) {
+    if (!display || !display->getPanel() || !display->getPanel()->config().readable) return false;
+    int w = display->width();
+    int h = display->height();
+    if (w <= 0 || h <= 0) return false;
+
+    uint32_t rowBytes = ((uint32_t)w * 3 + 3) & ~3u;    // BMP 每行按 4 字节对齐
+    uint32_t imageSize = rowBytes * (uint32_t)h;
+    uint16_t* line = new (std::nothrow) uint16_t[w];
+    uint8_t* row = new (std::nothrow) uint8_t[rowBytes];
+    if (!line || !row) {
+        delete[] line;
+        delete[] row;
+        return false;
+    }
+
+    File file = fs.open(path, FILE_WRITE);
+    if (!file) {
+        delete[] line;
+        delete[] row;
+        return false;
+    }
+
+    // BITMAPFILEHEADER + BITMAPINFOHEADER，高度为正表示自下而上存储
+    uint8_t header[54];
+    memset(header, 0, sizeof(header));
+    header[0] = 'B';
+    header[1] = 'M';
+    putLE32(header + 2, 54 + imageSize);
+    putLE32(header + 10, 54);
+    putLE32(header + 14, 40);
+    putLE32(header + 18, (uint32_t)w);
+    putLE32(header + 22, (uint32_t)h);
+    putLE16(header + 26, 1);
+    putLE16(header + 28, 24);
+    putLE32(header + 34, imageSize);
+    putLE32(header + 38, 2835);     // 72 DPI
+    putLE32(header + 42, 2835);
+    bool ok = file.write(header, sizeof(header)) == sizeof(header);
+
+    memset(row, 0, rowBytes);
+    for (int y = h - 1; ok && y >= 0; y--) {
+        display->readRect(0, y, w, 1, line);
+        for (int x = 0; x < w; x++) {
+            // readRect 读回的是高字节在前的 RGB565
+            uint16_t c = (uint16_t)((line[x] >> 8) | (line[x] << 8));
+            uint8_t r5 = (c >> 11) & 0x1F;
+            uint8_t g6 = (c >> 5) & 0x3F;
+            uint8_t b5 = c & 0x1F;
+            row[x * 3 + 0] = (uint8_t)((b5 << 3) | (b5 >> 2));
+            row[x * 3 + 1] = (uint8_t)((g6 << 2) | (g6 >> 4));
+            row[x * 3 + 2] = (uint8_t)((r5 << 3) | (r5 >> 2));
+        }
+        ok = file.write(row, rowBytes) == rowBytes;
+    }
+    file.close();
+    delete[] line;
+    delete[] row;
+    if (!ok) fs.remove(path);
+    return ok;
+}
+
+bool ScreenCapture::captureToDir(LGFX_Device* display, fs::FS& fs, const char* dir, String& outPath) {
+    if (!dir) dir = DEFAULT_DIR;
+    if (!fs.exists(dir) && !fs.mkdir(dir)) return false;
+    char name[64];
+    for (int i = 1; i < 10000; i++) {
+        snprintf(name, sizeof(name), "%s/shot_%04d.bmp", dir, i);
+        if (fs.exists(name)) continue;
+        outPath = name;
+        return saveBmp(display, fs, outPath);
+    }
+    return false;
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <M5Cardputer.h>
+#include <FS.h>
+
+// 屏幕截图：逐行 readRect 读回并直接写成 24 位 BMP。
+// 只分配一行像素与一行 BMP 数据（240 宽约 1.2KB），不复制整帧，
+// 音乐播放等占用内存较多的场景下也能使用。
+class ScreenCapture {
+public:
+    static const char* const DEFAULT_DIR;   // "/screenshots"
+
+    // 把 display 当前内容写到 path；面板不可读回、缓冲分配或写文件失败时返回 false
+    static bool saveBmp(LGFX_Device* display, fs::FS& fs, const String& path);
+
+    // 在 dir 下按 shot_0001.bmp、shot_0002.bmp… 选择第一个未使用的文件名并保存
+    static bool captureToDir(LGFX_Device* display, fs::FS& fs, const char* dir, String& outPath);
+};
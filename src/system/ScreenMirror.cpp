@@ -0,0 +1,214 @@
+#include "system/ScreenMirror.h"
+#include <new>
+
+static const uint8_t MIRROR_MAGIC0 = 0xA5;
+static const uint8_t MIRROR_MAGIC1 = 0x5A;
+static const uint8_t MIRROR_HELLO = 0x01;
+static const uint8_t MIRROR_ROW = 0x02;
+static const uint8_t MIRROR_REPEAT = 0x03;
+static const uint8_t MIRROR_FRAME = 0x04;
+
+static inline void putU16(uint8_t* out, int v) {
+    out[0] = (uint8_t)(v & 0xFF);
+    out[1] = (uint8_t)((v >> 8) & 0xFF);
+}
+
+ScreenMirror::ScreenMirror(LGFX_Device* _display)
+    : display(_display), active(false), lineCapacity(0),
+      lineBuf(nullptr), prevLine(nullptr), packetBuf(nullptr),
+      pendingCount(0), prevValid(false), frameOpen(false), frameSeq(0),
+      bytesPerSecond(DEFAULT_BYTES_PER_SECOND), budget(0), lastRefillMs(0), bytesSent(0) {}
+
+ScreenMirror::~ScreenMirror() {
+    releaseBuffers();
+}
+
+void ScreenMirror::releaseBuffers() {
+    delete[] lineBuf;
+    delete[] prevLine;
+    delete[] packetBuf;
+    lineBuf = nullptr;
+    prevLine = nullptr;
+    packetBuf = nullptr;
+    lineCapacity = 0;
+}
+
+size_t ScreenMirror::maxRowPacket() const {
+    // 包头 11 字节 + 全部为字面像素时每 128 像素多 1 个控制字节
+    return 11 + (size_t)lineCapacity * 2 + (lineCapacity + 127) / 128;
+}
+
+bool ScreenMirror::begin(uint32_t _bytesPerSecond) {
+    if (active) return true;
+    if (!display || !display->getPanel() || !display->getPanel()->config().readable) {
+        Serial.println("ScreenMirror: panel is not readable");
+        return false;
+    }
+    int w = display->width();
+    int h = display->height();
+    if (w <= 0 || h <= 0) return false;
+    lineCapacity = w;
+    lineBuf = new (std::nothrow) uint16_t[w];
+    prevLine = new (std::nothrow) uint16_t[w];
+    packetBuf = new (std::nothrow) uint8_t[maxRowPacket()];
+    if (!lineBuf || !prevLine || !packetBuf) {
+        releaseBuffers();
+        return false;
+    }
+    // 默认的 CDC 发送缓冲放不下一整行，扩大后才能按行整包写入而不阻塞
+    Serial.setTxBufferSize(4096);
+    bytesPerSecond = _bytesPerSecond > 0 ? _bytesPerSecond : DEFAULT_BYTES_PER_SECOND;
+    budget = (uint32_t)maxRowPacket() * 2;
+    lastRefillMs = millis();
+    bytesSent = 0;
+    pendingCount = 0;
+    prevValid = false;
+    frameOpen = false;
+    active = true;
+
+    uint8_t hello[7];
+    putHeader(hello, MIRROR_HELLO);
+    putU16(hello + 3, w);
+    putU16(hello + 5, h);
+    Serial.write(hello, sizeof(hello));
+    bytesSent += sizeof(hello);
+    markDirty(0, 0, w, h);
+    return true;
+}
+
+void ScreenMirror::end() {
+    if (!active) return;
+    active = false;
+    pendingCount = 0;
+    releaseBuffers();
+}
+
+void ScreenMirror::putHeader(uint8_t* out, uint8_t type) const {
+    out[0] = MIRROR_MAGIC0;
+    out[1] = MIRROR_MAGIC1;
+    out[2] = type;
+}
+
+void ScreenMirror::markDirty(int x, int y, int w, int h) {
+    if (!active) return;
+    int sw = display->width();
+    int sh = display->height();
+    int nx = max(x, 0);
+    int ny = max(y, 0);
+    int rx = min(x + w, sw);
+    int by = min(y + h, sh);
+    if (rx <= nx || by <= ny) return;
+
+    // 与已有区域相交时合并；区域表满时并入使外接矩形面积增长最小的一项
+    int best = -1;
+    long bestGrowth = 0;
+    for (int i = 0; i < pendingCount; i++) {
+        Rect& r = pending[i];
+        int ux = min(r.x, nx), uy = min(r.y, ny);
+        int ur = max(r.x + r.w, rx), ub = max(r.y + r.h, by);
+        long growth = (long)(ur - ux) * (ub - uy) - (long)r.w * r.h;
+        bool overlaps = nx < r.x + r.w && r.x < rx && ny < r.y + r.h && r.y < by;
+        if (overlaps || (pendingCount == MAX_PENDING && (best < 0 || growth < bestGrowth))) {
+            best = i;
+            bestGrowth = growth;
+            if (overlaps) break;
+        }
+    }
+    if (best < 0) {
+        Rect& r = pending[pendingCount++];
+        r.x = nx; r.y = ny; r.w = rx - nx; r.h = by - ny;
+        return;
+    }
+    Rect& r = pending[best];
+    int ux = min(r.x, nx), uy = min(r.y, ny);
+    int ur = max(r.x + r.w, rx), ub = max(r.y + r.h, by);
+    r.x = ux; r.y = uy; r.w = ur - ux; r.h = ub - uy;
+    if (best == 0) prevValid = false;   // 正在发送的区域变了，上一行不再可作参照
+}
+
+size_t ScreenMirror::encodeRow(const uint16_t* px, int w, uint8_t* out) const {
+    size_t n = 0;
+    int i = 0;
+    while (i < w) {
+        int run = 1;
+        while (i + run < w && run < 128 && px[i + run] == px[i]) run++;
+        if (run >= 2) {
+            out[n++] = (uint8_t)(0x80 | (run - 1));
+            memcpy(out + n, &px[i], 2);
+            n += 2;
+            i += run;
+            continue;
+        }
+        // 字面段一直延伸到下一段至少 3 像素的重复为止
+        int start = i;
+        int count = 0;
+        while (i < w && count < 128) {
+            if (i + 2 < w && px[i] == px[i + 1] && px[i] == px[i + 2]) break;
+            i++;
+            count++;
+        }
+        out[n++] = (uint8_t)(count - 1);
+        memcpy(out + n, &px[start], (size_t)count * 2);
+        n += (size_t)count * 2;
+    }
+    return n;
+}
+
+void ScreenMirror::sendFrameEnd() {
+    uint8_t frame[5];
+    putHeader(frame, MIRROR_FRAME);
+    putU16(frame + 3, frameSeq++);
+    Serial.write(frame, sizeof(frame));
+    bytesSent += sizeof(frame);
+    frameOpen = false;
+}
+
+void ScreenMirror::flush(uint32_t nowMs) {
+    if (!active) return;
+    uint32_t elapsed = nowMs - lastRefillMs;
+    lastRefillMs = nowMs;
+    if (elapsed > 1000) elapsed = 1000;
+    uint32_t cap = max(bytesPerSecond / 20, (uint32_t)maxRowPacket() * 2);
+    budget += elapsed * bytesPerSecond / 1000;
+    if (budget > cap) budget = cap;
+
+    while (pendingCount > 0) {
+        Rect& r = pending[0];
+        while (r.h > 0) {
+            if (budget < maxRowPacket()) return;
+            display->readRect(r.x, r.y, r.w, 1, lineBuf);
+            size_t n;
+            if (prevValid && memcmp(lineBuf, prevLine, (size_t)r.w * 2) == 0) {
+                putHeader(packetBuf, MIRROR_REPEAT);
+                putU16(packetBuf + 3, r.x);
+                putU16(packetBuf + 5, r.y);
+                putU16(packetBuf + 7, r.w);
+                n = 9;
+            } else {
+                size_t len = encodeRow(lineBuf, r.w, packetBuf + 11);
+                putHeader(packetBuf, MIRROR_ROW);
+                putU16(packetBuf + 3, r.x);
+                putU16(packetBuf + 5, r.y);
+                putU16(packetBuf + 7, r.w);
+                putU16(packetBuf + 9, (int)len);
+                n = 11 + len;
+            }
+            // 串口缓冲放不下时不阻塞，这一行留到下一次重新读回
+            if (Serial.availableForWrite() < (int)n) return;
+            Serial.write(packetBuf, n);
+            budget -= n;
+            bytesSent += n;
+            frameOpen = true;
+            uint16_t* t = prevLine;
+            prevLine = lineBuf;
+            lineBuf = t;
+            prevValid = true;
+            r.y++;
+            r.h--;
+        }
+        for (int i = 1; i < pendingCount; i++) pending[i - 1] = pending[i];
+        pendingCount--;
+        prevValid = false;
+    }
+    if (frameOpen) sendFrameEnd();
+}
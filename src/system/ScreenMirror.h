@@ -0,0 +1,61 @@
+#pragma once
+#include <M5Cardputer.h>
+
+// 屏幕镜像：把每次呈现的脏矩形读回并以行为单位 RLE 编码，经 USB-CDC 串口推送到 PC，
+// 由 tools/screen_mirror.py 显示。带宽只与变化的区域成正比，不推送整帧。
+//
+// 协议（多字节字段均为小端）。每个包以 0xA5 0x5A 开头，后跟 1 字节类型：
+//   HELLO  0x01  width u16, height u16            开启镜像时发送，随后推送整屏
+//   ROW    0x02  x u16, y u16, w u16, len u16, payload[len]
+//   REPEAT 0x03  x u16, y u16, w u16              与上一行 (y-1) 同一区间的内容完全相同
+//   FRAME  0x04  seq u16                          一批脏区推送完毕，查看器可以刷新画面
+// ROW 的 payload 为若干段：控制字节 c 的最高位为 1 时后跟 1 个像素、重复 (c & 0x7F) + 1 次；
+// 否则后跟 c + 1 个字面像素。像素为 RGB565，高字节在前（即 readRect 读回的内存顺序）。
+// 串口上的其他输出（日志）不以包头开头，查看器会跳过它们重新同步。
+class ScreenMirror {
+public:
+    static const int MAX_PENDING = 8;                       // 超出时合并为一个外接矩形
+    static const uint32_t DEFAULT_BYTES_PER_SECOND = 262144;
+
+private:
+    struct Rect { int x, y, w, h; };
+
+    LGFX_Device* display;
+    bool active;
+    int lineCapacity;
+    uint16_t* lineBuf;          // 当前行的读回像素
+    uint16_t* prevLine;         // 同一矩形内上一行，用于 REPEAT
+    uint8_t* packetBuf;         // 单行编码缓冲（最坏情况全部为字面像素）
+    Rect pending[MAX_PENDING];
+    int pendingCount;
+    bool prevValid;
+    bool frameOpen;             // 已发送过行但还没有发送 FRAME
+    uint16_t frameSeq;
+    uint32_t bytesPerSecond;
+    uint32_t budget;            // 令牌桶：当前可发送的字节数
+    uint32_t lastRefillMs;
+    uint32_t bytesSent;
+
+    size_t maxRowPacket() const;
+    size_t encodeRow(const uint16_t* px, int w, uint8_t* out) const;
+    void putHeader(uint8_t* out, uint8_t type) const;
+    void sendFrameEnd();
+    void releaseBuffers();
+
+public:
+    explicit ScreenMirror(LGFX_Device* display);
+    ~ScreenMirror();
+
+    // 面板不可读回或缓冲分配失败时返回 false
+    bool begin(uint32_t bytesPerSecond = DEFAULT_BYTES_PER_SECOND);
+    void end();
+    bool isActive() const { return active; }
+
+    // 记录一块已呈现到屏幕的区域（绝对坐标）
+    void markDirty(int x, int y, int w, int h);
+
+    // 在带宽预算内推送待发送区域；预算不足时剩余行留到下一次，期间新的脏区会继续合并
+    void flush(uint32_t nowMs);
+
+    uint32_t getBytesSent() const { return bytesSent; }
+};
@@ -0,0 +1,37 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+
+// 顺序锁发布：单个写者整体替换一份 T，任意读者复制最近一次完整写入的值。
+// 写者从不等待；读者在复制期间遇到写入时重试，重试次数用完返回 false 而不是等待。
+// T 应为可平凡复制的结构。
+template <typename T>
+class SeqLock {
+    std::atomic<uint32_t> sequence;     // 奇数表示正在写
+    T value;
+
+public:
+    SeqLock() : sequence(0), value() {}
+
+    void write(const T& v) {
+        uint32_t s = sequence.load(std::memory_order_relaxed);
+        sequence.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        value = v;
+        sequence.store(s + 2, std::memory_order_release);
+    }
+
+    bool read(T& out, int attempts = 4) const {
+        for (int i = 0; i < attempts; i++) {
+            uint32_t s1 = sequence.load(std::memory_order_acquire);
+            if (s1 & 1) continue;
+            T copy = value;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == s1) {
+                out = copy;
+                return true;
+            }
+        }
+        return false;
+    }
+};
@@ -0,0 +1,212 @@
+#include "system/SettingsStore.h"
+#include "system/BinaryUtil.h"
+#include <Preferences.h>
+#include <new>
+
+const char* const SettingsStore::NAMESPACE = "cardputer";
+const char* const SettingsStore::BLOB_KEY = "settings";
+
+// blob 格式：'S' 'T' 版本 条目数，之后每个条目为
+//   键长(1) 键 类型(1) 值：整数 4 字节小端；字符串 长度(1) + 内容
+static const uint8_t BLOB_VERSION = 1;
+static const uint8_t TYPE_INT = 0;
+static const uint8_t TYPE_STRING = 1;
+
+SettingsStore::SettingsStore()
+    : entryCount(0), loaded(false), dirty(false), firstDirtyMs(0), lastChangeMs(0),
+      lastWrittenHash(0), writeCount(0) {}
+
+size_t SettingsStore::maxBlobSize() {
+    return 4 + MAX_ENTRIES * (1 + MAX_KEY_LENGTH + 1 + 1 + MAX_STRING_LENGTH);
+}
+
+uint32_t SettingsStore::hashBytes(const uint8_t* data, size_t length) {
+    return fnv1a(data, (uint32_t)length);
+}
+
+void SettingsStore::begin() {
+    if (loaded) return;
+    loaded = true;
+    Preferences prefs;
+    if (!prefs.begin(NAMESPACE, true)) return;     // 首次启动时命名空间还不存在
+    size_t length = prefs.getBytesLength(BLOB_KEY);
+    if (length > 0 && length <= maxBlobSize()) {
+        uint8_t* buffer = new (std::nothrow) uint8_t[length];
+        if (buffer) {
+            if (prefs.getBytes(BLOB_KEY, buffer, length) == length) {
+                deserialize(buffer, length);
+                lastWrittenHash = hashBytes(buffer, length);
+            }
+            delete[] buffer;
+        }
+    }
+    prefs.end();
+}
+
+int SettingsStore::find(const char* key) const {
+    for (int i = 0; i < entryCount; i++) {
+        if (strcmp(entries[i].key, key) == 0) return i;
+    }
+    return -1;
+}
+
+SettingsStore::Entry* SettingsStore::obtain(const char* key) {
+    int index = find(key);
+    if (index >= 0) return &entries[index];
+    if (entryCount >= MAX_ENTRIES || !key || strlen(key) > (size_t)MAX_KEY_LENGTH) return nullptr;
+    Entry& entry = entries[entryCount++];
+    strcpy(entry.key, key);
+    entry.isString = false;
+    entry.intValue = 0;
+    entry.stringValue = "";
+    return &entry;
+}
+
+int32_t SettingsStore::getInt(const char* key, int32_t defaultValue) const {
+    int index = find(key);
+    if (index < 0 || entries[index].isString) return defaultValue;
+    return entries[index].intValue;
+}
+
+String SettingsStore::getString(const char* key, const char* defaultValue) const {
+    int index = find(key);
+    if (index < 0 || !entries[index].isString) return String(defaultValue);
+    return entries[index].stringValue;
+}
+
+bool SettingsStore::setInt(const char* key, int32_t value) {
+    int index = find(key);
+    if (index >= 0 && !entries[index].isString && entries[index].intValue == value) return true;
+    Entry* entry = obtain(key);
+    if (!entry) return false;
+    entry->isString = false;
+    entry->intValue = value;
+    entry->stringValue = "";
+    markDirty();
+    return true;
+}
+
+bool SettingsStore::setString(const char* key, const String& value) {
+    // 截断可能切开 UTF-8 字符，截断的路径也无法再匹配，所以直接拒绝
+    if (value.length() > (unsigned int)MAX_STRING_LENGTH) return false;
+    int index = find(key);
+    if (index >= 0 && entries[index].isString && entries[index].stringValue == value) return true;
+    Entry* entry = obtain(key);
+    if (!entry) return false;
+    entry->isString = true;
+    entry->intValue = 0;
+    entry->stringValue = value;
+    markDirty();
+    return true;
+}
+
+void SettingsStore::markDirty() {
+    uint32_t now = millis();
+    if (!dirty) {
+        dirty = true;
+        firstDirtyMs = now;
+    }
+    lastChangeMs = now;
+}
+
+void SettingsStore::update(uint32_t nowMs) {
+    if (!dirty) return;
+    if (nowMs - lastChangeMs >= WRITE_DELAY_MS || nowMs - firstDirtyMs >= MAX_WRITE_DELAY_MS) {
+        flush();
+    }
+}
+
+bool SettingsStore::flush() {
+    if (!dirty) return true;
+    size_t capacity = maxBlobSize();
+    uint8_t* buffer = new (std::nothrow) uint8_t[capacity];
+    if (!buffer) return false;      // 保持脏标记，下一帧重试
+    size_t length = serialize(buffer, capacity);
+    uint32_t hash = hashBytes(buffer, length);
+    bool ok = true;
+    // 改了又改回原值时内容与闪存中一致，不必写入
+    if (hash != lastWrittenHash) {
+        Preferences prefs;
+        ok = prefs.begin(NAMESPACE, false) && prefs.putBytes(BLOB_KEY, buffer, length) == length;
+        prefs.end();
+        if (ok) {
+            lastWrittenHash = hash;
+            writeCount++;
+        }
+    }
+    delete[] buffer;
+    if (ok) dirty = false;
+    return ok;
+}
+
+size_t SettingsStore::serialize(uint8_t* buffer, size_t capacity) const {
+    size_t pos = 0;
+    buffer[pos++] = 'S';
+    buffer[pos++] = 'T';
+    buffer[pos++] = BLOB_VERSION;
+    buffer[pos++] = (uint8_t)entryCount;
+    for (int i = 0; i < entryCount; i++) {
+        const Entry& e = entries[i];
+        size_t keyLength = strlen(e.key);
+        size_t need = 1 + keyLength + 1 + (e.isString ? 1 + e.stringValue.length() : 4);
+        if (pos + need > capacity) break;
+        buffer[pos++] = (uint8_t)keyLength;
+        memcpy(buffer + pos, e.key, keyLength);
+        pos += keyLength;
+        if (e.isString) {
+            buffer[pos++] = TYPE_STRING;
+            buffer[pos++] = (uint8_t)e.stringValue.length();
+            memcpy(buffer + pos, e.stringValue.c_str(), e.stringValue.length());
+            pos += e.stringValue.length();
+        } else {
+            uint32_t v = (uint32_t)e.intValue;
+            buffer[pos++] = TYPE_INT;
+            buffer[pos++] = (uint8_t)(v & 0xFF);
+            buffer[pos++] = (uint8_t)((v >> 8) & 0xFF);
+            buffer[pos++] = (uint8_t)((v >> 16) & 0xFF);
+            buffer[pos++] = (uint8_t)((v >> 24) & 0xFF);
+        }
+    }
+    return pos;
+}
+
+// 格式不符或数据截断时保留已解析的条目，其余丢弃
+void SettingsStore::deserialize(const uint8_t* data, size_t length) {
+    if (length < 4 || data[0] != 'S' || data[1] != 'T' || data[2] != BLOB_VERSION) return;
+    int count = data[3];
+    size_t pos = 4;
+    char key[MAX_KEY_LENGTH + 1];
+    char text[MAX_STRING_LENGTH + 1];
+    for (int i = 0; i < count && entryCount < MAX_ENTRIES; i++) {
+        if (pos + 1 > length) return;
+        size_t keyLength = data[pos++];
+        if (keyLength > (size_t)MAX_KEY_LENGTH || pos + keyLength + 1 > length) return;
+        memcpy(key, data + pos, keyLength);
+        key[keyLength] = '\0';
+        pos += keyLength;
+        uint8_t type = data[pos++];
+        if (type == TYPE_INT) {
+            if (pos + 4 > length) return;
+            int32_t value = (int32_t)((uint32_t)data[pos] | (uint32_t)data[pos + 1] << 8 |
+                                      (uint32_t)data[pos + 2] << 16 | (uint32_t)data[pos + 3] << 24);
+            pos += 4;
+            Entry* entry = obtain(key);
+            if (!entry) return;
+            entry->isString = false;
+            entry->intValue = value;
+        } else if (type == TYPE_STRING) {
+            if (pos + 1 > length) return;
+            size_t textLength = data[pos++];
+            if (textLength > (size_t)MAX_STRING_LENGTH || pos + textLength > length) return;
+            memcpy(text, data + pos, textLength);
+            text[textLength] = '\0';
+            pos += textLength;
+            Entry* entry = obtain(key);
+            if (!entry) return;
+            entry->isString = true;
+            entry->stringValue = text;
+        } else {
+            return;
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <M5Cardputer.h>
+
+// 已使用的键
+#define SETTING_THEME           "theme"         // 主题名称
+#define SETTING_VOLUME          "volume"        // 0-100
+#define SETTING_LAST_TRACK      "track"         // 最近播放曲目的完整路径
+#define SETTING_LAST_POS_MS     "pos_ms"        // 最近播放曲目的断点（播放时长）
+#define SETTING_LAST_POS_OFFSET "pos_off"       // 最近播放曲目的断点（文件位置）
+#define SETTING_CPU_GOVERNOR    "cpu_gov"       // 1 自动调频，0 固定 240MHz
+
+// 持久化设置：整张键值表在 RAM 中缓存，启动时从 NVS 一次读入，读取不访问闪存。
+// 修改只改缓存并标记为脏，由主循环在静默 WRITE_DELAY_MS 后（持续修改时最迟
+// MAX_WRITE_DELAY_MS）把整张表作为一个 NVS blob 写入一次；内容与上次写入相同时跳过。
+// 因此拖动音量滑块等连续修改只会产生一次写入，且写入不发生在按键处理或音频任务中。
+// 只能在主线程中使用。
+class SettingsStore {
+public:
+    static const int MAX_ENTRIES = 16;
+    static const int MAX_KEY_LENGTH = 15;           // NVS 键名上限
+    static const int MAX_STRING_LENGTH = 127;       // 字节数；更长的值被拒绝而不是截断
+    static const uint32_t WRITE_DELAY_MS = 2000;
+    static const uint32_t MAX_WRITE_DELAY_MS = 10000;
+    static const char* const NAMESPACE;
+    static const char* const BLOB_KEY;
+
+private:
+    struct Entry {
+        char key[MAX_KEY_LENGTH + 1];
+        bool isString;
+        int32_t intValue;
+        String stringValue;
+    };
+
+    Entry entries[MAX_ENTRIES];
+    int entryCount;
+    bool loaded;
+    bool dirty;
+    uint32_t firstDirtyMs;          // 第一次未写入修改的时间
+    uint32_t lastChangeMs;          // 最近一次修改的时间
+    uint32_t lastWrittenHash;       // 上次写入（或读入）的 blob 指纹
+    uint32_t writeCount;
+
+    int find(const char* key) const;
+    Entry* obtain(const char* key);
+    void markDirty();
+    size_t serialize(uint8_t* buffer, size_t capacity) const;
+    void deserialize(const uint8_t* data, size_t length);
+    static uint32_t hashBytes(const uint8_t* data, size_t length);
+    static size_t maxBlobSize();
+
+public:
+    SettingsStore();
+
+    // 从 NVS 读入整张表，重复调用无效果
+    void begin();
+    bool isLoaded() const { return loaded; }
+
+    int32_t getInt(const char* key, int32_t defaultValue) const;
+    String getString(const char* key, const char* defaultValue) const;
+    bool hasKey(const char* key) const { return find(key) >= 0; }
+
+    // 值未变化时不标记为脏；表满、键名过长或字符串超过 MAX_STRING_LENGTH 时返回 false（原值不变）
+    bool setInt(const char* key, int32_t value);
+    bool setString(const char* key, const String& value);
+
+    // 主循环每帧调用：到期时批量写入
+    void update(uint32_t nowMs);
+    // 立即写入未保存的修改
+    bool flush();
+
+    bool isDirty() const { return dirty; }
+    uint32_t getWriteCount() const { return writeCount; }
+};
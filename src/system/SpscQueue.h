@@ -0,0 +1,44 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+
+// 单生产者/单消费者无锁环形队列：一个任务只调用 push，另一个任务只调用 pop，
+// 两端都不加锁、不阻塞。N 必须是 2 的幂；满时 push 返回 false，空时 pop 返回 false。
+// 元素按值复制，T 应为可平凡复制的小结构。
+template <typename T, uint32_t N>
+class SpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+    T items[N];
+    std::atomic<uint32_t> head;     // 下一个写入位置，只由生产者修改
+    std::atomic<uint32_t> tail;     // 下一个读取位置，只由消费者修改
+
+public:
+    SpscQueue() : head(0), tail(0) {}
+
+    bool push(const T& item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= N) return false;
+        items[h & (N - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& out) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        out = items[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire);
+    }
+
+    // 只能在两端都不再访问时调用（例如任务已退出）
+    void reset() {
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+    }
+};
@@ -0,0 +1,122 @@
+#include "system/StorageLoader.h"
+#include <new>
+
+#ifndef NATIVE_BUILD
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#endif
+
+StorageLoader::StorageLoader()
+    : sdManager(nullptr), state(STORAGE_IDLE), refreshState(REFRESH_IDLE), libraryExtension(nullptr),
+      loadedIndex(nullptr), refreshBase(nullptr), refreshFull(false), refreshedIndex(nullptr), refreshSaved(false),
+      startUs(0), mountedUs(0), indexLoadedUs(0) {}
+
+StorageLoader::~StorageLoader() {
+    // 任务仍在运行时不能释放它正在使用的索引
+    if (getState() != STORAGE_RUNNING && !isRefreshing()) {
+        delete loadedIndex;
+        delete refreshedIndex;
+    }
+}
+
+void StorageLoader::begin(SDFileManager* fm, const char* extension) {
+    if (getState() != STORAGE_IDLE) return;
+    sdManager = fm;
+    libraryExtension = extension;
+    startUs = micros();
+    state.store(STORAGE_RUNNING, std::memory_order_release);
+
+    // 与音频任务同在 Core 0，UI 在 Core 1 上继续绘制启动器
+    if (spawn(bootTaskEntry, "StorageLoad")) return;
+    // native 环境或任务创建失败：在调用线程中同步完成
+    runBoot();
+}
+
+bool StorageLoader::spawn(void (*entry)(void*), const char* name) {
+#ifndef NATIVE_BUILD
+    TaskHandle_t handle = nullptr;
+    return xTaskCreatePinnedToCore(entry, name, TASK_STACK_SIZE, this, TASK_PRIORITY, &handle, 0) == pdPASS;
+#else
+    (void)entry;
+    (void)name;
+    return false;
+#endif
+}
+
+void StorageLoader::bootTaskEntry(void* parameter) {
+    static_cast<StorageLoader*>(parameter)->runBoot();
+#ifndef NATIVE_BUILD
+    vTaskDelete(nullptr);
+#endif
+}
+
+void StorageLoader::refreshTaskEntry(void* parameter) {
+    static_cast<StorageLoader*>(parameter)->runRefresh();
+#ifndef NATIVE_BUILD
+    vTaskDelete(nullptr);
+#endif
+}
+
+void StorageLoader::runBoot() {
+    bool mounted = sdManager && sdManager->initialize();
+    mountedUs = micros();
+
+    bool indexing = mounted && libraryExtension;
+    if (indexing) {
+        // 没有索引文件或文件损坏时保持为空索引，由下面的刷新完整建立
+        loadedIndex = new (std::nothrow) LibraryIndex();
+        if (loadedIndex) loadedIndex->load(SD);
+    }
+    indexLoadedUs = micros();
+
+    if (indexing) {
+        refreshBase = loadedIndex;
+        refreshFull = false;
+        refreshState.store(REFRESH_RUNNING, std::memory_order_release);
+    }
+    // release：主线程看到 settled 状态时，上面写入的结果都已可见
+    state.store(mounted ? STORAGE_MOUNTED : STORAGE_FAILED, std::memory_order_release);
+
+    if (indexing) runRefresh();
+}
+
+void StorageLoader::runRefresh() {
+    LibraryIndex* index = LibraryIndex::build(SD, libraryExtension, refreshBase, refreshFull, refreshStats);
+    refreshSaved = false;
+    if (index && refreshBase && index->sameContent(*refreshBase)) {
+        delete index;
+        index = nullptr;
+    } else if (index) {
+        refreshSaved = index->save(SD);
+    }
+    refreshedIndex = index;
+    refreshState.store(REFRESH_DONE, std::memory_order_release);
+}
+
+LibraryIndex* StorageLoader::takeIndex() {
+    if (!isSettled()) return nullptr;
+    LibraryIndex* index = loadedIndex;
+    loadedIndex = nullptr;
+    return index;
+}
+
+bool StorageLoader::startRefresh(const LibraryIndex* base, bool full) {
+    if (!isMounted() || !libraryExtension) return false;
+    int expected = REFRESH_IDLE;
+    if (!refreshState.compare_exchange_strong(expected, REFRESH_RUNNING, std::memory_order_acq_rel)) return false;
+    refreshBase = base;
+    refreshFull = full;
+    if (spawn(refreshTaskEntry, "LibraryIndex")) return true;
+    runRefresh();
+    return true;
+}
+
+bool StorageLoader::takeRefreshResult(LibraryIndex*& index, LibraryIndex::BuildStats& stats, bool& saved) {
+    if (refreshState.load(std::memory_order_acquire) != REFRESH_DONE) return false;
+    index = refreshedIndex;
+    stats = refreshStats;
+    saved = refreshSaved;
+    refreshedIndex = nullptr;
+    refreshState.store(REFRESH_IDLE, std::memory_order_release);
+    return true;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <M5Cardputer.h>
+#include <atomic>
+#include "system/SDFileManager.h"
+#include "system/LibraryIndex.h"
+
+// 后台存储加载：在 Core 0 上挂载 SD 卡并读入曲库索引，主线程同时完成启动器的首帧。
+// 索引读入后即进入 MOUNTED（settled），随后同一任务在低优先级下对照卡上内容刷新索引，
+// 只重新列出修改时间变化的目录，期间界面照常响应。挂载与索引读取只由加载任务执行；
+// settled 之后读入的索引由主线程通过 takeIndex 取走，刷新结果通过 takeRefreshResult 取走。
+class StorageLoader {
+public:
+    enum State {
+        STORAGE_IDLE,
+        STORAGE_RUNNING,
+        STORAGE_MOUNTED,
+        STORAGE_FAILED
+    };
+
+    enum RefreshState {
+        REFRESH_IDLE,
+        REFRESH_RUNNING,
+        REFRESH_DONE        // 结果待主线程取走
+    };
+
+    static const uint32_t TASK_STACK_SIZE = 8192;   // 递归扫描目录需要较深的栈
+    static const int TASK_PRIORITY = 1;             // 低于音频任务，只占用空闲时间
+
+private:
+    SDFileManager* sdManager;
+    std::atomic<int> state;
+    std::atomic<int> refreshState;
+    const char* libraryExtension;   // 为空时只挂载，不处理索引
+    LibraryIndex* loadedIndex;      // 启动时读入的索引，被 takeIndex 取走
+    const LibraryIndex* refreshBase;    // 刷新时对照的旧索引，刷新结束前调用者不能释放
+    bool refreshFull;
+    LibraryIndex* refreshedIndex;   // 刷新结果；与旧索引相同或失败时为空
+    LibraryIndex::BuildStats refreshStats;
+    bool refreshSaved;
+
+    // 各阶段时间戳（微秒），由加载任务写入，settled 后由主线程读取
+    uint32_t startUs;
+    uint32_t mountedUs;
+    uint32_t indexLoadedUs;
+
+    static void bootTaskEntry(void* parameter);
+    static void refreshTaskEntry(void* parameter);
+    bool spawn(void (*entry)(void*), const char* name);
+    void runBoot();
+    void runRefresh();
+
+public:
+    StorageLoader();
+    ~StorageLoader();
+
+    // 启动加载任务；extension 为空时只挂载。任务创建失败时同步执行
+    void begin(SDFileManager* fm, const char* extension);
+
+    State getState() const { return (State)state.load(std::memory_order_acquire); }
+    bool isSettled() const {
+        State s = getState();
+        return s == STORAGE_MOUNTED || s == STORAGE_FAILED;
+    }
+    bool isMounted() const { return getState() == STORAGE_MOUNTED; }
+
+    // settled 之后取走启动时读入的索引（没有索引文件时为空索引，挂载失败时为 nullptr），只能取一次
+    LibraryIndex* takeIndex();
+
+    // 以 base 为旧索引在后台刷新；full 为 true 时忽略目录修改时间。正在刷新或未挂载时返回 false
+    bool startRefresh(const LibraryIndex* base, bool full);
+    bool isRefreshing() const { return refreshState.load(std::memory_order_acquire) == REFRESH_RUNNING; }
+    // 刷新结束后返回 true：index 为新索引（已写回卡上，所有权交给调用者），没有变化时为 nullptr
+    bool takeRefreshResult(LibraryIndex*& index, LibraryIndex::BuildStats& stats, bool& saved);
+
+    uint32_t getStartUs() const { return startUs; }
+    uint32_t getMountedUs() const { return mountedUs; }
+    uint32_t getIndexLoadedUs() const { return indexLoadedUs; }
+};
@@ -0,0 +1,159 @@
+#include "system/SystemMonitor.h"
+#include "ui/UIManager.h"
+#include "system/AudioService.h"
+#include "esp_heap_caps.h"
+#include <new>
+
+#ifndef NATIVE_BUILD
+#include "freertos/task.h"
+#endif
+
+const char* const SystemMonitor::TASK_NAMES[MONITOR_TASK_COUNT] = {
+    "AudioTask", "loopTask", "spk_task"
+};
+
+#if !defined(NATIVE_BUILD) && configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+static uint8_t percentOf(uint32_t part, uint32_t whole) {
+    if (whole == 0) return 0;
+    uint32_t p = (uint32_t)((uint64_t)part * 100 / whole);
+    return (uint8_t)(p > 100 ? 100 : p);
+}
+#endif
+
+SystemMonitor::SystemMonitor(UIManager* uiManager, AudioService* audioService)
+    : ui(uiManager), audio(audioService), timer(nullptr), running(false), droppedSamples(0),
+      taskSnapshot(nullptr), prevTotalRun(0), prevTicks(0), prevFrames(0), prevSampleMs(0), primed(false) {
+    memset(prevTaskRun, 0, sizeof(prevTaskRun));
+    memset(prevIdleRun, 0, sizeof(prevIdleRun));
+}
+
+SystemMonitor::~SystemMonitor() {
+    stop();
+#ifndef NATIVE_BUILD
+    if (timer) xTimerDelete(timer, pdMS_TO_TICKS(10));
+    delete[] static_cast<TaskStatus_t*>(taskSnapshot);
+#endif
+}
+
+bool SystemMonitor::start() {
+    if (running) return true;
+    primed = false;
+    samples.reset();
+#ifndef NATIVE_BUILD
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+    if (!taskSnapshot) taskSnapshot = new (std::nothrow) TaskStatus_t[MAX_TASKS];
+#endif
+    if (!timer) {
+        timer = xTimerCreate("SysMon", pdMS_TO_TICKS(SAMPLE_PERIOD_MS), pdTRUE, this, timerCallback);
+    }
+    if (!timer || xTimerStart(timer, pdMS_TO_TICKS(10)) != pdPASS) return false;
+#endif
+    prevSampleMs = millis();
+    running = true;
+    return true;
+}
+
+void SystemMonitor::stop() {
+    if (!running) return;
+#ifndef NATIVE_BUILD
+    xTimerStop(timer, pdMS_TO_TICKS(10));
+#endif
+    running = false;
+}
+
+bool SystemMonitor::poll(MonitorSample& out) {
+#ifdef NATIVE_BUILD
+    // native 没有定时器服务任务，到期时在调用线程中采样
+    if (running && millis() - prevSampleMs >= SAMPLE_PERIOD_MS) sample();
+#endif
+    return samples.pop(out);
+}
+
+#ifndef NATIVE_BUILD
+void SystemMonitor::timerCallback(TimerHandle_t handle) {
+    static_cast<SystemMonitor*>(pvTimerGetTimerID(handle))->sample();
+}
+#endif
+
+// ---- 以下在定时器服务任务中运行（native 下在主线程） ----
+
+void SystemMonitor::sample() {
+    uint32_t now = millis();
+    MonitorSample s;
+    memset(&s, 0, sizeof(s));
+    s.timeMs = now;
+
+    uint32_t elapsed = now - prevSampleMs;
+    uint32_t ticks = ui ? ui->getTickCount() : 0;
+    uint32_t frames = ui ? ui->getFrameCount() : 0;
+    if (primed && elapsed > 0) {
+        s.tickRate10 = (uint16_t)((uint64_t)(ticks - prevTicks) * 10000 / elapsed);
+        s.frameRate10 = (uint16_t)((uint64_t)(frames - prevFrames) * 10000 / elapsed);
+    }
+    prevTicks = ticks;
+    prevFrames = frames;
+    prevSampleMs = now;
+
+#ifdef NATIVE_BUILD
+    s.heapFree = ESP.getFreeHeap();
+    s.heapLargest = s.heapFree;
+#else
+    s.heapFree = heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    s.heapLargest = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    s.psramFree = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    s.psramLargest = heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM);
+#endif
+
+    if (audio) {
+        AudioPlaybackStatus st;
+        if (audio->getStatus(st)) s.underruns = st.underruns;
+    }
+    sampleTasks(s);
+
+    // 第一轮只建立各计数的基准，比率还没有意义
+    if (!primed) {
+        primed = true;
+        return;
+    }
+    if (!samples.push(s)) droppedSamples++;
+}
+
+// 栈水位按任务名逐个查询，任何固件都有（与 Profiler 的做法相同）。
+// CPU 占比需要固件启用 configUSE_TRACE_FACILITY 与 configGENERATE_RUN_TIME_STATS
+// （arduino-esp32 默认未启用），未启用时只缺这一列
+void SystemMonitor::sampleTasks(MonitorSample& out) {
+    for (int k = 0; k < MONITOR_TASK_COUNT; k++) {
+        TaskHandle_t handle = xTaskGetHandle(TASK_NAMES[k]);
+        if (!handle) continue;
+        out.tasks[k].present = true;
+        out.tasks[k].stackFreeBytes = uxTaskGetStackHighWaterMark(handle);   // ESP-IDF 中以字节为单位
+    }
+#if !defined(NATIVE_BUILD) && configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+    TaskStatus_t* list = static_cast<TaskStatus_t*>(taskSnapshot);
+    if (!list) return;
+    uint32_t totalRun = 0;
+    UBaseType_t n = uxTaskGetSystemState(list, MAX_TASKS, &totalRun);
+    if (n == 0) return;     // 任务数超过快照容量
+    uint32_t totalDelta = totalRun - prevTotalRun;
+    out.hasRuntimeStats = primed && totalDelta > 0;
+    TaskHandle_t idle[2] = { xTaskGetIdleTaskHandleForCPU(0), xTaskGetIdleTaskHandleForCPU(1) };
+    for (UBaseType_t i = 0; i < n; i++) {
+        const TaskStatus_t& t = list[i];
+        for (int core = 0; core < 2; core++) {
+            if (t.xHandle != idle[core]) continue;
+            if (out.hasRuntimeStats) {
+                out.coreLoad[core] = 100 - percentOf(t.ulRunTimeCounter - prevIdleRun[core], totalDelta);
+            }
+            prevIdleRun[core] = t.ulRunTimeCounter;
+        }
+        for (int k = 0; k < MONITOR_TASK_COUNT; k++) {
+            if (strcmp(t.pcTaskName, TASK_NAMES[k]) != 0) continue;
+            if (out.hasRuntimeStats) {
+                out.tasks[k].cpuPercent = percentOf(t.ulRunTimeCounter - prevTaskRun[k], totalDelta);
+            }
+            prevTaskRun[k] = t.ulRunTimeCounter;
+        }
+    }
+    prevTotalRun = totalRun;
+#endif
+}
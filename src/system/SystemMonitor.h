@@ -0,0 +1,81 @@
+#pragma once
+#include <M5Cardputer.h>
+#include "system/SpscQueue.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/timers.h"
+
+class UIManager;
+class AudioService;
+
+// 被单独统计的任务
+enum MonitorTask {
+    MON_TASK_AUDIO,     // AudioService 的解码任务
+    MON_TASK_LOOP,      // Arduino loop 任务（UI 与应用）
+    MON_TASK_SPEAKER,   // M5Unified 扬声器任务
+    MONITOR_TASK_COUNT
+};
+
+struct MonitorTaskStat {
+    bool present;               // 采样时任务存在
+    uint8_t cpuPercent;         // 占单个核心的百分比
+    uint32_t stackFreeBytes;    // 栈高水位：运行以来剩余最少的字节数
+};
+
+// 一次采样；由定时器任务生成，经队列交给主线程
+struct MonitorSample {
+    uint32_t timeMs;
+    bool hasRuntimeStats;       // 固件启用了任务运行时间统计
+    uint8_t coreLoad[2];        // 各核心忙碌百分比（100 - 空闲任务占比）
+    MonitorTaskStat tasks[MONITOR_TASK_COUNT];
+    uint32_t heapFree;          // 内部 RAM
+    uint32_t heapLargest;
+    uint32_t psramFree;         // 没有 PSRAM 时为 0
+    uint32_t psramLargest;
+    uint16_t tickRate10;        // UI 每秒 tick 次数 ×10
+    uint16_t frameRate10;       // 每秒实际绘制帧数 ×10
+    uint32_t underruns;         // 音频欠载累计次数
+};
+
+// 系统监视采样器：FreeRTOS 软件定时器在低优先级的定时器服务任务中按固定周期采样，
+// 采样结果写入无锁队列，UI 线程只负责取出与绘制，不在主循环里做统计工作。
+// 对象必须比定时器活得久（由应用以成员形式持有，只启停、不销毁）。
+class SystemMonitor {
+public:
+    static const uint32_t SAMPLE_PERIOD_MS = 500;
+    static const int MAX_TASKS = 32;    // uxTaskGetSystemState 的快照容量
+    static const char* const TASK_NAMES[MONITOR_TASK_COUNT];
+
+private:
+    UIManager* ui;
+    AudioService* audio;
+    SpscQueue<MonitorSample, 8> samples;
+    TimerHandle_t timer;
+    bool running;
+    volatile uint32_t droppedSamples;
+
+    // 以下只在采样上下文中使用
+    void* taskSnapshot;                 // TaskStatus_t[MAX_TASKS]，启用运行时间统计时于首次启动分配
+    uint32_t prevTaskRun[MONITOR_TASK_COUNT];
+    uint32_t prevIdleRun[2];
+    uint32_t prevTotalRun;
+    uint32_t prevTicks;
+    uint32_t prevFrames;
+    uint32_t prevSampleMs;
+    bool primed;                        // 已有上一轮计数，可以计算差值
+
+    static void timerCallback(TimerHandle_t handle);
+    void sample();
+    void sampleTasks(MonitorSample& out);
+
+public:
+    SystemMonitor(UIManager* uiManager, AudioService* audioService);
+    ~SystemMonitor();
+
+    bool start();
+    void stop();
+    bool isRunning() const { return running; }
+
+    // 主线程取出下一份采样
+    bool poll(MonitorSample& out);
+    uint32_t getDroppedSamples() const { return droppedSamples; }
+};
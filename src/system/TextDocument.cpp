@@ -0,0 +1,286 @@
+#include "system/TextDocument.h"
+#include <new>
+
+TextDocument::TextDocument()
+    : fs(nullptr), fileSize(0), window(nullptr), windowStart(0), windowLength(0), fileReads(0),
+      checkpoints(nullptr), generation(0), checkpointCount(0), stride(INITIAL_STRIDE), scannedBytes(0),
+      scannedLines(0), indexState(INDEX_IDLE), stopRequested(false), totalLines(0), indexStartUs(0),
+      indexElapsedMs(0) {}
+
+TextDocument::~TextDocument() {
+    close();
+}
+
+bool TextDocument::open(fs::FS& fileSystem, const String& filePath) {
+    close();
+    fs = &fileSystem;
+    path = filePath;
+    file = fs->open(path, FILE_READ);
+    if (!file || file.isDirectory()) {
+        file = File();
+        return false;
+    }
+    fileSize = file.size();
+    window = new (std::nothrow) uint8_t[WINDOW_SIZE];
+    checkpoints = new (std::nothrow) uint32_t[TEXT_INDEX_MAX_CHECKPOINTS];
+    if (!window || !checkpoints) {
+        close();
+        return false;
+    }
+
+    // 第 0 行从文件开头开始
+    checkpoints[0] = 0;
+    checkpointCount.store(1, std::memory_order_relaxed);
+    stride.store(INITIAL_STRIDE, std::memory_order_relaxed);
+    scannedBytes.store(0, std::memory_order_relaxed);
+    scannedLines.store(0, std::memory_order_relaxed);
+    stopRequested.store(false, std::memory_order_relaxed);
+    indexState.store(INDEX_RUNNING, std::memory_order_release);
+    if (!spawn()) {
+        // native 环境或任务创建失败：在调用线程中同步完成
+        buildIndex();
+    }
+    return true;
+}
+
+void TextDocument::close() {
+    if (getIndexState() == INDEX_RUNNING) {
+        stopRequested.store(true, std::memory_order_relaxed);
+        // 任务每读一块检查一次，最多等一次读取的时间
+        while (getIndexState() == INDEX_RUNNING) delay(2);
+    }
+    indexState.store(INDEX_IDLE, std::memory_order_relaxed);
+    if (file) file.close();
+    delete[] window;
+    delete[] checkpoints;
+    window = nullptr;
+    checkpoints = nullptr;
+    windowStart = windowLength = 0;
+    fileSize = 0;
+    fileReads = 0;
+    totalLines = 0;
+    indexElapsedMs = 0;
+}
+
+bool TextDocument::spawn() {
+#ifndef NATIVE_BUILD
+    TaskHandle_t handle = nullptr;
+    return xTaskCreatePinnedToCore(taskEntry, "TextIndex", TASK_STACK_SIZE, this, TASK_PRIORITY, &handle, 0) == pdPASS;
+#else
+    return false;
+#endif
+}
+
+void TextDocument::taskEntry(void* parameter) {
+    static_cast<TextDocument*>(parameter)->buildIndex();
+#ifndef NATIVE_BUILD
+    vTaskDelete(nullptr);
+#endif
+}
+
+void TextDocument::buildIndex() {
+    indexStartUs = micros();
+    // 索引用自己的文件句柄，与显示窗口的读取互不影响
+    File scan = fs->open(path, FILE_READ);
+    uint8_t* buffer = new (std::nothrow) uint8_t[SCAN_CHUNK];
+    if (!scan || !buffer) {
+        delete[] buffer;
+        indexState.store(INDEX_FAILED, std::memory_order_release);
+        return;
+    }
+
+    uint32_t offset = 0;
+    uint32_t lines = 0;
+    bool endsWithNewline = true;
+    bool stopped = false;
+    while (offset < fileSize) {
+        if (stopRequested.load(std::memory_order_relaxed)) {
+            stopped = true;
+            break;
+        }
+        size_t n = scan.read(buffer, SCAN_CHUNK);
+        if (n == 0) break;
+        const uint8_t* p = buffer;
+        const uint8_t* end = buffer + n;
+        const uint8_t* nl;
+        while ((nl = (const uint8_t*)memchr(p, '\n', end - p)) != nullptr) {
+            lines++;
+            addCheckpoint(lines, offset + (uint32_t)(nl - buffer) + 1);
+            p = nl + 1;
+        }
+        endsWithNewline = buffer[n - 1] == '\n';
+        offset += n;
+        scannedLines.store(lines, std::memory_order_release);
+        scannedBytes.store(offset, std::memory_order_release);
+    }
+    scan.close();
+    delete[] buffer;
+
+    // 最后一行没有换行符时也算一行
+    totalLines = lines + (fileSize > 0 && !endsWithNewline ? 1 : 0);
+    indexElapsedMs = (micros() - indexStartUs) / 1000;
+    indexState.store(stopped || offset < fileSize ? INDEX_FAILED : INDEX_DONE, std::memory_order_release);
+}
+
+// 只由索引任务调用
+void TextDocument::addCheckpoint(uint32_t line, uint32_t offset) {
+    uint32_t s = stride.load(std::memory_order_relaxed);
+    if (line % s != 0) return;
+    uint32_t count = checkpointCount.load(std::memory_order_relaxed);
+    if (count == TEXT_INDEX_MAX_CHECKPOINTS) {
+        // 满了：保留偶数位的检查点，步长加倍
+        uint32_t g = generation.load(std::memory_order_relaxed);
+        generation.store(g + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (uint32_t k = 1; k < count / 2; k++) checkpoints[k] = checkpoints[2 * k];
+        s *= 2;
+        count /= 2;
+        stride.store(s, std::memory_order_relaxed);
+        checkpointCount.store(count, std::memory_order_relaxed);
+        generation.store(g + 2, std::memory_order_release);
+        if (line % s != 0) return;
+    }
+    checkpoints[count] = offset;
+    checkpointCount.store(count + 1, std::memory_order_release);
+}
+
+bool TextDocument::checkpointForLine(uint32_t line, uint32_t& cpLine, uint32_t& cpOffset) const {
+    for (int attempt = 0; attempt < 16; attempt++) {
+        uint32_t g = generation.load(std::memory_order_acquire);
+        if (g & 1) continue;
+        uint32_t s = stride.load(std::memory_order_relaxed);
+        uint32_t count = checkpointCount.load(std::memory_order_acquire);
+        uint32_t k = line / s;
+        if (k >= count) k = count - 1;
+        uint32_t offset = checkpoints[k];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (generation.load(std::memory_order_relaxed) == g) {
+            cpLine = k * s;
+            cpOffset = offset;
+            return true;
+        }
+    }
+    return false;
+}
+
+// 检查点偏移递增，二分查找不超过 offset 的最后一个
+bool TextDocument::checkpointForOffset(uint32_t offset, uint32_t& cpLine, uint32_t& cpOffset) const {
+    for (int attempt = 0; attempt < 16; attempt++) {
+        uint32_t g = generation.load(std::memory_order_acquire);
+        if (g & 1) continue;
+        uint32_t s = stride.load(std::memory_order_relaxed);
+        uint32_t count = checkpointCount.load(std::memory_order_acquire);
+        uint32_t lo = 0;
+        uint32_t hi = count;
+        while (hi - lo > 1) {
+            uint32_t mid = (lo + hi) / 2;
+            if (checkpoints[mid] <= offset) lo = mid;
+            else hi = mid;
+        }
+        uint32_t found = checkpoints[lo];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (generation.load(std::memory_order_relaxed) == g) {
+            cpLine = lo * s;
+            cpOffset = found;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t TextDocument::getLineCount() const {
+    if (getIndexState() == INDEX_DONE) return totalLines;
+    return scannedLines.load(std::memory_order_acquire);
+}
+
+bool TextDocument::loadWindow(uint32_t start) {
+    if (!file || start >= fileSize) return false;
+    if (!file.seek(start)) return false;
+    uint32_t length = fileSize - start < WINDOW_SIZE ? fileSize - start : WINDOW_SIZE;
+    size_t n = file.read(window, length);
+    fileReads++;
+    windowStart = start;
+    windowLength = n;
+    return n > 0;
+}
+
+const uint8_t* TextDocument::fetch(uint32_t offset, uint32_t& available) {
+    available = 0;
+    if (!window || offset >= fileSize) return nullptr;
+    uint32_t windowEnd = windowStart + windowLength;
+    bool inside = offset >= windowStart && offset < windowEnd;
+    if (!inside || (windowEnd - offset < MIN_AHEAD && windowEnd < fileSize)) {
+        // 按扇区对齐重新读取
+        if (!loadWindow(offset & ~511u)) return nullptr;
+        windowEnd = windowStart + windowLength;
+        if (offset >= windowEnd) return nullptr;
+    }
+    available = windowEnd - offset;
+    return window + (offset - windowStart);
+}
+
+int TextDocument::byteAt(uint32_t offset) {
+    uint32_t available;
+    const uint8_t* p = fetch(offset, available);
+    return p ? *p : -1;
+}
+
+uint32_t TextDocument::lineStartOf(uint32_t pos) {
+    if (pos > fileSize) pos = fileSize;
+    if (pos == 0 || !window) return 0;
+    uint32_t low = pos > MAX_LINE_SCAN ? pos - MAX_LINE_SCAN : 0;
+    if (low < windowStart || pos > windowStart + windowLength) {
+        if (!loadWindow(low & ~511u)) return pos;
+        if (pos > windowStart + windowLength) return pos;
+    }
+    for (uint32_t s = pos; s > low; s--) {
+        if (window[s - 1 - windowStart] == '\n') return s;
+    }
+    if (low == 0) return 0;
+    // 超长行：从回看边界起的第一个 UTF-8 首字节开始
+    uint32_t s = low;
+    while (s < pos && (window[s - windowStart] & 0xC0) == 0x80) s++;
+    return s;
+}
+
+bool TextDocument::offsetOfLine(uint32_t line, uint32_t& offset) {
+    if (!window) return false;
+    if (getIndexState() == INDEX_DONE) {
+        if (line >= totalLines && line > 0) return false;
+    } else if (line > scannedLines.load(std::memory_order_acquire)) {
+        return false;
+    }
+    uint32_t cpLine;
+    if (!checkpointForLine(line, cpLine, offset)) return false;
+    // 从检查点向后数换行
+    for (uint32_t need = line - cpLine; need > 0; ) {
+        uint32_t available;
+        const uint8_t* p = fetch(offset, available);
+        if (!p) return false;
+        const uint8_t* nl = (const uint8_t*)memchr(p, '\n', available);
+        if (!nl) {
+            offset += available;
+            continue;
+        }
+        offset += (uint32_t)(nl - p) + 1;
+        need--;
+    }
+    return true;
+}
+
+bool TextDocument::lineOfOffset(uint32_t offset, uint32_t& line) {
+    if (!window) return false;
+    if (getIndexState() != INDEX_DONE && offset > scannedBytes.load(std::memory_order_acquire)) return false;
+    uint32_t pos;
+    if (!checkpointForOffset(offset, line, pos)) return false;
+    while (pos < offset) {
+        uint32_t available;
+        const uint8_t* p = fetch(pos, available);
+        if (!p) return false;
+        if (available > offset - pos) available = offset - pos;
+        const uint8_t* end = p + available;
+        for (const uint8_t* nl = p; (nl = (const uint8_t*)memchr(nl, '\n', end - nl)) != nullptr; nl++) line++;
+        pos += available;
+    }
+    return true;
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <M5Cardputer.h>
+#include <FS.h>
+#include <atomic>
+
+// 行索引的检查点个数上限，索引内存固定为此数乘 4 字节
+#ifndef TEXT_INDEX_MAX_CHECKPOINTS
+#define TEXT_INDEX_MAX_CHECKPOINTS 2048
+#endif
+
+// 任意大小的文本文件：显示只按需读取一个窗口，行号由后台任务建立的稀疏行索引换算。
+//
+// 索引每 stride 行记一个行首偏移（检查点），从 16 行开始；检查点满了之后隔一个丢一个、步长加倍，
+// 所以内存与文件大小无关，定位某一行最多再向后数 stride 行。索引建立期间已扫描的部分就可以按行跳转，
+// 按百分比跳转与滚动不需要索引。工作任务只追加或压缩检查点，主线程按代号校验后读取（与 SeqLock 相同的做法）。
+// 读取窗口与行查询只能在主线程中使用。
+class TextDocument {
+public:
+    enum IndexState {
+        INDEX_IDLE,
+        INDEX_RUNNING,
+        INDEX_DONE,
+        INDEX_FAILED
+    };
+
+    static const uint32_t TASK_STACK_SIZE = 4096;
+    static const int TASK_PRIORITY = 1;             // 低于音频任务
+    static const uint32_t INITIAL_STRIDE = 16;
+    static const uint32_t SCAN_CHUNK = 4096;        // 建索引每次读取的字节数
+    static const uint32_t WINDOW_SIZE = 4096;       // 显示用的读取窗口
+    static const uint32_t MIN_AHEAD = 512;          // fetch 保证从偏移起至少有这么多字节（文件末尾除外）
+    static const uint32_t MAX_LINE_SCAN = 2048;     // 向前找行首时最多回看的字节数，超长行按此截断
+
+private:
+    fs::FS* fs;
+    String path;
+    File file;
+    uint32_t fileSize;
+
+    // 读取窗口：文件中 [windowStart, windowStart + windowLength) 的内容
+    uint8_t* window;
+    uint32_t windowStart;
+    uint32_t windowLength;
+    uint32_t fileReads;
+
+    // checkpoints[k] 为第 k * stride 行（从 0 起）的行首偏移
+    uint32_t* checkpoints;
+    std::atomic<uint32_t> generation;       // 奇数表示正在压缩
+    std::atomic<uint32_t> checkpointCount;
+    std::atomic<uint32_t> stride;
+    std::atomic<uint32_t> scannedBytes;
+    std::atomic<uint32_t> scannedLines;     // 已扫描部分中的换行数
+    std::atomic<int> indexState;
+    std::atomic<bool> stopRequested;
+    uint32_t totalLines;                    // 索引完成后有效
+    uint32_t indexStartUs;
+    uint32_t indexElapsedMs;
+
+    TextDocument(const TextDocument&);
+    TextDocument& operator=(const TextDocument&);
+
+    static void taskEntry(void* parameter);
+    bool spawn();
+    void buildIndex();
+    void addCheckpoint(uint32_t line, uint32_t offset);
+    bool loadWindow(uint32_t start);
+    bool checkpointForLine(uint32_t line, uint32_t& cpLine, uint32_t& cpOffset) const;
+    bool checkpointForOffset(uint32_t offset, uint32_t& cpLine, uint32_t& cpOffset) const;
+
+public:
+    TextDocument();
+    ~TextDocument();
+
+    // 打开文件并在后台开始建立索引（任务创建失败或 native 环境时同步建立）
+    bool open(fs::FS& fileSystem, const String& filePath);
+    // 停止索引任务（等它退出）并释放所有内存
+    void close();
+
+    bool isOpen() const { return window != nullptr; }
+    const String& getPath() const { return path; }
+    uint32_t getSize() const { return fileSize; }
+
+    // 返回指向 offset 处的数据，available 为窗口中从 offset 起的字节数；offset 越界时返回 nullptr
+    const uint8_t* fetch(uint32_t offset, uint32_t& available);
+    int byteAt(uint32_t offset);
+    // pos 所在行的行首（最多回看 MAX_LINE_SCAN 字节）
+    uint32_t lineStartOf(uint32_t pos);
+
+    // 第 line 行（从 0 起）的行首；该行尚未被索引到时返回 false
+    bool offsetOfLine(uint32_t line, uint32_t& offset);
+    // offset 所在的行号；offset 尚未被索引到时返回 false
+    bool lineOfOffset(uint32_t offset, uint32_t& line);
+
+    IndexState getIndexState() const { return (IndexState)indexState.load(std::memory_order_acquire); }
+    uint32_t getIndexedBytes() const { return scannedBytes.load(std::memory_order_acquire); }
+    // 索引完成后为总行数，之前为目前数到的行数
+    uint32_t getLineCount() const;
+    uint32_t getStride() const { return stride.load(std::memory_order_relaxed); }
+    uint32_t getIndexElapsedMs() const { return indexElapsedMs; }
+    uint32_t getFileReads() const { return fileReads; }
+};
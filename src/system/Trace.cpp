@@ -0,0 +1,124 @@
+#include "system/Trace.h"
+#include "system/BinaryUtil.h"
+
+#ifdef ENABLE_TRACE
+
+Tracer globalTracer;
+
+const char* const Tracer::DEFAULT_DIR = "/traces";
+
+// 与 TraceEventId 一一对应，写入转储文件供转换工具使用
+static const char* const kEventNames[TRACE_EVENT_COUNT] = {
+    "sync", "ui.tick", "ui.update", "ui.flush", "ui.overlay", "ui.mirror", "app.loop",
+    "audio.decode", "audio.command", "sd.read",
+    "queue.push", "queue.pop", "queue.full", "audio.underrun", "trigger"
+};
+
+// 转储文件格式（小端）：
+//   "CPTRACE1" | u16 版本 | u16 记录大小 | u16 核心数 | u16 事件数 | u16 触发原因 | u16 保留
+//   事件数 × (u8 名称长度 + 名称)
+//   核心数 × (u32 记录数 + 记录数 × TraceRecord)，每个核心从最旧到最新
+static const char FILE_MAGIC[8] = { 'C', 'P', 'T', 'R', 'A', 'C', 'E', '1' };
+static const uint16_t FILE_VERSION = 1;
+
+Tracer::Tracer() : recording(true), dumpPending(false), syncEpoch(1), triggerReason(0), lastDumpMs(0) {
+    memset(rings, 0, sizeof(rings));    // 各环的 syncEpoch 为 0，第一条记录前会先同步
+}
+
+void Tracer::addSync(Ring& ring, uint32_t cycles) {
+    TraceRecord& r = ring.records[ring.head & (RING_SIZE - 1)];
+    ring.head++;
+    r.cycles = cycles;
+    r.id = TRACE_SYNC;
+    r.phase = TRACE_PHASE_SYNC;
+    r.aux = (uint8_t)getCpuFrequencyMhz();
+    r.arg = micros();
+    ring.lastSyncCycles = cycles;
+    ring.lastSyncHead = ring.head;
+    ring.syncEpoch = syncEpoch;
+}
+
+void Tracer::trigger(uint16_t reason, bool manual) {
+    if (!recording || dumpPending) return;
+    // 自动触发（如欠载）可能连续发生，转储后一段时间内忽略
+    if (!manual && lastDumpMs != 0 && millis() - lastDumpMs < TRIGGER_COOLDOWN_MS) return;
+    record(TRACE_TRIGGER, TRACE_PHASE_INSTANT, reason);
+    triggerReason = reason;
+    recording = false;
+    dumpPending = true;
+}
+
+bool Tracer::writePendingDump(fs::FS& fs, const char* dir, String& outPath) {
+    if (!dumpPending) return false;
+    if (!dir) dir = DEFAULT_DIR;
+
+    bool ok = fs.exists(dir) || fs.mkdir(dir);
+    if (ok) {
+        ok = false;
+        char name[64];
+        for (int i = 1; i < 10000; i++) {
+            snprintf(name, sizeof(name), "%s/trace_%04d.bin", dir, i);
+            if (fs.exists(name)) continue;
+            outPath = name;
+            ok = true;
+            break;
+        }
+    }
+    File file;
+    if (ok) {
+        file = fs.open(outPath, FILE_WRITE);
+        ok = (bool)file;
+    }
+    if (ok) {
+        uint8_t header[20];
+        memcpy(header, FILE_MAGIC, sizeof(FILE_MAGIC));
+        putLE16(header + 8, FILE_VERSION);
+        putLE16(header + 10, (uint16_t)sizeof(TraceRecord));
+        putLE16(header + 12, CORE_COUNT);
+        putLE16(header + 14, TRACE_EVENT_COUNT);
+        putLE16(header + 16, triggerReason);
+        putLE16(header + 18, 0);
+        ok = file.write(header, sizeof(header)) == sizeof(header);
+
+        for (int i = 0; ok && i < TRACE_EVENT_COUNT; i++) {
+            uint8_t len = (uint8_t)strlen(kEventNames[i]);
+            ok = file.write(&len, 1) == 1 && file.write((const uint8_t*)kEventNames[i], len) == len;
+        }
+
+        // 记录按内存布局直接写出（两端均为小端，TraceRecord 无填充）
+        for (int core = 0; ok && core < CORE_COUNT; core++) {
+            const Ring& ring = rings[core];
+            uint32_t count = ring.head < RING_SIZE ? ring.head : RING_SIZE;
+            uint8_t countBytes[4];
+            putLE32(countBytes, count);
+            ok = file.write(countBytes, 4) == 4;
+            uint32_t start = (ring.head - count) & (RING_SIZE - 1);
+            uint32_t first = count < RING_SIZE - start ? count : RING_SIZE - start;
+            size_t firstBytes = first * sizeof(TraceRecord);
+            size_t restBytes = (count - first) * sizeof(TraceRecord);
+            if (ok && firstBytes) {
+                ok = file.write((const uint8_t*)&ring.records[start], firstBytes) == firstBytes;
+            }
+            if (ok && restBytes) {
+                ok = file.write((const uint8_t*)&ring.records[0], restBytes) == restBytes;
+            }
+        }
+        file.close();
+        if (!ok) fs.remove(outPath);
+    }
+    discardPendingDump();
+    return ok;
+}
+
+void Tracer::discardPendingDump() {
+    for (int core = 0; core < CORE_COUNT; core++) {
+        rings[core].head = 0;
+        rings[core].lastSyncHead = 0;
+        rings[core].syncEpoch = 0;
+    }
+    lastDumpMs = millis();
+    dumpPending = false;
+    recording = true;
+}
+
+#endif
@@ -0,0 +1,170 @@
+#pragma once
+#include <M5Cardputer.h>
+#include <FS.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// 跨核二进制事件追踪
+// 通过编译开关 ENABLE_TRACE 启用（见 platformio.ini 的 build_flags）。
+// 未定义时下方所有 TRACE_* 宏展开为空语句，不产生任何代码。
+// 每个核心一个环形缓冲，记录固定 12 字节的事件（周期计数、事件 ID、阶段、参数），
+// 满了覆盖最旧的记录。触发后冻结缓冲，由主循环写到 SD 卡 /traces，
+// PC 端用 tools/trace_to_chrome.py 转换成 Chrome trace JSON（chrome://tracing 或 Perfetto 打开）。
+
+// 事件 ID；名称表写在转储文件里，新增事件只需同时补充 Trace.cpp 的名称
+enum TraceEventId {
+    TRACE_SYNC,             // 时间同步：周期计数与 micros() 的对应关系（自动插入）
+    TRACE_UI_TICK,          // UIManager::tick，参数为帧序号
+    TRACE_UI_UPDATE,        // 控件 update() 动画推进
+    TRACE_UI_FLUSH,         // 脏区刷新（应用区/根屏幕/弹窗）
+    TRACE_UI_OVERLAY,       // 常驻浮层合成
+    TRACE_UI_MIRROR,        // 屏幕镜像推送
+    TRACE_APP_LOOP,         // 前台应用 loop()
+    TRACE_AUDIO_DECODE,     // 一次 AudioGeneratorMP3::loop()
+    TRACE_AUDIO_COMMAND,    // 音频任务处理一条命令，参数为命令类型
+    TRACE_SD_READ,          // SD 读取，开始参数为请求字节数，结束参数为实际字节数
+    TRACE_QUEUE_PUSH,       // 参数为 TraceQueueId
+    TRACE_QUEUE_POP,
+    TRACE_QUEUE_FULL,       // 推送失败（转入积压或丢弃）
+    TRACE_AUDIO_UNDERRUN,   // 参数为累计欠载次数
+    TRACE_TRIGGER,          // 触发转储，参数为 TraceTriggerReason
+    TRACE_EVENT_COUNT
+};
+
+enum TracePhase {
+    TRACE_PHASE_BEGIN,
+    TRACE_PHASE_END,
+    TRACE_PHASE_INSTANT,
+    TRACE_PHASE_SYNC
+};
+
+enum TraceQueueId {
+    TRACE_QUEUE_AUDIO_COMMAND,
+    TRACE_QUEUE_AUDIO_EVENT
+};
+
+enum TraceTriggerReason {
+    TRACE_TRIGGER_MANUAL,       // Ctrl+T
+    TRACE_TRIGGER_UNDERRUN      // 音频欠载
+};
+
+#ifdef ENABLE_TRACE
+
+#ifndef TRACE_RING_SIZE
+#define TRACE_RING_SIZE 1024    // 每核记录数，必须是 2 的幂
+#endif
+
+struct TraceRecord {
+    uint32_t cycles;    // 所在核心的 CCOUNT
+    uint16_t id;        // TraceEventId
+    uint8_t phase;      // TracePhase
+    uint8_t aux;        // 同步记录中为 CPU 频率（MHz）
+    uint32_t arg;       // 同步记录中为 micros()
+};
+
+class Tracer {
+public:
+    static const int CORE_COUNT = 2;
+    static const uint32_t RING_SIZE = TRACE_RING_SIZE;
+    // 超过约 2^26 个周期（240MHz 下约 0.28s）或 1/8 环形缓冲插入一次同步记录：
+    // 32 位周期计数回绕可以还原，缓冲被覆盖后也总留有同步点
+    static const uint32_t SYNC_INTERVAL_CYCLES = 1u << 26;
+    static const uint32_t SYNC_INTERVAL_RECORDS = RING_SIZE / 8;
+    static const uint32_t TRIGGER_COOLDOWN_MS = 10000;     // 自动触发的最小间隔
+    static const char* const DEFAULT_DIR;                   // "/traces"
+
+    struct Ring {
+        TraceRecord records[RING_SIZE];
+        uint32_t head;              // 累计写入条数，取模得到位置
+        uint32_t lastSyncCycles;
+        uint32_t lastSyncHead;
+        uint32_t syncEpoch;
+    };
+
+private:
+    static_assert((TRACE_RING_SIZE & (TRACE_RING_SIZE - 1)) == 0, "TRACE_RING_SIZE must be a power of two");
+    static_assert(sizeof(TraceRecord) == 12, "TraceRecord must stay 12 bytes");
+
+    Ring rings[CORE_COUNT];
+    volatile bool recording;
+    volatile bool dumpPending;
+    volatile uint32_t syncEpoch;        // 变化后每个核心的下一条记录前重新同步
+    volatile uint16_t triggerReason;
+    uint32_t lastDumpMs;
+
+    void addSync(Ring& ring, uint32_t cycles);
+
+public:
+    Tracer();
+
+    // 热路径：屏蔽本核中断后写入本核环形缓冲，不加锁、不分配内存，约数十个周期
+    inline void record(uint16_t id, uint8_t phase, uint32_t arg) {
+        if (!recording) return;
+        UBaseType_t irq = portSET_INTERRUPT_MASK_FROM_ISR();
+        uint32_t cycles = ESP.getCycleCount();
+        Ring& ring = rings[xPortGetCoreID() & 1];
+        if (ring.syncEpoch != syncEpoch || cycles - ring.lastSyncCycles > SYNC_INTERVAL_CYCLES ||
+            ring.head - ring.lastSyncHead >= SYNC_INTERVAL_RECORDS) {
+            addSync(ring, cycles);
+        }
+        TraceRecord& r = ring.records[ring.head & (RING_SIZE - 1)];
+        ring.head++;
+        r.cycles = cycles;
+        r.id = id;
+        r.phase = phase;
+        r.aux = 0;
+        r.arg = arg;
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(irq);
+    }
+
+    // 冻结缓冲并请求转储；可在任意任务中调用，实际写卡由主循环调用 writePendingDump 完成
+    void trigger(uint16_t reason, bool manual);
+    // CPU 频率变化后调用，之后的记录换算时间使用新的频率
+    void resync() { syncEpoch = syncEpoch + 1; }
+
+    bool isRecording() const { return recording; }
+    bool hasPendingDump() const { return dumpPending; }
+
+    // 主线程：有待转储时写到 dir 下第一个未使用的 trace_NNNN.bin，随后清空缓冲继续记录
+    bool writePendingDump(fs::FS& fs, const char* dir, String& outPath);
+    void discardPendingDump();
+};
+
+// 作用域事件：构造时记录开始，析构时记录结束
+class TraceScope {
+private:
+    uint16_t id;
+public:
+    TraceScope(uint16_t eventId, uint32_t arg);
+    ~TraceScope();
+};
+
+extern Tracer globalTracer;
+
+inline TraceScope::TraceScope(uint16_t eventId, uint32_t arg) : id(eventId) {
+    globalTracer.record(id, TRACE_PHASE_BEGIN, arg);
+}
+
+inline TraceScope::~TraceScope() {
+    globalTracer.record(id, TRACE_PHASE_END, 0);
+}
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(id, arg) TraceScope TRACE_CONCAT(_traceScope, __LINE__)((id), (arg))
+#define TRACE_BEGIN(id, arg) globalTracer.record((id), TRACE_PHASE_BEGIN, (arg))
+#define TRACE_END(id, arg) globalTracer.record((id), TRACE_PHASE_END, (arg))
+#define TRACE_INSTANT(id, arg) globalTracer.record((id), TRACE_PHASE_INSTANT, (arg))
+#define TRACE_TRIGGER(reason) globalTracer.trigger((reason), false)
+#define TRACE_RESYNC() globalTracer.resync()
+
+#else
+
+#define TRACE_SCOPE(id, arg) do {} while (0)
+#define TRACE_BEGIN(id, arg) do {} while (0)
+#define TRACE_END(id, arg) do {} while (0)
+#define TRACE_INSTANT(id, arg) do {} while (0)
+#define TRACE_TRIGGER(reason) do {} while (0)
+#define TRACE_RESYNC() do {} while (0)
+
+#endif
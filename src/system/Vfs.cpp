@@ -0,0 +1,166 @@
+#include "system/Vfs.h"
+#include "system/BinaryUtil.h"
+#include <errno.h>
+#include <sys/stat.h>
+
+static void fillStat(const struct stat& st, VfsStat& out) {
+    out.exists = true;
+    out.isDirectory = S_ISDIR(st.st_mode);
+    out.size = out.isDirectory ? 0 : (uint32_t)st.st_size;
+    out.mtime = (uint32_t)st.st_mtime;
+}
+
+// 不存在（ENOENT/ENOTDIR）是正常结果，其余错误交给调用者
+static bool statHostPath(const char* hostPath, VfsStat& out) {
+    out = VfsStat();
+    struct stat st;
+    if (::stat(hostPath, &st) == 0) {
+        fillStat(st, out);
+        return true;
+    }
+    return errno == ENOENT || errno == ENOTDIR;
+}
+
+bool FsBackend::stat(const char* path, VfsStat& out) {
+    // FATFS 不支持对挂载点本身 stat，根目录在挂载后总是存在
+    if (path[0] == '\0' || (path[0] == '/' && path[1] == '\0')) {
+        out = VfsStat();
+        out.exists = true;
+        out.isDirectory = true;
+        return true;
+    }
+    String full = mountPoint;
+    if (path[0] != '/') full += "/";
+    full += path;
+    return statHostPath(full.c_str(), out);
+}
+
+#ifdef NATIVE_BUILD
+bool HostBackend::stat(const char* path, VfsStat& out) {
+    return statHostPath(fs.hostPath(path).c_str(), out);
+}
+#endif
+
+Vfs::Vfs(VfsBackend* b) : backend(b), useClock(0), statCalls(0), cacheHits(0) {
+    invalidateAll();
+}
+
+uint32_t Vfs::hashPath(const char* path) {
+    return fnv1a(path);
+}
+
+Vfs::Dentry* Vfs::lookup(const char* path, uint32_t hash) {
+    for (int i = 0; i < VFS_DENTRY_CACHE_SIZE; i++) {
+        Dentry& d = dentries[i];
+        if (d.lastUse != 0 && d.hash == hash && d.path == path) return &d;
+    }
+    return nullptr;
+}
+
+void Vfs::remember(const String& path, const VfsStat& st) {
+    uint32_t hash = hashPath(path.c_str());
+    Dentry* slot = lookup(path.c_str(), hash);
+    if (!slot) {
+        // 换掉空槽或最久未用的条目
+        slot = &dentries[0];
+        for (int i = 0; i < VFS_DENTRY_CACHE_SIZE && slot->lastUse != 0; i++) {
+            if (dentries[i].lastUse < slot->lastUse) slot = &dentries[i];
+        }
+        slot->hash = hash;
+        slot->path = path;
+    }
+    slot->st = st;
+    slot->lastUse = ++useClock;
+}
+
+bool Vfs::stat(const String& path, VfsStat& out) {
+    statCalls++;
+    uint32_t hash = hashPath(path.c_str());
+    Dentry* d = lookup(path.c_str(), hash);
+    if (d) {
+        cacheHits++;
+        d->lastUse = ++useClock;
+        out = d->st;
+        return true;
+    }
+    if (!backend->stat(path.c_str(), out)) return false;
+    remember(path, out);
+    return true;
+}
+
+bool Vfs::exists(const String& path) {
+    VfsStat st;
+    return stat(path, st) && st.exists;
+}
+
+bool Vfs::isDirectory(const String& path) {
+    VfsStat st;
+    return stat(path, st) && st.exists && st.isDirectory;
+}
+
+void Vfs::invalidate(const String& path) {
+    Dentry* d = lookup(path.c_str(), hashPath(path.c_str()));
+    if (d) d->lastUse = 0;
+}
+
+// 上级目录的修改时间随之变化
+void Vfs::invalidateParent(const char* path) {
+    const char* slash = strrchr(path, '/');
+    if (!slash) return;
+    String parent = slash == path ? String("/") : String(path).substring(0, slash - path);
+    invalidate(parent);
+}
+
+// 使 path 本身及其下的所有路径失效
+void Vfs::invalidateTree(const char* path) {
+    size_t len = strlen(path);
+    for (int i = 0; i < VFS_DENTRY_CACHE_SIZE; i++) {
+        Dentry& d = dentries[i];
+        if (d.lastUse == 0) continue;
+        const char* p = d.path.c_str();
+        if (strncmp(p, path, len) == 0 && (p[len] == '\0' || p[len] == '/')) d.lastUse = 0;
+    }
+    invalidateParent(path);
+}
+
+void Vfs::invalidateAll() {
+    for (int i = 0; i < VFS_DENTRY_CACHE_SIZE; i++) {
+        dentries[i].lastUse = 0;
+        dentries[i].path = "";
+    }
+}
+
+File Vfs::open(const String& path, const char* mode) {
+    if (mode && mode[0] != 'r') {
+        invalidate(path);
+        invalidateParent(path.c_str());
+    }
+    return backend->getFs().open(path, mode);
+}
+
+bool Vfs::remove(const String& path) {
+    bool ok = backend->getFs().remove(path);
+    invalidate(path);
+    invalidateParent(path.c_str());
+    return ok;
+}
+
+bool Vfs::rename(const String& from, const String& to) {
+    bool ok = backend->getFs().rename(from, to);
+    invalidateTree(from.c_str());
+    invalidateTree(to.c_str());
+    return ok;
+}
+
+bool Vfs::mkdir(const String& path) {
+    bool ok = backend->getFs().mkdir(path);
+    invalidate(path);
+    invalidateParent(path.c_str());
+    return ok;
+}
+
+bool Vfs::rmdir(const String& path) {
+    bool ok = backend->getFs().rmdir(path);
+    invalidateTree(path.c_str());
+    return ok;
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <M5Cardputer.h>
+#include <FS.h>
+
+// 文件状态；mtime 为 0 表示未知（目录项由目录游标记录时不取修改时间）
+struct VfsStat {
+    bool exists;
+    bool isDirectory;
+    uint32_t size;
+    uint32_t mtime;
+    VfsStat() : exists(false), isDirectory(false), size(0), mtime(0) {}
+};
+
+// 存储后端：提供 Arduino 文件系统对象和不打开文件的 stat
+class VfsBackend {
+public:
+    virtual ~VfsBackend() {}
+    virtual fs::FS& getFs() = 0;
+    // 不存在时返回 true 且 out.exists 为 false；只有后端无法回答时返回 false
+    virtual bool stat(const char* path, VfsStat& out) = 0;
+};
+
+// Arduino 文件系统（SD、LittleFS）：stat 直接走 ESP-IDF VFS 挂载点（SD 为 "/sd"，LittleFS 为 "/littlefs"），
+// 不需要像 SD.open 那样打开文件
+class FsBackend : public VfsBackend {
+private:
+    fs::FS& fs;
+    const char* mountPoint;
+public:
+    FsBackend(fs::FS& f, const char* mount) : fs(f), mountPoint(mount) {}
+    fs::FS& getFs() override { return fs; }
+    bool stat(const char* path, VfsStat& out) override;
+};
+
+#ifdef NATIVE_BUILD
+// 主机端：路径映射到宿主机目录（替身文件系统的根目录），让文件管理器与曲库在 Linux 上做基准
+class HostBackend : public VfsBackend {
+private:
+    fs::FS& fs;
+public:
+    explicit HostBackend(fs::FS& f) : fs(f) {}
+    fs::FS& getFs() override { return fs; }
+    bool stat(const char* path, VfsStat& out) override;
+};
+#endif
+
+// 缓存的目录项条数
+#ifndef VFS_DENTRY_CACHE_SIZE
+#define VFS_DENTRY_CACHE_SIZE 32
+#endif
+
+// 文件系统访问层：路径到状态的目录项缓存（包括不存在的路径），同一路径重复的 exists/isDirectory
+// 不再访问存储。经过本层的写入（写方式打开、删除、改名、建删目录）会使相关路径与其上级目录失效，
+// 改名和删除目录还会使其下的所有路径失效。后台任务直接写 SD 的路径（/.cardputer 下的索引、追踪等）
+// 不在此列，不要通过本层查询。只能在主线程中使用。
+class Vfs {
+private:
+    struct Dentry {
+        uint32_t hash;
+        uint32_t lastUse;       // 0 为空槽
+        VfsStat st;
+        String path;
+    };
+
+    VfsBackend* backend;
+    Dentry dentries[VFS_DENTRY_CACHE_SIZE];
+    uint32_t useClock;
+    uint32_t statCalls;
+    uint32_t cacheHits;
+
+    Vfs(const Vfs&);
+    Vfs& operator=(const Vfs&);
+
+    static uint32_t hashPath(const char* path);
+    Dentry* lookup(const char* path, uint32_t hash);
+    void invalidateParent(const char* path);
+    void invalidateTree(const char* path);
+
+public:
+    explicit Vfs(VfsBackend* b);
+
+    fs::FS& getFs() { return backend->getFs(); }
+
+    // 查询状态（优先取缓存）；后端出错时返回 false
+    bool stat(const String& path, VfsStat& out);
+    bool exists(const String& path);
+    bool isDirectory(const String& path);
+
+    // 以写方式打开时使该路径失效
+    File open(const String& path, const char* mode = FILE_READ);
+    bool remove(const String& path);
+    bool rename(const String& from, const String& to);
+    bool mkdir(const String& path);
+    bool rmdir(const String& path);
+
+    // 记录已知的状态（目录游标列目录时顺带填入），之后的查询不必再访问存储
+    void remember(const String& path, const VfsStat& st);
+    void invalidate(const String& path);
+    void invalidateAll();
+
+    uint32_t getStatCalls() const { return statCalls; }
+    uint32_t getCacheHits() const { return cacheHits; }
+};
@@ -8,10 +8,10 @@ public:
         if (!params.visible || !params.display) return;
         
         params.display->setFont(&fonts::efontCN_12);
-        params.display->setTextColor(TFT_LIGHTGREY);  // 使用浅灰色文本
+        params.display->setTextColor(getLabelColor(params.textColor));
         params.display->setTextSize(1);
         params.display->setCursor(params.x, params.y);
-        params.display->print(params.text);
+        params.display->print(params.text.c_str());
     }
     
     void drawButton(const ThemeDrawParams& params) override {
@@ -33,7 +33,7 @@ public:
             int imgW = 0, imgH = 0;
             bool ok = false;
             if (params.imageData && params.imageDataSize > 24) ok = pngGetSize(params.imageData, params.imageDataSize, imgW, imgH);
-            else if (params.useFile && params.filePath.length() > 0) ok = pngFileGetSize(params.filePath, imgW, imgH);
+            else if (params.useFile && params.filePath.length() > 0) ok = pngFileGetSize(params.filePath.c_str(), imgW, imgH);
             if (ok) {
                 int maxW = params.width - 2;
                 int maxH = params.height - 2;
@@ -62,7 +62,7 @@ public:
             int textY = params.y + (params.height - textHeight) / 2;
             params.display->setTextColor(TFT_WHITE);
             params.display->setCursor(textX, textY);
-            params.display->print(params.text);
+            params.display->print(params.text.c_str());
         }
     }
     
@@ -70,7 +70,7 @@ public:
         if (!params.visible || !params.display) return;
         
         // 绘制深灰色背景
-        params.display->fillRect(params.x, params.y, params.width, params.height, 0x2104);  // 深灰色
+        params.display->fillRect(params.x, params.y, params.width, params.height, getSurfaceColor());
         
         // 绘制浅灰色边框
         params.display->drawRect(params.x, params.y, params.width, params.height, TFT_LIGHTGREY);
@@ -84,7 +84,7 @@ public:
             params.display->setTextColor(TFT_WHITE);
             params.display->setTextSize(1);
             params.display->setCursor(params.x + 5, params.y + 3);
-            params.display->print(params.text);
+            params.display->print(params.text.c_str());
         }
     }
     
@@ -97,7 +97,7 @@ public:
             params.display->setTextColor(TFT_LIGHTGREY);
             params.display->setTextSize(1);
             params.display->setCursor(params.x, params.y - 12);
-            params.display->print(params.label);
+            params.display->print(params.label.c_str());
         }
         
         // 计算滑块轨道
@@ -147,23 +147,17 @@ public:
         if (!params.display) return;
         
         // 绘制背景
-        uint16_t bgColor = params.selected ? TFT_CYAN : 0x2104;  // 选中时用青色，否则用深灰色
+        uint16_t textColor, bgColor;
+        int textX, textY;
+        getMenuItemStyle(params, textColor, bgColor, textX, textY);
         params.display->fillRect(params.x, params.y, params.width, params.height, bgColor);
         
-        // 设置文本颜色
-        uint16_t textColor = TFT_LIGHTGREY;
-        if (!params.enabled) {
-            textColor = 0x4208;  // 禁用时用更深的灰色
-        } else if (params.selected) {
-            textColor = TFT_BLACK;  // 选中时使用黑色文本以便在青色背景上显示
-        }
-        
         // 绘制文本
         params.display->setFont(&fonts::efontCN_12);
         params.display->setTextColor(textColor);
         params.display->setTextSize(1);
-        params.display->setCursor(params.x + 2, params.y + 2);
-        params.display->print(params.text);
+        params.display->setCursor(textX, textY);
+        params.display->print(params.text.c_str());
     }
     
     void drawGridMenuItem(const GridMenuItemDrawParams& params) override {
@@ -202,7 +196,7 @@ public:
             int imgW = 0, imgH = 0;
             bool ok = false;
             if (params.imageData && params.imageDataSize > 24) ok = pngGetSize(params.imageData, params.imageDataSize, imgW, imgH);
-            else if (params.useFile && params.filePath.length() > 0) ok = pngFileGetSize(params.filePath, imgW, imgH);
+            else if (params.useFile && params.filePath.length() > 0) ok = pngFileGetSize(params.filePath.c_str(), imgW, imgH);
             if (ok) {
                 int maxW = params.width - 4;
                 int maxH = params.height - 4;
@@ -235,7 +229,7 @@ public:
             int textX = params.x + (params.width - textWidth) / 2;
             int textY = params.y + (params.height - 8) / 2;
             params.display->setCursor(textX, textY);
-            params.display->print(params.text);
+            params.display->print(params.text.c_str());
         }
     }
     
@@ -245,6 +239,21 @@ public:
         }
     }
     
+    uint16_t getSurfaceColor() const override { return 0x2104; }  // 深灰色
+    uint16_t getLabelColor(uint16_t) const override { return TFT_LIGHTGREY; }
+    void getMenuItemStyle(const MenuItemDrawParams& params, uint16_t& textColor,
+                          uint16_t& backgroundColor, int& textX, int& textY) const override {
+        backgroundColor = params.selected ? TFT_CYAN : 0x2104;  // 选中时用青色，否则用深灰色
+        textColor = TFT_LIGHTGREY;
+        if (!params.enabled) {
+            textColor = 0x4208;  // 禁用时用更深的灰色
+        } else if (params.selected) {
+            textColor = TFT_BLACK;  // 选中时使用黑色文本以便在青色背景上显示
+        }
+        textX = params.x + 2;
+        textY = params.y + 2;
+    }
+    
     String getThemeName() const override {
         return "Dark";
     }
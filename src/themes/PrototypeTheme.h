@@ -11,7 +11,7 @@ public:
         params.display->setTextColor(params.textColor);
         params.display->setTextSize(1);
         params.display->setCursor(params.x, params.y);
-        params.display->print(params.text);
+        params.display->print(params.text.c_str());
     }
     
     void drawButton(const ThemeDrawParams& params) override {
@@ -33,7 +33,7 @@ public:
             int imgW = 0, imgH = 0;
             bool ok = false;
             if (params.imageData && params.imageDataSize > 24) ok = pngGetSize(params.imageData, params.imageDataSize, imgW, imgH);
-            else if (params.useFile && params.filePath.length() > 0) ok = pngFileGetSize(params.filePath, imgW, imgH);
+            else if (params.useFile && params.filePath.length() > 0) ok = pngFileGetSize(params.filePath.c_str(), imgW, imgH);
             if (ok) {
                 int maxW = params.width - 2;
                 int maxH = params.height - 2;
@@ -62,7 +62,7 @@ public:
             int textY = params.y + (params.height - textHeight) / 2;
             params.display->setTextColor(params.textColor);
             params.display->setCursor(textX, textY);
-            params.display->print(params.text);
+            params.display->print(params.text.c_str());
         }
     }
     
@@ -81,7 +81,7 @@ public:
             params.display->setTextColor(params.textColor);
             params.display->setTextSize(1);
             params.display->setCursor(params.x + 5, params.y + 3);
-            params.display->print(params.text);
+            params.display->print(params.text.c_str());
         }
     }
     
@@ -94,7 +94,7 @@ public:
             params.display->setTextColor(params.textColor);
             params.display->setTextSize(1);
             params.display->setCursor(params.x, params.y - 12);
-            params.display->print(params.label);
+            params.display->print(params.label.c_str());
         }
         
         // 计算滑块轨道
@@ -143,24 +143,18 @@ public:
     void drawMenuItem(const MenuItemDrawParams& params) override {
         if (!params.display) return;
         
-        // 绘制背景
-        uint16_t bgColor = params.selected ? params.selectedColor : params.backgroundColor;
+        // 颜色与文字位置见 Theme::getMenuItemStyle（选中时黑字黄底）
+        uint16_t textColor, bgColor;
+        int textX, textY;
+        getMenuItemStyle(params, textColor, bgColor, textX, textY);
         params.display->fillRect(params.x, params.y, params.width, params.height, bgColor);
         
-        // 设置文本颜色
-        uint16_t textColor = params.textColor;
-        if (!params.enabled) {
-            textColor = params.disabledColor;
-        } else if (params.selected) {
-            textColor = TFT_BLACK;  // 选中时使用黑色文本以便在黄色背景上显示
-        }
-        
         // 绘制文本
         params.display->setFont(&fonts::efontCN_12);
         params.display->setTextColor(textColor);
         params.display->setTextSize(1);
-        params.display->setCursor(params.x + 2, params.y + 2);
-        params.display->print(params.text);
+        params.display->setCursor(textX, textY);
+        params.display->print(params.text.c_str());
     }
     
     void drawGridMenuItem(const GridMenuItemDrawParams& params) override {
@@ -199,7 +193,7 @@ public:
             int imgW = 0, imgH = 0;
             bool ok = false;
             if (params.imageData && params.imageDataSize > 24) ok = pngGetSize(params.imageData, params.imageDataSize, imgW, imgH);
-            else if (params.useFile && params.filePath.length() > 0) ok = pngFileGetSize(params.filePath, imgW, imgH);
+            else if (params.useFile && params.filePath.length() > 0) ok = pngFileGetSize(params.filePath.c_str(), imgW, imgH);
             if (ok) {
                 int maxW = params.width - 4;
                 int maxH = params.height - 4;
@@ -232,7 +226,7 @@ public:
             int textX = params.x + (params.width - textWidth) / 2;
             int textY = params.y + (params.height - 8) / 2;
             params.display->setCursor(textX, textY);
-            params.display->print(params.text);
+            params.display->print(params.text.c_str());
         }
     }
     
@@ -1,13 +1,29 @@
 #pragma once
 #include <M5Cardputer.h>
 
+// 非拥有的只读文本引用：绘制参数只借用控件持有的字符串，不产生堆分配。
+// 被引用的 String 必须在绘制调用期间保持有效，因此禁止由临时对象构造。
+struct TextRef {
+    const char* ptr;
+    size_t len;
+
+    TextRef() : ptr(""), len(0) {}
+    TextRef(const char* s) : ptr(s ? s : ""), len(s ? strlen(s) : 0) {}
+    TextRef(const String& s) : ptr(s.c_str()), len(s.length()) {}
+    TextRef(String&&) = delete;
+
+    const char* c_str() const { return ptr; }
+    unsigned int length() const { return (unsigned int)len; }
+    bool isEmpty() const { return len == 0; }
+};
+
 // 主题绘制参数结构
 struct ThemeDrawParams {
     LGFX_Device* display;
     int x, y, width, height;
     bool focused;
     bool visible;
-    String text;
+    TextRef text;
     uint16_t textColor;
     uint16_t borderColor;
     uint16_t backgroundColor;
@@ -15,15 +31,15 @@ struct ThemeDrawParams {
     uint16_t disabledColor;
     const uint8_t* imageData;
     size_t imageDataSize;
-    String filePath;
+    TextRef filePath;
     bool useFile;
     
     ThemeDrawParams() : display(nullptr), x(0), y(0), width(0), height(0), 
-                       focused(false), visible(true), text(""),
+                       focused(false), visible(true),
                        textColor(TFT_WHITE), borderColor(TFT_WHITE), 
                        backgroundColor(TFT_BLACK), selectedColor(TFT_YELLOW),
                        disabledColor(TFT_DARKGREY), imageData(nullptr), imageDataSize(0),
-                       filePath(""), useFile(false) {}
+                       useFile(false) {}
 };
 
 // 滑块绘制参数
@@ -33,19 +49,19 @@ struct SliderDrawParams : public ThemeDrawParams {
     int currentValue;
     uint16_t trackColor;
     uint16_t thumbColor;
-    String label;
+    TextRef label;
     bool showValue;
     
     SliderDrawParams() : minValue(0), maxValue(100), currentValue(0),
                         trackColor(TFT_DARKGREY), thumbColor(TFT_WHITE),
-                        label(""), showValue(true) {}
+                        showValue(true) {}
 };
 
 // 菜单项绘制参数
 struct MenuItemDrawParams {
     LGFX_Device* display;
     int x, y, width, height;
-    String text;
+    TextRef text;
     bool selected;
     bool enabled;
     uint16_t textColor;
@@ -54,7 +70,7 @@ struct MenuItemDrawParams {
     uint16_t backgroundColor;
     
     MenuItemDrawParams() : display(nullptr), x(0), y(0), width(0), height(0),
-                          text(""), selected(false), enabled(true),
+                          selected(false), enabled(true),
                           textColor(TFT_WHITE), selectedColor(TFT_YELLOW),
                           disabledColor(TFT_DARKGREY), backgroundColor(TFT_BLACK) {}
 };
@@ -63,7 +79,7 @@ struct MenuItemDrawParams {
 struct GridMenuItemDrawParams {
     LGFX_Device* display;
     int x, y, width, height;
-    String text;
+    TextRef text;
     bool selected;
     bool enabled;
     bool focused;  // 整个网格菜单是否有焦点
@@ -74,15 +90,15 @@ struct GridMenuItemDrawParams {
     uint16_t borderColor;
     const uint8_t* imageData;
     size_t imageDataSize;
-    String filePath;
+    TextRef filePath;
     bool useFile;
     
     GridMenuItemDrawParams() : display(nullptr), x(0), y(0), width(0), height(0),
-                              text(""), selected(false), enabled(true), focused(false),
+                              selected(false), enabled(true), focused(false),
                               textColor(TFT_WHITE), selectedColor(TFT_YELLOW),
                               disabledColor(TFT_DARKGREY), backgroundColor(TFT_BLACK),
                               borderColor(TFT_DARKGREY), imageData(nullptr), imageDataSize(0),
-                              filePath(""), useFile(false) {}
+                              useFile(false) {}
 };
 
 #include <SD.h>
@@ -94,8 +110,8 @@ static inline bool pngGetSize(const uint8_t* data, size_t len, int& w, int& h) {
     return true;
 }
 
-static inline bool pngFileGetSize(const String& path, int& w, int& h) {
-    File f = SD.open(path.c_str());
+static inline bool pngFileGetSize(const char* path, int& w, int& h) {
+    File f = SD.open(path);
     if (!f) return false;
     uint8_t buf[24];
     size_t n = f.read(buf, sizeof(buf));
@@ -121,24 +137,57 @@ public:
     
     // 清除区域函数
     virtual void clearArea(LGFX_Device* display, int x, int y, int width, int height) = 0;
-    
+
+    // 颜色查询：跑马灯等控件要把文字预先画进不透明的离屏条带，
+    // 需要知道主题实际使用的前景/背景色，必须与对应 drawXxx 的结果一致
+    virtual uint16_t getSurfaceColor() const { return TFT_BLACK; }  // 窗口内容区底色
+    virtual uint16_t getLabelColor(uint16_t requested) const { return requested; }
+    virtual void getMenuItemStyle(const MenuItemDrawParams& params, uint16_t& textColor,
+                                  uint16_t& backgroundColor, int& textX, int& textY) const {
+        backgroundColor = params.selected ? params.selectedColor : params.backgroundColor;
+        textColor = params.textColor;
+        if (!params.enabled) {
+            textColor = params.disabledColor;
+        } else if (params.selected) {
+            textColor = TFT_BLACK;
+        }
+        textX = params.x + 2;
+        textY = params.y + 2;
+    }
+
     // 主题信息
     virtual String getThemeName() const = 0;
     virtual String getThemeDescription() const = 0;
 };
 
+// 主题工厂：惰性注册的主题在第一次被使用时才构造
+typedef Theme* (*ThemeFactory)();
+
 // 主题管理器
 class ThemeManager {
 private:
-    Theme* themes[10];  // 最多支持10个主题
+    Theme* themes[10];  // 最多支持10个主题；惰性主题创建前为 nullptr
+    ThemeFactory factories[10];
+    const char* names[10];      // 惰性主题的名称，创建前用于列表与按名查找
     int themeCount;
     int currentThemeIndex;
     String currentThemeName;
     
+    // 按需创建主题，内存不足时返回 nullptr
+    Theme* ensureTheme(int index) {
+        if (index < 0 || index >= themeCount) return nullptr;
+        if (!themes[index] && factories[index]) {
+            themes[index] = factories[index]();
+        }
+        return themes[index];
+    }
+    
 public:
     ThemeManager() : themeCount(0), currentThemeIndex(0), currentThemeName("Default") {
         for (int i = 0; i < 10; i++) {
             themes[i] = nullptr;
+            factories[i] = nullptr;
+            names[i] = nullptr;
         }
     }
     
@@ -157,23 +206,34 @@ public:
         return true;
     }
     
+    // 惰性注册主题：name 必须是静态字符串且与主题的 getThemeName() 一致
+    bool registerThemeFactory(const char* name, ThemeFactory factory) {
+        if (themeCount >= 10 || name == nullptr || factory == nullptr) {
+            return false;
+        }
+        
+        names[themeCount] = name;
+        factories[themeCount] = factory;
+        themeCount++;
+        return true;
+    }
+    
     // 设置当前主题
     bool setCurrentTheme(const String& themeName) {
         for (int i = 0; i < themeCount; i++) {
-            if (themes[i] && themes[i]->getThemeName() == themeName) {
-                currentThemeIndex = i;
-                currentThemeName = themeName;
-                return true;
+            if (getThemeName(i) == themeName) {
+                return setCurrentTheme(i);
             }
         }
         return false;
     }
     
-    // 设置当前主题（通过索引）
+    // 设置当前主题（通过索引），惰性主题在这里创建
     bool setCurrentTheme(int index) {
-        if (index >= 0 && index < themeCount && themes[index]) {
+        Theme* theme = ensureTheme(index);
+        if (theme) {
             currentThemeIndex = index;
-            currentThemeName = themes[index]->getThemeName();
+            currentThemeName = theme->getThemeName();
             return true;
         }
         return false;
@@ -192,13 +252,23 @@ public:
         return themeCount;
     }
     
+    // 获取主题名称，不会创建惰性主题
+    String getThemeName(int index) const {
+        if (index < 0 || index >= themeCount) return String();
+        if (themes[index]) return themes[index]->getThemeName();
+        return names[index] ? String(names[index]) : String();
+    }
+    
+    // 主题实例是否已创建
+    bool isThemeCreated(int index) const {
+        return index >= 0 && index < themeCount && themes[index] != nullptr;
+    }
+    
     // 获取主题列表
     void getThemeList(String* themeNames, int maxCount) const {
         int count = (maxCount < themeCount) ? maxCount : themeCount;
         for (int i = 0; i < count; i++) {
-            if (themes[i]) {
-                themeNames[i] = themes[i]->getThemeName();
-            }
+            themeNames[i] = getThemeName(i);
         }
     }
     
@@ -212,31 +282,22 @@ public:
         return currentThemeIndex;
     }
     
-    // 获取指定索引的主题
+    // 获取指定索引的主题（惰性主题会在这里创建）
     Theme* getTheme(int index) {
-        if (index >= 0 && index < themeCount) {
-            return themes[index];
-        }
-        return nullptr;
+        return ensureTheme(index);
     }
     
     // 下一个主题
     void nextTheme() {
         if (themeCount > 1) {
-            currentThemeIndex = (currentThemeIndex + 1) % themeCount;
-            if (themes[currentThemeIndex]) {
-                currentThemeName = themes[currentThemeIndex]->getThemeName();
-            }
+            setCurrentTheme((currentThemeIndex + 1) % themeCount);
         }
     }
     
     // 上一个主题
     void previousTheme() {
         if (themeCount > 1) {
-            currentThemeIndex = (currentThemeIndex - 1 + themeCount) % themeCount;
-            if (themes[currentThemeIndex]) {
-                currentThemeName = themes[currentThemeIndex]->getThemeName();
-            }
+            setCurrentTheme((currentThemeIndex - 1 + themeCount) % themeCount);
         }
     }
 };
@@ -29,10 +29,10 @@ public:
     void drawLabel(const ThemeDrawParams& params) override {
         if (!params.visible || !params.display) return;
         params.display->setFont(&fonts::efontCN_12);
-        params.display->setTextColor(WC_TEXT);
+        params.display->setTextColor(getLabelColor(params.textColor));
         params.display->setTextSize(1);
         params.display->setCursor(params.x, params.y);
-        params.display->print(params.text);
+        params.display->print(params.text.c_str());
     }
 
     void drawButton(const ThemeDrawParams& params) override {
@@ -56,7 +56,7 @@ public:
             int imgW = 0, imgH = 0;
             bool ok = false;
             if (params.imageData && params.imageDataSize > 24) ok = pngGetSize(params.imageData, params.imageDataSize, imgW, imgH);
-            else if (params.useFile && params.filePath.length() > 0) ok = pngFileGetSize(params.filePath, imgW, imgH);
+            else if (params.useFile && params.filePath.length() > 0) ok = pngFileGetSize(params.filePath.c_str(), imgW, imgH);
             if (ok) {
                 int maxW = params.width - 6;
                 int maxH = params.height - 6;
@@ -85,7 +85,7 @@ public:
             int textY = params.y + (params.height - textHeight) / 2;
             params.display->setTextColor(WC_TEXT);
             params.display->setCursor(textX, textY);
-            params.display->print(params.text);
+            params.display->print(params.text.c_str());
         }
     }
 
@@ -107,7 +107,7 @@ public:
             params.display->setTextColor(TFT_WHITE);
             params.display->setTextSize(1);
             params.display->setCursor(params.x + 4, params.y + 2);
-            params.display->print(params.text);
+            params.display->print(params.text.c_str());
         }
     }
 
@@ -120,7 +120,7 @@ public:
             params.display->setTextColor(WC_TEXT);
             params.display->setTextSize(1);
             params.display->setCursor(params.x, params.y - 12);
-            params.display->print(params.label);
+            params.display->print(params.label.c_str());
         }
 
         // 水彩风轨道与滑块
@@ -158,15 +158,15 @@ public:
 
     void drawMenuItem(const MenuItemDrawParams& params) override {
         if (!params.display) return;
-        uint16_t bg = params.selected ? WC_ACCENT : WC_BG;
-        uint16_t txt = params.enabled ? WC_TEXT : TFT_DARKGREY;
-        if (params.selected) txt = TFT_BLACK;
+        uint16_t txt, bg;
+        int textX, textY;
+        getMenuItemStyle(params, txt, bg, textX, textY);
         params.display->fillRect(params.x, params.y, params.width, params.height, bg);
         params.display->setFont(&fonts::efontCN_12);
         params.display->setTextColor(txt);
         params.display->setTextSize(1);
-        params.display->setCursor(params.x + 2, params.y + 2);
-        params.display->print(params.text);
+        params.display->setCursor(textX, textY);
+        params.display->print(params.text.c_str());
     }
 
     void drawGridMenuItem(const GridMenuItemDrawParams& params) override {
@@ -193,7 +193,7 @@ public:
             int imgW = 0, imgH = 0;
             bool ok = false;
             if (params.imageData && params.imageDataSize > 24) ok = pngGetSize(params.imageData, params.imageDataSize, imgW, imgH);
-            else if (params.useFile && params.filePath.length() > 0) ok = pngFileGetSize(params.filePath, imgW, imgH);
+            else if (params.useFile && params.filePath.length() > 0) ok = pngFileGetSize(params.filePath.c_str(), imgW, imgH);
             if (ok) {
                 int maxW = params.width - 6;
                 int maxH = params.height - 6;
@@ -222,7 +222,7 @@ public:
             params.display->setTextColor(txt);
             params.display->setTextSize(1);
             params.display->setCursor(textX, textY);
-            params.display->print(params.text);
+            params.display->print(params.text.c_str());
         }
     }
 
@@ -232,6 +232,18 @@ public:
         }
     }
 
+    // 窗口是九宫格贴图，纯色近似取内容区的白底
+    uint16_t getSurfaceColor() const override { return WC_BG; }
+    uint16_t getLabelColor(uint16_t) const override { return WC_TEXT; }
+    void getMenuItemStyle(const MenuItemDrawParams& params, uint16_t& textColor,
+                          uint16_t& backgroundColor, int& textX, int& textY) const override {
+        backgroundColor = params.selected ? WC_ACCENT : WC_BG;
+        textColor = params.enabled ? WC_TEXT : TFT_DARKGREY;
+        if (params.selected) textColor = TFT_BLACK;
+        textX = params.x + 2;
+        textY = params.y + 2;
+    }
+
     String getThemeName() const override { return "Watercolor"; }
     String getThemeDescription() const override { return "Soft watercolor UI with nine-patch windows"; }
 };
\ No newline at end of file
@@ -61,10 +61,10 @@ public:
         if (!params.visible || !params.display) return;
         
         params.display->setFont(&fonts::efontCN_12);
-        params.display->setTextColor(WIN98_WINDOW_TEXT);
+        params.display->setTextColor(getLabelColor(params.textColor));
         params.display->setTextSize(1);
         params.display->setCursor(params.x, params.y);
-        params.display->print(params.text);
+        params.display->print(params.text.c_str());
     }
     
     void drawButton(const ThemeDrawParams& params) override {
@@ -96,7 +96,7 @@ public:
             int imgW = 0, imgH = 0;
             bool ok = false;
             if (params.imageData && params.imageDataSize > 24) ok = pngGetSize(params.imageData, params.imageDataSize, imgW, imgH);
-            else if (params.useFile && params.filePath.length() > 0) ok = pngFileGetSize(params.filePath, imgW, imgH);
+            else if (params.useFile && params.filePath.length() > 0) ok = pngFileGetSize(params.filePath.c_str(), imgW, imgH);
             if (ok) {
                 int maxW = params.width - 6;
                 int maxH = params.height - 6;
@@ -128,7 +128,7 @@ public:
             if (params.focused) { textX += 1; textY += 1; }
             params.display->setTextColor(WIN98_WINDOW_TEXT);
             params.display->setCursor(textX, textY);
-            params.display->print(params.text);
+            params.display->print(params.text.c_str());
         }
     }
     
@@ -136,7 +136,7 @@ public:
         if (!params.visible || !params.display) return;
         
         // 绘制窗口背景
-        params.display->fillRect(params.x + 2, params.y + 15, params.width - 3, params.height - 17, WIN98_WINDOW_BACKGROUND);
+        params.display->fillRect(params.x + 2, params.y + 15, params.width - 3, params.height - 17, getSurfaceColor());
         
         // 绘制标题栏
         params.display->fillRect(params.x + 2, params.y + 2, params.width - 4, 14, WIN98_ACTIVE_CAPTION);
@@ -150,7 +150,7 @@ public:
             params.display->setTextColor(WIN98_CAPTION_TEXT);
             params.display->setTextSize(1);
             params.display->setCursor(params.x + 6, params.y + 2);
-            params.display->print(params.text);
+            params.display->print(params.text.c_str());
         }
     }
     
@@ -193,14 +193,9 @@ public:
     void drawMenuItem(const MenuItemDrawParams& params) override {
         if (!params.display) return;
         
-        uint16_t bgColor = WIN98_EDIT_BACKGROUND;  // 默认白色背景
-        uint16_t textColor = WIN98_WINDOW_TEXT;    // 黑色文本
-        
-        // 如果选中，使用高亮颜色
-        if (params.selected) {
-            bgColor = WIN98_MENU_HIGHLIGHT;        // 蓝色高亮背景
-            textColor = WIN98_CAPTION_TEXT;        // 白色文本
-        }
+        uint16_t textColor, bgColor;
+        int textX, textY;
+        getMenuItemStyle(params, textColor, bgColor, textX, textY);
         
         // 绘制菜单项背景（无边框）
         params.display->fillRect(params.x, params.y, params.width, params.height, bgColor);
@@ -209,8 +204,8 @@ public:
         params.display->setFont(&fonts::efontCN_12);
         params.display->setTextColor(textColor);
         params.display->setTextSize(1);
-        params.display->setCursor(params.x + 4, params.y + (params.height - 10) / 2);
-        params.display->print(params.text);
+        params.display->setCursor(textX, textY);
+        params.display->print(params.text.c_str());
     }
     
     void drawGridMenuItem(const GridMenuItemDrawParams& params) override {
@@ -245,7 +240,7 @@ public:
             int imgW = 0, imgH = 0;
             bool ok = false;
             if (params.imageData && params.imageDataSize > 24) ok = pngGetSize(params.imageData, params.imageDataSize, imgW, imgH);
-            else if (params.useFile && params.filePath.length() > 0) ok = pngFileGetSize(params.filePath, imgW, imgH);
+            else if (params.useFile && params.filePath.length() > 0) ok = pngFileGetSize(params.filePath.c_str(), imgW, imgH);
             if (ok) {
                 int maxW = params.width - 6;
                 int maxH = params.height - 6;
@@ -275,7 +270,7 @@ public:
             int textX = params.x + (params.width - textWidth) / 2;
             int textY = params.y + (params.height - 8) / 2;
             params.display->setCursor(textX, textY);
-            params.display->print(params.text);
+            params.display->print(params.text.c_str());
         }
     }
     
@@ -284,6 +279,21 @@ public:
         display->fillRect(x, y, width, height, WIN98_WINDOW_BACKGROUND);
     }
     
+    uint16_t getSurfaceColor() const override { return WIN98_WINDOW_BACKGROUND; }
+    uint16_t getLabelColor(uint16_t) const override { return WIN98_WINDOW_TEXT; }
+    void getMenuItemStyle(const MenuItemDrawParams& params, uint16_t& textColor,
+                          uint16_t& backgroundColor, int& textX, int& textY) const override {
+        backgroundColor = WIN98_EDIT_BACKGROUND;  // 默认白色背景
+        textColor = WIN98_WINDOW_TEXT;            // 黑色文本
+        // 如果选中，使用高亮颜色
+        if (params.selected) {
+            backgroundColor = WIN98_MENU_HIGHLIGHT;  // 蓝色高亮背景
+            textColor = WIN98_CAPTION_TEXT;          // 白色文本
+        }
+        textX = params.x + 4;
+        textY = params.y + (params.height - 10) / 2;
+    }
+    
     String getThemeName() const override {
         return "Windows 98";
     }
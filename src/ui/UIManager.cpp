@@ -1,4 +1,6 @@
 #include "UIManager.h"
+#include "system/Profiler.h"
+#include "system/Trace.h"
 
 static bool rectIntersects(int ax, int ay, int aw, int ah, int bx, int by, int bw, int bh) {
     if (aw <= 0 || ah <= 0 || bw <= 0 || bh <= 0) return false;
@@ -24,6 +26,21 @@ static bool intersectRects(int ax, int ay, int aw, int ah, int bx, int by, int b
     return true;
 }
 
+#ifdef ENABLE_UI_PROFILER
+static ProfileSection profileSectionForWidget(UIWidget* widget) {
+    switch (widget->getType()) {
+        case WIDGET_LABEL: return PROF_DRAW_LABEL;
+        case WIDGET_BUTTON: return PROF_DRAW_BUTTON;
+        case WIDGET_WINDOW: return PROF_DRAW_WINDOW;
+        case WIDGET_MENU_LIST: return PROF_DRAW_LIST;
+        case WIDGET_MENU_GRID: return PROF_DRAW_GRID;
+        case WIDGET_SLIDER: return PROF_DRAW_SLIDER;
+        case WIDGET_IMAGE: return PROF_DRAW_IMAGE;
+        default: return PROF_DRAW_OTHER;
+    }
+}
+#endif
+
 bool UIManager::computeClipRect(UIWidget* widget, int& outX, int& outY, int& outW, int& outH) {
     if (!widget) return false;
     int ax, ay, aw, ah;
@@ -60,9 +77,14 @@ void UIManager::drawWidgetClipped(UIWidget* widget, bool partial) {
     if (!display || !widget) return;
     int cx, cy, cw, ch;
     if (!computeClipRect(widget, cx, cy, cw, ch)) return;
+    noteDrawn(cx, cy, cw, ch);
     display->setClipRect(cx, cy, cw, ch);
-    if (partial) widget->drawPartial(display);
-    else widget->draw(display);
+    {
+        PROFILE_SCOPE(profileSectionForWidget(widget));
+        PROFILE_PIXELS((uint32_t)(cw * ch));
+        if (partial) widget->drawPartial(display);
+        else widget->draw(display);
+    }
     display->clearClipRect();
     widget->markDrawn();
 }
@@ -73,21 +95,41 @@ void UIManager::drawWidgetClippedWithExtra(UIWidget* widget, bool partial, int c
     if (!computeClipRect(widget, wx, wy, ww, wh)) return;
     int cx, cy, cw, ch;
     if (!intersectRects(wx, wy, ww, wh, clipX, clipY, clipW, clipH, cx, cy, cw, ch)) return;
+    noteDrawn(cx, cy, cw, ch);
     display->setClipRect(cx, cy, cw, ch);
-    if (partial) widget->drawPartial(display);
-    else widget->draw(display);
+    {
+        PROFILE_SCOPE(profileSectionForWidget(widget));
+        PROFILE_PIXELS((uint32_t)(cw * ch));
+        if (partial) widget->drawPartial(display);
+        else widget->draw(display);
+    }
     display->clearClipRect();
     widget->markDrawn();
 }
 
+void UIManager::drawOpaqueDamage(UIWidget** list, int count) {
+    for (int i = 0; i < count; i++) {
+        UIWidget* w = list[i];
+        if (!w || !w->isVisible() || !w->isDirty()) continue;
+        int x, y, ww, hh;
+        w->getDirtyBounds(x, y, ww, hh);
+        drawWidgetClippedWithExtra(w, false, x, y, ww, hh);
+        w->markDrawn();
+    }
+}
+
 bool UIManager::flushDirtyInAppArea() {
     if (!hasBackgroundLayer || foregroundWidgetCount <= 0) return false;
+    PROFILE_SCOPE(PROF_FLUSH);
+    TRACE_SCOPE(TRACE_UI_FLUSH, 0);
 
     int dirtyX = 0, dirtyY = 0, dirtyW = 0, dirtyH = 0;
     bool hasDirty = false;
+    bool opaqueOnly = true;
     for (int i = 0; i < foregroundWidgetCount; i++) {
         UIWidget* w = foregroundWidgets[i];
         if (!w || !w->isVisible() || !w->isDirty()) continue;
+        if (!w->isDamageOpaque()) opaqueOnly = false;
         int x, y, ww, hh;
         w->getDirtyBounds(x, y, ww, hh);
         if (!hasDirty) {
@@ -106,6 +148,12 @@ bool UIManager::flushDirtyInAppArea() {
     }
     if (!hasDirty) return false;
 
+    if (opaqueOnly) {
+        // 所有脏区都会被控件自身不透明地覆盖（跑马灯逐帧推进），不必重绘窗口背景
+        drawOpaqueDamage(foregroundWidgets, foregroundWidgetCount);
+        return true;
+    }
+
     UIWindow* appWindow = nullptr;
     for (int i = 0; i < foregroundWidgetCount; i++) {
         if (foregroundWidgets[i] && foregroundWidgets[i]->getType() == WIDGET_WINDOW) {
@@ -136,12 +184,17 @@ bool UIManager::flushDirtyInAppArea() {
 }
 
 bool UIManager::flushDirtyInRoot() {
-    if (hasBackgroundLayer) return false;
+    // 没有前景应用时（包括从应用返回启动器后）直接刷新主列表
+    if (hasBackgroundLayer && foregroundWidgetCount > 0) return false;
+    PROFILE_SCOPE(PROF_FLUSH);
+    TRACE_SCOPE(TRACE_UI_FLUSH, 0);
     int dirtyX = 0, dirtyY = 0, dirtyW = 0, dirtyH = 0;
     bool hasDirty = false;
+    bool opaqueOnly = true;
     for (int i = 0; i < widgetCount; i++) {
         UIWidget* w = widgets[i];
         if (!w || !w->isVisible() || !w->isDirty()) continue;
+        if (!w->isDamageOpaque()) opaqueOnly = false;
         int x, y, ww, hh;
         w->getDirtyBounds(x, y, ww, hh);
         if (!hasDirty) {
@@ -160,6 +213,11 @@ bool UIManager::flushDirtyInRoot() {
     }
     if (!hasDirty) return false;
 
+    if (opaqueOnly) {
+        drawOpaqueDamage(widgets, widgetCount);
+        return true;
+    }
+
     for (int i = 0; i < widgetCount; i++) {
         UIWidget* w = widgets[i];
         if (!w || !w->isVisible()) continue;
@@ -179,23 +237,31 @@ bool UIManager::flushDirtyInRoot() {
 }
 
 UIManager::UIManager() : display(&M5Cardputer.Display), widgetCount(0), currentFocus(-1), focusableCount(0),
-                  backgroundWidgetCount(0), foregroundWidgetCount(0), hasBackgroundLayer(false), rootScreen(nullptr), lastAnimationRedrawMs(0) {
+                  backgroundWidgetCount(0), foregroundWidgetCount(0), hasBackgroundLayer(false), rootScreen(nullptr), lastAnimationRedrawMs(0),
+                  popup(nullptr), popupSaveUnder(nullptr), popupSaveX(0), popupSaveY(0), popupSaveW(0), popupSaveH(0),
+                  savedFocusableCount(0), savedCurrentFocus(-1),
+                  overlay(nullptr), hasDrawnRect(false), drawnX(0), drawnY(0), drawnW(0), drawnH(0),
+                  mirror(nullptr), tickCount(0), frameCount(0) {
     for (int i = 0; i < 20; i++) {
         widgets[i] = nullptr;
         focusableWidgets[i] = -1;
         backgroundWidgets[i] = nullptr;
         foregroundWidgets[i] = nullptr;
+        savedFocusableWidgets[i] = -1;
     }
     int dw = display ? display->width() : 0;
     int dh = display ? display->height() : 0;
     if (dw <= 0) dw = 240;
     if (dh <= 0) dh = 135;
     rootScreen = new UIScreen(-1000, dw, dh, "RootScreen");
+    overlay = new UIOverlay(display);
 }
 
 UIManager::~UIManager() {
     clear();
     if (rootScreen) { delete rootScreen; rootScreen = nullptr; }
+    if (overlay) { delete overlay; overlay = nullptr; }
+    if (mirror) { delete mirror; mirror = nullptr; }
 }
 
 void UIManager::addWidget(UIWidget* widget) {
@@ -273,6 +339,9 @@ void UIManager::removeWidget(int id) {
 }
 
 void UIManager::clear() {
+    // 弹窗及其选项按钮也在 widgets 中，随之一起释放
+    popup = nullptr;
+    if (popupSaveUnder) { delete[] popupSaveUnder; popupSaveUnder = nullptr; }
     for (int i = 0; i < widgetCount; i++) {
         if (widgets[i]) {
             delete widgets[i];
@@ -354,6 +423,27 @@ UIWidget* UIManager::getCurrentFocusedWidget() {
 }
 
 bool UIManager::handleKeyEvent(const KeyEvent& event) {
+    if (popup) {
+        // 模态：按键只在弹窗选项间流转，ESC 取消
+        if (event.esc) {
+            popup->finish(UIPopup::RESULT_CANCEL);
+        } else if (event.tab || event.right || event.down) {
+            nextFocus();
+        } else if (event.left || event.up) {
+            previousFocus();
+        } else {
+            UIWidget* option = getCurrentFocusedWidget();
+            if (option) {
+                option->handleKeyEvent(event);
+            } else if (event.enter) {
+                popup->finish(0);
+            }
+        }
+        if (popup->isFinished()) {
+            closePopup();
+        }
+        return true;
+    }
     UIWidget* focusedWidget = getCurrentFocusedWidget();
     if (event.tab) {
         nextFocus();
@@ -372,6 +462,7 @@ bool UIManager::handleKeyEvent(const KeyEvent& event) {
 
 void UIManager::clearScreen() {
     display->fillScreen(TFT_BLACK);
+    noteDrawn(0, 0, display->width(), display->height());
 }
 
 void UIManager::drawAll() {
@@ -389,19 +480,29 @@ void UIManager::drawAll() {
     }
     if (!hasBackgroundLayer && foregroundWidgetCount == 0) {
         for (int i = 0; i < widgetCount; i++) {
-            if (widgets[i] && widgets[i]->isVisible()) {
+            if (widgets[i] && widgets[i]->isVisible() && widgets[i] != popup && widgets[i]->getParent() != popup) {
                 drawWidgetClipped(widgets[i], false);
             }
         }
     }
+    if (popup) {
+        // 整屏重绘后弹窗下方的内容已变化，重新保存底图再盖上弹窗
+        capturePopupBackground();
+        drawPopup();
+    }
 }
 
 void UIManager::refresh() {
     clearScreen();
     drawAll();
+    compositeOverlay();
 }
 
 void UIManager::switchToApp() {
+    if (popup) {
+        popup->finish(UIPopup::RESULT_CANCEL);
+        closePopup();
+    }
     if (!hasBackgroundLayer && widgetCount > 0) {
         saveToBackground();
     }
@@ -412,11 +513,16 @@ void UIManager::switchToApp() {
 }
 
 void UIManager::switchToLauncher() {
+    if (popup) {
+        popup->finish(UIPopup::RESULT_CANCEL);
+        closePopup();
+    }
     if (foregroundWidgetCount > 0) {
         clearForeground();
     }
     clearScreen();
     drawAll();
+    compositeOverlay();
 }
 
 void UIManager::finishAppSetup() {
@@ -426,19 +532,89 @@ void UIManager::finishAppSetup() {
     } else {
         drawAll();
     }
+    compositeOverlay();
+}
+
+void UIManager::detachForeground(RetainedWidgets& out) {
+    if (popup) {
+        popup->finish(UIPopup::RESULT_CANCEL);
+        closePopup();
+    }
+    out.count = 0;
+    out.focusIndex = (foregroundWidgetCount > 0) ? currentFocus : -1;
+    for (int i = 0; i < foregroundWidgetCount; i++) {
+        UIWidget* w = foregroundWidgets[i];
+        if (!w) continue;
+        removeFromMainList(w);
+        out.widgets[out.count++] = w;
+        foregroundWidgets[i] = nullptr;
+    }
+    foregroundWidgetCount = 0;
+    rebuildFocusListForBackground();
+}
+
+void UIManager::attachForeground(RetainedWidgets& set) {
+    if (!hasBackgroundLayer && widgetCount > 0) {
+        saveToBackground();
+    }
+    if (foregroundWidgetCount > 0) {
+        clearForeground();
+    }
+    for (int i = 0; i < set.count; i++) {
+        UIWidget* w = set.widgets[i];
+        set.widgets[i] = nullptr;
+        if (!w) continue;
+        if (widgetCount >= 20 || foregroundWidgetCount >= 20) {
+            delete w;
+            continue;
+        }
+        widgets[widgetCount++] = w;
+        foregroundWidgets[foregroundWidgetCount++] = w;
+        w->invalidate();
+    }
+    set.count = 0;
+    rebuildFocusListForForeground();
+    // rebuild 把焦点放在第一个控件上，改回挂起前的位置
+    if (set.focusIndex > 0 && set.focusIndex < focusableCount) {
+        widgets[focusableWidgets[currentFocus]]->setFocused(false);
+        currentFocus = set.focusIndex;
+        widgets[focusableWidgets[currentFocus]]->setFocused(true);
+    }
+    set.focusIndex = -1;
+    drawForegroundPartial();
+    compositeOverlay();
+}
+
+void UIManager::destroyRetained(RetainedWidgets& set) {
+    for (int i = 0; i < set.count; i++) {
+        delete set.widgets[i];
+        set.widgets[i] = nullptr;
+    }
+    set.count = 0;
+    set.focusIndex = -1;
 }
 
 void UIManager::drawWidget(int id) {
     UIWidget* widget = getWidget(id);
     if (widget && widget->isVisible()) {
+        if (popup && widget != popup && widget->getParent() != popup) {
+            widget->invalidate();  // 弹窗打开期间推迟到关闭后再绘制
+            return;
+        }
         drawWidgetClipped(widget, false);
+        compositeOverlay();
     }
 }
 
 void UIManager::drawWidgetPartial(int id) {
     UIWidget* widget = getWidget(id);
     if (widget && widget->isVisible()) {
+        if (popup && widget != popup && widget->getParent() != popup) {
+            widget->invalidate();
+            return;
+        }
         drawWidgetClipped(widget, true);
+        compositeOverlay();
     }
 }
 
@@ -449,12 +625,21 @@ void UIManager::drawForegroundPartial() {
                 drawWidgetClipped(foregroundWidgets[i], true);
             }
         }
+        compositeOverlay();
     }
 }
 
 void UIManager::refreshAppArea() {
+    if (popup) {
+        flushDirtyInPopup();
+        compositeOverlay();
+        return;
+    }
     if (hasBackgroundLayer && foregroundWidgetCount > 0) {
-        if (flushDirtyInAppArea()) return;
+        if (flushDirtyInAppArea()) {
+            compositeOverlay();
+            return;
+        }
         UIWindow* appWindow = nullptr;
         for (int i = 0; i < foregroundWidgetCount; i++) {
             if (foregroundWidgets[i] && foregroundWidgets[i]->getType() == WIDGET_WINDOW) {
@@ -469,9 +654,13 @@ void UIManager::refreshAppArea() {
                     drawWidgetClipped(foregroundWidgets[i], false);
                 }
             }
+            compositeOverlay();
         }
     } else {
-        if (flushDirtyInRoot()) return;
+        if (flushDirtyInRoot()) {
+            compositeOverlay();
+            return;
+        }
         refresh();
     }
 }
@@ -486,6 +675,32 @@ void UIManager::smartRefresh() {
 
 void UIManager::tick() {
     uint32_t nowMs = millis();
+    tickCount++;
+    {
+        PROFILE_SCOPE(PROF_TICK);
+        TRACE_SCOPE(TRACE_UI_TICK, tickCount);
+        // 浮层按自身节奏更新，只在提示条消失时让其下方区域重绘
+        int rx, ry, rw, rh;
+        if (overlay && overlay->update(nowMs, rx, ry, rw, rh)) {
+            invalidateRegion(rx, ry, rw, rh);
+        }
+        updateAndFlush(nowMs);
+        compositeOverlay();
+        if (mirror) {
+            TRACE_SCOPE(TRACE_UI_MIRROR, 0);
+            if (overlay && overlay->takeRenderedRect(rx, ry, rw, rh)) {
+                mirror->markDirty(rx, ry, rw, rh);
+            }
+            mirror->flush(nowMs);
+        }
+    }
+    PROFILE_END_FRAME();
+#ifdef ENABLE_UI_PROFILER
+    globalProfiler.drawOverlay(display, nowMs);
+#endif
+}
+
+void UIManager::updateAndFlush(uint32_t nowMs) {
     if (display && rootScreen) {
         int w = display->width();
         int h = display->height();
@@ -494,35 +709,40 @@ void UIManager::tick() {
         }
     }
     bool anyUpdateRequested = false;
-    if (hasBackgroundLayer) {
-        for (int i = 0; i < backgroundWidgetCount; i++) {
-            if (backgroundWidgets[i] && backgroundWidgets[i]->isVisible()) {
-                if (backgroundWidgets[i]->update(nowMs)) {
-                    backgroundWidgets[i]->invalidate();
-                    anyUpdateRequested = true;
+    {
+        PROFILE_SCOPE(PROF_UPDATE);
+        TRACE_SCOPE(TRACE_UI_UPDATE, 0);
+        if (hasBackgroundLayer) {
+            for (int i = 0; i < backgroundWidgetCount; i++) {
+                if (backgroundWidgets[i] && backgroundWidgets[i]->isVisible()) {
+                    if (backgroundWidgets[i]->update(nowMs)) {
+                        backgroundWidgets[i]->invalidate();
+                        anyUpdateRequested = true;
+                    }
                 }
             }
-        }
-        for (int i = 0; i < foregroundWidgetCount; i++) {
-            if (foregroundWidgets[i] && foregroundWidgets[i]->isVisible()) {
-                if (foregroundWidgets[i]->update(nowMs)) {
-                    foregroundWidgets[i]->invalidate();
-                    anyUpdateRequested = true;
+            for (int i = 0; i < foregroundWidgetCount; i++) {
+                if (foregroundWidgets[i] && foregroundWidgets[i]->isVisible()) {
+                    if (foregroundWidgets[i]->update(nowMs)) {
+                        foregroundWidgets[i]->invalidate();
+                        anyUpdateRequested = true;
+                    }
                 }
             }
-        }
-    } else {
-        for (int i = 0; i < widgetCount; i++) {
-            if (widgets[i] && widgets[i]->isVisible()) {
-                if (widgets[i]->update(nowMs)) {
-                    widgets[i]->invalidate();
-                    anyUpdateRequested = true;
+        } else {
+            for (int i = 0; i < widgetCount; i++) {
+                if (widgets[i] && widgets[i]->isVisible()) {
+                    if (widgets[i]->update(nowMs)) {
+                        widgets[i]->invalidate();
+                        anyUpdateRequested = true;
+                    }
                 }
             }
         }
     }
     bool anyDirty = false;
-    if (hasBackgroundLayer) {
+    bool appLayer = hasBackgroundLayer && foregroundWidgetCount > 0;
+    if (appLayer) {
         for (int i = 0; i < foregroundWidgetCount; i++) {
             if (foregroundWidgets[i] && foregroundWidgets[i]->isVisible() && foregroundWidgets[i]->isDirty()) {
                 anyDirty = true;
@@ -537,14 +757,210 @@ void UIManager::tick() {
             }
         }
     }
+    if (popup) {
+        // 弹窗打开期间下层控件只累积脏标记，关闭并恢复底图后再统一刷新
+        if (nowMs - lastAnimationRedrawMs < 16) return;
+        if (flushDirtyInPopup()) {
+            lastAnimationRedrawMs = nowMs;
+            frameCount++;
+        }
+        return;
+    }
     if (!anyUpdateRequested && !anyDirty) return;
     if (nowMs - lastAnimationRedrawMs < 16) return;
     lastAnimationRedrawMs = nowMs;
-    if (hasBackgroundLayer) {
-        flushDirtyInAppArea();
+    bool drawn = appLayer ? flushDirtyInAppArea() : flushDirtyInRoot();
+    if (drawn) frameCount++;
+}
+
+bool UIManager::showPopup(UIPopup* newPopup) {
+    // 失败时不接管 newPopup 的所有权
+    if (!newPopup || popup || !display) return false;
+    int optionCount = newPopup->getOptionCount();
+    if (widgetCount + 1 + optionCount > 20) return false;
+    if (newPopup->getParent() == nullptr) {
+        newPopup->setParent(rootScreen);
+    }
+    popup = newPopup;
+    popup->optionsHandedOver = true;
+
+    // 保存当前焦点列表；焦点状态本身不变，避免下层控件因失焦而重绘
+    for (int i = 0; i < 20; i++) {
+        savedFocusableWidgets[i] = focusableWidgets[i];
+        focusableWidgets[i] = -1;
+    }
+    savedFocusableCount = focusableCount;
+    savedCurrentFocus = currentFocus;
+    focusableCount = 0;
+    currentFocus = -1;
+
+    // 弹窗与选项追加在 widgets 末尾，关闭时移除不会改变其他控件的索引
+    widgets[widgetCount++] = popup;
+    for (int i = 0; i < optionCount; i++) {
+        UIButton* option = popup->getOption(i);
+        if (!option) continue;
+        option->setFocused(false);
+        focusableWidgets[focusableCount++] = widgetCount;
+        widgets[widgetCount++] = option;
+    }
+    if (focusableCount > 0) {
+        currentFocus = 0;
+        widgets[focusableWidgets[0]]->setFocused(true);
+    }
+
+    capturePopupBackground();
+    drawPopup();
+    compositeOverlay();
+    return true;
+}
+
+void UIManager::closePopup() {
+    if (!popup) return;
+    UIPopup* closing = popup;
+    int result = closing->getResult();
+
+    for (int i = 0; i < closing->getOptionCount(); i++) {
+        UIButton* option = closing->getOption(i);
+        if (option) {
+            removeFromMainList(option);
+            delete option;
+        }
+    }
+    removeFromMainList(closing);
+    popup = nullptr;
+
+    for (int i = 0; i < 20; i++) {
+        focusableWidgets[i] = savedFocusableWidgets[i];
+    }
+    focusableCount = savedFocusableCount;
+    currentFocus = savedCurrentFocus;
+
+    if (popupSaveUnder) {
+        // 一次推送恢复弹窗下方的像素，不重绘应用窗口；
+        // 弹窗期间变脏的下层控件由随后的 tick 按脏区刷新
+        display->pushImage(popupSaveX, popupSaveY, popupSaveW, popupSaveH, popupSaveUnder);
+        PROFILE_PIXELS((uint32_t)(popupSaveW * popupSaveH));
+        noteDrawn(popupSaveX, popupSaveY, popupSaveW, popupSaveH);
+        delete[] popupSaveUnder;
+        popupSaveUnder = nullptr;
+        compositeOverlay();
     } else {
-        flushDirtyInRoot();
+        // 没有底图（内存不足或屏幕不支持回读）时退回整屏重绘
+        refresh();
     }
+
+    closing->onResult(result);
+    delete closing;
+}
+
+void UIManager::capturePopupBackground() {
+    if (popupSaveUnder) { delete[] popupSaveUnder; popupSaveUnder = nullptr; }
+    if (!popup || !display) return;
+    int ax, ay, aw, ah;
+    popup->getAbsoluteBounds(ax, ay, aw, ah);
+    if (!intersectRects(ax, ay, aw, ah, 0, 0, display->width(), display->height(),
+                        popupSaveX, popupSaveY, popupSaveW, popupSaveH)) return;
+    lgfx::Panel_Device* panel = display->getPanel();
+    if (!panel || !panel->config().readable) return;
+    popupSaveUnder = new (std::nothrow) uint16_t[popupSaveW * popupSaveH];
+    if (popupSaveUnder) {
+        display->readRect(popupSaveX, popupSaveY, popupSaveW, popupSaveH, popupSaveUnder);
+    }
+}
+
+void UIManager::drawPopup() {
+    if (!popup) return;
+    drawWidgetClipped(popup, false);
+    for (int i = 0; i < popup->getOptionCount(); i++) {
+        UIButton* option = popup->getOption(i);
+        if (option && option->isVisible()) {
+            drawWidgetClipped(option, false);
+        }
+    }
+}
+
+bool UIManager::flushDirtyInPopup() {
+    if (!popup) return false;
+    PROFILE_SCOPE(PROF_FLUSH);
+    TRACE_SCOPE(TRACE_UI_FLUSH, 0);
+    if (popup->isDirty()) {
+        drawPopup();
+        return true;
+    }
+    bool flushed = false;
+    for (int i = 0; i < popup->getOptionCount(); i++) {
+        UIButton* option = popup->getOption(i);
+        if (!option || !option->isVisible() || !option->isDirty()) continue;
+        int dx, dy, dw, dh;
+        option->getDirtyBounds(dx, dy, dw, dh);
+        drawWidgetClippedWithExtra(popup, false, dx, dy, dw, dh);
+        drawWidgetClipped(option, false);
+        flushed = true;
+    }
+    return flushed;
+}
+
+void UIManager::invalidateRegion(int x, int y, int w, int h) {
+    UIWidget** list = widgets;
+    int count = widgetCount;
+    if (hasBackgroundLayer && foregroundWidgetCount > 0) {
+        list = foregroundWidgets;
+        count = foregroundWidgetCount;
+    }
+    for (int i = 0; i < count; i++) {
+        UIWidget* widget = list[i];
+        if (!widget || !widget->isVisible()) continue;
+        int cx, cy, cw, ch;
+        if (!computeClipRect(widget, cx, cy, cw, ch)) continue;
+        int ix, iy, iw, ih;
+        if (!intersectRects(cx, cy, cw, ch, x, y, w, h, ix, iy, iw, ih)) continue;
+        widget->invalidateRect(ix, iy, iw, ih);
+    }
+    if (popup) {
+        int px, py, pw, ph;
+        popup->getAbsoluteBounds(px, py, pw, ph);
+        if (rectIntersects(px, py, pw, ph, x, y, w, h)) popup->invalidate();
+    }
+}
+
+void UIManager::noteDrawn(int x, int y, int w, int h) {
+    if (w <= 0 || h <= 0) return;
+    if (!hasDrawnRect) {
+        drawnX = x; drawnY = y; drawnW = w; drawnH = h;
+        hasDrawnRect = true;
+        return;
+    }
+    int nx = min(drawnX, x);
+    int ny = min(drawnY, y);
+    int rx = max(drawnX + drawnW, x + w);
+    int by = max(drawnY + drawnH, y + h);
+    drawnX = nx; drawnY = ny; drawnW = rx - nx; drawnH = by - ny;
+}
+
+void UIManager::compositeOverlay() {
+    if (!hasDrawnRect) return;
+    hasDrawnRect = false;
+    TRACE_SCOPE(TRACE_UI_OVERLAY, 0);
+    if (overlay) overlay->compositeOver(drawnX, drawnY, drawnW, drawnH);
+    // 浮层合成之后的区域即最终呈现的内容，交给镜像在下一次 tick 时推送
+    if (mirror) mirror->markDirty(drawnX, drawnY, drawnW, drawnH);
+}
+
+bool UIManager::setMirrorEnabled(bool enabled) {
+    if (enabled == (mirror != nullptr)) return true;
+    if (!enabled) {
+        delete mirror;
+        mirror = nullptr;
+        return true;
+    }
+    mirror = new (std::nothrow) ScreenMirror(display);
+    if (!mirror) return false;
+    if (!mirror->begin()) {
+        delete mirror;
+        mirror = nullptr;
+        return false;
+    }
+    return true;
 }
 
 UILabel* UIManager::createLabel(int id, int x, int y, const String& text, const String& name, UIWidget* parent) {
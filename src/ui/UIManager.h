@@ -1,7 +1,20 @@
 #pragma once
 #include <M5Cardputer.h>
 #include "UIWidget.h"
+#include "UIOverlay.h"
+#include "system/ScreenMirror.h"
 #include "system/EventSystem.h"
+
+// 挂起应用时从前景层摘下、由 AppManager 保管的控件集合
+struct RetainedWidgets {
+    UIWidget* widgets[20];
+    int count;
+    int focusIndex;     // 摘下时焦点在前景焦点列表中的位置
+    RetainedWidgets() : count(0), focusIndex(-1) {
+        for (int i = 0; i < 20; i++) widgets[i] = nullptr;
+    }
+};
+
 class UIManager {
 private:
     LGFX_Device* display;
@@ -17,6 +30,22 @@ private:
     bool hasBackgroundLayer;
     UIScreen* rootScreen;
     uint32_t lastAnimationRedrawMs;
+    // 模态弹窗层
+    UIPopup* popup;
+    uint16_t* popupSaveUnder;       // 弹窗下方的像素（RGB565），分配失败时为 nullptr
+    int popupSaveX, popupSaveY, popupSaveW, popupSaveH;
+    int savedFocusableWidgets[20];  // 打开弹窗前的焦点列表
+    int savedFocusableCount;
+    int savedCurrentFocus;
+    // 顶层浮层与本轮绘制覆盖的区域（用于重新合成浮层）
+    UIOverlay* overlay;
+    bool hasDrawnRect;
+    int drawnX, drawnY, drawnW, drawnH;
+    // 屏幕镜像（USB 串口），未开启时为 nullptr
+    ScreenMirror* mirror;
+    // 帧计数：tick 次数与实际发生绘制的帧数（系统监视器在定时器任务中读取）
+    volatile uint32_t tickCount;
+    volatile uint32_t frameCount;
 public:
     UIManager();
     ~UIManager();
@@ -37,12 +66,27 @@ public:
     void switchToApp();
     void switchToLauncher();
     void finishAppSetup();
+    // 前景控件的保留与恢复：detach 不释放控件，attach 放回前景层、恢复焦点并绘制
+    void detachForeground(RetainedWidgets& out);
+    void attachForeground(RetainedWidgets& set);
+    static void destroyRetained(RetainedWidgets& set);
     void drawWidget(int id);
     void drawWidgetPartial(int id);
     void drawForegroundPartial();
     void refreshAppArea();
     void smartRefresh();
     void tick();
+    bool showPopup(UIPopup* newPopup);
+    void closePopup();
+    bool hasPopup() const { return popup != nullptr; }
+    UIPopup* getPopup() const { return popup; }
+    UIOverlay* getOverlay() const { return overlay; }
+    bool setMirrorEnabled(bool enabled);
+    bool isMirrorEnabled() const { return mirror != nullptr; }
+    uint32_t getMirrorBytesSent() const { return mirror ? mirror->getBytesSent() : 0; }
+    uint32_t getTickCount() const { return tickCount; }
+    uint32_t getFrameCount() const { return frameCount; }
+    void invalidateRegion(int x, int y, int w, int h);
     UILabel* createLabel(int id, int x, int y, const String& text, const String& name = "", UIWidget* parent = nullptr);
     UIButton* createButton(int id, int x, int y, int width, int height, const String& text, const String& name = "", UIWidget* parent = nullptr);
     UIButton* createImageButton(int id, int x, int y, int width, int height, const uint8_t* imageData, size_t dataSize, const String& name = "", UIWidget* parent = nullptr);
@@ -59,6 +103,13 @@ private:
     bool computeClipRect(UIWidget* widget, int& outX, int& outY, int& outW, int& outH);
     void drawWidgetClipped(UIWidget* widget, bool partial);
     void drawWidgetClippedWithExtra(UIWidget* widget, bool partial, int clipX, int clipY, int clipW, int clipH);
+    void updateAndFlush(uint32_t nowMs);
+    void drawOpaqueDamage(UIWidget** list, int count);
     bool flushDirtyInAppArea();
     bool flushDirtyInRoot();
+    bool flushDirtyInPopup();
+    void capturePopupBackground();
+    void drawPopup();
+    void noteDrawn(int x, int y, int w, int h);
+    void compositeOverlay();
 };
@@ -0,0 +1,166 @@
+#include "ui/UIOverlay.h"
+#include "system/Profiler.h"
+
+static bool overlayIntersects(int ax, int ay, int aw, int ah, int bx, int by, int bw, int bh) {
+    if (aw <= 0 || ah <= 0 || bw <= 0 || bh <= 0) return false;
+    return !(ax + aw <= bx || bx + bw <= ax || ay + ah <= by || by + bh <= ay);
+}
+
+UIOverlay::UIOverlay(LGFX_Device* _display)
+    : display(_display), statusSprite(_display), statusVisible(true), statusReady(false),
+      statusX(0), statusY(0), statusW(30), statusH(10), statusText(""), statusColor(TFT_GREEN),
+      statusLevel(-1), statusCharging(false),
+      toastSprite(_display), toastActive(false), toastX(0), toastY(0), toastW(0), toastH(16),
+      toastText(""), toastDurationMs(0), toastUntilMs(0), toastPending(false),
+      hasRenderedRect(false), renderedX(0), renderedY(0), renderedW(0), renderedH(0) {
+    int dw = display ? display->width() : 240;
+    if (dw <= 0) dw = 240;
+    statusX = dw - statusW;
+    statusSprite.setColorDepth(16);
+}
+
+UIOverlay::~UIOverlay() {
+    statusSprite.deleteSprite();
+    toastSprite.deleteSprite();
+}
+
+void UIOverlay::setStatusVisible(bool show) {
+    if (statusVisible == show) return;
+    statusVisible = show;
+    if (show) {
+        statusReady = false;
+    } else {
+        statusSprite.deleteSprite();
+        statusReady = false;
+    }
+}
+
+void UIOverlay::showToast(const String& text, uint32_t durationMs) {
+    toastText = text;
+    toastDurationMs = durationMs;
+    // 在下一次 update 中开始计时并绘制，保证与 tick 的节奏一致
+    toastPending = true;
+}
+
+void UIOverlay::renderStatus() {
+    if (!statusReady) {
+        if (!statusSprite.createSprite(statusW, statusH)) return;
+        statusReady = true;
+    }
+    statusSprite.fillRect(0, 0, statusW, statusH, TFT_BLACK);
+    statusSprite.setFont(&fonts::Font0);
+    statusSprite.setTextSize(1);
+    statusSprite.setTextColor(statusColor, TFT_BLACK);
+    int textW = statusText.length() * 6;
+    statusSprite.drawString(statusText.c_str(), statusW - textW - 2, 1);
+    statusSprite.pushSprite(statusX, statusY);
+    PROFILE_PIXELS((uint32_t)(statusW * statusH));
+    noteRendered(statusX, statusY, statusW, statusH);
+}
+
+void UIOverlay::renderToast() {
+    toastSprite.fillRect(0, 0, toastW, toastH, TFT_DARKGREY);
+    toastSprite.drawRect(0, 0, toastW, toastH, TFT_WHITE);
+    toastSprite.setFont(&fonts::efontCN_12);
+    toastSprite.setTextSize(1);
+    toastSprite.setTextColor(TFT_WHITE);
+    toastSprite.setCursor(6, (toastH - 12) / 2);
+    toastSprite.print(toastText.c_str());
+    toastSprite.pushSprite(toastX, toastY);
+    PROFILE_PIXELS((uint32_t)(toastW * toastH));
+    noteRendered(toastX, toastY, toastW, toastH);
+}
+
+void UIOverlay::noteRendered(int x, int y, int w, int h) {
+    if (!hasRenderedRect) {
+        renderedX = x; renderedY = y; renderedW = w; renderedH = h;
+        hasRenderedRect = true;
+        return;
+    }
+    int nx = min(renderedX, x);
+    int ny = min(renderedY, y);
+    int rx = max(renderedX + renderedW, x + w);
+    int by = max(renderedY + renderedH, y + h);
+    renderedX = nx; renderedY = ny; renderedW = rx - nx; renderedH = by - ny;
+}
+
+bool UIOverlay::takeRenderedRect(int& outX, int& outY, int& outW, int& outH) {
+    if (!hasRenderedRect) return false;
+    hasRenderedRect = false;
+    outX = renderedX; outY = renderedY; outW = renderedW; outH = renderedH;
+    return true;
+}
+
+bool UIOverlay::update(uint32_t nowMs, int& outX, int& outY, int& outW, int& outH) {
+    if (!display) return false;
+    bool needRestore = false;
+
+    if (statusVisible) {
+        battery.update();
+        // 每帧都会走到这里，只比较缓存的数值，电量或充电状态变化时才生成文字（避免每帧分配 String）
+        int level = battery.getBatteryLevel();
+        bool charging = battery.getChargingStatus();
+        if (!statusReady || level != statusLevel || charging != statusCharging) {
+            statusLevel = level;
+            statusCharging = charging;
+            statusText = battery.getBatteryLevelString();
+            statusColor = level > 50 ? TFT_GREEN : (level > 20 ? TFT_YELLOW : TFT_RED);
+            renderStatus();
+        }
+    }
+
+    if (toastPending) {
+        toastPending = false;
+        int oldX = toastX, oldY = toastY, oldW = toastW, oldH = toastH;
+        bool hadToast = toastActive;
+        int dw = display->width();
+        int dh = display->height();
+        int textW = 0;
+        for (unsigned int i = 0; i < toastText.length(); ) {
+            unsigned char c = (unsigned char)toastText.charAt(i);
+            int n = c < 0x80 ? 1 : ((c & 0xE0) == 0xC0 ? 2 : ((c & 0xF0) == 0xE0 ? 3 : 4));
+            textW += n == 1 ? 6 : 12;
+            i += n;
+        }
+        int newW = min(textW + 12, dw - 8);
+        if (!hadToast || newW != toastW) {
+            toastSprite.deleteSprite();
+            if (!toastSprite.createSprite(newW, toastH)) {
+                toastActive = false;
+                if (hadToast) {
+                    outX = oldX; outY = oldY; outW = oldW; outH = oldH;
+                    return true;
+                }
+                return false;
+            }
+        }
+        toastW = newW;
+        toastX = (dw - toastW) / 2;
+        toastY = dh - toastH - 4;
+        toastActive = true;
+        toastUntilMs = nowMs + toastDurationMs;
+        renderToast();
+        // 新提示条比旧的窄时，旧提示条露出的两侧需要恢复
+        if (hadToast && oldW > toastW) {
+            outX = oldX; outY = oldY; outW = oldW; outH = oldH;
+            needRestore = true;
+        }
+    } else if (toastActive && (int32_t)(nowMs - toastUntilMs) >= 0) {
+        toastActive = false;
+        toastSprite.deleteSprite();
+        outX = toastX; outY = toastY; outW = toastW; outH = toastH;
+        needRestore = true;
+    }
+    return needRestore;
+}
+
+void UIOverlay::compositeOver(int x, int y, int w, int h) {
+    if (statusVisible && statusReady && overlayIntersects(x, y, w, h, statusX, statusY, statusW, statusH)) {
+        statusSprite.pushSprite(statusX, statusY);
+        PROFILE_PIXELS((uint32_t)(statusW * statusH));
+    }
+    if (toastActive && overlayIntersects(x, y, w, h, toastX, toastY, toastW, toastH)) {
+        toastSprite.pushSprite(toastX, toastY);
+        PROFILE_PIXELS((uint32_t)(toastW * toastH));
+    }
+}
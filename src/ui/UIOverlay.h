@@ -0,0 +1,63 @@
+#pragma once
+#include <M5Cardputer.h>
+#include "system/BatteryManager.h"
+
+// 顶层浮层：状态栏 + 提示条（toast）
+// 浮层内容先画进各自的小精灵（backing store），再整块推送到屏幕；
+// 下层刷新覆盖到浮层区域时由 UIManager 调用 compositeOver 重新推送，
+// 因此浮层更新不会让前景/背景控件变脏。
+class UIOverlay {
+private:
+    LGFX_Device* display;
+
+    // 状态栏（右上角，显示电量）
+    LGFX_Sprite statusSprite;
+    bool statusVisible;
+    bool statusReady;
+    int statusX, statusY, statusW, statusH;
+    String statusText;
+    uint16_t statusColor;
+    int statusLevel;            // 上次绘制时的电量与充电状态，变化时才重新生成文字
+    bool statusCharging;
+    BatteryManager battery;
+
+    // 提示条（底部居中，按需分配精灵，过期后释放）
+    LGFX_Sprite toastSprite;
+    bool toastActive;
+    int toastX, toastY, toastW, toastH;
+    String toastText;
+    uint32_t toastDurationMs;
+    uint32_t toastUntilMs;
+    bool toastPending;
+
+    // update 中浮层自己推送过的区域（供屏幕镜像等需要知道屏幕变化的地方取用）
+    bool hasRenderedRect;
+    int renderedX, renderedY, renderedW, renderedH;
+
+    void renderStatus();
+    void renderToast();
+    void noteRendered(int x, int y, int w, int h);
+
+public:
+    static const uint32_t DEFAULT_TOAST_MS = 2000;
+
+    explicit UIOverlay(LGFX_Device* display);
+    ~UIOverlay();
+
+    void setStatusVisible(bool show);
+    bool isStatusVisible() const { return statusVisible; }
+
+    // 显示提示条；已有提示时直接替换内容并重新计时
+    void showToast(const String& text, uint32_t durationMs = DEFAULT_TOAST_MS);
+    bool hasToast() const { return toastActive; }
+
+    // 按浮层自身节奏推进（电量约 1Hz，提示条到期）。
+    // 浮层移除后需要恢复下方内容时返回 true，并给出该区域。
+    bool update(uint32_t nowMs, int& outX, int& outY, int& outW, int& outH);
+
+    // 下层在 (x, y, w, h) 内绘制过之后调用，重新推送与之相交的浮层
+    void compositeOver(int x, int y, int w, int h);
+
+    // 取出并清空自上次调用以来 update 推送到屏幕的区域
+    bool takeRenderedRect(int& outX, int& outY, int& outW, int& outH);
+};
@@ -9,3 +9,5 @@
 #include "widgets/UIMenuGrid.h"
 #include "widgets/UISlider.h"
 #include "widgets/UIImage.h"
+#include "widgets/UIPopup.h"
+#include "widgets/UISparkline.h"
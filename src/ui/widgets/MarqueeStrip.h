@@ -0,0 +1,125 @@
+#pragma once
+#include <M5Cardputer.h>
+#include <new>
+
+// 跑马灯条带：整段文字只光栅化一次到离屏精灵（宽 = 文字宽 + 间隔），
+// 之后每帧只把平移后的窗口推送到屏幕，不再逐帧重新排版 CJK 字形。
+// 窗口跨过条带末尾时再推送一次条带，首尾无缝衔接。
+class MarqueeStrip {
+public:
+    static const int GAP = 24;                  // 末尾与下一轮开头之间的空白
+    static const int MAX_TEXT_WIDTH = 720;      // 条带上限：(720+24)x12x2B ≈ 17KB
+    static const int SPEED_PX_PER_S = 30;
+    static const uint32_t PAUSE_MS = 1200;      // 每轮回到开头后的停顿
+
+private:
+    LGFX_Sprite* sprite;    // 按需分配，不滚动的文本不占内存
+    int stripW;
+    int stripH;
+    int offset;
+    uint32_t startMs;       // 本轮开始滚动的时刻
+    bool started;
+
+public:
+    MarqueeStrip() : sprite(nullptr), stripW(0), stripH(0), offset(0), startMs(0), started(false) {}
+    ~MarqueeStrip() { release(); }
+
+    bool isReady() const { return sprite != nullptr; }
+    int getHeight() const { return stripH; }
+
+    // efontCN_12 的像素宽度：ASCII 6px，多字节字形 12px
+    static int measureText(const char* s) {
+        int px = 0;
+        while (s && *s) {
+            unsigned char lead = (unsigned char)*s;
+            int n = 1;
+            if ((lead & 0xE0) == 0xC0) n = 2;
+            else if ((lead & 0xF0) == 0xE0) n = 3;
+            else if ((lead & 0xF8) == 0xF0) n = 4;
+            px += n == 1 ? 6 : 12;
+            for (int i = 0; i < n && *s; i++) s++;
+        }
+        return px;
+    }
+
+    // 把 text 画进条带并回到起点；textY 为文字在条带内的纵向偏移。分配失败返回 false
+    bool render(const char* text, int textWidth, int height, int textY, uint16_t fg, uint16_t bg) {
+        if (height <= 0) return false;
+        int w = (textWidth > MAX_TEXT_WIDTH ? MAX_TEXT_WIDTH : textWidth) + GAP;
+        if (!sprite) {
+            sprite = new (std::nothrow) LGFX_Sprite();
+            if (!sprite) return false;
+            sprite->setColorDepth(16);
+        }
+        if (w != stripW || height != stripH) {
+            sprite->deleteSprite();
+            if (!sprite->createSprite(w, height)) {
+                release();
+                return false;
+            }
+            stripW = w;
+            stripH = height;
+        }
+        sprite->fillScreen(bg);
+        sprite->setFont(&fonts::efontCN_12);
+        sprite->setTextSize(1);
+        sprite->setTextColor(fg, bg);
+        sprite->setCursor(0, textY);
+        sprite->print(text);
+        restart();
+        return true;
+    }
+
+    void release() {
+        if (sprite) {
+            sprite->deleteSprite();
+            delete sprite;
+            sprite = nullptr;
+        }
+        stripW = 0;
+        stripH = 0;
+        restart();
+    }
+
+    void restart() {
+        offset = 0;
+        started = false;
+    }
+
+    // 按时间推进滚动位置，位置变化时返回 true
+    bool advance(uint32_t nowMs) {
+        if (!sprite) return false;
+        if (!started) {
+            started = true;
+            startMs = nowMs + PAUSE_MS;
+            return false;
+        }
+        if ((int32_t)(nowMs - startMs) < 0) return false;
+        int next = (int)((nowMs - startMs) * SPEED_PX_PER_S / 1000);
+        if (next >= stripW) {
+            startMs = nowMs + PAUSE_MS;
+            next = 0;
+        }
+        if (next == offset) return false;
+        offset = next;
+        return true;
+    }
+
+    // 在 (x, y) 处显示宽 viewW 的窗口，输出限制在窗口与当前裁剪矩形的交集内
+    void push(LGFX_Device* display, int x, int y, int viewW) {
+        if (!sprite || !display || viewW <= 0) return;
+        int32_t cx, cy, cw, ch;
+        display->getClipRect(&cx, &cy, &cw, &ch);
+        int nx = max((int)cx, x);
+        int ny = max((int)cy, y);
+        int rx = min((int)(cx + cw), x + viewW);
+        int by = min((int)(cy + ch), y + stripH);
+        if (rx <= nx || by <= ny) return;
+        display->setClipRect(nx, ny, rx - nx, by - ny);
+        sprite->pushSprite(display, x - offset, y);
+        if (stripW - offset < viewW) {
+            sprite->pushSprite(display, x - offset + stripW, y);
+        }
+        display->setClipRect(cx, cy, cw, ch);
+    }
+};
@@ -34,7 +34,7 @@ public:
             params.height = height;
             params.visible = visible;
             params.focused = focused;
-            params.text = (imageData || useFileImage) ? String("") : text;
+            if (!(imageData || useFileImage)) params.text = text;
             params.textColor = textColor;
             params.borderColor = borderColor;
             params.backgroundColor = TFT_BLACK;
@@ -68,7 +68,7 @@ public:
                 if (imageData && imageDataSize > 24) {
                     ok = pngGetSize(imageData, imageDataSize, imgW, imgH);
                 } else if (useFileImage && imageFilePath.length() > 0) {
-                    ok = pngFileGetSize(imageFilePath, imgW, imgH);
+                    ok = pngFileGetSize(imageFilePath.c_str(), imgW, imgH);
                 }
                 if (ok) {
                     int maxW = width - 2;
@@ -1,25 +1,130 @@
 #pragma once
 #include <M5Cardputer.h>
 #include "WidgetBase.h"
+#include "MarqueeStrip.h"
 class UILabel : public UIWidget {
 private:
     String text;
     uint16_t textColor;
+    int textPixelWidth;     // 当前文本按字形宽度累计的像素宽度
+    int marqueeWidth;       // >0 时为跑马灯模式的可视宽度
+    MarqueeStrip marquee;
+    bool stripValid;        // 条带内容与当前文本、颜色、主题一致
+    Theme* stripTheme;
+
+    // efontCN_12：ASCII 字形 6px，多字节（中文等）字形 12px
+    static int glyphBytes(unsigned char lead) {
+        if (lead < 0x80) return 1;
+        if ((lead & 0xE0) == 0xC0) return 2;
+        if ((lead & 0xF0) == 0xE0) return 3;
+        if ((lead & 0xF8) == 0xF0) return 4;
+        return 1;
+    }
+    static int glyphAdvance(int bytes) { return bytes == 1 ? 6 : 12; }
+    static int measure(const char* s, int len) {
+        int px = 0;
+        for (int i = 0; i < len; ) {
+            int n = glyphBytes((unsigned char)s[i]);
+            px += glyphAdvance(n);
+            i += n;
+        }
+        return px;
+    }
+
+    // 比较新旧文本，求出需要重绘的像素区间 [outStart, outEnd)（相对标签左边）。
+    // 公共前缀按字形对齐；公共后缀只有在新旧总宽度相同（后缀位置不变）时才能跳过，
+    // 否则区间延伸到新旧文本中较长的末尾，以擦除被让出的区域。
+    void changedSpan(const String& newText, int newPixelWidth, int& outStart, int& outEnd) const {
+        const char* a = text.c_str();
+        const char* b = newText.c_str();
+        int lenA = text.length();
+        int lenB = newText.length();
+        int i = 0;
+        int prefixPx = 0;
+        while (i < lenA && i < lenB) {
+            int n = glyphBytes((unsigned char)a[i]);
+            if (i + n > lenA || i + n > lenB || memcmp(a + i, b + i, n) != 0) break;
+            prefixPx += glyphAdvance(n);
+            i += n;
+        }
+        outStart = prefixPx;
+        if (newPixelWidth != textPixelWidth) {
+            outEnd = max(textPixelWidth, newPixelWidth);
+            return;
+        }
+        int ea = lenA;
+        int eb = lenB;
+        int suffixPx = 0;
+        while (ea > i && eb > i) {
+            int sa = ea - 1;
+            while (sa > i && ((unsigned char)a[sa] & 0xC0) == 0x80) sa--;
+            int n = ea - sa;
+            if (eb - n < i || memcmp(a + sa, b + eb - n, n) != 0) break;
+            suffixPx += glyphAdvance(glyphBytes((unsigned char)a[sa]));
+            ea = sa;
+            eb -= n;
+        }
+        outEnd = textPixelWidth - suffixPx;
+    }
 public:
     UILabel(int id, int x, int y, const String& text, const String& name = "")
         : UIWidget(id, WIDGET_LABEL, x, y, text.length() * 6, 8, name, false),
-          text(text), textColor(TFT_WHITE) {}
+          text(text), textColor(TFT_WHITE), textPixelWidth(measure(text.c_str(), text.length())),
+          marqueeWidth(0), stripValid(false), stripTheme(nullptr) {}
+    // 只把变化的字形区间标记为脏区，频繁更新的标签（进度、歌词、电量）不必整块重绘
     void setText(const String& newText) {
         if (text == newText) return;
+        int newPixelWidth = measure(newText.c_str(), newText.length());
+        if (marqueeWidth > 0) {
+            // 跑马灯模式下文本整体变化，条带重新生成并从头开始滚动
+            text = newText;
+            textPixelWidth = newPixelWidth;
+            applyMarqueeLayout();
+            invalidate();
+            return;
+        }
+        if (hasLastDrawBounds && visible) {
+            int spanStart = 0, spanEnd = 0;
+            changedSpan(newText, newPixelWidth, spanStart, spanEnd);
+            invalidateRect(getAbsoluteX() + spanStart, getAbsoluteY(), spanEnd - spanStart, height);
+        } else {
+            invalidate();
+        }
         text = newText;
+        textPixelWidth = newPixelWidth;
         width = text.length() * 6;
-        invalidate();
     }
     String getText() const { return text; }
-    void setTextColor(uint16_t color) { if (textColor != color) { textColor = color; invalidate(); } }
+    void setTextColor(uint16_t color) { if (textColor != color) { textColor = color; stripValid = false; invalidate(); } }
+    // 跑马灯模式：文本超过 maxWidth 时在固定宽度内循环滚动，maxWidth <= 0 关闭
+    void setMarquee(int maxWidth) {
+        if (maxWidth == marqueeWidth) return;
+        marqueeWidth = maxWidth > 0 ? maxWidth : 0;
+        applyMarqueeLayout();
+        invalidate();
+    }
+    bool isScrolling() const { return marqueeWidth > 0 && textPixelWidth > marqueeWidth; }
+    bool update(uint32_t nowMs) override {
+        if (!visible || !isScrolling() || !stripValid) return false;
+        if (marquee.advance(nowMs)) {
+            invalidateRect(getAbsoluteX(), getAbsoluteY(), width, height);
+        }
+        return false;
+    }
+    bool isDamageOpaque() const override {
+        return isScrolling() && stripValid && dirty && hasDamageRect;
+    }
     void draw(LGFX_Device* display) override {
         if (!visible) return;
         Theme* theme = getCurrentTheme();
+        if (isScrolling()) {
+            if (!stripValid || stripTheme != theme) renderStrip(theme);
+            if (stripValid) {
+                marquee.push(display, getAbsoluteX(), getAbsoluteY(), width);
+                return;
+            }
+            // 条带分配失败时退回普通绘制，超出部分被裁剪
+        }
         if (theme) {
             ThemeDrawParams params;
             params.display = display;
@@ -51,4 +156,22 @@ public:
     bool handleKeyEvent(const KeyEvent& event) override {
         return false;
     }
+private:
+    void applyMarqueeLayout() {
+        stripValid = false;
+        if (isScrolling()) {
+            width = marqueeWidth;
+            height = 12;
+        } else {
+            marquee.release();
+            width = text.length() * 6;
+            height = 8;
+        }
+    }
+    void renderStrip(Theme* theme) {
+        uint16_t fg = theme ? theme->getLabelColor(textColor) : textColor;
+        uint16_t bg = theme ? theme->getSurfaceColor() : TFT_BLACK;
+        stripValid = marquee.render(text.c_str(), textPixelWidth, height, 0, fg, bg);
+        stripTheme = theme;
+    }
 };
@@ -9,8 +9,18 @@ struct MenuItem {
     size_t imageDataSize;
     String imageFilePath;
     bool useFileImage;
+    String clippedText;     // 按 clippedWidth 截断后的显示文本缓存（文本放得下时为空）
+    int clippedWidth;       // 缓存对应的可用宽度，-1 表示缓存失效
+    uint16_t revision;      // 文本每变化一次加一，供跑马灯条带等缓存判断是否过期
     MenuItem(const String& _text, int _id, bool _enabled = true)
-        : text(_text), id(_id), enabled(_enabled), imageData(nullptr), imageDataSize(0), imageFilePath(""), useFileImage(false) {}
+        : text(_text), id(_id), enabled(_enabled), imageData(nullptr), imageDataSize(0), imageFilePath(""), useFileImage(false), clippedWidth(-1), revision(0) {}
+    void setText(const String& newText) {
+        if (text == newText) return;
+        text = newText;
+        clippedText = "";
+        clippedWidth = -1;
+        revision++;
+    }
 };
 class UIMenu : public UIWidget {
 protected:
@@ -72,6 +82,7 @@ public:
                 }
                 items[itemCount - 1] = nullptr;
                 itemCount--;
+                onItemsDeleted();
                 if (selectedIndex >= itemCount && itemCount > 0) {
                     selectedIndex = itemCount - 1;
                 } else if (itemCount == 0) {
@@ -91,8 +102,11 @@ public:
         }
         itemCount = 0;
         selectedIndex = 0;
+        onItemsDeleted();
         invalidate();
     }
+    int getItemCount() const { return itemCount; }
+    int getSelectedIndex() const { return selectedIndex; }
     MenuItem* getSelectedItem() {
         if (selectedIndex >= 0 && selectedIndex < itemCount && items[selectedIndex]) {
             return items[selectedIndex];
@@ -115,6 +129,9 @@ public:
     }
     virtual void onItemSelected(MenuItem* item) {}
 protected:
+    // 有条目被释放后调用；新条目可能分配到旧地址，按 MenuItem* 做缓存的子类在这里清掉缓存。
+    // 析构时不会调到子类的实现（子类此时已析构）
+    virtual void onItemsDeleted() {}
     void drawMenuBorder(LGFX_Device* display) {
         Theme* currentTheme = getCurrentTheme();
         if (currentTheme) {
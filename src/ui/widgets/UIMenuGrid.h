@@ -36,7 +36,7 @@ public:
                     params.y = itemY;
                     params.width = itemWidth;
                     params.height = itemHeight;
-                    params.text = (item->imageData || item->useFileImage) ? String("") : item->text;
+                    if (!(item->imageData || item->useFileImage)) params.text = item->text;
                     params.selected = (row == selectedRow && col == selectedCol);
                     params.enabled = item->enabled;
                     params.focused = focused;
@@ -59,7 +59,7 @@ public:
                         int imgW = 0, imgH = 0;
                         bool ok = false;
                         if (item->imageData && item->imageDataSize > 24) ok = pngGetSize(item->imageData, item->imageDataSize, imgW, imgH);
-                        else if (item->useFileImage && item->imageFilePath.length() > 0) ok = pngFileGetSize(item->imageFilePath, imgW, imgH);
+                        else if (item->useFileImage && item->imageFilePath.length() > 0) ok = pngFileGetSize(item->imageFilePath.c_str(), imgW, imgH);
                         if (ok) {
                             int maxW = itemWidth - 4;
                             int maxH = itemHeight - 4;
@@ -1,6 +1,7 @@
 #pragma once
 #include <M5Cardputer.h>
 #include "UIMenu.h"
+#include "MarqueeStrip.h"
 class UIMenuList : public UIMenu {
 private:
     int itemHeight;
@@ -10,18 +11,70 @@ private:
     float targetScrollPixel;
     uint32_t lastAnimMs;
     bool animating;
-    String clipText(const String& text, int maxWidth) {
-        if (text.length() == 0) return text;
+    // 选中行文本放不下时以跑马灯滚动；条带按菜单项、文本版本、主题和颜色缓存
+    bool marqueeEnabled;
+    MarqueeStrip marquee;
+    MenuItem* marqueeItem;
+    uint16_t marqueeRevision;
+    Theme* marqueeTheme;
+    uint16_t marqueeFg, marqueeBg;
+    int marqueeX, marqueeY, marqueeW, marqueeH;   // 选中行文字区（绝对坐标），marqueeW 为 0 表示没有滚动行
+    // 返回适合 maxWidth 的显示文本；截断结果缓存在菜单项中，
+    // 只有文本或宽度变化时才重新生成，滚动动画的每帧不再分配字符串
+    const String& clipText(MenuItem* item, int maxWidth) {
+        const String& text = item->text;
         int availableWidth = maxWidth - 8;
-        int ellipsisWidth = 18;
-        if (text.length() * 6 <= availableWidth) {
+        if ((int)text.length() * 6 <= availableWidth) {
             return text;
         }
-        int maxChars = (availableWidth - ellipsisWidth) / 6;
-        if (maxChars <= 0) {
-            return "...";
+        if (item->clippedWidth != maxWidth) {
+            int ellipsisWidth = 18;
+            int maxChars = (availableWidth - ellipsisWidth) / 6;
+            if (maxChars <= 0) {
+                item->clippedText = "...";
+            } else {
+                item->clippedText = text.substring(0, maxChars) + "...";
+            }
+            item->clippedWidth = maxWidth;
         }
-        return text.substring(0, maxChars) + "...";
+        return item->clippedText;
+    }
+    // 为选中行准备条带并记录文字区位置；分配失败返回 false，调用方按普通方式绘制
+    bool prepareMarquee(Theme* theme, const MenuItemDrawParams& params, MenuItem* item) {
+        uint16_t fg, bg;
+        int tx, ty;
+        theme->getMenuItemStyle(params, fg, bg, tx, ty);
+        int viewW = params.x + params.width - 2 - tx;
+        int stripH = min(12, params.y + params.height - ty);
+        if (viewW <= 0 || stripH <= 0) return false;
+        if (!marquee.isReady() || item != marqueeItem || item->revision != marqueeRevision ||
+            theme != marqueeTheme || fg != marqueeFg || bg != marqueeBg || stripH != marquee.getHeight()) {
+            const char* text = item->text.c_str();
+            if (!marquee.render(text, MarqueeStrip::measureText(text), stripH, 0, fg, bg)) return false;
+            marqueeItem = item;
+            marqueeRevision = item->revision;
+            marqueeTheme = theme;
+            marqueeFg = fg;
+            marqueeBg = bg;
+        }
+        marqueeX = tx;
+        marqueeY = ty;
+        marqueeW = viewW;
+        marqueeH = stripH;
+        return true;
+    }
+    void releaseMarquee() {
+        marquee.release();
+        marqueeItem = nullptr;
+        marqueeW = 0;
+    }
+    void onItemsDeleted() override {
+        // 条带按条目指针与 revision 判断是否过期，重建的列表可能复用旧地址，这里必须作废
+        releaseMarquee();
+    }
+    bool rectInsideMarquee(int rx, int ry, int rw, int rh) const {
+        return marqueeW > 0 && rx >= marqueeX && ry >= marqueeY &&
+               rx + rw <= marqueeX + marqueeW && ry + rh <= marqueeY + marqueeH;
     }
     void setScrollOffsetAnimated(int newScrollOffset) {
         float current = animating ? scrollPixel : ((float)scrollOffset * (float)itemHeight);
@@ -35,11 +88,49 @@ private:
 public:
     UIMenuList(int id, int x, int y, int width, int height, const String& name = "", int _itemHeight = 14)
         : UIMenu(id, WIDGET_MENU_LIST, x, y, width, height, name),
-          itemHeight(_itemHeight), scrollOffset(0), scrollPixel(0.0f), targetScrollPixel(0.0f), lastAnimMs(0), animating(false) {
+          itemHeight(_itemHeight), scrollOffset(0), scrollPixel(0.0f), targetScrollPixel(0.0f), lastAnimMs(0), animating(false),
+          marqueeEnabled(true), marqueeItem(nullptr), marqueeRevision(0), marqueeTheme(nullptr),
+          marqueeFg(0), marqueeBg(0), marqueeX(0), marqueeY(0), marqueeW(0), marqueeH(0) {
         visibleItems = (height - 4) / itemHeight;
     }
+    int getScrollOffset() const { return scrollOffset; }
+    // 直接选中第 index 项，并让第 topIndex 项显示在首行（不做滚动动画）；
+    // 用于分页重建列表后让选中项保持在屏幕上原来的位置
+    void setSelection(int index, int topIndex) {
+        if (itemCount == 0) return;
+        if (index < 0) index = 0;
+        if (index >= itemCount) index = itemCount - 1;
+        if (topIndex > index) topIndex = index;
+        if (topIndex < index - visibleItems + 1) topIndex = index - visibleItems + 1;
+        if (topIndex > itemCount - visibleItems) topIndex = itemCount - visibleItems;
+        if (topIndex < 0) topIndex = 0;
+        selectedIndex = index;
+        scrollOffset = topIndex;
+        scrollPixel = targetScrollPixel = (float)scrollOffset * (float)itemHeight;
+        animating = false;
+        invalidate();
+    }
+    void setMarqueeEnabled(bool enabled) {
+        if (marqueeEnabled == enabled) return;
+        marqueeEnabled = enabled;
+        if (!enabled) releaseMarquee();
+        invalidate();
+    }
+    bool isDamageOpaque() const override {
+        return dirty && hasDamageRect && marquee.isReady() && rectInsideMarquee(damageX, damageY, damageW, damageH);
+    }
     void draw(LGFX_Device* display) override {
         if (!visible) return;
+        if (marquee.isReady()) {
+            // 裁剪区完全落在滚动文字区内时（跑马灯逐帧推进），只需推送一次条带
+            int32_t cx, cy, cw, ch;
+            display->getClipRect(&cx, &cy, &cw, &ch);
+            if (rectInsideMarquee(cx, cy, cw, ch)) {
+                marquee.push(display, marqueeX, marqueeY, marqueeW);
+                return;
+            }
+        }
+        bool marqueeDrawn = false;
         drawMenuBorder(display);
         int absX = getAbsoluteX();
         int absY = getAbsoluteY();
@@ -72,13 +163,23 @@ public:
                 params.y = itemY;
                 params.width = contentW;
                 params.height = itemHeight;
-                params.text = clipText(item->text, width - 2);
+                const String& shown = clipText(item, width - 2);
+                params.text = shown;
                 params.selected = (focused && itemIndex == selectedIndex);
                 params.enabled = item->enabled;
                 params.selectedColor = selectedColor;
                 params.textColor = textColor;
                 params.disabledColor = disabledColor;
-                currentTheme->drawMenuItem(params);
+                // 被截断的选中行：主题只画行背景，文字由条带推送（滚动动画期间保持静态截断）
+                if (params.selected && marqueeEnabled && !animating && &shown != &item->text &&
+                    prepareMarquee(currentTheme, params, item)) {
+                    params.text = "";
+                    currentTheme->drawMenuItem(params);
+                    marquee.push(display, marqueeX, marqueeY, marqueeW);
+                    marqueeDrawn = true;
+                } else {
+                    currentTheme->drawMenuItem(params);
+                }
             } else {
                 if (focused && itemIndex == selectedIndex) {
                     display->fillRect(contentX, itemY, contentW, itemHeight, selectedColor);
@@ -91,14 +192,20 @@ public:
                 display->setTextColor(color);
                 display->setTextSize(1);
                 display->setCursor(contentX + 3, itemY + (itemHeight - 8) / 2);
-                String clippedText = clipText(item->text, width - 2);
-                display->print(clippedText);
+                display->print(clipText(item, width - 2).c_str());
             }
         }
+        if (!marqueeDrawn && marquee.isReady()) releaseMarquee();
     }
     bool update(uint32_t nowMs) override {
         if (!visible || itemHeight <= 0) return false;
-        if (!animating) return false;
+        if (!animating) {
+            // 跑马灯推进只标记文字区，刷新时由 draw 的快速路径单独推送
+            if (marqueeW > 0 && marquee.advance(nowMs)) {
+                invalidateRect(marqueeX, marqueeY, marqueeW, marqueeH);
+            }
+            return false;
+        }
         if (lastAnimMs == 0) {
             lastAnimMs = nowMs;
             return true;
@@ -0,0 +1,131 @@
+#pragma once
+#include <M5Cardputer.h>
+#include "WidgetBase.h"
+#include "UIButton.h"
+
+// 模态弹窗：标题 + 提示文本 + 最多 3 个选项按钮。
+// 由 UIManager::showPopup 打开，打开时保存下方像素，关闭时一次性恢复；
+// 选项按钮作为弹窗的子控件加入焦点列表，左右键/Tab 切换，Enter 选择，ESC 取消。
+// 使用方式与 LauncherMenuGrid 相同：派生并重写 onResult 处理结果。
+class UIPopup : public UIWidget {
+public:
+    static const int MAX_OPTIONS = 3;
+    static const int RESULT_CANCEL = -1;
+
+private:
+    class PopupButton : public UIButton {
+    public:
+        PopupButton(int id, int x, int y, int width, int height, const String& text, UIPopup* owner, int index)
+            : UIButton(id, x, y, width, height, text), popup(owner), optionIndex(index) {}
+        void onButtonClick() override { popup->finish(optionIndex); }
+    private:
+        UIPopup* popup;
+        int optionIndex;
+    };
+
+    String title;
+    String message;
+    UIButton* options[MAX_OPTIONS];
+    int optionCount;
+    bool finished;
+    int result;
+    bool optionsHandedOver;     // showPopup 成功后为 true，选项按钮改由 UIManager 释放
+
+    friend class UIManager;
+
+public:
+    UIPopup(int id, int x, int y, int width, int height, const String& title, const String& message, const String& name = "")
+        : UIWidget(id, WIDGET_POPUP, x, y, width, height, name, false),
+          title(title), message(message), optionCount(0), finished(false), result(RESULT_CANCEL),
+          optionsHandedOver(false) {
+        for (int i = 0; i < MAX_OPTIONS; i++) {
+            options[i] = nullptr;
+        }
+    }
+    // 选项按钮的所有权在 showPopup 成功后移交给 UIManager；没有打开过（showPopup 失败后由调用者 delete）时在这里释放
+    virtual ~UIPopup() {
+        if (optionsHandedOver) return;
+        for (int i = 0; i < optionCount; i++) {
+            delete options[i];
+            options[i] = nullptr;
+        }
+    }
+
+    // 添加选项按钮，按钮沿弹窗底部等宽排列
+    bool addOption(const String& text) {
+        if (optionCount >= MAX_OPTIONS) return false;
+        options[optionCount] = new PopupButton(-2000 - id * MAX_OPTIONS - optionCount, 0, 0, 10, 14, text, this, optionCount);
+        options[optionCount]->setParent(this);
+        optionCount++;
+        int slotW = (width - 8) / optionCount;
+        for (int i = 0; i < optionCount; i++) {
+            options[i]->setPosition(4 + i * slotW + 2, height - 20);
+            options[i]->setSize(slotW - 4, 16);
+        }
+        return true;
+    }
+    int getOptionCount() const { return optionCount; }
+    UIButton* getOption(int index) const { return (index >= 0 && index < optionCount) ? options[index] : nullptr; }
+
+    void setMessage(const String& newMessage) { if (message != newMessage) { message = newMessage; invalidate(); } }
+    const String& getMessage() const { return message; }
+
+    // 结束弹窗；实际关闭由 UIManager 在本次按键处理结束后完成
+    void finish(int optionIndex) {
+        if (finished) return;
+        finished = true;
+        result = optionIndex;
+    }
+    bool isFinished() const { return finished; }
+    int getResult() const { return result; }
+
+    // 弹窗关闭（像素已恢复、焦点已交还）之后回调；option 为选项序号，ESC 为 RESULT_CANCEL
+    virtual void onResult(int option) {}
+
+    void draw(LGFX_Device* display) override {
+        if (!visible) return;
+        int absX = getAbsoluteX();
+        int absY = getAbsoluteY();
+        Theme* theme = getCurrentTheme();
+        if (theme) {
+            ThemeDrawParams params;
+            params.display = display;
+            params.x = absX;
+            params.y = absY;
+            params.width = width;
+            params.height = height;
+            params.visible = visible;
+            params.text = title;
+            params.textColor = TFT_WHITE;
+            params.borderColor = TFT_WHITE;
+            params.backgroundColor = TFT_BLACK;
+            theme->drawWindow(params);
+
+            ThemeDrawParams label;
+            label.display = display;
+            label.x = absX + 6;
+            label.y = absY + (title.isEmpty() ? 6 : 20);
+            label.width = width - 12;
+            label.height = 12;
+            label.visible = visible;
+            label.text = message;
+            label.textColor = TFT_WHITE;
+            theme->drawLabel(label);
+        } else {
+            display->fillRect(absX, absY, width, height, TFT_BLACK);
+            display->drawRect(absX, absY, width, height, TFT_WHITE);
+            display->setFont(&fonts::efontCN_12);
+            display->setTextColor(TFT_WHITE);
+            display->setTextSize(1);
+            if (!title.isEmpty()) {
+                display->setCursor(absX + 5, absY + 3);
+                display->print(title);
+            }
+            display->setCursor(absX + 6, absY + (title.isEmpty() ? 6 : 20));
+            display->print(message);
+        }
+    }
+    bool handleKeyEvent(const KeyEvent& event) override {
+        return false;
+    }
+};
@@ -0,0 +1,117 @@
+#pragma once
+#include <M5Cardputer.h>
+#include "WidgetBase.h"
+
+// 迷你折线图：每个像素列对应一个采样，最新的采样在最右侧。采样存放在固定容量的环形缓冲中，
+// 追加采样只把控件自身标记为不透明的局部损伤，刷新时不会连带重绘下层窗口与相邻控件。
+class UISparkline : public UIWidget {
+public:
+    static const int MAX_SAMPLES = 128;
+
+private:
+    int32_t samples[MAX_SAMPLES];
+    int head;               // 下一个写入位置
+    int count;
+    int32_t rangeMin;
+    int32_t rangeMax;       // autoScale 时为纵轴上限的下限
+    bool autoScale;         // 纵轴上限取可见采样的最大值
+    uint16_t lineColor;
+    uint16_t fillColor;
+
+    int32_t sampleAt(int age) const {   // age 0 为最新
+        int index = head - 1 - age;
+        if (index < 0) index += MAX_SAMPLES;
+        return samples[index];
+    }
+
+public:
+    UISparkline(int id, int x, int y, int width, int height, int32_t minValue, int32_t maxValue, const String& name = "")
+        : UIWidget(id, WIDGET_SPARKLINE, x, y, width > MAX_SAMPLES ? MAX_SAMPLES : width, height, name),
+          head(0), count(0), rangeMin(minValue), rangeMax(maxValue > minValue ? maxValue : minValue + 1),
+          autoScale(false), lineColor(TFT_GREEN), fillColor(TFT_DARKGREEN) {
+        memset(samples, 0, sizeof(samples));
+    }
+
+    void push(int32_t value) {
+        samples[head] = value;
+        head = (head + 1) % MAX_SAMPLES;
+        if (count < MAX_SAMPLES) count++;
+        if (hasLastDrawBounds && visible) {
+            invalidateRect(getAbsoluteX(), getAbsoluteY(), width, height);
+        } else {
+            invalidate();
+        }
+    }
+
+    void clearSamples() {
+        head = 0;
+        count = 0;
+        invalidate();
+    }
+
+    int getSampleCount() const { return count; }
+    int32_t getLatest() const { return count > 0 ? sampleAt(0) : 0; }
+
+    void setRange(int32_t minValue, int32_t maxValue) {
+        if (maxValue <= minValue) maxValue = minValue + 1;
+        if (rangeMin == minValue && rangeMax == maxValue) return;
+        rangeMin = minValue;
+        rangeMax = maxValue;
+        invalidate();
+    }
+    void setAutoScale(bool enabled) { if (autoScale != enabled) { autoScale = enabled; invalidate(); } }
+    void setColors(uint16_t line, uint16_t fill) {
+        if (lineColor == line && fillColor == fill) return;
+        lineColor = line;
+        fillColor = fill;
+        invalidate();
+    }
+
+    // 控件每次都整块不透明重绘
+    bool isDamageOpaque() const override {
+        return dirty && hasDamageRect;
+    }
+
+    void draw(LGFX_Device* display) override {
+        if (!visible) return;
+        int ax = getAbsoluteX();
+        int ay = getAbsoluteY();
+        Theme* theme = getCurrentTheme();
+        uint16_t background = theme ? theme->getSurfaceColor() : TFT_BLACK;
+        display->fillRect(ax, ay, width, height, background);
+        display->drawFastHLine(ax, ay + height - 1, width, TFT_DARKGREY);
+        if (count == 0 || height < 3) return;
+
+        int visibleCount = count < width ? count : width;
+        int32_t top = rangeMax;
+        if (autoScale) {
+            for (int age = 0; age < visibleCount; age++) {
+                int32_t v = sampleAt(age);
+                if (v > top) top = v;
+            }
+        }
+        int32_t span = top - rangeMin;
+        if (span <= 0) span = 1;
+        int plotH = height - 2;     // 底部留出基线
+
+        int prevY = -1;
+        for (int age = visibleCount - 1; age >= 0; age--) {
+            int32_t v = sampleAt(age);
+            if (v < rangeMin) v = rangeMin;
+            if (v > top) v = top;
+            int colX = ax + width - 1 - age;
+            int y = ay + plotH - (int)((int64_t)(v - rangeMin) * plotH / span);
+            if (y < ay) y = ay;
+            if (y < ay + height - 1) {
+                display->drawFastVLine(colX, y, ay + height - 1 - y, fillColor);
+            }
+            // 与前一列相连，陡峭变化时不会断开
+            int y0 = prevY < 0 ? y : (prevY < y ? prevY : y);
+            int y1 = prevY < 0 ? y : (prevY > y ? prevY : y);
+            display->drawFastVLine(colX, y0, y1 - y0 + 1, lineColor);
+            prevY = y;
+        }
+    }
+
+    bool handleKeyEvent(const KeyEvent& event) override { return false; }
+};
@@ -10,7 +10,9 @@ enum UIWidgetType {
     WIDGET_MENU_GRID,
     WIDGET_SLIDER,
     WIDGET_IMAGE,
-    WIDGET_SCREEN
+    WIDGET_SCREEN,
+    WIDGET_POPUP,
+    WIDGET_SPARKLINE
 };
 class UIWidget {
 protected:
@@ -28,11 +30,17 @@ protected:
     int lastDrawY;
     int lastDrawW;
     int lastDrawH;
+    bool hasDamageRect;     // 为 true 时只有 damage 区域需要重绘（绝对坐标）
+    int damageX;
+    int damageY;
+    int damageW;
+    int damageH;
 public:
     UIWidget(int _id, UIWidgetType _type, int _x, int _y, int _w, int _h, const String& _name, bool _focusable = false)
         : id(_id), type(_type), x(_x), y(_y), width(_w), height(_h), name(_name),
           visible(true), focusable(_focusable), focused(false), parent(nullptr),
-          dirty(true), hasLastDrawBounds(false), lastDrawX(0), lastDrawY(0), lastDrawW(0), lastDrawH(0) {}
+          dirty(true), hasLastDrawBounds(false), lastDrawX(0), lastDrawY(0), lastDrawW(0), lastDrawH(0),
+          hasDamageRect(false), damageX(0), damageY(0), damageW(0), damageH(0) {}
     virtual ~UIWidget() {}
     int getId() const { return id; }
     UIWidgetType getType() const { return type; }
@@ -60,13 +68,34 @@ public:
         _h = height;
     }
     bool isDirty() const { return dirty; }
-    void invalidate() { dirty = true; }
+    void invalidate() { dirty = true; hasDamageRect = false; }
+    // 只标记控件内的一块区域需要重绘；控件已整体失效时保持整体重绘
+    void invalidateRect(int ax, int ay, int aw, int ah) {
+        if (aw <= 0 || ah <= 0) return;
+        if (dirty && !hasDamageRect) return;
+        if (!dirty) {
+            dirty = true;
+            hasDamageRect = true;
+            damageX = ax; damageY = ay; damageW = aw; damageH = ah;
+            return;
+        }
+        int nx = min(damageX, ax);
+        int ny = min(damageY, ay);
+        int rx = max(damageX + damageW, ax + aw);
+        int by = max(damageY + damageH, ay + ah);
+        damageX = nx; damageY = ny; damageW = rx - nx; damageH = by - ny;
+    }
     void markDrawn() {
         dirty = false;
+        hasDamageRect = false;
         hasLastDrawBounds = true;
         getAbsoluteBounds(lastDrawX, lastDrawY, lastDrawW, lastDrawH);
     }
     void getDirtyBounds(int& outX, int& outY, int& outW, int& outH) const {
+        if (dirty && hasDamageRect) {
+            outX = damageX; outY = damageY; outW = damageW; outH = damageH;
+            return;
+        }
         int cx, cy, cw, ch;
         getAbsoluteBounds(cx, cy, cw, ch);
         if (!hasLastDrawBounds) {
@@ -89,6 +118,9 @@ public:
     virtual bool handleKeyEvent(const KeyEvent& event) = 0;
     virtual void onFocusChanged(bool hasFocus) {}
     virtual bool update(uint32_t nowMs) { return false; }
+    // 当前脏区是否会被本控件自己的不透明绘制完全覆盖（如跑马灯条带），
+    // 为 true 时刷新可以跳过下层窗口背景与相邻控件的重绘
+    virtual bool isDamageOpaque() const { return false; }
     virtual void clearArea(LGFX_Device* display) {
         int ax, ay, aw, ah;
         getAbsoluteBounds(ax, ay, aw, ah);
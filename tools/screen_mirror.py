@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+"""
+Cardputer 屏幕镜像查看器
+
+设备端按 Ctrl+M 开启镜像后，UIManager 会把每次呈现的脏矩形经 USB 串口推送过来
+（协议见 src/system/ScreenMirror.h）。本工具解码数据流并实时显示；串口上夹杂的
+普通日志会原样打印到终端。
+
+使用：
+  python tools/screen_mirror.py --port /dev/ttyACM0          # 实时查看
+  python tools/screen_mirror.py --replay mirror.bin --ppm out.ppm
+      # 离线解码（例如原生基准 --mirror 生成的文件），把最终画面写成 PPM
+
+依赖：
+  pip install PyQt5 pyserial
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = b"\xA5\x5A"
+HELLO, ROW, REPEAT, FRAME = 0x01, 0x02, 0x03, 0x04
+SCALE = 3
+
+
+class MirrorDecoder:
+    """增量解码器：feed() 任意切分的字节流，维护一份 RGB565 帧缓冲。"""
+
+    def __init__(self, log=None):
+        self.buf = bytearray()
+        self.width = 0
+        self.height = 0
+        self.fb = []
+        self.frames = 0
+        self.log = log
+        self._text = bytearray()
+
+    def _emit_text(self, data):
+        if not self.log:
+            return
+        self._text.extend(data)
+        while b"\n" in self._text:
+            line, _, rest = self._text.partition(b"\n")
+            self.log(line.decode("utf-8", "replace").rstrip("\r"))
+            self._text = bytearray(rest)
+
+    def feed(self, data):
+        """返回本次数据中完成的 FRAME 数。"""
+        self.buf.extend(data)
+        done = 0
+        while True:
+            i = self.buf.find(MAGIC)
+            if i < 0:
+                # 末尾可能是半个包头，保留 1 字节
+                keep = 1 if self.buf[-1:] == MAGIC[:1] else 0
+                self._emit_text(self.buf[:len(self.buf) - keep])
+                del self.buf[:len(self.buf) - keep]
+                return done
+            if i > 0:
+                self._emit_text(self.buf[:i])
+                del self.buf[:i]
+            if len(self.buf) < 3:
+                return done
+            n = self._parse(self.buf[2], memoryview(self.buf)[3:])
+            if n is None:
+                return done          # 包不完整，等更多数据
+            if n < 0:
+                del self.buf[:1]     # 非法包，跳过这个包头重新同步
+                continue
+            if self.buf[2] == FRAME:
+                done += 1
+                self.frames += 1
+            del self.buf[:3 + n]
+
+    def _parse(self, kind, body):
+        if kind == HELLO:
+            if len(body) < 4:
+                return None
+            self.width, self.height = struct.unpack_from("<HH", body)
+            self.fb = [0] * (self.width * self.height)
+            return 4
+        if kind == FRAME:
+            return 2 if len(body) >= 2 else None
+        if kind == REPEAT:
+            if len(body) < 6:
+                return None
+            x, y, w = struct.unpack_from("<HHH", body)
+            if not self._valid(x, y, w) or y == 0:
+                return -1
+            src = (y - 1) * self.width + x
+            dst = y * self.width + x
+            self.fb[dst:dst + w] = self.fb[src:src + w]
+            return 6
+        if kind == ROW:
+            if len(body) < 8:
+                return None
+            x, y, w, length = struct.unpack_from("<HHHH", body)
+            if not self._valid(x, y, w):
+                return -1
+            if len(body) < 8 + length:
+                return None
+            row = self._decode_rle(body[8:8 + length], w)
+            if row is None:
+                return -1
+            dst = y * self.width + x
+            self.fb[dst:dst + w] = row
+            return 8 + length
+        return -1
+
+    def _valid(self, x, y, w):
+        return self.width > 0 and w > 0 and x + w <= self.width and y < self.height
+
+    @staticmethod
+    def _decode_rle(payload, w):
+        out = []
+        i = 0
+        while i < len(payload):
+            c = payload[i]
+            i += 1
+            if c & 0x80:
+                if i + 2 > len(payload):
+                    return None
+                px = (payload[i] << 8) | payload[i + 1]
+                out.extend([px] * ((c & 0x7F) + 1))
+                i += 2
+            else:
+                count = c + 1
+                if i + count * 2 > len(payload):
+                    return None
+                for k in range(count):
+                    out.append((payload[i + 2 * k] << 8) | payload[i + 2 * k + 1])
+                i += count * 2
+        return out if len(out) == w else None
+
+    def rgb888(self):
+        data = bytearray()
+        for c in self.fb:
+            data += bytes((((c >> 11) & 0x1F) << 3, ((c >> 5) & 0x3F) << 2, (c & 0x1F) << 3))
+        return bytes(data)
+
+
+def write_ppm(decoder, path):
+    with open(path, "wb") as f:
+        f.write(b"P6\n%d %d\n255\n" % (decoder.width, decoder.height))
+        f.write(decoder.rgb888())
+
+
+def run_viewer(port, baud):
+    import serial
+    from PyQt5.QtCore import QTimer, Qt
+    from PyQt5.QtGui import QImage, QPixmap
+    from PyQt5.QtWidgets import QApplication, QLabel
+
+    ser = serial.Serial(port, baud, timeout=0)
+    decoder = MirrorDecoder(log=print)
+    app = QApplication(sys.argv)
+    view = QLabel("等待设备开启镜像（Ctrl+M）…")
+    view.setAlignment(Qt.AlignCenter)
+    view.setWindowTitle("Cardputer Mirror - " + port)
+    view.resize(240 * SCALE, 135 * SCALE)
+    view.show()
+
+    def poll():
+        data = ser.read(65536)
+        if data and decoder.feed(data) and decoder.width:
+            img = QImage(decoder.rgb888(), decoder.width, decoder.height,
+                         decoder.width * 3, QImage.Format_RGB888)
+            view.setPixmap(QPixmap.fromImage(img).scaled(
+                decoder.width * SCALE, decoder.height * SCALE, Qt.KeepAspectRatio))
+
+    timer = QTimer()
+    timer.timeout.connect(poll)
+    timer.start(15)
+    sys.exit(app.exec_())
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Cardputer USB screen mirror viewer")
+    parser.add_argument("--port", help="serial port, e.g. /dev/ttyACM0 or COM5")
+    parser.add_argument("--baud", type=int, default=115200, help="ignored by USB-CDC, kept for adapters")
+    parser.add_argument("--replay", help="decode a captured byte stream instead of a serial port")
+    parser.add_argument("--ppm", help="with --replay: write the final frame as PPM")
+    args = parser.parse_args()
+
+    if args.replay:
+        decoder = MirrorDecoder()
+        with open(args.replay, "rb") as f:
+            decoder.feed(f.read())
+        print("%dx%d, %d frames" % (decoder.width, decoder.height, decoder.frames))
+        if args.ppm and decoder.width:
+            write_ppm(decoder, args.ppm)
+        return
+    if not args.port:
+        parser.error("--port or --replay is required")
+    run_viewer(args.port, args.baud)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+"""
+Cardputer 追踪转储转换工具
+
+以 -DENABLE_TRACE 编译的固件按 Ctrl+T（或音频欠载时自动）把两个核心的事件环形缓冲
+写到 SD 卡 /traces/trace_NNNN.bin（格式见 src/system/Trace.cpp）。本工具把转储
+转换成 Chrome trace JSON，可用 chrome://tracing 或 https://ui.perfetto.dev 打开。
+
+时间换算：每个核心的记录按 CCOUNT 周期计数，周期性的同步记录给出对应的 micros()
+与 CPU 频率；两核各自换算到 micros() 时间轴后即可对齐。成对的开始/结束记录合并为
+完整事件（X），其余为瞬时事件（i）。
+
+使用：
+  python tools/trace_to_chrome.py trace_0001.bin                # 输出 trace_0001.json
+  python tools/trace_to_chrome.py trace_0001.bin -o out.json --summary
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+MAGIC = b"CPTRACE1"
+PHASE_BEGIN, PHASE_END, PHASE_INSTANT, PHASE_SYNC = 0, 1, 2, 3
+RECORD = struct.Struct("<IHBBI")
+CORE_NAMES = {0: "core 0 (AudioTask)", 1: "core 1 (loopTask / UI)"}
+QUEUE_NAMES = {0: "audio.command", 1: "audio.event"}
+TRIGGER_NAMES = {0: "manual", 1: "underrun"}
+
+
+def parse_dump(data):
+    """返回 (事件名列表, 触发原因, {核心: [(cycles, id, phase, aux, arg), ...]})。"""
+    if data[:8] != MAGIC:
+        raise ValueError("not a Cardputer trace dump")
+    version, record_size, core_count, event_count, trigger, _ = struct.unpack_from("<6H", data, 8)
+    if version != 1 or record_size != RECORD.size:
+        raise ValueError("unsupported dump version %d / record size %d" % (version, record_size))
+    pos = 20
+    names = []
+    for _ in range(event_count):
+        n = data[pos]
+        names.append(data[pos + 1:pos + 1 + n].decode("ascii"))
+        pos += 1 + n
+    cores = {}
+    for core in range(core_count):
+        (count,) = struct.unpack_from("<I", data, pos)
+        pos += 4
+        records = [RECORD.unpack_from(data, pos + i * RECORD.size) for i in range(count)]
+        pos += count * RECORD.size
+        cores[core] = records
+    return names, trigger, cores
+
+
+def to_micros(records):
+    """把一个核心的记录换算成微秒时间戳；第一条同步之前的记录按第一条同步倒推。"""
+    syncs = [i for i, r in enumerate(records) if r[2] == PHASE_SYNC]
+    if not syncs:
+        return []
+    out = []
+    first = records[syncs[0]]
+    base_cycles, base_us, mhz = first[0], float(first[4]), max(first[3], 1)
+    for r in records[:syncs[0]]:
+        back = (base_cycles - r[0]) & 0xFFFFFFFF
+        out.append((base_us - back / mhz, r))
+    for r in records[syncs[0]:]:
+        if r[2] == PHASE_SYNC:
+            # micros() 是 32 位，跨越回绕时沿用上一段的时间轴
+            us = float(r[4])
+            while out and us < base_us - 2 ** 31:
+                us += 2 ** 32
+            base_cycles, base_us, mhz = r[0], us, max(r[3], 1)
+            continue
+        delta = (r[0] - base_cycles) & 0xFFFFFFFF
+        out.append((base_us + delta / mhz, r))
+    return out
+
+
+def describe_arg(name, arg):
+    if name.startswith("queue."):
+        return {"queue": QUEUE_NAMES.get(arg, arg)}
+    if name == "trigger":
+        return {"reason": TRIGGER_NAMES.get(arg, arg)}
+    return {"arg": arg}
+
+
+def convert(names, trigger, cores):
+    events = [{"ph": "M", "pid": 1, "name": "process_name", "args": {"name": "Cardputer"}}]
+    origin = None
+    timed = {}
+    for core, records in cores.items():
+        timed[core] = to_micros(records)
+        if timed[core]:
+            t0 = timed[core][0][0]
+            origin = t0 if origin is None else min(origin, t0)
+    origin = origin or 0.0
+    stats = {}
+    for core, items in timed.items():
+        events.append({"ph": "M", "pid": 1, "tid": core, "name": "thread_name",
+                       "args": {"name": CORE_NAMES.get(core, "core %d" % core)}})
+        open_spans = {}
+        for ts, (cycles, eid, phase, aux, arg) in items:
+            name = names[eid] if eid < len(names) else "event%d" % eid
+            ts -= origin
+            if phase == PHASE_BEGIN:
+                open_spans.setdefault(eid, []).append((ts, arg))
+            elif phase == PHASE_END:
+                stack = open_spans.get(eid)
+                if not stack:
+                    continue    # 开始记录已被环形缓冲覆盖
+                start, begin_arg = stack.pop()
+                args = describe_arg(name, begin_arg)
+                if name == "sd.read":
+                    args["bytes"] = arg
+                events.append({"ph": "X", "pid": 1, "tid": core, "name": name,
+                               "ts": round(start, 3), "dur": round(ts - start, 3), "args": args})
+                s = stats.setdefault(name, [0, 0.0, 0.0])
+                s[0] += 1
+                s[1] += ts - start
+                s[2] = max(s[2], ts - start)
+            else:
+                events.append({"ph": "i", "s": "t", "pid": 1, "tid": core, "name": name,
+                               "ts": round(ts, 3), "args": describe_arg(name, arg)})
+        # 转储时仍未结束的事件（例如触发发生在其内部）
+        for eid, stack in open_spans.items():
+            for start, begin_arg in stack:
+                events.append({"ph": "B", "pid": 1, "tid": core, "name": names[eid],
+                               "ts": round(start, 3), "args": describe_arg(names[eid], begin_arg)})
+    trace = {"traceEvents": events, "displayTimeUnit": "ms",
+             "otherData": {"trigger": TRIGGER_NAMES.get(trigger, trigger)}}
+    return trace, stats
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert a Cardputer trace dump to Chrome trace JSON")
+    parser.add_argument("dump", help="trace_NNNN.bin copied from the SD card")
+    parser.add_argument("-o", "--output", help="output JSON path (default: dump name with .json)")
+    parser.add_argument("--summary", action="store_true", help="print per-event duration statistics")
+    args = parser.parse_args()
+
+    with open(args.dump, "rb") as f:
+        data = f.read()
+    try:
+        names, trigger, cores = parse_dump(data)
+    except (ValueError, struct.error, IndexError) as e:
+        print("error: %s" % e, file=sys.stderr)
+        return 1
+    trace, stats = convert(names, trigger, cores)
+
+    output = args.output or (args.dump.rsplit(".", 1)[0] + ".json")
+    with open(output, "w") as f:
+        json.dump(trace, f)
+    counts = ", ".join("core %d: %d records" % (c, len(r)) for c, r in sorted(cores.items()))
+    print("%s -> %s (%s, trigger %s)" % (args.dump, output, counts, TRIGGER_NAMES.get(trigger, trigger)))
+
+    if args.summary:
+        print("%-16s %8s %10s %10s" % ("event", "count", "avg us", "max us"))
+        for name, (count, total, peak) in sorted(stats.items(), key=lambda kv: -kv[1][1]):
+            print("%-16s %8d %10.1f %10.1f" % (name, count, total / count, peak))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())